@@ -115,12 +115,14 @@ check_include_files("limits.h" HAVE_LIMITS_H)
 check_include_files("linux/limits.h" HAVE_LINUX_LIMITS_H)
 check_include_files("malloc.h" HAVE_MALLOC_H)
 check_include_files("math.h" HAVE_MATH_H)
+check_include_files("pthread.h" HAVE_PTHREAD_H)
 check_include_files("stddef.h" HAVE_STDDEF_H)
 check_include_files("stdint.h" HAVE_STDINT_H)
 check_include_files("stdio.h" HAVE_STDIO_H)
 check_include_files("stdlib.h" HAVE_STDLIB_H)
 check_include_files("strings.h" HAVE_STRINGS_H)
 check_include_files("string.h" HAVE_STRING_H)
+check_include_files("sys/mman.h" HAVE_SYS_MMAN_H)
 check_include_files("sys/types.h" HAVE_SYS_TYPES_H)
 check_include_files("unistd.h" HAVE_UNISTD_H)
 check_include_files("windows.h" HAVE_WINDOWS_H)
@@ -128,3 +130,5 @@ check_include_files("windows.h" HAVE_WINDOWS_H)
 # check for certain functions
 include(CheckFunctionExists)
 check_function_exists("bzero" HAVE_BZERO)
+check_function_exists("preadv" HAVE_PREADV)
+check_function_exists("pwritev" HAVE_PWRITEV)
@@ -0,0 +1,181 @@
+#ifndef _CMX_COMMON_REG_INDEX_H_
+#define _CMX_COMMON_REG_INDEX_H_
+
+/**
+ * Registration index.
+ *
+ * Backs the per-process registration caches of the cmx ports.  Each
+ * process gets a reg_index_t holding its registered segments sorted by
+ * starting address, so lookups are a binary search instead of a list
+ * walk.  The most recent hit is remembered and checked first, since
+ * consecutive operations usually target the same segment.
+ *
+ * Segments of one index must not overlap.  The index only stores the
+ * address range and an opaque pointer to the port's own entry type.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    char *beg;      /**< starting address of segment */
+    char *end;      /**< one past the last byte of segment */
+    void *entry;    /**< the port's registration entry */
+} reg_index_item_t;
+
+typedef struct {
+    reg_index_item_t *items;    /**< segments sorted by beg */
+    int size;                   /**< number of segments */
+    int capacity;               /**< allocated length of items */
+    int last;                   /**< index of the most recent hit */
+} reg_index_t;
+
+
+static inline void reg_index_init(reg_index_t *index)
+{
+    index->items = NULL;
+    index->size = 0;
+    index->capacity = 0;
+    index->last = 0;
+}
+
+
+static inline void reg_index_destroy(reg_index_t *index)
+{
+    free(index->items);
+    reg_index_init(index);
+}
+
+
+/* a zero length query is treated as one byte so that a query at the end of
+ * one segment never matches its neighbor */
+static inline char* reg_index_query_end(void *buf, size_t len)
+{
+    return (char*)buf + (len ? len : 1);
+}
+
+
+/* index of the last segment whose beg is <= addr, or -1 */
+static inline int reg_index_upper(reg_index_t *index, char *addr)
+{
+    int lo = 0;
+    int hi = index->size;
+
+    while (lo < hi) {
+        int mid = lo + (hi-lo)/2;
+        if (index->items[mid].beg <= addr) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+
+    return lo - 1;
+}
+
+
+/**
+ * Find the entry whose segment contains [buf,buf+len) completely.
+ *
+ * @return the entry, or NULL if there is none
+ */
+static inline void* reg_index_find(reg_index_t *index, void *buf, size_t len)
+{
+    char *beg = (char*)buf;
+    char *end = reg_index_query_end(buf, len);
+    int last = index->last;
+    int i = 0;
+
+    if (last < index->size
+            && index->items[last].beg <= beg && end <= index->items[last].end) {
+        return index->items[last].entry;
+    }
+
+    i = reg_index_upper(index, beg);
+    if (i >= 0 && end <= index->items[i].end) {
+        index->last = i;
+        return index->items[i].entry;
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Find an entry whose segment intersects [buf,buf+len).
+ *
+ * @return the entry, or NULL if there is none
+ */
+static inline void* reg_index_find_intersection(
+        reg_index_t *index, void *buf, size_t len)
+{
+    char *beg = (char*)buf;
+    char *end = reg_index_query_end(buf, len);
+    int i = reg_index_upper(index, end-1);
+
+    if (i >= 0 && index->items[i].end > beg) {
+        return index->items[i].entry;
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Add the segment [buf,buf+len) for entry.
+ *
+ * @pre the segment does not intersect any other in the index
+ */
+static inline void reg_index_insert(
+        reg_index_t *index, void *buf, size_t len, void *entry)
+{
+    int i = 0;
+
+    if (index->size == index->capacity) {
+        int capacity = index->capacity ? 2*index->capacity : 16;
+        reg_index_item_t *items = (reg_index_item_t*)realloc(
+                index->items, sizeof(reg_index_item_t)*capacity);
+        if (NULL == items) {
+            abort();
+        }
+        index->items = items;
+        index->capacity = capacity;
+    }
+
+    i = reg_index_upper(index, (char*)buf) + 1;
+    (void)memmove(&index->items[i+1], &index->items[i],
+            sizeof(reg_index_item_t)*(index->size-i));
+    index->items[i].beg = (char*)buf;
+    index->items[i].end = (char*)buf + len;
+    index->items[i].entry = entry;
+    index->size += 1;
+    index->last = i;
+}
+
+
+/**
+ * Remove the segment starting exactly at buf.
+ *
+ * @return its entry, or NULL if no segment starts at buf
+ */
+static inline void* reg_index_remove(reg_index_t *index, void *buf)
+{
+    int i = reg_index_upper(index, (char*)buf);
+    void *entry = NULL;
+
+    if (i < 0 || index->items[i].beg != (char*)buf) {
+        return NULL;
+    }
+
+    entry = index->items[i].entry;
+    (void)memmove(&index->items[i], &index->items[i+1],
+            sizeof(reg_index_item_t)*(index->size-i-1));
+    index->size -= 1;
+    index->last = 0;
+
+    return entry;
+}
+
+#endif /* _CMX_COMMON_REG_INDEX_H_ */
@@ -19,7 +19,6 @@ typedef enum _reg_return_t {
  * A registered contiguous memory region.
  */
 typedef struct _reg_entry_t {
-    struct _reg_entry_t *next;  /**< next memory region in list */
     void *buf;                  /**< starting address of region */
     size_t len;                 /**< length of region */
     void *mapped;               /**< starting address of mmap'd region */
@@ -1,6 +1,11 @@
 #ifndef _COMEX_COMMON_ACC_H_
 #define _COMEX_COMMON_ACC_H_
 
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "comex.h"
 
 /* needed for complex accumulate */
@@ -103,54 +108,500 @@ static inline void _scale(
 #undef SCALE
 }
 
-static inline void _acc(
-        const int op,
+/*
+ * Accumulate kernels.
+ *
+ * Each kernel does dst += scale*src over bytes of one COMEX_ACC_* type.
+ * There are portable C kernels, plus AVX2 and AVX-512 kernels on x86-64
+ * compilers that support per-function target attributes.  The best kernel
+ * the CPU supports is chosen at run time, once per process; COMEX_ACC_SIMD
+ * (none, avx2 or avx512) caps the choice.  Accumulates with scale==1 use
+ * plain adds, and a complex scale of 1 is handled as a real add over twice
+ * the elements.  Blocks of at least COMEX_ACC_NT_BYTES (default 4MB, 0
+ * disables) are written with non-temporal stores so that a large
+ * accumulate does not flush the cache of whoever applies it.
+ */
+
+typedef void (*_acc_kernel_t)(
         const int bytes,
         void * const restrict dst,
         const void * const restrict src,
+        const void * const restrict scale,
+        const int nt);
+
+#define ACC_ISA_NONE   0
+#define ACC_ISA_AVX2   1
+#define ACC_ISA_AVX512 2
+
+#if defined(__x86_64__) && defined(__GNUC__) \
+    && (defined(__clang__) || __GNUC__ >= 5) && !defined(__INTEL_COMPILER)
+#define ACC_SIMD 1
+#include <immintrin.h>
+#else
+#define ACC_SIMD 0
+#endif
+
+#define ACC_KERNEL_C(NAME, WHICH, C_TYPE)                                   \
+static inline void _acc_c_##NAME(                                          \
+        const int bytes,                                                    \
+        void * const restrict dst,                                          \
+        const void * const restrict src,                                    \
+        const void * const restrict scale,                                  \
+        const int nt)                                                       \
+{                                                                           \
+    int m;                                                                  \
+    const int m_lim = bytes/sizeof(C_TYPE);                                 \
+    C_TYPE * const restrict iterator = (C_TYPE * const restrict)dst;        \
+    const C_TYPE * const restrict value = (const C_TYPE * const restrict)src;\
+    const C_TYPE calc_scale = *(const C_TYPE * const restrict)scale;        \
+    (void)nt;                                                               \
+    for (m = 0 ; m < m_lim; ++m) {                                          \
+        IADD_SCALE_##WHICH(iterator[m], value[m], calc_scale);              \
+    }                                                                       \
+}
+#define ACC_KERNEL_C_ONE(NAME, C_TYPE)                                      \
+static inline void _acc_c_##NAME##_one(                                    \
+        const int bytes,                                                    \
+        void * const restrict dst,                                          \
+        const void * const restrict src,                                    \
+        const void * const restrict scale,                                  \
+        const int nt)                                                       \
+{                                                                           \
+    int m;                                                                  \
+    const int m_lim = bytes/sizeof(C_TYPE);                                 \
+    C_TYPE * const restrict iterator = (C_TYPE * const restrict)dst;        \
+    const C_TYPE * const restrict value = (const C_TYPE * const restrict)src;\
+    (void)scale;                                                            \
+    (void)nt;                                                               \
+    for (m = 0 ; m < m_lim; ++m) {                                          \
+        iterator[m] += value[m];                                            \
+    }                                                                       \
+}
+ACC_KERNEL_C(dbl, REG, double)
+ACC_KERNEL_C(flt, REG, float)
+ACC_KERNEL_C(int, REG, int)
+ACC_KERNEL_C(lng, REG, long)
+ACC_KERNEL_C(dcp, CPL, DoubleComplex)
+ACC_KERNEL_C(cpl, CPL, SingleComplex)
+ACC_KERNEL_C_ONE(dbl, double)
+ACC_KERNEL_C_ONE(flt, float)
+ACC_KERNEL_C_ONE(int, int)
+ACC_KERNEL_C_ONE(lng, long)
+#undef ACC_KERNEL_C
+#undef ACC_KERNEL_C_ONE
+
+#if HAVE_BLAS
+#define ACC_KERNEL_BLAS(NAME, C_TYPE, LETTER)                               \
+static inline void _acc_blas_##NAME(                                       \
+        const int bytes,                                                    \
+        void * const restrict dst,                                          \
+        const void * const restrict src,                                    \
+        const void * const restrict scale,                                  \
+        const int nt)                                                       \
+{                                                                           \
+    const BLAS_INT ONE = 1;                                                 \
+    const BLAS_INT N = bytes/sizeof(C_TYPE);                                \
+    (void)nt;                                                               \
+    BLAS_##LETTER##AXPY(&N, scale, src, &ONE, dst, &ONE);                   \
+}
+ACC_KERNEL_BLAS(dbl, double, D)
+ACC_KERNEL_BLAS(flt, float, S)
+ACC_KERNEL_BLAS(dcp, DoubleComplex, Z)
+ACC_KERNEL_BLAS(cpl, SingleComplex, C)
+#undef ACC_KERNEL_BLAS
+#define ACC_FALLBACK_dbl _acc_blas_dbl
+#define ACC_FALLBACK_flt _acc_blas_flt
+#define ACC_FALLBACK_dcp _acc_blas_dcp
+#define ACC_FALLBACK_cpl _acc_blas_cpl
+#else
+#define ACC_FALLBACK_dbl _acc_c_dbl
+#define ACC_FALLBACK_flt _acc_c_flt
+#define ACC_FALLBACK_dcp _acc_c_dcp
+#define ACC_FALLBACK_cpl _acc_c_cpl
+#endif
+#define ACC_FALLBACK_int _acc_c_int
+
+#if ACC_SIMD
+/* wrappers that give every vector type the same load/store/set1 shape */
+#define ACC_LD_PD256(p)     _mm256_loadu_pd(p)
+#define ACC_ST_PD256(p,v)   _mm256_storeu_pd(p,v)
+#define ACC_NT_PD256(p,v)   _mm256_stream_pd(p,v)
+#define ACC_LD_PS256(p)     _mm256_loadu_ps(p)
+#define ACC_ST_PS256(p,v)   _mm256_storeu_ps(p,v)
+#define ACC_NT_PS256(p,v)   _mm256_stream_ps(p,v)
+#define ACC_LD_SI256(p)     _mm256_loadu_si256((const __m256i*)(p))
+#define ACC_ST_SI256(p,v)   _mm256_storeu_si256((__m256i*)(p),v)
+#define ACC_NT_SI256(p,v)   _mm256_stream_si256((__m256i*)(p),v)
+#define ACC_LD_PD512(p)     _mm512_loadu_pd(p)
+#define ACC_ST_PD512(p,v)   _mm512_storeu_pd(p,v)
+#define ACC_NT_PD512(p,v)   _mm512_stream_pd(p,v)
+#define ACC_LD_PS512(p)     _mm512_loadu_ps(p)
+#define ACC_ST_PS512(p,v)   _mm512_storeu_ps(p,v)
+#define ACC_NT_PS512(p,v)   _mm512_stream_ps(p,v)
+#define ACC_LD_SI512(p)     _mm512_loadu_si512((const void*)(p))
+#define ACC_ST_SI512(p,v)   _mm512_storeu_si512((void*)(p),v)
+#define ACC_NT_SI512(p,v)   _mm512_stream_si512((__m512i*)(p),v)
+
+/* y + a*x, and y + x for scale==1 */
+#define ACC_FMA_PD256(a,x,y)  _mm256_fmadd_pd(a,x,y)
+#define ACC_ADD_PD256(a,x,y)  _mm256_add_pd(x,y)
+#define ACC_FMA_PS256(a,x,y)  _mm256_fmadd_ps(a,x,y)
+#define ACC_ADD_PS256(a,x,y)  _mm256_add_ps(x,y)
+#define ACC_MUL_I32_256(a,x,y) _mm256_add_epi32(y,_mm256_mullo_epi32(a,x))
+#define ACC_ADD_I32_256(a,x,y) _mm256_add_epi32(x,y)
+#define ACC_ADD_I64_256(a,x,y) _mm256_add_epi64(x,y)
+#define ACC_FMA_PD512(a,x,y)  _mm512_fmadd_pd(a,x,y)
+#define ACC_ADD_PD512(a,x,y)  _mm512_add_pd(x,y)
+#define ACC_FMA_PS512(a,x,y)  _mm512_fmadd_ps(a,x,y)
+#define ACC_ADD_PS512(a,x,y)  _mm512_add_ps(x,y)
+#define ACC_MUL_I32_512(a,x,y) _mm512_add_epi32(y,_mm512_mullo_epi32(a,x))
+#define ACC_ADD_I32_512(a,x,y) _mm512_add_epi32(x,y)
+#define ACC_ADD_I64_512(a,x,y) _mm512_add_epi64(x,y)
+
+/* swap real and imaginary parts of every complex element */
+#define ACC_SWAP_PD256(x)   _mm256_permute_pd(x,0x5)
+#define ACC_SWAP_PS256(x)   _mm256_permute_ps(x,0xB1)
+#define ACC_SWAP_PD512(x)   _mm512_permute_pd(x,0x55)
+#define ACC_SWAP_PS512(x)   _mm512_permute_ps(x,0xB1)
+
+#define ACC_KERNEL_SIMD(ISA, TARGET, NAME, C_TYPE, VEC, SET1, VK, OP)       \
+static inline __attribute__((target(TARGET))) void _acc_##ISA##_##NAME(    \
+        const int bytes,                                                    \
+        void * const restrict dst,                                          \
+        const void * const restrict src,                                    \
+        const void * const restrict scale,                                  \
+        const int nt)                                                       \
+{                                                                           \
+    const int w = sizeof(VEC)/sizeof(C_TYPE);                               \
+    const int n = bytes/sizeof(C_TYPE);                                     \
+    C_TYPE * const restrict d = (C_TYPE * const restrict)dst;               \
+    const C_TYPE * const restrict s = (const C_TYPE * const restrict)src;   \
+    const C_TYPE alpha = *(const C_TYPE * const restrict)scale;             \
+    const VEC a = SET1(alpha);                                              \
+    int i = 0;                                                              \
+    (void)a;                                                                \
+    /* the peel below reaches vector alignment only from an aligned element,\
+       otherwise the unaligned loop takes the whole block */                \
+    if (nt && 0 == ((size_t)d) % sizeof(C_TYPE)) {                          \
+        for (; i < n && ((size_t)(d+i)) % sizeof(VEC); ++i) {              \
+            d[i] += alpha*s[i];                                             \
+        }                                                                   \
+        for (; i+w <= n; i += w) {                                          \
+            ACC_NT_##VK(d+i, OP(a, ACC_LD_##VK(s+i), ACC_LD_##VK(d+i)));    \
+        }                                                                   \
+        _mm_sfence();                                                       \
+    }                                                                       \
+    for (; i+w <= n; i += w) {                                              \
+        ACC_ST_##VK(d+i, OP(a, ACC_LD_##VK(s+i), ACC_LD_##VK(d+i)));        \
+    }                                                                       \
+    for (; i < n; ++i) {                                                    \
+        d[i] += alpha*s[i];                                                 \
+    }                                                                       \
+}
+
+/* y += (ar + i*ai)*x as y + addsub(ar*x, ai*swap(x)) */
+#define ACC_KERNEL_SIMD_CPL(ISA, TARGET, NAME, C_TYPE, R_TYPE, VEC, SET1,   \
+        VK, FMADDSUB, MUL, ADD)                                             \
+static inline __attribute__((target(TARGET))) void _acc_##ISA##_##NAME(    \
+        const int bytes,                                                    \
+        void * const restrict dst,                                          \
+        const void * const restrict src,                                    \
+        const void * const restrict scale,                                  \
+        const int nt)                                                       \
+{                                                                           \
+    const int w = sizeof(VEC)/sizeof(R_TYPE);                               \
+    const int n = 2*(bytes/sizeof(C_TYPE));                                 \
+    R_TYPE * const restrict d = (R_TYPE * const restrict)dst;               \
+    const R_TYPE * const restrict s = (const R_TYPE * const restrict)src;   \
+    const C_TYPE alpha = *(const C_TYPE * const restrict)scale;             \
+    const VEC ar = SET1(alpha.real);                                        \
+    const VEC ai = SET1(alpha.imag);                                        \
+    int i = 0;                                                              \
+    /* a complex element may be aligned only to its real part, in which    \
+       case the unaligned loop takes the whole block */                     \
+    if (nt && 0 == ((size_t)d) % sizeof(C_TYPE)) {                          \
+        for (; i < n && ((size_t)(d+i)) % sizeof(VEC); i += 2) {           \
+            IADD_SCALE_CPL(*(C_TYPE*)(d+i), *(const C_TYPE*)(s+i), alpha);  \
+        }                                                                   \
+        for (; i+w <= n; i += w) {                                          \
+            const VEC x = ACC_LD_##VK(s+i);                                 \
+            const VEC t = FMADDSUB(ar, x, MUL(ai, ACC_SWAP_##VK(x)));       \
+            ACC_NT_##VK(d+i, ADD(ACC_LD_##VK(d+i), t));                     \
+        }                                                                   \
+        _mm_sfence();                                                       \
+    }                                                                       \
+    for (; i+w <= n; i += w) {                                              \
+        const VEC x = ACC_LD_##VK(s+i);                                     \
+        const VEC t = FMADDSUB(ar, x, MUL(ai, ACC_SWAP_##VK(x)));           \
+        ACC_ST_##VK(d+i, ADD(ACC_LD_##VK(d+i), t));                         \
+    }                                                                       \
+    for (; i < n; i += 2) {                                                 \
+        IADD_SCALE_CPL(*(C_TYPE*)(d+i), *(const C_TYPE*)(s+i), alpha);      \
+    }                                                                       \
+}
+
+ACC_KERNEL_SIMD(avx2, "avx2,fma", dbl, double, __m256d,
+        _mm256_set1_pd, PD256, ACC_FMA_PD256)
+ACC_KERNEL_SIMD(avx2, "avx2,fma", dbl_one, double, __m256d,
+        _mm256_set1_pd, PD256, ACC_ADD_PD256)
+ACC_KERNEL_SIMD(avx2, "avx2,fma", flt, float, __m256,
+        _mm256_set1_ps, PS256, ACC_FMA_PS256)
+ACC_KERNEL_SIMD(avx2, "avx2,fma", flt_one, float, __m256,
+        _mm256_set1_ps, PS256, ACC_ADD_PS256)
+ACC_KERNEL_SIMD(avx2, "avx2,fma", int, int, __m256i,
+        _mm256_set1_epi32, SI256, ACC_MUL_I32_256)
+ACC_KERNEL_SIMD(avx2, "avx2,fma", int_one, int, __m256i,
+        _mm256_set1_epi32, SI256, ACC_ADD_I32_256)
+ACC_KERNEL_SIMD(avx2, "avx2,fma", lng_one, long, __m256i,
+        _mm256_set1_epi64x, SI256, ACC_ADD_I64_256)
+ACC_KERNEL_SIMD_CPL(avx2, "avx2,fma", dcp, DoubleComplex, double, __m256d,
+        _mm256_set1_pd, PD256, _mm256_fmaddsub_pd, _mm256_mul_pd,
+        _mm256_add_pd)
+ACC_KERNEL_SIMD_CPL(avx2, "avx2,fma", cpl, SingleComplex, float, __m256,
+        _mm256_set1_ps, PS256, _mm256_fmaddsub_ps, _mm256_mul_ps,
+        _mm256_add_ps)
+
+ACC_KERNEL_SIMD(avx512, "avx512f", dbl, double, __m512d,
+        _mm512_set1_pd, PD512, ACC_FMA_PD512)
+ACC_KERNEL_SIMD(avx512, "avx512f", dbl_one, double, __m512d,
+        _mm512_set1_pd, PD512, ACC_ADD_PD512)
+ACC_KERNEL_SIMD(avx512, "avx512f", flt, float, __m512,
+        _mm512_set1_ps, PS512, ACC_FMA_PS512)
+ACC_KERNEL_SIMD(avx512, "avx512f", flt_one, float, __m512,
+        _mm512_set1_ps, PS512, ACC_ADD_PS512)
+ACC_KERNEL_SIMD(avx512, "avx512f", int, int, __m512i,
+        _mm512_set1_epi32, SI512, ACC_MUL_I32_512)
+ACC_KERNEL_SIMD(avx512, "avx512f", int_one, int, __m512i,
+        _mm512_set1_epi32, SI512, ACC_ADD_I32_512)
+ACC_KERNEL_SIMD(avx512, "avx512f", lng_one, long, __m512i,
+        _mm512_set1_epi64, SI512, ACC_ADD_I64_512)
+ACC_KERNEL_SIMD_CPL(avx512, "avx512f", dcp, DoubleComplex, double, __m512d,
+        _mm512_set1_pd, PD512, _mm512_fmaddsub_pd, _mm512_mul_pd,
+        _mm512_add_pd)
+ACC_KERNEL_SIMD_CPL(avx512, "avx512f", cpl, SingleComplex, float, __m512,
+        _mm512_set1_ps, PS512, _mm512_fmaddsub_ps, _mm512_mul_ps,
+        _mm512_add_ps)
+#undef ACC_KERNEL_SIMD
+#undef ACC_KERNEL_SIMD_CPL
+#undef ACC_LD_PD256
+#undef ACC_ST_PD256
+#undef ACC_NT_PD256
+#undef ACC_LD_PS256
+#undef ACC_ST_PS256
+#undef ACC_NT_PS256
+#undef ACC_LD_SI256
+#undef ACC_ST_SI256
+#undef ACC_NT_SI256
+#undef ACC_LD_PD512
+#undef ACC_ST_PD512
+#undef ACC_NT_PD512
+#undef ACC_LD_PS512
+#undef ACC_ST_PS512
+#undef ACC_NT_PS512
+#undef ACC_LD_SI512
+#undef ACC_ST_SI512
+#undef ACC_NT_SI512
+#undef ACC_FMA_PD256
+#undef ACC_ADD_PD256
+#undef ACC_FMA_PS256
+#undef ACC_ADD_PS256
+#undef ACC_MUL_I32_256
+#undef ACC_ADD_I32_256
+#undef ACC_ADD_I64_256
+#undef ACC_FMA_PD512
+#undef ACC_ADD_PD512
+#undef ACC_FMA_PS512
+#undef ACC_ADD_PS512
+#undef ACC_MUL_I32_512
+#undef ACC_ADD_I32_512
+#undef ACC_ADD_I64_512
+#undef ACC_SWAP_PD256
+#undef ACC_SWAP_PS256
+#undef ACC_SWAP_PD512
+#undef ACC_SWAP_PS512
+#endif /* ACC_SIMD */
+
+/* best kernel set supported by both the CPU and COMEX_ACC_SIMD */
+static inline int _acc_isa(void)
+{
+    static int isa = -1;
+
+    if (isa < 0) {
+        int best = ACC_ISA_NONE;
+        const char *value = getenv("COMEX_ACC_SIMD");
+#if ACC_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            best = ACC_ISA_AVX512;
+        }
+        else if (__builtin_cpu_supports("avx2")
+                && __builtin_cpu_supports("fma")) {
+            best = ACC_ISA_AVX2;
+        }
+#endif
+        if (NULL != value) {
+            if (0 == strcmp(value, "none") || 0 == strcmp(value, "0")) {
+                best = ACC_ISA_NONE;
+            }
+            else if (0 == strcmp(value, "avx2") && best > ACC_ISA_AVX2) {
+                best = ACC_ISA_AVX2;
+            }
+        }
+        isa = best;
+    }
+
+    return isa;
+}
+
+/* blocks of at least this many bytes are written with streaming stores */
+static inline int _acc_nt_bytes(void)
+{
+    static int nt_bytes = -1;
+
+    if (nt_bytes < 0) {
+        const char *value = getenv("COMEX_ACC_NT_BYTES");
+        nt_bytes = (NULL != value) ? atoi(value) : 4*1024*1024;
+        if (nt_bytes <= 0) {
+            nt_bytes = INT_MAX;
+        }
+    }
+
+    return nt_bytes;
+}
+
+/* the kernel for op and scale, resolved once per accumulate */
+static inline _acc_kernel_t _acc_kernel(
+        const int op,
         const void * const restrict scale)
 {
-#define ACC_BLAS(COMEX_TYPE, C_TYPE, LETTER)                                \
-    if (op == COMEX_TYPE) {                                                 \
-        const BLAS_INT ONE = 1;                                             \
-        const BLAS_INT N = bytes/sizeof(C_TYPE);                            \
-        BLAS_##LETTER##AXPY(&N, scale, src, &ONE, dst, &ONE);               \
-    } else                                                                 
-#define ACC(WHICH, COMEX_TYPE, C_TYPE)                                      \
-    if (op == COMEX_TYPE) {                                                 \
-        int m;                                                              \
-        const int m_lim = bytes/sizeof(C_TYPE);                             \
-        C_TYPE * const restrict iterator = (C_TYPE * const restrict)dst;    \
-        const C_TYPE * const restrict value = (const C_TYPE * const restrict)src;\
-        const C_TYPE calc_scale = *(const C_TYPE * const restrict)scale;    \
-        for (m = 0 ; m < m_lim; ++m) {                                      \
-            IADD_SCALE_##WHICH(iterator[m], value[m], calc_scale);          \
-        }                                                                   \
-    } else
-#if HAVE_BLAS
-    ACC_BLAS(COMEX_ACC_DBL, double, D)
-    ACC_BLAS(COMEX_ACC_FLT, float, S)
-    ACC(REG, COMEX_ACC_INT, int)
-    ACC(REG, COMEX_ACC_LNG, long)
-    ACC_BLAS(COMEX_ACC_DCP, DoubleComplex, Z)
-    ACC_BLAS(COMEX_ACC_CPL, SingleComplex, C)
+    const int isa = _acc_isa();
+    int one = 0;
+
+    switch (op) {
+        case COMEX_ACC_DBL:
+            one = (1.0 == *(const double*)scale); break;
+        case COMEX_ACC_FLT:
+            one = (1.0f == *(const float*)scale); break;
+        case COMEX_ACC_INT:
+            one = (1 == *(const int*)scale); break;
+        case COMEX_ACC_LNG:
+            one = (1 == *(const long*)scale); break;
+        case COMEX_ACC_DCP:
+            one = (1.0 == ((const DoubleComplex*)scale)->real
+                    && 0.0 == ((const DoubleComplex*)scale)->imag); break;
+        case COMEX_ACC_CPL:
+            one = (1.0f == ((const SingleComplex*)scale)->real
+                    && 0.0f == ((const SingleComplex*)scale)->imag); break;
+    }
+
+#define ACC_PICK(NAME, ONE_NAME)                                            \
+    if (ACC_ISA_AVX512 == isa) return one ? ONE(avx512, ONE_NAME) : SCALED(avx512, NAME);\
+    if (ACC_ISA_AVX2 == isa)   return one ? ONE(avx2, ONE_NAME) : SCALED(avx2, NAME);  \
+    return one ? _acc_c_##ONE_NAME##_one : FALLBACK(NAME)
+#if ACC_SIMD
+#define ONE(ISA, NAME) _acc_##ISA##_##NAME##_one
+#define SCALED(ISA, NAME) _acc_##ISA##_##NAME
 #else
-    ACC(REG, COMEX_ACC_DBL, double)
-    ACC(REG, COMEX_ACC_FLT, float)
-    ACC(REG, COMEX_ACC_INT, int)
-    ACC(REG, COMEX_ACC_LNG, long)
-    ACC(CPL, COMEX_ACC_DCP, DoubleComplex)
-    ACC(CPL, COMEX_ACC_CPL, SingleComplex)
+#define ONE(ISA, NAME) _acc_c_##NAME##_one
+#define SCALED(ISA, NAME) FALLBACK(NAME)
 #endif
-    {
+#define FALLBACK(NAME) ACC_FALLBACK_##NAME
+    switch (op) {
+        case COMEX_ACC_DBL: ACC_PICK(dbl, dbl);
+        case COMEX_ACC_FLT: ACC_PICK(flt, flt);
+        case COMEX_ACC_INT: ACC_PICK(int, int);
+        case COMEX_ACC_DCP: ACC_PICK(dcp, dbl);
+        case COMEX_ACC_CPL: ACC_PICK(cpl, flt);
+        case COMEX_ACC_LNG:
+            /* no 64-bit multiply below AVX-512DQ, so only adds are vector */
+            if (one) {
+                if (ACC_ISA_AVX512 == isa) return ONE(avx512, lng);
+                if (ACC_ISA_AVX2 == isa) return ONE(avx2, lng);
+            }
+            return one ? _acc_c_lng_one : _acc_c_lng;
+    }
+#undef ACC_PICK
+#undef ONE
+#undef SCALED
+#undef FALLBACK
+#undef ACC_FALLBACK_dbl
+#undef ACC_FALLBACK_flt
+#undef ACC_FALLBACK_dcp
+#undef ACC_FALLBACK_cpl
+#undef ACC_FALLBACK_int
+
 #ifdef COMEX_ASSERT
-        COMEX_ASSERT(0);
+    COMEX_ASSERT(0);
 #else
-        assert(0);
+    assert(0);
 #endif
+    return NULL;
+}
+
+static inline void _acc(
+        const int op,
+        const int bytes,
+        void * const restrict dst,
+        const void * const restrict src,
+        const void * const restrict scale)
+{
+    _acc_kernel(op, scale)(bytes, dst, src, scale, bytes >= _acc_nt_bytes());
+}
+
+/**
+ * Fused strided accumulate.
+ *
+ * Accumulates count[0] bytes at each of the count[1]*...*count[levels]
+ * positions of the strided dst, with the kernel resolved once.  If
+ * src_stride is NULL, src is packed.
+ */
+static inline void _acc_strided(
+        const int op,
+        const int stride_levels,
+        const int * const count,
+        void * const dst,
+        const int * const dst_stride,
+        const void * const src,
+        const int * const src_stride,
+        const void * const restrict scale)
+{
+    const _acc_kernel_t kernel = _acc_kernel(op, scale);
+    const int nt = count[0] >= _acc_nt_bytes();
+    int idx[8];
+    long dst_idx = 0;
+    long src_idx = 0;
+    int i;
+
+    for (i=0; i<=stride_levels; ++i) {
+        idx[i] = 0;
+    }
+
+    while (1) {
+        kernel(count[0], (char*)dst + dst_idx, (const char*)src + src_idx,
+                scale, nt);
+
+        if (!src_stride) {
+            src_idx += count[0];
+        }
+        /* advance the odometer, innermost stride level first */
+        for (i=1; i<=stride_levels; ++i) {
+            dst_idx += dst_stride[i-1];
+            if (src_stride) {
+                src_idx += src_stride[i-1];
+            }
+            if (++idx[i] < count[i]) {
+                break;
+            }
+            dst_idx -= (long)count[i] * dst_stride[i-1];
+            if (src_stride) {
+                src_idx -= (long)count[i] * src_stride[i-1];
+            }
+            idx[i] = 0;
+        }
+        if (i > stride_levels) {
+            break;
+        }
     }
-#undef ACC_BLAS
-#undef ACC
 }
 
 #undef IADD_SCALE_REG
@@ -158,5 +609,9 @@ static inline void _acc(
 #undef MUL_REG
 #undef MUL_CPL
 #undef BLAS_INT
+#undef ACC_ISA_NONE
+#undef ACC_ISA_AVX2
+#undef ACC_ISA_AVX512
+#undef ACC_SIMD
 
 #endif /* _COMEX_COMMON_ACC_H_ */
@@ -21,6 +21,7 @@
 #include "comex.h"
 #include "comex_impl.h"
 #include "reg_cache.h"
+#include "reg_index.h"
 
 
 /**
@@ -38,7 +39,7 @@ typedef struct _dmapp_entry_t {
 
 
 /* the static members in this module */
-static reg_entry_t **reg_cache = NULL; /**< list of caches (one per process) */
+static reg_index_t *reg_cache = NULL; /**< segment index (one per process) */
 static int reg_nprocs = 0; /**< number of caches (one per process) */
 static dmapp_entry_t *dmapp_cache = NULL; /**< list of cached dmapp segments */
 
@@ -54,10 +55,6 @@ static reg_return_t   seg_intersects(void *reg_addr, size_t reg_len,
                                      void *oth_addr, size_t oth_len);
 static reg_return_t   seg_contains(void *reg_addr, size_t reg_len,
                                    void *oth_addr, size_t oth_len);
-static reg_return_t   reg_entry_intersects(reg_entry_t *reg_entry,
-                                           void *buf, size_t len);
-static reg_return_t   reg_entry_contains(reg_entry_t *reg_entry,
-                                         void *buf, size_t len);
 static reg_return_t   dmapp_seg_intersects(dmapp_seg_desc_t first,
                                            dmapp_seg_desc_t second);
 static reg_return_t   dmapp_seg_contains(dmapp_seg_desc_t first,
@@ -176,60 +173,6 @@ seg_contains(void *reg_addr, size_t reg_len, void *oth_addr, size_t oth_len)
 }
 
 
-/**
- * Detects whether two memory segments intersect.
- *
- * @param[in] reg_entry the registration entry
- * @param[in] buf       starting address for the contiguous memory region
- * @param[in] len       length of the contiguous memory region
- *
- * @pre NULL != reg_entry
- * @pre NULL != buf
- * @pre len >= 0
- *
- * @return RR_SUCCESS on success
- */
-static reg_return_t
-reg_entry_intersects(reg_entry_t *reg_entry, void *buf, size_t len)
-{
-    /* preconditions */
-    assert(NULL != reg_entry);
-    assert(NULL != buf);
-    assert(len >= 0);
-
-    return seg_intersects(
-            reg_entry->buf, reg_entry->len,
-            buf, len);
-}
-
-
-/**
- * Detects whether the first memory segment contains the other.
- *
- * @param[in] reg_entry the registration entry
- * @param[in] buf       starting address for the contiguous memory region
- * @param[in] len       length of the contiguous memory region
- *
- * @pre NULL != reg_entry
- * @pre NULL != buf
- * @pre len >= 0
- *
- * @return RR_SUCCESS on success
- */
-static reg_return_t
-reg_entry_contains(reg_entry_t *reg_entry, void *buf, size_t len)
-{
-    /* preconditions */
-    assert(NULL != reg_entry);
-    assert(NULL != buf);
-    assert(len >= 0);
-
-    return seg_contains(
-            reg_entry->buf, reg_entry->len,
-            buf, len);
-}
-
-
 /**
  * Detects whether two dmapp segments intersect.
  *
@@ -316,14 +259,14 @@ reg_cache_init(int nprocs)
     /* keep the number of caches around for later use */
     reg_nprocs = nprocs;
 
-    /* allocate the registration cache list: */
-    reg_cache = (reg_entry_t **)malloc(
-            sizeof(reg_entry_t *) * reg_nprocs); 
+    /* allocate the registration cache indices: */
+    reg_cache = (reg_index_t *)malloc(
+            sizeof(reg_index_t) * reg_nprocs); 
     assert(reg_cache); 
 
-    /* initialize the registration cache list: */
+    /* initialize the registration cache indices: */
     for (i = 0; i < reg_nprocs; ++i) {
-        reg_cache[i] = NULL;
+        reg_index_init(&reg_cache[i]);
     }
 
     return RR_SUCCESS;
@@ -350,19 +293,15 @@ reg_cache_destroy()
     assert(0 != reg_nprocs);
 
     for (i = 0; i < reg_nprocs; ++i) {
-        reg_entry_t *runner = reg_cache[i];
-
-        while (runner) {
-            reg_entry_t *previous = runner; /* pointer to previous runner */
+        int j = 0;
 
-            /* get next runner */
-            runner = runner->next;
-            /* destroy the entry */
-            reg_entry_destroy(i, previous);
+        for (j = 0; j < reg_cache[i].size; ++j) {
+            reg_entry_destroy(i, (reg_entry_t*)reg_cache[i].items[j].entry);
         }
+        reg_index_destroy(&reg_cache[i]);
     }
 
-    /* free registration cache list */
+    /* free registration cache indices */
     free(reg_cache);
     reg_cache = NULL;
 
@@ -392,33 +331,11 @@ reg_cache_destroy()
 reg_entry_t*
 reg_cache_find(int rank, void *buf, size_t len)
 {
-    reg_entry_t *entry = NULL;
-    reg_entry_t *runner = NULL;
-
     /* preconditions */
     assert(NULL != reg_cache);
     assert(0 <= rank && rank < reg_nprocs);
 
-    runner = reg_cache[rank];
-
-    while (runner && NULL == entry) {
-        if (RR_SUCCESS == reg_entry_contains(runner, buf, len)) {
-            entry = runner;
-        }
-        runner = runner->next;
-    }
-
-#ifndef NDEBUG
-    /* we assert that the found entry was unique */
-    while (runner) {
-        if (RR_SUCCESS == reg_entry_contains(runner, buf, len)) {
-            assert(0);
-        }
-        runner = runner->next;
-    }
-#endif
-
-    return entry;
+    return (reg_entry_t*)reg_index_find(&reg_cache[rank], buf, len);
 }
 
 
@@ -471,31 +388,11 @@ dmapp_cache_find(dmapp_seg_desc_t mr)
 reg_entry_t*
 reg_cache_find_intersection(int rank, void *buf, size_t len)
 {
-    reg_entry_t *entry = NULL;
-    reg_entry_t *runner = NULL;
-
     /* preconditions */
     assert(NULL != reg_cache);
     assert(0 <= rank && rank < reg_nprocs);
 
-    runner = reg_cache[rank];
-
-    while (runner && NULL == entry) {
-        if (RR_SUCCESS == reg_entry_intersects(runner, buf, len)) {
-            entry = runner;
-        }
-        runner = runner->next;
-    }
-
-    /* we assert that the found entry was unique */
-    while (runner) {
-        if (RR_SUCCESS == reg_entry_contains(runner, buf, len)) {
-            assert(0);
-        }
-        runner = runner->next;
-    }
-
-    return entry;
+    return (reg_entry_t*)reg_index_find_intersection(&reg_cache[rank], buf, len);
 }
 
 
@@ -570,19 +467,9 @@ reg_cache_insert(int rank, void *buf, size_t len, dmapp_seg_desc_t mr)
     node->buf = buf;
     node->len = len;
     node->mr = mr;
-    node->next = NULL;
 
-    /* push new entry to tail of linked list */
-    if (NULL == reg_cache[rank]) {
-        reg_cache[rank] = node;
-    }
-    else {
-        reg_entry_t *runner = reg_cache[rank];
-        while (runner->next) {
-            runner = runner->next;
-        }
-        runner->next = node;
-    }
+    /* add new entry to the sorted index */
+    reg_index_insert(&reg_cache[rank], buf, len, node);
 
     return RR_SUCCESS;
 }
@@ -609,7 +496,6 @@ reg_cache_delete(int rank, void *buf)
 {
     reg_return_t status = RR_FAILURE;
     reg_entry_t *runner = NULL;
-    reg_entry_t *previous_runner = NULL;
 
     /* preconditions */
     assert(NULL != reg_cache);
@@ -619,28 +505,13 @@ reg_cache_delete(int rank, void *buf)
 
     /* this is more restrictive than reg_cache_find() in that we locate
      * exactlty the same region starting address */
-    runner = reg_cache[rank];
-    while (runner) {
-        if (runner->buf == buf) {
-            break;
-        }
-        previous_runner = runner;
-        runner = runner->next;
-    }
+    runner = (reg_entry_t*)reg_index_remove(&reg_cache[rank], buf);
     /* we should have found an entry */
     if (NULL == runner) {
         assert(0);
         return RR_FAILURE;
     }
 
-    /* pop the entry out of the linked list */
-    if (previous_runner) {
-        previous_runner->next = runner->next;
-    }
-    else {
-        reg_cache[rank] = reg_cache[rank]->next;
-    }
-
     status = reg_entry_destroy(rank, runner);
 
     return status;
@@ -18,7 +18,6 @@ typedef struct _reg_entry_t {
     void *buf;                  /**< starting address of region */
     size_t len;                 /**< length of region */
     dmapp_seg_desc_t mr;        /**< dmapp registered memory region */
-    struct _reg_entry_t *next;  /**< next memory region in list */
 } reg_entry_t;
 
 /* functions
@@ -147,12 +147,40 @@ typedef struct {
 } rank_ptr_t;
 
 
+/* one stripe of a rank's accumulate lock table, padded to a cache line */
+typedef struct {
+    int value; /**< -1 if held exclusively, else number of shared holders */
+    char pad[COMEX_ACC_LOCK_PAD-sizeof(int)];
+} acc_lock_t;
+
+
+/* a received request waiting for a progress thread */
+typedef struct progress_job {
+    struct progress_job *next;
+    char *message;
+    int source;
+} progress_job_t;
+
+
+/* requests are run concurrently across sources but in order per source */
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    progress_job_t *ready_head;     /**< jobs whose source is not busy */
+    progress_job_t *ready_tail;
+    progress_job_t **pending_head;  /**< per source, jobs behind a busy one */
+    progress_job_t **pending_tail;
+    char *busy;                     /**< per source, a job is in flight */
+    int running;
+} progress_queue_t;
+
+
 /* static state */
 static int *num_mutexes = NULL;     /**< (all) how many mutexes on each process */
 static int **mutexes = NULL;        /**< (masters) value is rank of lock holder */
 static lock_t ***lq_heads = NULL;   /**< array of lock queues */
-static char *sem_name = NULL;       /* local semaphore name */
-static sem_t **semaphores = NULL;   /* semaphores for locking within SMP node */
+static char *acc_lock_name = NULL;  /* local acc lock table name */
+static acc_lock_t **acc_locks = NULL; /* acc lock tables within SMP node */
 static int initialized = 0;         /* for comex_initialized(), 0=false */
 static char *fence_array = NULL;
 
@@ -166,8 +194,12 @@ static int nb_count_send_processed = 0;
 static int nb_count_recv = 0;
 static int nb_count_recv_processed = 0;
 
-static char *static_server_buffer = NULL;
 static int static_server_buffer_size = 0;
+static pthread_key_t server_buffer_key; /* per progress thread buffer */
+static int progress_threads = COMEX_PROGRESS_THREADS;
+static int progress_recvs = COMEX_PROGRESS_RECVS;
+static progress_queue_t progress_queue;
+static pthread_rwlock_t progress_rwlock; /* handlers vs. reg_cache/mutex updates */
 static int eager_threshold = -1;
 static int max_message_size = -1;
 
@@ -255,11 +287,16 @@ STATIC void _lock_handler(header_t *header, int proc);
 STATIC void _unlock_handler(header_t *header, int proc);
 STATIC void _malloc_handler(header_t *header, char *payload, int proc);
 STATIC void _free_handler(header_t *header, char *payload, int proc);
+STATIC int _progress_dispatch(char *message, int source);
+STATIC void _progress_enqueue(char *message, int source);
+STATIC void* _progress_worker(void *arg);
+STATIC char* _server_buffer();
 
 /* worker functions */
-STATIC void nb_send_common(void *buf, int count, int dest, nb_t *nb, int need_free);
+STATIC void nb_send_common(void *buf, int count, int dest, nb_t *nb, int need_free, int tag);
 STATIC void nb_send_datatype(void *buf, MPI_Datatype dt, int dest, nb_t *nb);
 STATIC void nb_send_header(void *buf, int count, int dest, nb_t *nb);
+STATIC void nb_send_payload(void *buf, int count, int dest, nb_t *nb);
 STATIC void nb_send_buffer(void *buf, int count, int dest, nb_t *nb);
 STATIC void nb_recv_packed(void *buf, int count, int source, nb_t *nb, stride_t *stride);
 STATIC void nb_recv_datatype(void *buf, MPI_Datatype dt, int source, nb_t *nb);
@@ -336,8 +373,16 @@ STATIC int _get_world_rank(comex_igroup_t *igroup, int rank);
 STATIC int* _get_world_ranks(comex_igroup_t *igroup);
 STATIC int _smallest_world_rank_with_same_hostid(comex_igroup_t *group);
 STATIC int _largest_world_rank_with_same_hostid(comex_igroup_t *igroup);
-STATIC void _malloc_semaphore(void);
-STATIC void _free_semaphore(void);
+STATIC void _malloc_acc_locks(void);
+STATIC void _free_acc_locks(void);
+STATIC void _acc_lock(int rank, void *addr, int bytes, int shared);
+STATIC void _acc_unlock(int rank, void *addr, int bytes, int shared);
+STATIC void _acc_range(int rank, void *addr, int datatype, int bytes,
+        void *dst, const void *src, const void *scale);
+STATIC long _acc_strided_span(int *count, int *dst_stride, int stride_levels);
+STATIC int _acc_strided_range(int rank, void *addr, int datatype,
+        int stride_levels, int *count, void *dst, int *dst_stride,
+        const void *src, int *src_stride, const void *scale);
 STATIC void* _shm_create(const char *name, size_t size);
 STATIC void* _shm_attach(const char *name, size_t size);
 STATIC void* _shm_map(int fd, size_t size);
@@ -502,6 +547,20 @@ int comex_init()
             COMEX_ENABLE_ACC_IOV = atoi(value);
         }
 
+        progress_threads = COMEX_PROGRESS_THREADS; /* default */
+        value = getenv("COMEX_PROGRESS_THREADS");
+        if (NULL != value) {
+            progress_threads = atoi(value);
+        }
+        COMEX_ASSERT(progress_threads > 0);
+
+        progress_recvs = COMEX_PROGRESS_RECVS; /* default */
+        value = getenv("COMEX_PROGRESS_RECVS");
+        if (NULL != value) {
+            progress_recvs = atoi(value);
+        }
+        COMEX_ASSERT(progress_recvs > 0);
+
         max_message_size = INT_MAX; /* default */
         value = getenv("COMEX_MAX_MESSAGE_SIZE");
         if (NULL != value) {
@@ -523,6 +582,8 @@ int comex_init()
             printf("COMEX_STATIC_BUFFER_SIZE=%d\n", static_server_buffer_size);
             printf("COMEX_MAX_MESSAGE_SIZE=%d\n", max_message_size);
             printf("COMEX_EAGER_THRESHOLD=%d\n", eager_threshold);
+            printf("COMEX_PROGRESS_THREADS=%d\n", progress_threads);
+            printf("COMEX_PROGRESS_RECVS=%d\n", progress_recvs);
             printf("COMEX_PUT_DATATYPE_THRESHOLD=%d\n", COMEX_PUT_DATATYPE_THRESHOLD);
             printf("COMEX_GET_DATATYPE_THRESHOLD=%d\n", COMEX_GET_DATATYPE_THRESHOLD);
             printf("COMEX_ENABLE_PUT_SELF=%d\n", COMEX_ENABLE_PUT_SELF);
@@ -614,7 +675,7 @@ int comex_init()
      * world rank and size */
     reg_cache_init(g_state.size);
 
-    _malloc_semaphore();
+    _malloc_acc_locks();
 
 #if DEBUG
     fprintf(stderr, "[%d] comex_init() before progress server\n", g_state.rank);
@@ -711,7 +772,7 @@ int comex_finalize()
 
     initialized = 0;
 
-    _free_semaphore();
+    _free_acc_locks();
 
     /* Make sure that all outstanding operations are done */
     comex_wait_all(COMEX_GROUP_WORLD);
@@ -2585,63 +2646,35 @@ int comex_malloc_mem_dev(void *ptrs[], size_t size, comex_group_t group,
 }
 
 
-/* one unnamed semaphore per world process */
-void _malloc_semaphore()
+/* one accumulate lock table per world process, in shared memory */
+void _malloc_acc_locks()
 {
     char *name = NULL;
     char *names = NULL;
-    sem_t *my_sem = NULL;
+    size_t size = sizeof(acc_lock_t)*COMEX_ACC_LOCKS;
     int status = 0;
     MPI_Datatype shm_name_type;
     int i = 0;
 
 #if DEBUG
-    fprintf(stderr, "[%d] _malloc_semaphore()\n", g_state.rank);
+    fprintf(stderr, "[%d] _malloc_acc_locks()\n", g_state.rank);
 #endif
 
     status = MPI_Type_contiguous(SHM_NAME_SIZE, MPI_CHAR, &shm_name_type);
-    COMEX_ASSERT(MPI_SUCCESS == status);
+    CHECK_MPI_RETVAL(status);
     status = MPI_Type_commit(&shm_name_type);
-    COMEX_ASSERT(MPI_SUCCESS == status);
+    CHECK_MPI_RETVAL(status);
 
-    semaphores = (sem_t**)malloc(sizeof(sem_t*) * g_state.size);
-    COMEX_ASSERT(semaphores);
+    acc_locks = (acc_lock_t**)malloc(sizeof(acc_lock_t*) * g_state.size);
+    COMEX_ASSERT(acc_locks);
 
     name = _generate_shm_name(g_state.rank);
     COMEX_ASSERT(name);
 
-#if ENABLE_UNNAMED_SEM
-    {
-        my_sem = _shm_create(name, sizeof(sem_t));
-        /* initialize the memory as an inter-process semaphore */
-        if (0 != sem_init(my_sem, 1, 1)) {
-            perror("_malloc_semaphore: sem_init");
-            comex_error("_malloc_semaphore: sem_init", -1);
-        }
-    }
-#else
-    {
-        my_sem = sem_open(name, O_CREAT|O_EXCL, S_IRUSR|S_IWUSR, 1);
-        if (SEM_FAILED == my_sem) {
-            if (EEXIST == errno) {
-                status = sem_unlink(name);
-                if (-1 == status) {
-                    perror("_malloc_semaphore: sem_unlink");
-                    comex_error("_malloc_semaphore: sem_unlink", status);
-                }
-            }
-            /* second try */
-            my_sem = sem_open(name, O_CREAT|O_EXCL, S_IRUSR|S_IWUSR, 1);
-        }
-        if (SEM_FAILED == my_sem) {
-            perror("_malloc_semaphore: sem_open");
-            comex_error("_malloc_semaphore: sem_open", -1);
-        }
-    }
-#endif
-
-    /* store my sem in global cache */
-    semaphores[g_state.rank] = my_sem;
+    /* store my lock table in global cache, all stripes unlocked */
+    acc_locks[g_state.rank] = (acc_lock_t*)_shm_create(name, size);
+    COMEX_ASSERT(acc_locks[g_state.rank]);
+    (void)memset(acc_locks[g_state.rank], 0, size);
 
     names = (char*)malloc(sizeof(char) * SHM_NAME_SIZE * g_state.size);
     COMEX_ASSERT(names);
@@ -2650,105 +2683,256 @@ void _malloc_semaphore()
     (void)memcpy(&names[SHM_NAME_SIZE*g_state.rank], name, SHM_NAME_SIZE);
     status = MPI_Allgather(MPI_IN_PLACE, 1, shm_name_type,
             names, 1, shm_name_type, g_state.comm);
-    COMEX_ASSERT(MPI_SUCCESS == status);
+    CHECK_MPI_RETVAL(status);
 
-    /* create/open remote semaphores and store in cache */
+    /* attach remote lock tables and store in cache */
     for (i=0; i<g_state.size; ++i) {
         if (g_state.rank == i) {
             continue; /* skip my own rank */
         }
         else if (g_state.hostid[g_state.rank] == g_state.hostid[i]) {
             /* same SMP node */
-#if ENABLE_UNNAMED_SEM
-            semaphores[i] = _shm_attach(
-                    &names[SHM_NAME_SIZE*i], sizeof(sem_t));
-            COMEX_ASSERT(semaphores[i]);
-#else
-            semaphores[i] = sem_open(&names[SHM_NAME_SIZE*i], 0);
-            if (SEM_FAILED == semaphores[i]) {
-                perror("_malloc_semaphore: sem_open");
-                comex_error("_malloc_semaphore: sem_open", -2);
-            }
-#endif
+            acc_locks[i] = (acc_lock_t*)_shm_attach(
+                    &names[SHM_NAME_SIZE*i], size);
+            COMEX_ASSERT(acc_locks[i]);
         }
         else {
-            semaphores[i] = NULL;
+            acc_locks[i] = NULL;
         }
     }
 
-    sem_name = name;
+    acc_lock_name = name;
 
     free(names);
 
     status = MPI_Type_free(&shm_name_type);
-    COMEX_ASSERT(MPI_SUCCESS == status);
+    CHECK_MPI_RETVAL(status);
 }
 
 
-void _free_semaphore()
+void _free_acc_locks()
 {
+    size_t size = sizeof(acc_lock_t)*COMEX_ACC_LOCKS;
     int i;
     int retval;
 
 #if DEBUG
-    fprintf(stderr, "[%d] _free_semaphore()\n", g_state.rank);
+    fprintf(stderr, "[%d] _free_acc_locks()\n", g_state.rank);
 #endif
 
     for (i=0; i<g_state.size; ++i) {
-        if (g_state.rank == i) {
-            /* me */
-#if ENABLE_UNNAMED_SEM
-            retval = sem_destroy(semaphores[i]);
-            if (-1 == retval) {
-                perror("_free_semaphore: sem_destroy");
-                comex_error("_free_semaphore: sem_destroy", retval);
-            }
-            retval = munmap(semaphores[i], sizeof(sem_t));
-            if (-1 == retval) {
-                perror("_free_semaphore: munmap");
-                comex_error("_free_semaphore: munmap", retval);
-            }
-            retval = shm_unlink(sem_name);
-            if (-1 == retval) {
-                perror("_free_semaphore: shm_unlink");
-                comex_error("_free_semaphore: shm_unlink", retval);
-            }
-#else
-            retval = sem_close(semaphores[i]);
-            if (-1 == retval) {
-                perror("_free_semaphore: sem_close");
-                comex_error("_free_semaphore: sem_close", retval);
+        if (NULL == acc_locks[i]) {
+            continue; /* another SMP node */
+        }
+        retval = munmap(acc_locks[i], size);
+        if (-1 == retval) {
+            perror("_free_acc_locks: munmap");
+            comex_error("_free_acc_locks: munmap", retval);
+        }
+    }
+    check_devshm(0, -size);
+
+    retval = shm_unlink(acc_lock_name);
+    if (-1 == retval) {
+        perror("_free_acc_locks: shm_unlink");
+        comex_error("_free_acc_locks: shm_unlink", retval);
+    }
+
+    free(acc_lock_name);
+    acc_lock_name = NULL;
+
+    free(acc_locks);
+    acc_locks = NULL;
+}
+
+
+/* the range of stripes covering [addr,addr+bytes) in a rank's lock table,
+ * as at most two ascending runs so that every caller locks in one order */
+STATIC int _acc_lock_runs(void *addr, int bytes, int *lo, int *hi)
+{
+    size_t first = ((size_t)addr) >> COMEX_ACC_LOCK_SHIFT;
+    size_t last = ((size_t)addr + bytes - 1) >> COMEX_ACC_LOCK_SHIFT;
+    int start = first % COMEX_ACC_LOCKS;
+    int end = last % COMEX_ACC_LOCKS;
+
+    if (last - first + 1 >= COMEX_ACC_LOCKS) {
+        lo[0] = 0;
+        hi[0] = COMEX_ACC_LOCKS-1;
+        return 1;
+    }
+    if (start <= end) {
+        lo[0] = start;
+        hi[0] = end;
+        return 1;
+    }
+    lo[0] = 0;
+    hi[0] = end;
+    lo[1] = start;
+    hi[1] = COMEX_ACC_LOCKS-1;
+    return 2;
+}
+
+
+/* lock the stripes of rank's memory covering [addr,addr+bytes); addr is
+ * in rank's address space so all processes on the node agree on stripes.
+ * shared holders only do atomic updates and may overlap each other. */
+STATIC void _acc_lock(int rank, void *addr, int bytes, int shared)
+{
+    acc_lock_t *table = acc_locks[rank];
+    int lo[2], hi[2];
+    int nruns = _acc_lock_runs(addr, bytes, lo, hi);
+    int run, i;
+
+    COMEX_ASSERT(table);
+    for (run=0; run<nruns; ++run) {
+        for (i=lo[run]; i<=hi[run]; ++i) {
+            volatile int *value = &table[i].value;
+            if (shared) {
+                while (1) {
+                    int current = *value;
+                    if (current >= 0 && __sync_bool_compare_and_swap(
+                                value, current, current+1)) {
+                        break;
+                    }
+                    sched_yield();
+                }
             }
-            retval = sem_unlink(sem_name);
-            if (-1 == retval) {
-                perror("_free_semaphore: sem_unlink");
-                comex_error("_free_semaphore: sem_unlink", retval);
+            else {
+                while (!__sync_bool_compare_and_swap(value, 0, -1)) {
+                    sched_yield();
+                }
             }
-#endif
         }
-        else if (g_state.hostid[g_state.rank] == g_state.hostid[i]) {
-            /* same SMP node */
-#if ENABLE_UNNAMED_SEM
-            retval = munmap(semaphores[i], sizeof(sem_t));
-            if (-1 == retval) {
-                perror("_free_semaphore: munmap");
-                comex_error("_free_semaphore: munmap", retval);
+    }
+}
+
+
+STATIC void _acc_unlock(int rank, void *addr, int bytes, int shared)
+{
+    acc_lock_t *table = acc_locks[rank];
+    int lo[2], hi[2];
+    int nruns = _acc_lock_runs(addr, bytes, lo, hi);
+    int run, i;
+
+    for (run=0; run<nruns; ++run) {
+        for (i=lo[run]; i<=hi[run]; ++i) {
+            if (shared) {
+                (void)__sync_fetch_and_sub(&table[i].value, 1);
             }
-#else
-            retval = sem_close(semaphores[i]);
-            if (-1 == retval) {
-                perror("_free_semaphore: sem_close");
-                comex_error("_free_semaphore: sem_close", retval);
+            else {
+                __sync_lock_release(&table[i].value);
             }
-#endif
         }
     }
+}
+
+
+/* small, aligned double and long accs are applied with atomic adds */
+STATIC int _acc_is_atomic(int datatype, int bytes, void *dst)
+{
+    if (bytes > COMEX_ACC_ATOMIC_BYTES) {
+        return 0;
+    }
+    if (COMEX_ACC_DBL == datatype) {
+        return sizeof(double) == sizeof(long)
+            && 0 == ((size_t)dst) % sizeof(double);
+    }
+    if (COMEX_ACC_LNG == datatype) {
+        return 0 == ((size_t)dst) % sizeof(long);
+    }
+    return 0;
+}
+
+
+STATIC void _acc_atomic(int datatype, int bytes, void *dst,
+        const void *src, const void *scale)
+{
+    int i;
+
+    if (COMEX_ACC_LNG == datatype) {
+        long *d = (long*)dst;
+        const long *s = (const long*)src;
+        const long alpha = *(const long*)scale;
+        for (i=0; i<bytes/(int)sizeof(long); ++i) {
+            (void)__sync_fetch_and_add(&d[i], alpha*s[i]);
+        }
+    }
+    else {
+        long *d = (long*)dst;
+        const double *s = (const double*)src;
+        const double alpha = *(const double*)scale;
+        for (i=0; i<bytes/(int)sizeof(double); ++i) {
+            long old_bits, new_bits;
+            double value;
+            do {
+                old_bits = d[i];
+                (void)memcpy(&value, &old_bits, sizeof(double));
+                value += alpha*s[i];
+                (void)memcpy(&new_bits, &value, sizeof(double));
+            } while (!__sync_bool_compare_and_swap(&d[i], old_bits, new_bits));
+        }
+    }
+}
+
+
+/* accumulate into rank's memory at addr, mapped locally at dst */
+STATIC void _acc_range(int rank, void *addr, int datatype, int bytes,
+        void *dst, const void *src, const void *scale)
+{
+    int shared = _acc_is_atomic(datatype, bytes, dst);
+
+    _acc_lock(rank, addr, bytes, shared);
+    if (shared) {
+        _acc_atomic(datatype, bytes, dst, src, scale);
+    }
+    else {
+        _acc(datatype, bytes, dst, src, scale);
+    }
+    _acc_unlock(rank, addr, bytes, shared);
+}
+
+
+/* bytes from the first to the last byte of a strided patch */
+STATIC long _acc_strided_span(int *count, int *dst_stride, int stride_levels)
+{
+    long span = count[0];
+    int i;
 
-    free(sem_name);
-    sem_name = NULL;
+    for (i=1; i<=stride_levels; i++) {
+        span += (long)(count[i]-1) * (long)dst_stride[i-1];
+    }
 
-    free(semaphores);
-    semaphores = NULL;
+    return span;
+}
+
+
+/* Accumulate a strided patch into rank's memory at addr, mapped locally at
+ * dst, with the fused strided kernel under a single lock of the patch's
+ * span.  This is done only if the span takes no more lock stripes than its
+ * rows would one at a time; returns 0 if the patch was not applied. */
+STATIC int _acc_strided_range(int rank, void *addr, int datatype,
+        int stride_levels, int *count, void *dst, int *dst_stride,
+        const void *src, int *src_stride, const void *scale)
+{
+    long span = _acc_strided_span(count, dst_stride, stride_levels);
+    long n1dim = 1;
+    int i;
+
+    for (i=1; i<=stride_levels; i++) {
+        n1dim *= count[i];
+    }
+    if (span > INT_MAX
+            || (span >> COMEX_ACC_LOCK_SHIFT) + 1
+            > n1dim * ((count[0] >> COMEX_ACC_LOCK_SHIFT) + 2)) {
+        return 0;
+    }
+
+    _acc_lock(rank, addr, (int)span, 0);
+    _acc_strided(datatype, stride_levels, count,
+            dst, dst_stride, src, src_stride, scale);
+    _acc_unlock(rank, addr, (int)span, 0);
+
+    return 1;
 }
 
 
@@ -3153,6 +3337,15 @@ STATIC void _progress_server()
     char *static_header_buffer = NULL;
     int static_header_buffer_size = 0;
     int extra_size = 0;
+    char *server_buffer = NULL;
+    MPI_Request *requests = NULL;
+    MPI_Status *statuses = NULL;
+    MPI_Status *slot_status = NULL;
+    int *indices = NULL;
+    int *complete = NULL;
+    pthread_t *threads = NULL;
+    int head = 0;
+    int i = 0;
 
 #if DEBUG
     fprintf(stderr, "[%d] _progress_server()\n", g_state.rank);
@@ -3183,123 +3376,149 @@ STATIC void _progress_server()
         static_header_buffer_size = eager_threshold;
     }
 
+    /* handlers run concurrently only if MPI allows it */
+    if (progress_threads > 1) {
+        int provided = 0;
+        MPI_Query_thread(&provided);
+        if (MPI_THREAD_MULTIPLE != provided) {
+            if (g_state.rank == g_state.master[0]) {
+                fprintf(stderr, "COMEX_PROGRESS_THREADS=%d requires "
+                        "MPI_THREAD_MULTIPLE, using 1 progress thread\n",
+                        progress_threads);
+            }
+            progress_threads = 1;
+        }
+    }
+
     /* initialize shared buffers */
-    static_header_buffer = (char*)malloc(sizeof(char)*static_header_buffer_size);
+    static_header_buffer = (char*)malloc(
+            sizeof(char)*static_header_buffer_size*progress_recvs);
     COMEX_ASSERT(static_header_buffer);
-    static_server_buffer = (char*)malloc(sizeof(char)*static_server_buffer_size);
-    COMEX_ASSERT(static_server_buffer);
+    server_buffer = (char*)malloc(sizeof(char)*static_server_buffer_size);
+    COMEX_ASSERT(server_buffer);
+    pthread_key_create(&server_buffer_key, NULL);
+    pthread_setspecific(server_buffer_key, server_buffer);
+
+    /* pre-post one header receive per slot; slots are serviced as a ring
+     * so that requests are dispatched in the order MPI matched them */
+    requests = (MPI_Request*)malloc(sizeof(MPI_Request)*progress_recvs);
+    statuses = (MPI_Status*)malloc(sizeof(MPI_Status)*progress_recvs);
+    slot_status = (MPI_Status*)malloc(sizeof(MPI_Status)*progress_recvs);
+    indices = (int*)malloc(sizeof(int)*progress_recvs);
+    complete = (int*)malloc(sizeof(int)*progress_recvs);
+    COMEX_ASSERT(requests && statuses && slot_status && indices && complete);
+    for (i=0; i<progress_recvs; ++i) {
+        complete[i] = 0;
+        MPI_Irecv(static_header_buffer + i*static_header_buffer_size,
+                static_header_buffer_size, MPI_CHAR, MPI_ANY_SOURCE,
+                COMEX_TAG, g_state.comm, &requests[i]);
+    }
+
+    if (progress_threads > 1) {
+        pthread_rwlock_init(&progress_rwlock, NULL);
+        pthread_mutex_init(&progress_queue.mutex, NULL);
+        pthread_cond_init(&progress_queue.cond, NULL);
+        progress_queue.ready_head = NULL;
+        progress_queue.ready_tail = NULL;
+        progress_queue.pending_head = (progress_job_t**)calloc(
+                g_state.size, sizeof(progress_job_t*));
+        progress_queue.pending_tail = (progress_job_t**)calloc(
+                g_state.size, sizeof(progress_job_t*));
+        progress_queue.busy = (char*)calloc(g_state.size, sizeof(char));
+        COMEX_ASSERT(progress_queue.pending_head);
+        COMEX_ASSERT(progress_queue.pending_tail);
+        COMEX_ASSERT(progress_queue.busy);
+        progress_queue.running = 1;
+        threads = (pthread_t*)malloc(sizeof(pthread_t)*progress_threads);
+        COMEX_ASSERT(threads);
+        for (i=0; i<progress_threads; ++i) {
+            int retval = pthread_create(&threads[i], NULL, _progress_worker, NULL);
+            if (retval) {
+                comex_error("_progress_server: pthread_create", retval);
+            }
+        }
+    }
 
     running = 1;
     while (running) {
-        int source = 0;
-        int length = 0;
-        char *payload = NULL;
-        header_t *header = NULL;
-        MPI_Status recv_status;
+        int outcount = 0;
 
-        MPI_Recv(static_header_buffer, static_header_buffer_size, MPI_CHAR,
-                MPI_ANY_SOURCE, COMEX_TAG, g_state.comm, &recv_status);
-        MPI_Get_count(&recv_status, MPI_CHAR, &length);
-        source = recv_status.MPI_SOURCE;
+        MPI_Waitsome(progress_recvs, requests, &outcount, indices, statuses);
+        COMEX_ASSERT(MPI_UNDEFINED != outcount);
+        for (i=0; i<outcount; ++i) {
+            complete[indices[i]] = 1;
+            slot_status[indices[i]] = statuses[i];
+        }
+
+        while (running && complete[head]) {
+            int source = slot_status[head].MPI_SOURCE;
+            int length = 0;
+            char *message = static_header_buffer + head*static_header_buffer_size;
+
+            MPI_Get_count(&slot_status[head], MPI_CHAR, &length);
 #   if DEBUG
-        fprintf(stderr, "[%d] progress MPI_Recv source=%d length=%d\n",
-                g_state.rank, source, length);
+            fprintf(stderr, "[%d] progress MPI_Irecv source=%d length=%d\n",
+                    g_state.rank, source, length);
 #   endif
-        header = (header_t*)static_header_buffer;
-        payload = static_header_buffer + sizeof(header_t);
-        /* dispatch message handler */
-        switch (header->operation) {
-            case OP_PUT:
-                _put_handler(header, payload, source);
-                break;
-            case OP_PUT_PACKED:
-                _put_packed_handler(header, payload, source);
-                break;
-            case OP_PUT_DATATYPE:
-                _put_datatype_handler(header, payload, source);
-                break;
-            case OP_PUT_IOV:
-                _put_iov_handler(header, source);
-                break;
-            case OP_GET:
-                _get_handler(header, source);
-                break;
-            case OP_GET_PACKED:
-                _get_packed_handler(header, payload, source);
-                break;
-            case OP_GET_DATATYPE:
-                _get_datatype_handler(header, payload, source);
-                break;
-            case OP_GET_IOV:
-                _get_iov_handler(header, source);
-                break;
-            case OP_ACC_INT:
-            case OP_ACC_DBL:
-            case OP_ACC_FLT:
-            case OP_ACC_CPL:
-            case OP_ACC_DCP:
-            case OP_ACC_LNG:
-                _acc_handler(header, payload, source);
-                break;
-            case OP_ACC_INT_PACKED:
-            case OP_ACC_DBL_PACKED:
-            case OP_ACC_FLT_PACKED:
-            case OP_ACC_CPL_PACKED:
-            case OP_ACC_DCP_PACKED:
-            case OP_ACC_LNG_PACKED:
-                _acc_packed_handler(header, payload, source);
-                break;
-            case OP_ACC_INT_IOV:
-            case OP_ACC_DBL_IOV:
-            case OP_ACC_FLT_IOV:
-            case OP_ACC_CPL_IOV:
-            case OP_ACC_DCP_IOV:
-            case OP_ACC_LNG_IOV:
-                _acc_iov_handler(header, payload, source);
-                break;
-            case OP_FENCE:
-                _fence_handler(header, source);
-                break;
-            case OP_FETCH_AND_ADD:
-                _fetch_and_add_handler(header, payload, source);
-                break;
-            case OP_SWAP:
-                _swap_handler(header, payload, source);
-                break;
-            case OP_CREATE_MUTEXES:
-                _mutex_create_handler(header, source);
-                break;
-            case OP_DESTROY_MUTEXES:
-                _mutex_destroy_handler(header, source);
-                break;
-            case OP_LOCK:
-                _lock_handler(header, source);
-                break;
-            case OP_UNLOCK:
-                _unlock_handler(header, source);
-                break;
-            case OP_QUIT:
+            complete[head] = 0;
+            if (OP_QUIT == ((header_t*)message)->operation) {
                 running = 0;
                 break;
-            case OP_MALLOC:
-                _malloc_handler(header, payload, source);
-                break;
-            case OP_FREE:
-                _free_handler(header, payload, source);
-                break;
-            default:
-                fprintf(stderr, "[%d] header operation not recognized: %d\n",
-                        g_state.rank, header->operation);
-                COMEX_ASSERT(0);
+            }
+            if (progress_threads > 1) {
+                char *copy = (char*)malloc(length);
+                COMEX_ASSERT(copy);
+                (void)memcpy(copy, message, length);
+                _progress_enqueue(copy, source);
+            }
+            else {
+                (void)_progress_dispatch(message, source);
+            }
+            MPI_Irecv(message, static_header_buffer_size, MPI_CHAR,
+                    MPI_ANY_SOURCE, COMEX_TAG, g_state.comm, &requests[head]);
+            head = (head+1) % progress_recvs;
+        }
+    }
+
+    if (progress_threads > 1) {
+        /* let the workers drain their queues, then stop them */
+        pthread_mutex_lock(&progress_queue.mutex);
+        progress_queue.running = 0;
+        pthread_cond_broadcast(&progress_queue.cond);
+        pthread_mutex_unlock(&progress_queue.mutex);
+        for (i=0; i<progress_threads; ++i) {
+            pthread_join(threads[i], NULL);
+        }
+        free(threads);
+        free(progress_queue.pending_head);
+        free(progress_queue.pending_tail);
+        free(progress_queue.busy);
+        pthread_cond_destroy(&progress_queue.cond);
+        pthread_mutex_destroy(&progress_queue.mutex);
+        pthread_rwlock_destroy(&progress_rwlock);
+    }
+
+    /* retire the header receives that are still posted */
+    for (i=0; i<progress_recvs; ++i) {
+        if (MPI_REQUEST_NULL != requests[i]) {
+            MPI_Cancel(&requests[i]);
+            MPI_Wait(&requests[i], MPI_STATUS_IGNORE);
         }
     }
 
     initialized = 0;
 
+    free(requests);
+    free(statuses);
+    free(slot_status);
+    free(indices);
+    free(complete);
     free(static_header_buffer);
-    free(static_server_buffer);
+    pthread_setspecific(server_buffer_key, NULL);
+    pthread_key_delete(server_buffer_key);
+    free(server_buffer);
 
-    _free_semaphore();
+    _free_acc_locks();
 
     free(mutexes);
     free(lq_heads);
@@ -3333,6 +3552,231 @@ STATIC void _progress_server()
 }
 
 
+/* run the handler for one request; returns 0 for OP_QUIT */
+STATIC int _progress_dispatch(char *message, int source)
+{
+    header_t *header = (header_t*)message;
+    char *payload = message + sizeof(header_t);
+    int exclusive = 0;
+
+    /* these update the reg_cache or the mutex tables, so they must not
+     * overlap with other handlers */
+    switch (header->operation) {
+        case OP_CREATE_MUTEXES:
+        case OP_DESTROY_MUTEXES:
+        case OP_LOCK:
+        case OP_UNLOCK:
+        case OP_MALLOC:
+        case OP_FREE:
+            exclusive = 1;
+            break;
+        default:
+            break;
+    }
+    if (progress_threads > 1) {
+        if (exclusive) {
+            pthread_rwlock_wrlock(&progress_rwlock);
+        }
+        else {
+            pthread_rwlock_rdlock(&progress_rwlock);
+        }
+    }
+
+    /* dispatch message handler */
+    switch (header->operation) {
+        case OP_PUT:
+            _put_handler(header, payload, source);
+            break;
+        case OP_PUT_PACKED:
+            _put_packed_handler(header, payload, source);
+            break;
+        case OP_PUT_DATATYPE:
+            _put_datatype_handler(header, payload, source);
+            break;
+        case OP_PUT_IOV:
+            _put_iov_handler(header, source);
+            break;
+        case OP_GET:
+            _get_handler(header, source);
+            break;
+        case OP_GET_PACKED:
+            _get_packed_handler(header, payload, source);
+            break;
+        case OP_GET_DATATYPE:
+            _get_datatype_handler(header, payload, source);
+            break;
+        case OP_GET_IOV:
+            _get_iov_handler(header, source);
+            break;
+        case OP_ACC_INT:
+        case OP_ACC_DBL:
+        case OP_ACC_FLT:
+        case OP_ACC_CPL:
+        case OP_ACC_DCP:
+        case OP_ACC_LNG:
+            _acc_handler(header, payload, source);
+            break;
+        case OP_ACC_INT_PACKED:
+        case OP_ACC_DBL_PACKED:
+        case OP_ACC_FLT_PACKED:
+        case OP_ACC_CPL_PACKED:
+        case OP_ACC_DCP_PACKED:
+        case OP_ACC_LNG_PACKED:
+            _acc_packed_handler(header, payload, source);
+            break;
+        case OP_ACC_INT_IOV:
+        case OP_ACC_DBL_IOV:
+        case OP_ACC_FLT_IOV:
+        case OP_ACC_CPL_IOV:
+        case OP_ACC_DCP_IOV:
+        case OP_ACC_LNG_IOV:
+            _acc_iov_handler(header, payload, source);
+            break;
+        case OP_FENCE:
+            _fence_handler(header, source);
+            break;
+        case OP_FETCH_AND_ADD:
+            _fetch_and_add_handler(header, payload, source);
+            break;
+        case OP_SWAP:
+            _swap_handler(header, payload, source);
+            break;
+        case OP_CREATE_MUTEXES:
+            _mutex_create_handler(header, source);
+            break;
+        case OP_DESTROY_MUTEXES:
+            _mutex_destroy_handler(header, source);
+            break;
+        case OP_LOCK:
+            _lock_handler(header, source);
+            break;
+        case OP_UNLOCK:
+            _unlock_handler(header, source);
+            break;
+        case OP_QUIT:
+            break;
+        case OP_MALLOC:
+            _malloc_handler(header, payload, source);
+            break;
+        case OP_FREE:
+            _free_handler(header, payload, source);
+            break;
+        default:
+            fprintf(stderr, "[%d] header operation not recognized: %d\n",
+                    g_state.rank, header->operation);
+            COMEX_ASSERT(0);
+    }
+
+    if (progress_threads > 1) {
+        pthread_rwlock_unlock(&progress_rwlock);
+    }
+
+    return OP_QUIT != header->operation;
+}
+
+
+/* hand a request to the progress threads, behind any from the same source */
+STATIC void _progress_enqueue(char *message, int source)
+{
+    progress_job_t *job = (progress_job_t*)malloc(sizeof(progress_job_t));
+
+    COMEX_ASSERT(job);
+    job->next = NULL;
+    job->message = message;
+    job->source = source;
+
+    pthread_mutex_lock(&progress_queue.mutex);
+    if (progress_queue.busy[source]) {
+        if (progress_queue.pending_tail[source]) {
+            progress_queue.pending_tail[source]->next = job;
+        }
+        else {
+            progress_queue.pending_head[source] = job;
+        }
+        progress_queue.pending_tail[source] = job;
+    }
+    else {
+        progress_queue.busy[source] = 1;
+        if (progress_queue.ready_tail) {
+            progress_queue.ready_tail->next = job;
+        }
+        else {
+            progress_queue.ready_head = job;
+        }
+        progress_queue.ready_tail = job;
+        pthread_cond_signal(&progress_queue.cond);
+    }
+    pthread_mutex_unlock(&progress_queue.mutex);
+}
+
+
+STATIC void* _progress_worker(void *arg)
+{
+    char *server_buffer = (char*)malloc(sizeof(char)*static_server_buffer_size);
+
+    COMEX_ASSERT(server_buffer);
+    pthread_setspecific(server_buffer_key, server_buffer);
+
+    pthread_mutex_lock(&progress_queue.mutex);
+    while (1) {
+        progress_job_t *job = NULL;
+        progress_job_t *next = NULL;
+        int source = 0;
+
+        while (NULL == progress_queue.ready_head && progress_queue.running) {
+            pthread_cond_wait(&progress_queue.cond, &progress_queue.mutex);
+        }
+        if (NULL == progress_queue.ready_head) {
+            break;
+        }
+        job = progress_queue.ready_head;
+        progress_queue.ready_head = job->next;
+        if (NULL == progress_queue.ready_head) {
+            progress_queue.ready_tail = NULL;
+        }
+        pthread_mutex_unlock(&progress_queue.mutex);
+
+        source = job->source;
+        (void)_progress_dispatch(job->message, source);
+        free(job->message);
+        free(job);
+
+        /* the next request from this source, if any, is now runnable */
+        pthread_mutex_lock(&progress_queue.mutex);
+        next = progress_queue.pending_head[source];
+        if (next) {
+            progress_queue.pending_head[source] = next->next;
+            if (NULL == next->next) {
+                progress_queue.pending_tail[source] = NULL;
+            }
+            next->next = NULL;
+            if (progress_queue.ready_tail) {
+                progress_queue.ready_tail->next = next;
+            }
+            else {
+                progress_queue.ready_head = next;
+            }
+            progress_queue.ready_tail = next;
+        }
+        else {
+            progress_queue.busy[source] = 0;
+        }
+    }
+    pthread_mutex_unlock(&progress_queue.mutex);
+
+    free(server_buffer);
+
+    return NULL;
+}
+
+
+/* scratch buffer of the calling progress thread */
+STATIC char* _server_buffer()
+{
+    return (char*)pthread_getspecific(server_buffer_key);
+}
+
+
 STATIC void _put_handler(header_t *header, char *payload, int proc)
 {
     reg_entry_t *reg_entry = NULL;
@@ -3419,7 +3863,7 @@ STATIC void _put_packed_handler(header_t *header, char *payload, int proc)
             packed_buffer = malloc(header->length);
         }
         else {
-            packed_buffer = static_server_buffer;
+            packed_buffer = _server_buffer();
         }
 
         {
@@ -3555,7 +3999,7 @@ STATIC void _put_iov_handler(header_t *header, int proc)
         COMEX_ASSERT(packed_buffer);
     }
     else {
-        packed_buffer = static_server_buffer;
+        packed_buffer = _server_buffer();
     }
 
     server_recv(packed_buffer, bytes * limit, proc);
@@ -3782,7 +4226,7 @@ STATIC void _get_iov_handler(header_t *header, int proc)
         COMEX_ASSERT(packed_buffer);
     }
     else {
-        packed_buffer = static_server_buffer;
+        packed_buffer = _server_buffer();
     }
 
     packed_index = 0;
@@ -3862,7 +4306,7 @@ STATIC void _acc_handler(header_t *header, char *scale, int proc)
             acc_buffer = malloc(header->length);
         }
         else {
-            acc_buffer = static_server_buffer;
+            acc_buffer = _server_buffer();
         }
 
         {
@@ -3879,14 +4323,8 @@ STATIC void _acc_handler(header_t *header, char *scale, int proc)
         }
     }
 
-    if (COMEX_ENABLE_ACC_SELF || COMEX_ENABLE_ACC_SMP) {
-        sem_wait(semaphores[header->rank]);
-        _acc(acc_type, header->length, mapped_offset, acc_buffer, scale);
-        sem_post(semaphores[header->rank]);
-    }
-    else {
-        _acc(acc_type, header->length, mapped_offset, acc_buffer, scale);
-    }
+    _acc_range(header->rank, header->remote_address, acc_type,
+            header->length, mapped_offset, acc_buffer, scale);
 
     if (use_eager) {
     }
@@ -3953,7 +4391,7 @@ STATIC void _acc_packed_handler(header_t *header, char *payload, int proc)
             acc_buffer = malloc(header->length);
         }
         else {
-            acc_buffer = static_server_buffer;
+            acc_buffer = _server_buffer();
         }
 
         {
@@ -3975,9 +4413,6 @@ STATIC void _acc_packed_handler(header_t *header, char *payload, int proc)
     COMEX_ASSERT(reg_entry);
     mapped_offset = _get_offset_memory(reg_entry, header->remote_address);
 
-    if (COMEX_ENABLE_ACC_SELF || COMEX_ENABLE_ACC_SMP) {
-        sem_wait(semaphores[header->rank]);
-    }
     {
         char *packed_buffer = acc_buffer;
         char *dst = mapped_offset;
@@ -4009,35 +4444,42 @@ STATIC void _acc_packed_handler(header_t *header, char *payload, int proc)
             n1dim *= count[i];
         }
 
-        /* calculate the destination indices */
-        dst_bvalue[0] = 0; dst_bvalue[1] = 0; dst_bunit[0] = 1; dst_bunit[1] = 1;
-
-        for(i=2; i<=stride_levels; i++) {
-            dst_bvalue[i] = 0;
-            dst_bunit[i] = dst_bunit[i-1] * count[i-1];
+        if (_acc_strided_range(header->rank, header->remote_address,
+                    acc_type, stride_levels, count, dst, dst_stride,
+                    packed_buffer, NULL, scale)) {
+            packed_index = n1dim*count[0];
         }
+        else {
+            /* calculate the destination indices */
+            dst_bvalue[0] = 0; dst_bvalue[1] = 0; dst_bunit[0] = 1; dst_bunit[1] = 1;
 
-        for(i=0; i<n1dim; i++) {
-            dst_idx = 0;
-            for(j=1; j<=stride_levels; j++) {
-                dst_idx += (long) dst_bvalue[j] * (long) dst_stride[j-1];
-                if((i+1) % dst_bunit[j] == 0) {
-                    dst_bvalue[j]++;
-                }
-                if(dst_bvalue[j] > (count[j]-1)) {
-                    dst_bvalue[j] = 0;
-                }
+            for(i=2; i<=stride_levels; i++) {
+                dst_bvalue[i] = 0;
+                dst_bunit[i] = dst_bunit[i-1] * count[i-1];
             }
 
-            _acc(acc_type, count[0], &dst[dst_idx], &packed_buffer[packed_index], scale);
-            packed_index += count[0];
+            for(i=0; i<n1dim; i++) {
+                dst_idx = 0;
+                for(j=1; j<=stride_levels; j++) {
+                    dst_idx += (long) dst_bvalue[j] * (long) dst_stride[j-1];
+                    if((i+1) % dst_bunit[j] == 0) {
+                        dst_bvalue[j]++;
+                    }
+                    if(dst_bvalue[j] > (count[j]-1)) {
+                        dst_bvalue[j] = 0;
+                    }
+                }
+
+                /* rows are locked one at a time */
+                _acc_range(header->rank, (char*)header->remote_address + dst_idx,
+                        acc_type, count[0], &dst[dst_idx],
+                        &packed_buffer[packed_index], scale);
+                packed_index += count[0];
+            }
         }
 
         COMEX_ASSERT(packed_index == n1dim*count[0]);
     }
-    if (COMEX_ENABLE_ACC_SELF || COMEX_ENABLE_ACC_SMP) {
-        sem_post(semaphores[header->rank]);
-    }
 
     if (use_eager) {
     }
@@ -4134,14 +4576,11 @@ STATIC void _acc_iov_handler(header_t *header, char *scale, int proc)
         packed_buffer = malloc(bytes*limit);
     }
     else {
-        packed_buffer = static_server_buffer;
+        packed_buffer = _server_buffer();
     }
 
     server_recv(packed_buffer, bytes*limit, proc);
 
-    if (COMEX_ENABLE_ACC_SELF || COMEX_ENABLE_ACC_SMP) {
-        sem_wait(semaphores[header->rank]);
-    }
     packed_index = 0;
     for (i=0; i<limit; ++i) {
         reg_entry = reg_cache_find(
@@ -4149,13 +4588,11 @@ STATIC void _acc_iov_handler(header_t *header, char *scale, int proc)
         COMEX_ASSERT(reg_entry);
         mapped_offset = _get_offset_memory(reg_entry, dst[i]);
 
-        _acc(acc_type, bytes, mapped_offset, &packed_buffer[packed_index], scale);
+        _acc_range(header->rank, dst[i], acc_type, bytes, mapped_offset,
+                &packed_buffer[packed_index], scale);
         packed_index += bytes;
     }
     COMEX_ASSERT(packed_index == bytes*limit);
-    if (COMEX_ENABLE_ACC_SELF || COMEX_ENABLE_ACC_SMP) {
-        sem_post(semaphores[header->rank]);
-    }
 
     if ((unsigned)(bytes*limit) > static_server_buffer_size) {
         free(packed_buffer);
@@ -4215,15 +4652,19 @@ STATIC void _fetch_and_add_handler(header_t *header, char *payload, int proc)
     
     if (sizeof(int) == header->length) {
         value_int = malloc(sizeof(int));
+        _acc_lock(header->rank, header->remote_address, header->length, 0);
         *value_int = *((int*)mapped_offset); /* "fetch" */
         *((int*)mapped_offset) += *((int*)payload); /* "add" */
+        _acc_unlock(header->rank, header->remote_address, header->length, 0);
         server_send(value_int, sizeof(int), proc);
         free(value_int);
     }
     else if (sizeof(long) == header->length) {
         value_long = malloc(sizeof(long));
+        _acc_lock(header->rank, header->remote_address, header->length, 0);
         *value_long = *((long*)mapped_offset); /* "fetch" */
         *((long*)mapped_offset) += *((long*)payload); /* "add" */
+        _acc_unlock(header->rank, header->remote_address, header->length, 0);
         server_send(value_long, sizeof(long), proc);
         free(value_long);
     }
@@ -4258,15 +4699,19 @@ STATIC void _swap_handler(header_t *header, char *payload, int proc)
     
     if (sizeof(int) == header->length) {
         value_int = malloc(sizeof(int));
+        _acc_lock(header->rank, header->remote_address, header->length, 0);
         *value_int = *((int*)mapped_offset); /* "fetch" */
         *((int*)mapped_offset) = *((int*)payload); /* "swap" */
+        _acc_unlock(header->rank, header->remote_address, header->length, 0);
         server_send(value_int, sizeof(int), proc);
         free(value_int);
     }
     else if (sizeof(long) == header->length) {
         value_long = malloc(sizeof(long));
+        _acc_lock(header->rank, header->remote_address, header->length, 0);
         *value_long = *((long*)mapped_offset); /* "fetch" */
         *((long*)mapped_offset) = *((long*)payload); /* "swap" */
+        _acc_unlock(header->rank, header->remote_address, header->length, 0);
         server_send(value_long, sizeof(long), proc);
         free(value_long);
     }
@@ -5031,11 +5476,11 @@ STATIC void server_recv(void *buf, int count, int source)
     int recv_count = 0;
 
     retval = MPI_Recv(buf, count, MPI_CHAR, source,
-            COMEX_TAG, g_state.comm, &status);
+            COMEX_TAG_DATA, g_state.comm, &status);
 
     CHECK_MPI_RETVAL(retval);
     COMEX_ASSERT(status.MPI_SOURCE == source);
-    COMEX_ASSERT(status.MPI_TAG == COMEX_TAG);
+    COMEX_ASSERT(status.MPI_TAG == COMEX_TAG_DATA);
 
     retval = MPI_Get_count(&status, MPI_CHAR, &recv_count);
     CHECK_MPI_RETVAL(retval);
@@ -5049,15 +5494,15 @@ STATIC void server_recv_datatype(void *buf, MPI_Datatype dt, int source)
     MPI_Status status;
 
     retval = MPI_Recv(buf, 1, dt, source,
-            COMEX_TAG, g_state.comm, &status);
+            COMEX_TAG_DATA, g_state.comm, &status);
 
     CHECK_MPI_RETVAL(retval);
     COMEX_ASSERT(status.MPI_SOURCE == source);
-    COMEX_ASSERT(status.MPI_TAG == COMEX_TAG);
+    COMEX_ASSERT(status.MPI_TAG == COMEX_TAG_DATA);
 }
 
 
-STATIC void nb_send_common(void *buf, int count, int dest, nb_t *nb, int need_free)
+STATIC void nb_send_common(void *buf, int count, int dest, nb_t *nb, int need_free, int tag)
 {
     int retval = 0;
     message_t *message = NULL;
@@ -5084,7 +5529,7 @@ STATIC void nb_send_common(void *buf, int count, int dest, nb_t *nb, int need_fr
     }
     nb->send_tail = message;
 
-    retval = MPI_Isend(buf, count, MPI_CHAR, dest, COMEX_TAG, g_state.comm,
+    retval = MPI_Isend(buf, count, MPI_CHAR, dest, tag, g_state.comm,
             &(message->request));
     CHECK_MPI_RETVAL(retval);
 }
@@ -5117,7 +5562,7 @@ STATIC void nb_send_datatype(void *buf, MPI_Datatype dt, int dest, nb_t *nb)
     }
     nb->send_tail = message;
 
-    retval = MPI_Isend(buf, 1, dt, dest, COMEX_TAG, g_state.comm,
+    retval = MPI_Isend(buf, 1, dt, dest, COMEX_TAG_DATA, g_state.comm,
             &(message->request));
     CHECK_MPI_RETVAL(retval);
 }
@@ -5125,13 +5570,21 @@ STATIC void nb_send_datatype(void *buf, MPI_Datatype dt, int dest, nb_t *nb)
 
 STATIC void nb_send_header(void *buf, int count, int dest, nb_t *nb)
 {
-    nb_send_common(buf, count, dest, nb, 1);
+    nb_send_common(buf, count, dest, nb, 1, COMEX_TAG);
+}
+
+
+/* payloads that follow a header use their own tag so that the progress
+ * rank's pre-posted header receives never match them */
+STATIC void nb_send_payload(void *buf, int count, int dest, nb_t *nb)
+{
+    nb_send_common(buf, count, dest, nb, 1, COMEX_TAG_DATA);
 }
 
 
 STATIC void nb_send_buffer(void *buf, int count, int dest, nb_t *nb)
 {
-    nb_send_common(buf, count, dest, nb, 0);
+    nb_send_common(buf, count, dest, nb, 0, COMEX_TAG_DATA);
 }
 
 
@@ -5872,9 +6325,7 @@ STATIC void nb_acc(int datatype, void *scale,
             if (fence_array[g_state.master[proc]]) {
                 _fence_master(g_state.master[proc]);
             }
-            sem_wait(semaphores[proc]);
-            _acc(datatype, bytes, dst, src, scale);
-            sem_post(semaphores[proc]);
+            _acc_range(proc, dst, datatype, bytes, dst, src, scale);
             return;
         }
     }
@@ -5894,9 +6345,7 @@ STATIC void nb_acc(int datatype, void *scale,
             reg_entry = reg_cache_find(proc, dst, bytes);
             COMEX_ASSERT(reg_entry);
             mapped_offset = _get_offset_memory(reg_entry, dst);
-            sem_wait(semaphores[proc]);
-            _acc(datatype, bytes, mapped_offset, src, scale);
-            sem_post(semaphores[proc]);
+            _acc_range(proc, dst, datatype, bytes, mapped_offset, src, scale);
             return;
         }
     }
@@ -6162,7 +6611,7 @@ STATIC void nb_puts_packed(
                 buf -= size;
                 if (size == bytes_remaining) {
                     /* on the last send, mark buffer for deletion */
-                    nb_send_header(buf, size, master_rank, nb);
+                    nb_send_payload(buf, size, master_rank, nb);
                 }
                 else {
                     nb_send_buffer(buf, size, master_rank, nb);
@@ -6556,6 +7005,29 @@ STATIC void nb_accs(
         return;
     }
 
+    /* a strided acc to self or SMP is applied in one fused call when its
+     * span can be locked at once, as in _acc_packed_handler */
+    if (((COMEX_ENABLE_ACC_SELF && g_state.rank == proc)
+                || (COMEX_ENABLE_ACC_SMP
+                    && g_state.master[proc] == g_state.master[g_state.rank]))
+            && _acc_strided_span(count, dst_stride, stride_levels) <= INT_MAX) {
+        void *mapped_offset = dst;
+
+        if (fence_array[g_state.master[proc]]) {
+            _fence_master(g_state.master[proc]);
+        }
+        if (!COMEX_ENABLE_ACC_SELF || g_state.rank != proc) {
+            reg_entry_t *reg_entry = reg_cache_find(proc, dst,
+                    (int)_acc_strided_span(count, dst_stride, stride_levels));
+            COMEX_ASSERT(reg_entry);
+            mapped_offset = _get_offset_memory(reg_entry, dst);
+        }
+        if (_acc_strided_range(proc, dst, datatype, stride_levels, count,
+                    mapped_offset, dst_stride, src, src_stride, scale)) {
+            return;
+        }
+    }
+
     /* number of n-element of the first dimension */
     n1dim = 1;
     for(i=1; i<=stride_levels; i++) {
@@ -6738,7 +7210,7 @@ STATIC void nb_accs_packed(
                     max_message_size : bytes_remaining;
                 buf -= size;
                 if (size == bytes_remaining) {
-                    nb_send_header(buf, size, master_rank, nb);
+                    nb_send_payload(buf, size, master_rank, nb);
                 }
                 else {
                     nb_send_buffer(buf, size, master_rank, nb);
@@ -6848,8 +7320,8 @@ STATIC void nb_putv_packed(comex_giov_t *iov, int proc, nb_t *nb)
         header->rank = proc;
         header->length = iov_size;
         nb_send_header(header, sizeof(header_t), master_rank, nb);
-        nb_send_header(iov_buf, iov_size, master_rank, nb);
-        nb_send_header(packed_buffer, packed_size, master_rank, nb);
+        nb_send_payload(iov_buf, iov_size, master_rank, nb);
+        nb_send_payload(packed_buffer, packed_size, master_rank, nb);
     }
 }
 
@@ -6960,7 +7432,7 @@ STATIC void nb_getv_packed(comex_giov_t *iov, int proc, nb_t *nb)
         header->length = iov_size;
         nb_recv_iov(packed_buffer, packed_size, master_rank, nb, iov_copy);
         nb_send_header(header, sizeof(header_t), master_rank, nb);
-        nb_send_header(iov_buf, iov_size, master_rank, nb);
+        nb_send_payload(iov_buf, iov_size, master_rank, nb);
     }
 }
 
@@ -7101,8 +7573,8 @@ STATIC void nb_accv_packed(
         header->length = iov_size;
         (void)memcpy(message+sizeof(header_t), scale, scale_size);
         nb_send_header(message, message_size, master_rank, nb);
-        nb_send_header(iov_buf, iov_size, master_rank, nb);
-        nb_send_header(packed_buffer, packed_size, master_rank, nb);
+        nb_send_payload(iov_buf, iov_size, master_rank, nb);
+        nb_send_payload(packed_buffer, packed_size, master_rank, nb);
     }
 }
 
@@ -7232,7 +7704,7 @@ STATIC void check_devshm(int fd, size_t size){
     fprintf(stderr, "[%d] /dev/shm fs has size %ld new shm area has size %ld need to increase /dev/shm by %ld Mbytes\n",
 	    g_state.rank, devshm_fs_left/CONVERT_TO_M, newspace/CONVERT_TO_M, (newspace - devshm_fs_left)/CONVERT_TO_M);
         perror("check_devshm: /dev/shm out of space");
-    //    _free_semaphore();
+    //    _free_acc_locks();
     comex_error("check_devshm: /dev/shm out of space", -1);
     
   }else{
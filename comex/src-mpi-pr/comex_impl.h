@@ -10,16 +10,18 @@
 #define COMEX_MAX_NB_OUTSTANDING 256
 #define COMEX_MAX_STRIDE_LEVEL 8
 #define COMEX_TAG 27624
+#define COMEX_TAG_DATA 27625
+#define COMEX_PROGRESS_THREADS 1
+#define COMEX_PROGRESS_RECVS 16
+#define COMEX_ACC_LOCKS 512
+#define COMEX_ACC_LOCK_SHIFT 8
+#define COMEX_ACC_LOCK_PAD 64
+#define COMEX_ACC_ATOMIC_BYTES 256
 #define COMEX_STATIC_BUFFER_SIZE (2u*1048576u)
 #define SHM_NAME_SIZE 31
 #define UNLOCKED -1
 
 /* performance or correctness related settings */
-#if defined(__bgq__) || defined(__bgp__)
-#define ENABLE_UNNAMED_SEM 1
-#else
-#define ENABLE_UNNAMED_SEM 0
-#endif
 #define NEED_ASM_VOLATILE_MEMORY 0
 #define MASTER_IS_SMALLEST_SMP_RANK 0
 #define COMEX_SET_AFFINITY 0
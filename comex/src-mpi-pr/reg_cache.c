@@ -20,224 +20,15 @@
 #include "comex.h"
 #include "comex_impl.h"
 #include "reg_cache.h"
+#include "reg_index.h"
 
 #define STATIC static inline
 
 /* the static members in this module */
-static reg_entry_t **reg_cache = NULL; /**< list of caches (one per process) */
+static reg_index_t *reg_cache = NULL; /**< segment index (one per process) */
 static int reg_nprocs = 0; /**< number of caches (one per process) */
 
 
-/* the static functions in this module */
-static reg_return_t seg_cmp(void *reg_addr, size_t reg_len,
-                            void *oth_addr, size_t oth_len, int op);
-static reg_return_t seg_intersects(void *reg_addr, size_t reg_len,
-                                   void *oth_addr, size_t oth_len);
-static reg_return_t seg_contains(void *reg_addr, size_t reg_len,
-                                 void *oth_addr, size_t oth_len);
-static reg_return_t reg_entry_intersects(reg_entry_t *reg_entry,
-                                         void *buf, size_t len);
-static reg_return_t reg_entry_contains(reg_entry_t *reg_entry,
-                                       void *buf, size_t len);
-
-#define TEST_FOR_INTERSECTION 0
-#define TEST_FOR_CONTAINMENT 1
-
-
-/**
- * Detects whether two memory segments intersect or one contains the other.
- *
- * @param[in] reg_addr  starting address of original segment
- * @param[in] reg_len   length of original segment
- * @param[in] oth_addr  starting address of other segment
- * @param[in] oth_len   length of other segment
- * @param[in] op        op to perform, either TEST_FOR_INTERSECTION or
- *                      TEST_FOR_CONTAINMENT
- *
- * @pre NULL != reg_beg
- * @pre NULL != oth_beg
- *
- * @return RR_SUCCESS on success
- */
-STATIC reg_return_t
-seg_cmp(void *reg_addr, size_t reg_len, void *oth_addr, size_t oth_len, int op)
-{
-    ptrdiff_t reg_beg = 0;
-    ptrdiff_t reg_end = 0;
-    ptrdiff_t oth_beg = 0;
-    ptrdiff_t oth_end = 0;
-    int result = 0;
-
-    /* preconditions */
-    COMEX_ASSERT(NULL != reg_addr);
-    COMEX_ASSERT(NULL != oth_addr);
-
-    /* casts to ptrdiff_t since arithmetic on void* is undefined */
-    reg_beg = (ptrdiff_t)(reg_addr);
-    reg_end = reg_beg + (ptrdiff_t)(reg_len);
-    oth_beg = (ptrdiff_t)(oth_addr);
-    oth_end = oth_beg + (ptrdiff_t)(oth_len);
-    
-    /* hack? we had problems with adjacent registered memory regions and
-     * when the length of the query region was 0 */
-    if (oth_beg == oth_end) {
-        oth_end += 1;
-    }
-
-    switch (op) {
-        case TEST_FOR_INTERSECTION:
-            result = (reg_beg >= oth_beg && reg_beg <  oth_end) ||
-                     (reg_end >  oth_beg && reg_end <= oth_end);
-#if DEBUG
-            printf("[%d] TEST_FOR_INTERSECTION "
-                    "(%td >= %td [%d] && %td < %td [%d]) ||"
-                    "(%td > %td [%d] && %td <= %td [%d])\n",
-                    g_state.rank,
-                    reg_beg, oth_beg, (reg_beg >= oth_beg),
-                    reg_beg, oth_end, (reg_beg < oth_end),
-                    reg_end, oth_beg, (reg_end > oth_beg),
-                    reg_end, oth_end, (reg_end <= oth_end));
-#endif
-            break;
-        case TEST_FOR_CONTAINMENT:
-            result = reg_beg <= oth_beg && reg_end >= oth_end;
-#if DEBUG
-            printf("[%d] TEST_FOR_CONTAINMENT "
-                    "%td <= %td [%d] && %td >= %td [%d]\n",
-                    g_state.rank,
-                    reg_beg, oth_beg, (reg_beg <= oth_beg),
-                    reg_end, oth_end, (reg_end >= oth_end));
-#endif
-            break;
-        default:
-            COMEX_ASSERT(0);
-    }
-
-    if (result) {
-        return RR_SUCCESS;
-    }
-    else {
-        return RR_FAILURE;
-    }
-}
-
-
-/**
- * Detects whether two memory segments intersect.
- *
- * @param[in] reg_addr starting address of original segment
- * @param[in] reg_len  length of original segment
- * @param[in] oth_addr starting address of other segment
- * @param[in] oth_len  length of other segment
- *
- * @pre NULL != reg_beg
- * @pre NULL != oth_beg
- *
- * @return RR_SUCCESS on success
- */
-STATIC reg_return_t
-seg_intersects(void *reg_addr, size_t reg_len, void *oth_addr, size_t oth_len)
-{
-    /* preconditions */
-    COMEX_ASSERT(NULL != reg_addr);
-    COMEX_ASSERT(NULL != oth_addr);
-
-    return seg_cmp(
-            reg_addr, reg_len,
-            oth_addr, oth_len,
-            TEST_FOR_INTERSECTION);
-}
-
-
-/**
- * Detects whether the first memory segment contains the other.
- *
- * @param[in] reg_addr starting address of original segment
- * @param[in] reg_len  length of original segment
- * @param[in] oth_addr starting address of other segment
- * @param[in] oth_len  length of other segment
- *
- * @pre NULL != reg_beg
- * @pre NULL != oth_beg
- *
- * @return RR_SUCCESS on success
- */
-STATIC reg_return_t
-seg_contains(void *reg_addr, size_t reg_len, void *oth_addr, size_t oth_len)
-{
-    /* preconditions */
-    COMEX_ASSERT(NULL != reg_addr);
-    COMEX_ASSERT(NULL != oth_addr);
-
-    return seg_cmp(
-            reg_addr, reg_len,
-            oth_addr, oth_len,
-            TEST_FOR_CONTAINMENT);
-}
-
-
-/**
- * Detects whether two memory segments intersect.
- *
- * @param[in] reg_entry the registration entry
- * @param[in] buf       starting address for the contiguous memory region
- * @param[in] len       length of the contiguous memory region
- *
- * @pre NULL != reg_entry
- * @pre NULL != buf
- * @pre len >= 0
- *
- * @return RR_SUCCESS on success
- */
-STATIC reg_return_t
-reg_entry_intersects(reg_entry_t *reg_entry, void *buf, size_t len)
-{
-#if DEBUG
-    printf("[%d] reg_entry_intersects(reg_entry=%p, buf=%p, len=%d)\n",
-            g_state.rank, reg_entry, buf, len);
-#endif
-    /* preconditions */
-    COMEX_ASSERT(NULL != reg_entry);
-    COMEX_ASSERT(NULL != buf);
-    COMEX_ASSERT(len >= 0);
-
-    return seg_intersects(
-            reg_entry->buf, reg_entry->len,
-            buf, len);
-}
-
-
-/**
- * Detects whether the first memory segment contains the other.
- *
- * @param[in] reg_entry the registration entry
- * @param[in] buf       starting address for the contiguous memory region
- * @param[in] len       length of the contiguous memory region
- *
- * @pre NULL != reg_entry
- * @pre NULL != buf
- * @pre len >= 0
- *
- * @return RR_SUCCESS on success
- */
-STATIC reg_return_t
-reg_entry_contains(reg_entry_t *reg_entry, void *buf, size_t len)
-{
-#if DEBUG
-    printf("[%d] reg_entry_contains(reg_entry=%p, buf=%p, len=%d)\n",
-            g_state.rank, reg_entry, buf, len);
-#endif
-
-    /* preconditions */
-    COMEX_ASSERT(NULL != reg_entry);
-    COMEX_ASSERT(NULL != buf);
-    COMEX_ASSERT(len >= 0);
-
-    return seg_contains(
-            reg_entry->buf, reg_entry->len,
-            buf, len);
-}
-
 
 /**
  * Remove registration cache entry without deregistration.
@@ -303,13 +94,13 @@ reg_cache_init(int nprocs)
     /* keep the number of caches around for later use */
     reg_nprocs = nprocs;
 
-    /* allocate the registration cache list: */
-    reg_cache = (reg_entry_t **)malloc(sizeof(reg_entry_t*) * reg_nprocs); 
+    /* allocate the registration cache indices: */
+    reg_cache = (reg_index_t *)malloc(sizeof(reg_index_t) * reg_nprocs); 
     COMEX_ASSERT(reg_cache); 
 
-    /* initialize the registration cache list: */
+    /* initialize the registration cache indices: */
     for (i = 0; i < reg_nprocs; ++i) {
-        reg_cache[i] = NULL;
+        reg_index_init(&reg_cache[i]);
     }
 
     return RR_SUCCESS;
@@ -340,19 +131,15 @@ reg_cache_destroy()
     COMEX_ASSERT(0 != reg_nprocs);
 
     for (i = 0; i < reg_nprocs; ++i) {
-        reg_entry_t *runner = reg_cache[i];
+        int j = 0;
 
-        while (runner) {
-            reg_entry_t *previous = runner; /* pointer to previous runner */
-
-            /* get next runner */
-            runner = runner->next;
-            /* destroy the entry */
-            reg_entry_destroy(i, previous);
+        for (j = 0; j < reg_cache[i].size; ++j) {
+            reg_entry_destroy(i, (reg_entry_t*)reg_cache[i].items[j].entry);
         }
+        reg_index_destroy(&reg_cache[i]);
     }
 
-    /* free registration cache list */
+    /* free registration cache indices */
     free(reg_cache);
     reg_cache = NULL;
 
@@ -380,7 +167,6 @@ reg_entry_t*
 reg_cache_find(int rank, void *buf, size_t len)
 {
     reg_entry_t *entry = NULL;
-    reg_entry_t *runner = NULL;
 
 #if DEBUG
     printf("[%d] reg_cache_find(rank=%d, buf=%p, len=%d)\n",
@@ -391,38 +177,16 @@ reg_cache_find(int rank, void *buf, size_t len)
     COMEX_ASSERT(NULL != reg_cache);
     COMEX_ASSERT(0 <= rank && rank < reg_nprocs);
 
-    runner = reg_cache[rank];
+    entry = (reg_entry_t*)reg_index_find(&reg_cache[rank], buf, len);
 
-    while (runner && NULL == entry) {
-        if (RR_SUCCESS == reg_entry_contains(runner, buf, len)) {
-            entry = runner;
 #if DEBUG
-            printf("[%d] reg_cache_find entry found\n"
-                    "reg_entry=%p buf=%p len=%d\n"
-                    "rank=%d buf=%p len=%zu name=%s mapped=%p\n",
-                    g_state.rank, runner, buf, len,
-                    runner->rank, runner->buf, runner->len,
-                    runner->name, runner->mapped);
-#endif
-        }
-        runner = runner->next;
-    }
-
-#ifndef NDEBUG
-    /* we COMEX_ASSERT that the found entry was unique */
-    while (runner) {
-        if (RR_SUCCESS == reg_entry_contains(runner, buf, len)) {
-#if DEBUG
-            printf("[%d] reg_cache_find duplicate found\n"
-                    "reg_entry=%p buf=%p len=%d\n"
-                    "rank=%d buf=%p len=%zu name=%s mapped=%p\n",
-                    g_state.rank, runner, buf, len,
-                    runner->rank, runner->buf, runner->len,
-                    runner->name, runner->mapped);
-#endif
-            COMEX_ASSERT(0);
-        }
-        runner = runner->next;
+    if (entry) {
+        printf("[%d] reg_cache_find entry found\n"
+                "reg_entry=%p buf=%p len=%d\n"
+                "rank=%d buf=%p len=%zu name=%s mapped=%p\n",
+                g_state.rank, entry, buf, len,
+                entry->rank, entry->buf, entry->len,
+                entry->name, entry->mapped);
     }
 #endif
 
@@ -445,9 +209,6 @@ reg_cache_find(int rank, void *buf, size_t len)
 reg_entry_t*
 reg_cache_find_intersection(int rank, void *buf, size_t len)
 {
-    reg_entry_t *entry = NULL;
-    reg_entry_t *runner = NULL;
-
 #if DEBUG
     printf("[%d] reg_cache_find_intersection(rank=%d, buf=%p, len=%d)\n",
             g_state.rank, rank, buf, len);
@@ -457,24 +218,7 @@ reg_cache_find_intersection(int rank, void *buf, size_t len)
     COMEX_ASSERT(NULL != reg_cache);
     COMEX_ASSERT(0 <= rank && rank < reg_nprocs);
 
-    runner = reg_cache[rank];
-
-    while (runner && NULL == entry) {
-        if (RR_SUCCESS == reg_entry_intersects(runner, buf, len)) {
-            entry = runner;
-        }
-        runner = runner->next;
-    }
-
-    /* we COMEX_ASSERT that the found entry was unique */
-    while (runner) {
-        if (RR_SUCCESS == reg_entry_contains(runner, buf, len)) {
-            COMEX_ASSERT(0);
-        }
-        runner = runner->next;
-    }
-
-    return entry;
+    return (reg_entry_t*)reg_index_find_intersection(&reg_cache[rank], buf, len);
 }
 
 
@@ -528,22 +272,12 @@ reg_cache_insert(int rank, void *buf, size_t len, const char *name, void *mapped
     node->use_dev = use_dev;
     (void)memcpy(node->name, name, SHM_NAME_SIZE);
     node->mapped = mapped;
-    node->next = NULL;
 #if USE_SICM
     node->device = device;
 #endif
 
-    /* push new entry to tail of linked list */
-    if (NULL == reg_cache[rank]) {
-        reg_cache[rank] = node;
-    }
-    else {
-        reg_entry_t *runner = reg_cache[rank];
-        while (runner->next) {
-            runner = runner->next;
-        }
-        runner->next = node;
-    }
+    /* add new entry to the sorted index */
+    reg_index_insert(&reg_cache[rank], buf, len, node);
 
     return node;
 }
@@ -570,7 +304,6 @@ reg_cache_delete(int rank, void *buf)
 {
     reg_return_t status = RR_FAILURE;
     reg_entry_t *runner = NULL;
-    reg_entry_t *previous_runner = NULL;
 
 #if DEBUG
     printf("[%d] reg_cache_delete(rank=%d, buf=%p)\n",
@@ -585,28 +318,13 @@ reg_cache_delete(int rank, void *buf)
 
     /* this is more restrictive than reg_cache_find() in that we locate
      * exactlty the same region starting address */
-    runner = reg_cache[rank];
-    while (runner) {
-        if (runner->buf == buf) {
-            break;
-        }
-        previous_runner = runner;
-        runner = runner->next;
-    }
+    runner = (reg_entry_t*)reg_index_remove(&reg_cache[rank], buf);
     /* we should have found an entry */
     if (NULL == runner) {
         COMEX_ASSERT(0);
         return RR_FAILURE;
     }
 
-    /* pop the entry out of the linked list */
-    if (previous_runner) {
-        previous_runner->next = runner->next;
-    }
-    else {
-        reg_cache[rank] = reg_cache[rank]->next;
-    }
-
     status = reg_entry_destroy(rank, runner);
 
     return status;
@@ -620,7 +338,6 @@ reg_return_t reg_cache_nullify(reg_entry_t *node)
             g_state.rank, node);
 #endif
 
-    node->next = NULL;
     node->buf = NULL;
     node->len = 0;
     node->mapped = NULL;
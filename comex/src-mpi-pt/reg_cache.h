@@ -20,7 +20,6 @@ typedef struct _reg_entry_t {
     size_t len;                 /**< length of region */
     char name[SHM_NAME_SIZE];   /**< name of region */
     void *mapped;               /**< starting address of mmap'd region */
-    struct _reg_entry_t *next;  /**< next memory region in list */
 } reg_entry_t;
 
 /* functions
@@ -9,6 +9,7 @@
 #include <string.h>
 #include <strings.h>
 #include <unistd.h>
+#include <sched.h>
 
 /* 3rd party headers */
 #include <mpi.h>
@@ -43,7 +44,11 @@
 #define USE_MPI_FLUSH_LOCAL
 #define USE_MPI_WIN_ALLOC
 */
+#define USE_MPI_DEFERRED_FLUSH
 
+#ifdef USE_MPI_DEFERRED_FLUSH
+#define USE_MPI_FLUSH_LOCAL
+#endif
 #ifdef USE_MPI_FLUSH_LOCAL
 #define USE_MPI_REQUESTS
 #endif
@@ -70,6 +75,17 @@ local_state l_state;
 /* static state */
 static int  initialized=0;  /* for comex_initialized(), 0=false */
 static char skip_lock=0;    /* don't acquire or release lock */
+static int  use_shm=1;      /* bypass MPI on this node, COMEX_USE_SHM */
+
+/* Segments are allocated from an MPI_Win_allocate_shared window on the node
+ * communicator of their group. SHM_PAD bytes ahead of each segment hold the
+ * lock word that serializes load/store accumulates into it. */
+#define SHM_PAD 64
+#define SHM_PUT 0
+#define SHM_GET 1
+#define SHM_ACC 2
+/* handle returned by non-blocking calls that completed through shared memory */
+#define SHM_HDL_DONE -1
 
 /* static function declarations */
 static void acquire_remote_lock(int proc);
@@ -87,6 +103,27 @@ int _mutex_total;
 /* Maximum number of outstanding non-blocking requests */
 static int nb_max_outstanding = COMEX_MAX_NB_OUTSTANDING;
 
+#ifdef USE_MPI_DEFERRED_FLUSH
+/* Completion state of deferred non-blocking operations on one window.
+ * Operations are numbered in the order they are issued; an operation is
+ * complete once a flush of its target has been issued after it. */
+typedef struct nb_window {
+  MPI_Win win;
+  int size;                 /* number of ranks in win */
+  long all;                 /* last operation completed on every rank */
+  long *flushed;            /* last operation completed, per target rank */
+  int *pending;             /* operations issued since that flush */
+  struct nb_window *next;
+} nb_window_t;
+
+static nb_window_t *nb_windows = NULL;
+/* attribute of a window holding its completion state */
+static int nb_keyval = MPI_KEYVAL_INVALID;
+static long nb_seq = 0;     /* number of the last operation issued */
+/* flush a target once this many operations to it are pending */
+static int nb_flush_threshold = COMEX_NB_FLUSH_THRESHOLD;
+#endif
+
 typedef struct {
   MPI_Request request;
   MPI_Win win;
@@ -99,6 +136,11 @@ typedef struct {
 #else
   int remote_proc;
 #endif
+#ifdef USE_MPI_DEFERRED_FLUSH
+  nb_window_t *nb_win;      /* completion state of win, NULL once complete */
+  long seq;                 /* number of the operation */
+#endif
+  void *buf;                /* temporary origin buffer freed on completion */
 } nb_t;
 
 static nb_t **nb_list = NULL;
@@ -136,9 +178,12 @@ void get_nb_request(comex_request_t *handle, nb_t **req)
     nb_full_count++;
     nb_full_count = nb_full_count%nb_max_outstanding;
   }
+  (*req)->request = MPI_REQUEST_NULL;
+  (*req)->buf = NULL;
 }
 #endif
 
+
 /**
  * Utility function to catch and translate MPI errors. Returns silently if
  * no error detected.
@@ -175,6 +220,243 @@ int get_local_rank_from_win(MPI_Win win, int world_rank, int *local_rank)
   return COMEX_SUCCESS;
 }
 
+
+#ifdef USE_MPI_DEFERRED_FLUSH
+/* Find the completion state of window win, creating it if create is set.
+ * The state is attached to the window as an attribute, so it is found
+ * from the window handle without searching. */
+static nb_window_t* nb_window_find(MPI_Win win, int create)
+{
+  nb_window_t *w = NULL;
+  MPI_Group group;
+  int flag = 0, ierr;
+  if (nb_keyval == MPI_KEYVAL_INVALID) {
+    if (!create) return NULL;
+    ierr = MPI_Win_create_keyval(MPI_WIN_NULL_COPY_FN,
+        MPI_WIN_NULL_DELETE_FN, &nb_keyval, NULL);
+    translate_mpi_error(ierr,"nb_window_find:MPI_Win_create_keyval");
+  }
+  ierr = MPI_Win_get_attr(win, nb_keyval, &w, &flag);
+  translate_mpi_error(ierr,"nb_window_find:MPI_Win_get_attr");
+  if (flag) return w;
+  if (!create) return NULL;
+  w = (nb_window_t*)malloc(sizeof(nb_window_t));
+  COMEX_ASSERT(w);
+  MPI_Win_get_group(win, &group);
+  MPI_Group_size(group, &w->size);
+  MPI_Group_free(&group);
+  w->win = win;
+  w->all = nb_seq;
+  w->flushed = (long*)calloc(w->size, sizeof(long));
+  w->pending = (int*)calloc(w->size, sizeof(int));
+  COMEX_ASSERT(w->flushed && w->pending);
+  ierr = MPI_Win_set_attr(win, nb_keyval, w);
+  translate_mpi_error(ierr,"nb_window_find:MPI_Win_set_attr");
+  w->next = nb_windows;
+  nb_windows = w;
+  return w;
+}
+
+
+/* Record that all operations issued so far to rank proc of w are complete.
+ * A proc of -1 stands for every rank of the window. */
+static void nb_window_done(nb_window_t *w, int proc)
+{
+  if (w == NULL) return;
+  if (proc < 0) {
+    w->all = nb_seq;
+    memset(w->pending, 0, sizeof(int)*w->size);
+  } else {
+    w->flushed[proc] = nb_seq;
+    w->pending[proc] = 0;
+  }
+}
+
+
+static void nb_flush(nb_window_t *w, int proc)
+{
+  int ierr = MPI_Win_flush_local(proc, w->win);
+  translate_mpi_error(ierr,"nb_flush:MPI_Win_flush_local");
+  nb_window_done(w, proc);
+}
+
+
+/* Queue the operation just issued for req instead of completing it. The
+ * target is only flushed if too many operations to it are pending. */
+static void nb_defer(nb_t *req)
+{
+  nb_window_t *w = nb_window_find(req->win, 1);
+  req->nb_win = w;
+  req->seq = ++nb_seq;
+  if (++w->pending[req->remote_proc] >= nb_flush_threshold) {
+    nb_flush(w, req->remote_proc);
+  }
+}
+
+
+/* Drop the completion state w */
+static void nb_window_free(nb_window_t *w)
+{
+  nb_window_t *prev = nb_windows;
+  int i;
+  for (i=0; i<nb_max_outstanding; i++) {
+    if (nb_list[i]->active && nb_list[i]->nb_win == w) {
+      nb_list[i]->nb_win = NULL;
+    }
+  }
+  if (prev == w) {
+    nb_windows = w->next;
+  } else {
+    while (prev->next != w) prev = prev->next;
+    prev->next = w->next;
+  }
+  free(w->flushed);
+  free(w->pending);
+  free(w);
+}
+
+
+/* Drop the completion state of a window that is being freed */
+static void nb_window_delete(MPI_Win win)
+{
+  nb_window_t *w = nb_window_find(win, 0);
+  int ierr;
+  if (w == NULL) return;
+  ierr = MPI_Win_delete_attr(win, nb_keyval);
+  translate_mpi_error(ierr,"nb_window_delete:MPI_Win_delete_attr");
+  nb_window_free(w);
+}
+#endif
+
+/* Address of remote location addr in this process, for a region on this node */
+static inline char* shm_addr(reg_entry_t *reg, void *addr)
+{
+  return (char*)reg->shm + ((char*)addr - (char*)reg->buf);
+}
+
+
+static inline void shm_lock(reg_entry_t *reg)
+{
+  while (__sync_lock_test_and_set(reg->shm_lock, 1)) {
+    while (*(volatile int*)reg->shm_lock) sched_yield();
+  }
+}
+
+
+static inline void shm_unlock(reg_entry_t *reg)
+{
+  __sync_lock_release(reg->shm_lock);
+}
+
+
+/* Region holding remote address addr on proc if op can be carried out with
+ * loads and stores, otherwise NULL. Accumulates only bypass MPI if every rank
+ * of the window shares this node, since they must stay atomic with respect to
+ * each other and a load/store accumulate is not atomic with MPI_Accumulate
+ * calls from other nodes. */
+static inline reg_entry_t* shm_find(int op, int proc, void *addr)
+{
+  reg_entry_t *reg;
+  if (!use_shm) return NULL;
+  reg = reg_win_find(proc, addr, 0);
+  if (reg == NULL || reg->shm == NULL) return NULL;
+  if (op == SHM_ACC && !reg->shm_acc) return NULL;
+  return reg;
+}
+
+
+/**
+ * Put, get or accumulate a strided section by loads and stores if the
+ * remote region is on this node. A contiguous transfer is passed with
+ * stride_levels equal to 0. Returns 1 if the operation has been completed,
+ * 0 if it has to go through MPI.
+ */
+static int shm_strided(int op, int datatype, void *scale,
+    void *src_ptr, int *src_stride_ar, void *dst_ptr, int *dst_stride_ar,
+    int *count, int stride_levels, int proc)
+{
+  reg_entry_t *reg;
+  char *src, *dst;
+  long src_idx = 0, dst_idx = 0;
+  int idx[7], i;
+
+  reg = shm_find(op, proc, op == SHM_GET ? src_ptr : dst_ptr);
+  if (reg == NULL) return 0;
+  for (i=1; i<=stride_levels; i++) {
+    if (count[i] <= 0) return 1;
+    idx[i] = 0;
+  }
+  src = op == SHM_GET ? shm_addr(reg, src_ptr) : (char*)src_ptr;
+  dst = op == SHM_GET ? (char*)dst_ptr : shm_addr(reg, dst_ptr);
+  if (op == SHM_ACC) shm_lock(reg);
+  do {
+    if (op == SHM_ACC) {
+      acc(datatype, count[0], dst+dst_idx, src, src_idx, scale);
+    } else {
+      memcpy(dst+dst_idx, src+src_idx, count[0]);
+    }
+    /* step to the next contiguous segment */
+    for (i=1; i<=stride_levels; i++) {
+      src_idx += src_stride_ar[i-1];
+      dst_idx += dst_stride_ar[i-1];
+      if (++idx[i] < count[i]) break;
+      src_idx -= (long)count[i]*src_stride_ar[i-1];
+      dst_idx -= (long)count[i]*dst_stride_ar[i-1];
+      idx[i] = 0;
+    }
+  } while (i <= stride_levels);
+  if (op == SHM_ACC) shm_unlock(reg);
+  return 1;
+}
+
+
+/**
+ * Vector version of shm_strided. As in the MPI path, all remote addresses
+ * are assumed to lie in the region holding the first one.
+ */
+static int shm_vector(int op, int datatype, void *scale,
+    comex_giov_t *iov, int iov_len, int proc)
+{
+  reg_entry_t *reg;
+  int i, j;
+
+  if (iov_len < 1 || iov[0].count < 1) return 0;
+  reg = shm_find(op, proc, op == SHM_GET ? iov[0].src[0] : iov[0].dst[0]);
+  if (reg == NULL) return 0;
+  if (op == SHM_ACC) shm_lock(reg);
+  for (i=0; i<iov_len; i++) {
+    for (j=0; j<iov[i].count; j++) {
+      if (op == SHM_GET) {
+        memcpy(iov[i].dst[j], shm_addr(reg, iov[i].src[j]), iov[i].bytes);
+      } else if (op == SHM_PUT) {
+        memcpy(shm_addr(reg, iov[i].dst[j]), iov[i].src[j], iov[i].bytes);
+      } else {
+        acc(datatype, iov[i].bytes, shm_addr(reg, iov[i].dst[j]),
+            iov[i].src[j], 0, scale);
+      }
+    }
+  }
+  if (op == SHM_ACC) shm_unlock(reg);
+  return 1;
+}
+
+
+/* Make load/store updates of shared segments visible across the node */
+static void shm_sync(comex_igroup_t *igroup)
+{
+  win_link_t *curr_win;
+  int ierr;
+  if (!use_shm || igroup == NULL) return;
+  curr_win = igroup->win_list;
+  while (curr_win != NULL) {
+    if (curr_win->shm_win != MPI_WIN_NULL) {
+      ierr = MPI_Win_sync(curr_win->shm_win);
+      translate_mpi_error(ierr,"shm_sync:MPI_Win_sync");
+    }
+    curr_win = curr_win->next;
+  }
+}
+
 int comex_init()
 {
     int i, status;
@@ -218,6 +500,21 @@ int comex_init()
       }
       COMEX_ASSERT(nb_max_outstanding > 0);
 
+#ifdef USE_MPI_DEFERRED_FLUSH
+      nb_flush_threshold = COMEX_NB_FLUSH_THRESHOLD; /* default */
+      value = getenv("COMEX_NB_FLUSH_THRESHOLD");
+      if (NULL != value) {
+        nb_flush_threshold = atoi(value);
+      }
+      COMEX_ASSERT(nb_flush_threshold > 0);
+#endif
+
+      use_shm = 1; /* default */
+      value = getenv("COMEX_USE_SHM");
+      if (NULL != value) {
+        use_shm = atoi(value);
+      }
+
 #if DEBUG
       armci_verbose = 1;
 #else
@@ -230,6 +527,10 @@ int comex_init()
 
       if (armci_verbose && 0 == l_state.rank) {
             printf("COMEX_MAX_NB_OUTSTANDING=%d\n", nb_max_outstanding);
+#ifdef USE_MPI_DEFERRED_FLUSH
+            printf("COMEX_NB_FLUSH_THRESHOLD=%d\n", nb_flush_threshold);
+#endif
+            printf("COMEX_USE_SHM=%d\n", use_shm);
             fflush(stdout);
       }
 
@@ -255,6 +556,10 @@ int comex_init()
     for (i=0; i<nb_max_outstanding; i++) {
       nb_list[i] = (nb_t*)malloc(sizeof(nb_t));
       nb_list[i]->active = 0;
+      nb_list[i]->buf = NULL;
+#ifdef USE_MPI_DEFERRED_FLUSH
+      nb_list[i]->nb_win = NULL;
+#endif
     }
 #endif
 
@@ -353,10 +658,14 @@ int comex_put(
     void *ptr;
     int lproc, ierr;
     reg_entry_t *reg_win;
-#ifdef USE_MPI_REQUESTS
+#if defined(USE_MPI_REQUESTS) && !defined(USE_MPI_FLUSH_LOCAL)
     MPI_Request request;
     MPI_Status status;
 #endif
+    if (shm_strided(SHM_PUT, 0, NULL, src, NULL,
+          dst, NULL, &bytes, 0, proc)) {
+      return COMEX_SUCCESS;
+    }
     reg_win = reg_win_find(proc, dst, 0);
     ptr = reg_win->buf;
     displ = (MPI_Aint)(dst) - (MPI_Aint)(ptr);
@@ -469,10 +778,14 @@ int comex_get(
     void *ptr;
     int lproc, ierr;
     reg_entry_t *reg_win;
-#ifdef USE_MPI_REQUESTS
+#if defined(USE_MPI_REQUESTS) && !defined(USE_MPI_FLUSH_LOCAL)
     MPI_Request request;
     MPI_Status status;
 #endif
+    if (shm_strided(SHM_GET, 0, NULL, src, NULL,
+          dst, NULL, &bytes, 0, proc)) {
+      return COMEX_SUCCESS;
+    }
     reg_win = reg_win_find(proc, src, 0);
     ptr = reg_win->buf;
     displ = (MPI_Aint)(src) - (MPI_Aint)(ptr);
@@ -532,11 +845,15 @@ int comex_acc(
     void *ptr, *tbuf;
     int count, i, lproc, ierr;
     reg_entry_t *reg_win;
-#ifdef USE_MPI_REQUESTS
+#if defined(USE_MPI_REQUESTS) && !defined(USE_MPI_FLUSH_LOCAL)
     MPI_Request request;
     MPI_Status status;
 #endif
     MPI_Datatype mpi_type;
+    if (shm_strided(SHM_ACC, datatype, scale, src, NULL,
+          dst, NULL, &bytes, 0, proc)) {
+      return COMEX_SUCCESS;
+    }
     reg_win = reg_win_find(proc, dst, 0);
     ptr = reg_win->buf;
     displ = (MPI_Aint)(dst) - (MPI_Aint)(ptr);
@@ -734,6 +1051,10 @@ int comex_puts(
         int *count, int stride_levels,
         int proc, comex_group_t group)
 {
+    if (shm_strided(SHM_PUT, 0, NULL, src_ptr, src_stride_ar,
+          dst_ptr, dst_stride_ar, count, stride_levels, proc)) {
+      return COMEX_SUCCESS;
+    }
 #ifndef USE_MPI_DATATYPES
     int i, j;
     long src_idx, dst_idx;  /* index offset of current block position to ptr */
@@ -795,7 +1116,7 @@ int comex_puts(
     void *ptr;
     int lproc, ierr;
     reg_entry_t *reg_win;
-#ifdef USE_MPI_REQUESTS
+#if defined(USE_MPI_REQUESTS) && !defined(USE_MPI_FLUSH_LOCAL)
     MPI_Request request;
     MPI_Status status;
 #endif
@@ -877,6 +1198,10 @@ int comex_gets(
         int *count, int stride_levels,
         int proc, comex_group_t group)
 {
+    if (shm_strided(SHM_GET, 0, NULL, src_ptr, src_stride_ar,
+          dst_ptr, dst_stride_ar, count, stride_levels, proc)) {
+      return COMEX_SUCCESS;
+    }
 #ifndef USE_MPI_DATATYPES
     int i, j;
     long src_idx, dst_idx;  /* index offset of current block position to ptr */
@@ -938,7 +1263,7 @@ int comex_gets(
     void *ptr;
     int lproc,ierr;
     reg_entry_t *reg_win;
-#ifdef USE_MPI_REQUESTS
+#if defined(USE_MPI_REQUESTS) && !defined(USE_MPI_FLUSH_LOCAL)
     MPI_Request request;
     MPI_Status status;
 #endif
@@ -1133,6 +1458,10 @@ int comex_accs(
         int *count, int stride_levels,
         int proc, comex_group_t group)
 {
+    if (shm_strided(SHM_ACC, datatype, scale, src_ptr, src_stride_ar,
+          dst_ptr, dst_stride_ar, count, stride_levels, proc)) {
+      return COMEX_SUCCESS;
+    }
 #ifndef USE_MPI_DATATYPES
     int i, j;
     long src_idx, dst_idx;  /* index offset of current block position to ptr */
@@ -1195,7 +1524,7 @@ int comex_accs(
     int bufsize;
     int new_strides[7], new_count[7];
     reg_entry_t *reg_win;
-#ifdef USE_MPI_REQUESTS
+#if defined(USE_MPI_REQUESTS) && !defined(USE_MPI_FLUSH_LOCAL)
     MPI_Request request;
     MPI_Status status;
 #endif
@@ -1429,6 +1758,9 @@ int comex_putv(
         comex_giov_t *iov, int iov_len,
         int proc, comex_group_t group)
 {
+    if (shm_vector(SHM_PUT, 0, NULL, iov, iov_len, proc)) {
+      return COMEX_SUCCESS;
+    }
 #ifndef USE_MPI_DATATYPES
     int status;
     int i;
@@ -1452,7 +1784,7 @@ int comex_putv(
     void *ptr, *src_ptr, *dst_ptr;
     int lproc, ierr;
     reg_entry_t *reg_win;
-#ifdef USE_MPI_REQUESTS
+#if defined(USE_MPI_REQUESTS) && !defined(USE_MPI_FLUSH_LOCAL)
     MPI_Request request;
     MPI_Status status;
 #endif
@@ -1514,6 +1846,9 @@ int comex_getv(
         comex_giov_t *iov, int iov_len,
         int proc, comex_group_t group)
 {
+    if (shm_vector(SHM_GET, 0, NULL, iov, iov_len, proc)) {
+      return COMEX_SUCCESS;
+    }
 #ifndef USE_MPI_DATATYPES
     int status;
     int i;
@@ -1537,7 +1872,7 @@ int comex_getv(
     void *ptr, *src_ptr, *dst_ptr;
     int lproc, ierr;
     reg_entry_t *reg_win;
-#ifdef USE_MPI_REQUESTS
+#if defined(USE_MPI_REQUESTS) && !defined(USE_MPI_FLUSH_LOCAL)
     MPI_Request request;
     MPI_Status status;
 #endif
@@ -1814,6 +2149,9 @@ int comex_accv(
         comex_giov_t *iov, int iov_len,
         int proc, comex_group_t group)
 {
+    if (shm_vector(SHM_ACC, datatype, scale, iov, iov_len, proc)) {
+      return COMEX_SUCCESS;
+    }
 #ifndef USE_MPI_DATATYPES
     int i;
     
@@ -1835,7 +2173,7 @@ int comex_accv(
     MPI_Datatype base_type;
     void *ptr, *src_ptr, *dst_ptr;
     int ierr;
-#ifdef USE_MPI_REQUESTS
+#if defined(USE_MPI_REQUESTS) && !defined(USE_MPI_FLUSH_LOCAL)
     MPI_Request request;
     MPI_Status status;
 #endif
@@ -1932,9 +2270,13 @@ int comex_fence_proc(int proc, comex_group_t group)
     while (curr_win != NULL) {
       ierr = MPI_Win_flush(proc, curr_win->win);
       translate_mpi_error(ierr,"comex_fence_proc:MPI_Win_flush");
+#ifdef USE_MPI_DEFERRED_FLUSH
+      nb_window_done(nb_window_find(curr_win->win, 0), proc);
+#endif
       curr_win = curr_win->next;
     }
   }
+  shm_sync(igroup);
   return COMEX_SUCCESS;
 }
 
@@ -1949,6 +2291,8 @@ int comex_barrier(comex_group_t group)
     ierr = comex_group_comm(group, &comm);
     assert(COMEX_SUCCESS == ierr);
     MPI_Barrier(comm);
+    /* pick up stores other ranks on this node made before the barrier */
+    shm_sync(comex_get_igroup_from_group(group));
 
     return COMEX_SUCCESS;
 }
@@ -2034,6 +2378,14 @@ int comex_finalize()
 #endif
 
     /* Clean up request list */
+#ifdef USE_MPI_DEFERRED_FLUSH
+    while (nb_windows != NULL) {
+      nb_window_free(nb_windows);
+    }
+    if (nb_keyval != MPI_KEYVAL_INVALID) {
+      MPI_Win_free_keyval(&nb_keyval);
+    }
+#endif
 #ifdef USE_MPI_REQUESTS
     for (i=0; i<nb_max_outstanding; i++) {
       free(nb_list[i]);
@@ -2051,7 +2403,26 @@ int comex_finalize()
 
 int comex_wait_proc(int proc, comex_group_t group)
 {
+#ifdef USE_MPI_DEFERRED_FLUSH
+    comex_igroup_t *igroup = NULL;
+    win_link_t *curr_win;
+    nb_window_t *w;
+    int lproc;
+    igroup = comex_get_igroup_from_group(group);
+    if (igroup != NULL) {
+      curr_win = igroup->win_list;
+      while (curr_win != NULL) {
+        w = nb_window_find(curr_win->win, 0);
+        if (w != NULL) {
+          get_local_rank_from_win(curr_win->win, proc, &lproc);
+          if (w->pending[lproc] > 0) nb_flush(w, lproc);
+        }
+        curr_win = curr_win->next;
+      }
+    }
+#else
     assert(0);
+#endif
 
     return COMEX_SUCCESS;
 }
@@ -2060,11 +2431,21 @@ int comex_wait_proc(int proc, comex_group_t group)
 int comex_wait(comex_request_t* hdl)
 {
   int ierr;
+  if (*hdl == SHM_HDL_DONE) return COMEX_SUCCESS;
 #ifndef USE_MPI_DATATYPES
   return COMEX_SUCCESS;
 #endif
 #ifdef USE_MPI_REQUESTS
-#ifdef USE_MPI_FLUSH_LOCAL
+#ifdef USE_MPI_DEFERRED_FLUSH
+  {
+    /* a single flush completes every operation queued to the target */
+    nb_t *req = nb_list[*hdl];
+    if (req->active && req->nb_win != NULL && req->seq > req->nb_win->all
+        && req->seq > req->nb_win->flushed[req->remote_proc]) {
+      nb_flush(req->nb_win, req->remote_proc);
+    }
+  }
+#elif defined(USE_MPI_FLUSH_LOCAL)
   ierr = MPI_Win_flush_local(nb_list[*hdl]->remote_proc,nb_list[*hdl]->win);
   translate_mpi_error(ierr,"comex_wait:MPI_Win_flush_local");
 #else
@@ -2087,6 +2468,8 @@ int comex_wait(comex_request_t* hdl)
     translate_mpi_error(ierr,"comex_wait:MPI_Type_free");
     nb_list[*hdl]->use_type = 0;
   }
+  free(nb_list[*hdl]->buf);
+  nb_list[*hdl]->buf = NULL;
   return COMEX_SUCCESS;
 #else
   /* Non-blocking functions not implemented */
@@ -2099,11 +2482,19 @@ int comex_wait(comex_request_t* hdl)
 
 int comex_test(comex_request_t* hdl, int *status)
 {
+  if (*hdl == SHM_HDL_DONE) {
+    *status = 0;
+    return COMEX_SUCCESS;
+  }
 #ifndef USE_MPI_DATATYPES
   *status = 0;
   return COMEX_SUCCESS;
 #endif
-#ifdef USE_MPI_REQUESTS
+#ifdef USE_MPI_FLUSH_LOCAL
+  /* flushes cannot be tested, so complete the operation */
+  *status = 0;
+  return comex_wait(hdl);
+#elif defined(USE_MPI_REQUESTS)
     int flag;
     int ierr;
     MPI_Status stat;
@@ -2123,6 +2514,8 @@ int comex_test(comex_request_t* hdl, int *status)
         translate_mpi_error(ierr,"comex_wait:MPI_Type_free");
         nb_list[*hdl]->use_type = 0;
       }
+      free(nb_list[*hdl]->buf);
+      nb_list[*hdl]->buf = NULL;
     } else {
       /* operation is incomplete */
       *status = 1;
@@ -2147,6 +2540,9 @@ int comex_wait_all(comex_group_t group)
 #ifdef USE_MPI_REQUESTS
         ierr = MPI_Win_flush_all(curr_win->win);
         translate_mpi_error(ierr,"comex_wait_all:MPI_Win_flush_all");
+#ifdef USE_MPI_DEFERRED_FLUSH
+        nb_window_done(nb_window_find(curr_win->win, 0), -1);
+#endif
 #else
         ierr = MPI_Win_fence(0,curr_win->win);
         translate_mpi_error(ierr,"comex_wait_all:MPI_Win_fence");
@@ -2154,6 +2550,7 @@ int comex_wait_all(comex_group_t group)
         curr_win = curr_win->next;
       }
     }
+    shm_sync(igroup);
     return COMEX_SUCCESS;
 }
 
@@ -2163,6 +2560,11 @@ int comex_nbput(
         int proc, comex_group_t group,
         comex_request_t *hdl)
 {
+    if (shm_strided(SHM_PUT, 0, NULL, src, NULL,
+          dst, NULL, &bytes, 0, proc)) {
+      if (hdl != NULL) *hdl = SHM_HDL_DONE;
+      return COMEX_SUCCESS;
+    }
 #ifndef USE_MPI_DATATYPES
     return comex_put(src, dst, bytes, proc, group);
 #endif
@@ -2175,7 +2577,9 @@ int comex_nbput(
     int lproc, ierr;
     nb_t *req;
     reg_entry_t *reg_win;
+#ifndef USE_MPI_FLUSH_LOCAL
     MPI_Request request;
+#endif
     reg_win = reg_win_find(proc, dst, 0);
     ptr = reg_win->buf;
     displ = (MPI_Aint)(dst) - (MPI_Aint)(ptr);
@@ -2194,12 +2598,15 @@ int comex_nbput(
     translate_mpi_error(ierr,"comex_nbput:MPI_Put");
     req->remote_proc = lproc;
     req->win = reg_win->win;
+#ifdef USE_MPI_DEFERRED_FLUSH
+    nb_defer(req);
+#endif
 #else
     ierr = MPI_Rput(src, bytes, MPI_CHAR, lproc, displ, bytes, MPI_CHAR,
         reg_win->win, &request);
     translate_mpi_error(ierr,"comex_nbput:MPI_Rput");
-#endif
     req->request = request;
+#endif
     req->use_type = 0;
     req->active = 1;
     return COMEX_SUCCESS;
@@ -2214,6 +2621,11 @@ int comex_nbget(
         int proc, comex_group_t group,
         comex_request_t *hdl)
 {
+    if (shm_strided(SHM_GET, 0, NULL, src, NULL,
+          dst, NULL, &bytes, 0, proc)) {
+      if (hdl != NULL) *hdl = SHM_HDL_DONE;
+      return COMEX_SUCCESS;
+    }
 #ifndef USE_MPI_DATATYPES
     return comex_get(src, dst, bytes, proc, group);
 #endif
@@ -2226,7 +2638,9 @@ int comex_nbget(
     int lproc, ierr;
     nb_t *req;
     reg_entry_t *reg_win;
+#ifndef USE_MPI_FLUSH_LOCAL
     MPI_Request request;
+#endif
     reg_win = reg_win_find(proc, src, 0);
     ptr = reg_win->buf;
     displ = (MPI_Aint)(src) - (MPI_Aint)(ptr);
@@ -2245,12 +2659,15 @@ int comex_nbget(
     translate_mpi_error(ierr,"comex_nbget:MPI_Get");
     req->remote_proc = lproc;
     req->win = reg_win->win;
+#ifdef USE_MPI_DEFERRED_FLUSH
+    nb_defer(req);
+#endif
 #else
     ierr = MPI_Rget(dst, bytes, MPI_CHAR, lproc, displ, bytes, MPI_CHAR,
         reg_win->win, &request);
     translate_mpi_error(ierr,"comex_nbget:MPI_Rget");
-#endif
     req->request = request;
+#endif
     req->use_type = 0;
     req->active = 1;
     return COMEX_SUCCESS;
@@ -2266,6 +2683,11 @@ int comex_nbacc(
         int proc, comex_group_t group,
         comex_request_t *hdl)
 {
+    if (shm_strided(SHM_ACC, datatype, scale, src_ptr, NULL,
+          dst_ptr, NULL, &bytes, 0, proc)) {
+      if (hdl != NULL) *hdl = SHM_HDL_DONE;
+      return COMEX_SUCCESS;
+    }
 #ifndef USE_MPI_DATATYPES
     return comex_acc( datatype, scale, src_ptr, dst_ptr,
         bytes, proc, group);
@@ -2280,8 +2702,10 @@ int comex_nbacc(
     int count, i, lproc, ierr;
     nb_t *req;
     reg_entry_t *reg_win;
+#ifndef USE_MPI_FLUSH_LOCAL
     MPI_Request request;
     MPI_Status status;
+#endif
     reg_win = reg_win_find(proc, dst_ptr, 0);
     ptr = reg_win->buf;
     displ = (MPI_Aint)(dst_ptr) - (MPI_Aint)(ptr);
@@ -2309,15 +2733,18 @@ int comex_nbacc(
       translate_mpi_error(ierr,"comex_nbacc:MPI_Accumulate");
       req->remote_proc = lproc;
       req->win = reg_win->win;
+#ifdef USE_MPI_DEFERRED_FLUSH
+      nb_defer(req);
+#endif
 #else
       ierr = MPI_Raccumulate(buf,count,MPI_INT,lproc,displ,count,
           MPI_INT,MPI_SUM,reg_win->win,&request);
       translate_mpi_error(ierr,"comex_nbacc:MPI_Raccumulate");
-#endif
       req->request = request;
+#endif
       req->use_type = 0;
       req->active = 1;
-      free(buf);
+      req->buf = buf;
     } else if (datatype == COMEX_ACC_LNG) {
       long *buf;
       long *lsrc = (long*)src_ptr;
@@ -2333,15 +2760,18 @@ int comex_nbacc(
       translate_mpi_error(ierr,"comex_nbacc:MPI_Accumulate");
       req->remote_proc = lproc;
       req->win = reg_win->win;
+#ifdef USE_MPI_DEFERRED_FLUSH
+      nb_defer(req);
+#endif
 #else
       ierr = MPI_Raccumulate(buf,count,MPI_LONG,lproc,displ,count,
           MPI_LONG,MPI_SUM,reg_win->win,&request);
       translate_mpi_error(ierr,"comex_nbacc:MPI_Raccumulate");
-#endif
       req->request = request;
+#endif
       req->use_type = 0;
       req->active = 1;
-      free(buf);
+      req->buf = buf;
     } else if (datatype == COMEX_ACC_FLT) {
       float *buf;
       float *fsrc = (float*)src_ptr;
@@ -2357,15 +2787,18 @@ int comex_nbacc(
       translate_mpi_error(ierr,"comex_nbacc:MPI_Accumulate");
       req->remote_proc = lproc;
       req->win = reg_win->win;
+#ifdef USE_MPI_DEFERRED_FLUSH
+      nb_defer(req);
+#endif
 #else
       ierr = MPI_Raccumulate(buf,count,MPI_FLOAT,lproc,displ,count,
           MPI_FLOAT,MPI_SUM,reg_win->win,&request);
       translate_mpi_error(ierr,"comex_nbacc:MPI_Raccumulate");
-#endif
       req->request = request;
+#endif
       req->use_type = 0;
       req->active = 1;
-      free(buf);
+      req->buf = buf;
     } else if (datatype == COMEX_ACC_DBL) {
       double *buf;
       double *dsrc = (double*)src_ptr;
@@ -2381,15 +2814,18 @@ int comex_nbacc(
       translate_mpi_error(ierr,"comex_nbacc:MPI_Accumulate");
       req->remote_proc = lproc;
       req->win = reg_win->win;
+#ifdef USE_MPI_DEFERRED_FLUSH
+      nb_defer(req);
+#endif
 #else
       ierr = MPI_Raccumulate(buf,count,MPI_DOUBLE,lproc,displ,count,
           MPI_DOUBLE,MPI_SUM,reg_win->win,&request);
       translate_mpi_error(ierr,"comex_nbacc:MPI_Raccumulate");
-#endif
       req->request = request;
+#endif
       req->use_type = 0;
       req->active = 1;
-      free(buf);
+      req->buf = buf;
     } else if (datatype == COMEX_ACC_CPL) {
       int cnum;
       float *buf;
@@ -2409,15 +2845,18 @@ int comex_nbacc(
       translate_mpi_error(ierr,"comex_nbacc:MPI_Accumulate");
       req->remote_proc = lproc;
       req->win = reg_win->win;
+#ifdef USE_MPI_DEFERRED_FLUSH
+      nb_defer(req);
+#endif
 #else
       ierr = MPI_Raccumulate(buf,count,MPI_FLOAT,lproc,displ,count,
           MPI_FLOAT,MPI_SUM,reg_win->win,&request);
       translate_mpi_error(ierr,"comex_nbacc:MPI_Raccumulate");
-#endif
       req->request = request;
+#endif
       req->use_type = 0;
       req->active = 1;
-      free(buf);
+      req->buf = buf;
     } else if (datatype == COMEX_ACC_DCP) {
       int cnum;
       double *buf;
@@ -2437,15 +2876,18 @@ int comex_nbacc(
       translate_mpi_error(ierr,"comex_nbacc:MPI_Accumulate");
       req->remote_proc = lproc;
       req->win = reg_win->win;
+#ifdef USE_MPI_DEFERRED_FLUSH
+      nb_defer(req);
+#endif
 #else
       ierr = MPI_Raccumulate(buf,count,MPI_DOUBLE,lproc,displ,count,
           MPI_DOUBLE,MPI_SUM,reg_win->win,&request);
       translate_mpi_error(ierr,"comex_nbacc:MPI_Raccumulate");
-#endif
       req->request = request;
+#endif
       req->use_type = 0;
       req->active = 1;
-      free(buf);
+      req->buf = buf;
     } else {
       assert(0);
     }
@@ -2464,6 +2906,11 @@ int comex_nbputs(
         int proc, comex_group_t group,
         comex_request_t *hdl)
 {
+    if (shm_strided(SHM_PUT, 0, NULL, src, src_stride,
+          dst, dst_stride, count, stride_levels, proc)) {
+      if (hdl != NULL) *hdl = SHM_HDL_DONE;
+      return COMEX_SUCCESS;
+    }
 #ifndef USE_MPI_DATATYPES
     return comex_puts(src, src_stride, dst, dst_stride,
             count, stride_levels, proc, group);
@@ -2476,8 +2923,10 @@ int comex_nbputs(
     int lproc, ierr;
     reg_entry_t *reg_win;
     nb_t *req;
+#ifndef USE_MPI_FLUSH_LOCAL
     MPI_Request request;
     MPI_Status status;
+#endif
     if (hdl == NULL) {
       return comex_puts(src, src_stride, dst, dst_stride,
           count, stride_levels, proc, group);
@@ -2509,12 +2958,15 @@ int comex_nbputs(
     translate_mpi_error(ierr,"comex_nbputs:MPI_Put");
     req->remote_proc = lproc;
     req->win = reg_win->win;
+#ifdef USE_MPI_DEFERRED_FLUSH
+    nb_defer(req);
+#endif
 #else
     ierr = MPI_Rput(src, 1, src_type, lproc, displ, 1, dst_type,
         reg_win->win, &request);
     translate_mpi_error(ierr,"comex_nbputs:MPI_Rput");
-#endif
     req->request = request;
+#endif
     req->use_type = 1;
     req->src_type = src_type;
     req->dst_type = dst_type;
@@ -2537,6 +2989,11 @@ int comex_nbgets(
         int proc, comex_group_t group,
         comex_request_t *hdl) 
 {
+    if (shm_strided(SHM_GET, 0, NULL, src, src_stride,
+          dst, dst_stride, count, stride_levels, proc)) {
+      if (hdl != NULL) *hdl = SHM_HDL_DONE;
+      return COMEX_SUCCESS;
+    }
 #ifndef USE_MPI_DATATYPES
     hdl = NULL;
     return comex_gets(src, src_stride, dst, dst_stride,
@@ -2552,8 +3009,10 @@ int comex_nbgets(
     void *ptr;
     int lproc, ierr;
     reg_entry_t *reg_win;
+#ifndef USE_MPI_FLUSH_LOCAL
     MPI_Request request;
     MPI_Status status;
+#endif
     nb_t *req;
     reg_win = reg_win_find(proc, src, 0);
     ptr = reg_win->buf;
@@ -2582,12 +3041,15 @@ int comex_nbgets(
     translate_mpi_error(ierr,"comex_nbgets:MPI_Get");
     req->remote_proc = lproc;
     req->win = reg_win->win;
+#ifdef USE_MPI_DEFERRED_FLUSH
+    nb_defer(req);
+#endif
 #else
     ierr = MPI_Rget(dst, 1, dst_type, lproc, displ, 1, src_type,
         reg_win->win, &request);
     translate_mpi_error(ierr,"comex_nbgets:MPI_Rget");
-#endif
     req->request = request;
+#endif
     req->use_type = 1;
     req->src_type = src_type;
     req->dst_type = dst_type;
@@ -2611,6 +3073,11 @@ int comex_nbaccs(
         int proc, comex_group_t group,
         comex_request_t *hdl)
 {
+    if (shm_strided(SHM_ACC, datatype, scale, src, src_stride,
+          dst, dst_stride, count, stride_levels, proc)) {
+      if (hdl != NULL) *hdl = SHM_HDL_DONE;
+      return COMEX_SUCCESS;
+    }
 #ifndef USE_MPI_DATATYPES
     hdl = NULL;
     return comex_accs(datatype, scale,
@@ -2626,8 +3093,10 @@ int comex_nbaccs(
     int bufsize;
     int new_strides[7], new_count[7];
     reg_entry_t *reg_win;
+#ifndef USE_MPI_FLUSH_LOCAL
     MPI_Request request;
     MPI_Status status;
+#endif
     if (hdl == NULL) {
       return comex_accs(datatype, scale,
           src, src_stride, dst, dst_stride,
@@ -2742,19 +3211,22 @@ int comex_nbaccs(
     translate_mpi_error(ierr,"comex_nbaccs:MPI_Accumulate");
     req->remote_proc = lproc;
     req->win = reg_win->win;
+#ifdef USE_MPI_DEFERRED_FLUSH
+    nb_defer(req);
+#endif
 #else
     ierr = MPI_Raccumulate(packbuf,1,src_type,lproc,displ,1,dst_type,
         MPI_SUM,reg_win->win,&request);
     translate_mpi_error(ierr,"comex_nbaccs:MPI_Rget");
-#endif
     req->request = request;
+#endif
     req->use_type = 1;
     req->src_type = src_type;
     req->dst_type = dst_type;
     req->remote_proc = lproc;
     req->win = reg_win->win;
     req->active = 1;
-    free(packbuf);
+    req->buf = packbuf;
 
     return COMEX_SUCCESS;
 #else
@@ -2771,6 +3243,10 @@ int comex_nbputv(
         int proc, comex_group_t group,
         comex_request_t* handle)
 {
+    if (shm_vector(SHM_PUT, 0, NULL, iov, iov_len, proc)) {
+      if (handle != NULL) *handle = SHM_HDL_DONE;
+      return COMEX_SUCCESS;
+    }
 #ifndef USE_MPI_DATATYPES
     return comex_putv(iov, iov_len, proc, group);
 #else
@@ -2783,8 +3259,10 @@ int comex_nbputv(
     void *ptr, *src_ptr, *dst_ptr;
     int lproc, ierr;
     reg_entry_t *reg_win;
+#ifndef USE_MPI_FLUSH_LOCAL
     MPI_Request request;
     MPI_Status status;
+#endif
     nb_t *req;
     src_ptr = iov[0].src[0];
     dst_ptr = iov[0].dst[0];
@@ -2812,12 +3290,15 @@ int comex_nbputv(
     translate_mpi_error(ierr,"comex_nbputv:MPI_Put");
     req->remote_proc = lproc;
     req->win = reg_win->win;
+#ifdef USE_MPI_DEFERRED_FLUSH
+    nb_defer(req);
+#endif
 #else
     ierr = MPI_Rput(src_ptr, 1, src_type, lproc, displ, 1, dst_type,
         reg_win->win, &request);
     translate_mpi_error(ierr,"comex_nbputv:MPI_Rput");
-#endif
     req->request = request;
+#endif
     req->use_type = 1;
     req->src_type = src_type;
     req->dst_type = dst_type;
@@ -2837,6 +3318,10 @@ int comex_nbgetv(
         int proc, comex_group_t group,
         comex_request_t* handle)
 {
+    if (shm_vector(SHM_GET, 0, NULL, iov, iov_len, proc)) {
+      if (handle != NULL) *handle = SHM_HDL_DONE;
+      return COMEX_SUCCESS;
+    }
 #ifndef USE_MPI_DATATYPES
     return comex_getv(iov, iov_len, proc, group);
 #else
@@ -2849,8 +3334,10 @@ int comex_nbgetv(
     void *ptr, *src_ptr, *dst_ptr;
     int lproc, ierr;
     reg_entry_t *reg_win;
+#ifndef USE_MPI_FLUSH_LOCAL
     MPI_Request request;
     MPI_Status status;
+#endif
     nb_t *req;
     src_ptr = iov[0].src[0];
     dst_ptr = iov[0].dst[0];
@@ -2878,12 +3365,15 @@ int comex_nbgetv(
     translate_mpi_error(ierr,"comex_nbgetv:MPI_Get");
     req->remote_proc = lproc;
     req->win = reg_win->win;
+#ifdef USE_MPI_DEFERRED_FLUSH
+    nb_defer(req);
+#endif
 #else
     ierr = MPI_Rget(dst_ptr, 1, dst_type, lproc, displ, 1, src_type,
         reg_win->win, &request);
     translate_mpi_error(ierr,"comex_nbgetv:MPI_Rget");
-#endif
     req->request = request;
+#endif
     req->use_type = 1;
     req->src_type = src_type;
     req->dst_type = dst_type;
@@ -2904,6 +3394,10 @@ int comex_nbaccv(
         int proc, comex_group_t group,
         comex_request_t* handle)
 {
+    if (shm_vector(SHM_ACC, datatype, scale, iov, iov_len, proc)) {
+      if (handle != NULL) *handle = SHM_HDL_DONE;
+      return COMEX_SUCCESS;
+    }
 #ifndef USE_MPI_DATATYPES
     return comex_accv(datatype, scale, iov, iov_len, proc, group);
 #else
@@ -2915,8 +3409,10 @@ int comex_nbaccv(
     MPI_Aint displ;
     MPI_Datatype base_type;
     void *ptr, *src_ptr, *dst_ptr;
+#ifndef USE_MPI_FLUSH_LOCAL
     MPI_Request request;
     MPI_Status status;
+#endif
     nb_t *req;
     int lproc, size, ierr;
     if (datatype == COMEX_ACC_INT) {
@@ -2964,19 +3460,22 @@ int comex_nbaccv(
     translate_mpi_error(ierr,"comex_nbaccv:MPI_Accumulate");
     req->remote_proc = lproc;
     req->win = reg_win->win;
+#ifdef USE_MPI_DEFERRED_FLUSH
+    nb_defer(req);
+#endif
 #else
     ierr = MPI_Raccumulate(src_ptr,1,src_type,lproc,displ,1,dst_type,
         MPI_SUM,reg_win->win,&request);
     translate_mpi_error(ierr,"comex_nbaccv:MPI_Raccumulate");
-#endif
     req->request = request;
+#endif
     req->use_type = 1;
     req->src_type = src_type;
     req->dst_type = dst_type;
     req->remote_proc = lproc;
     req->win = reg_win->win;
     req->active = 1;
-    free(src_ptr);
+    req->buf = src_ptr;
     return COMEX_SUCCESS;
 #else
     return comex_accv(datatype, scale, iov, iov_len, proc, group);
@@ -2996,6 +3495,30 @@ int comex_rmw(
     reg_win = reg_win_find(proc, prem, 0);
     ptr = reg_win->buf;
     if (ptr == NULL) return COMEX_FAILURE;
+    if (use_shm && reg_win->shm && reg_win->shm_acc) {
+      /* same lock as load/store accumulates into this region */
+      char *rem = shm_addr(reg_win, prem);
+      shm_lock(reg_win);
+      if (op == COMEX_FETCH_AND_ADD) {
+        *(int*)ploc = *(int*)rem;
+        *(int*)rem += extra;
+      } else if (op == COMEX_FETCH_AND_ADD_LONG) {
+        *(long*)ploc = *(long*)rem;
+        *(long*)rem += extra;
+      } else if (op == COMEX_SWAP) {
+        int tmp = *(int*)rem;
+        *(int*)rem = *(int*)ploc;
+        *(int*)ploc = tmp;
+      } else if (op == COMEX_SWAP_LONG) {
+        long tmp = *(long*)rem;
+        *(long*)rem = *(long*)ploc;
+        *(long*)ploc = tmp;
+      } else {
+        assert(0);
+      }
+      shm_unlock(reg_win);
+      return COMEX_SUCCESS;
+    }
     displ = (MPI_Aint)(prem) - (MPI_Aint)(ptr);
     if (!(get_local_rank_from_win(reg_win->win, proc, &lproc)
           == COMEX_SUCCESS)) {
@@ -3287,6 +3810,9 @@ int comex_malloc(void *ptrs[], size_t size, comex_group_t group)
     int comm_size = -1;
     int tsize;
     reg_entry_t src;
+    MPI_Win shm_win = MPI_WIN_NULL;
+    int *node_ranks = NULL;
+    int node_size = 0;
 
     igroup = comex_get_igroup_from_group(group);
 
@@ -3320,12 +3846,35 @@ int comex_malloc(void *ptrs[], size_t size, comex_group_t group)
     } else {
       tsize = 8;
     }
+    if (use_shm) {
+      /* allocate from shared memory so that ranks on this node can reach the
+       * segment with loads and stores. The lock word for accumulates goes in
+       * front of it, and the segment is padded to keep the next one aligned */
+      MPI_Info info;
+      char *base;
+      if (igroup->node_comm == MPI_COMM_NULL) {
+        ierr = MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, comm_rank,
+            MPI_INFO_NULL, &igroup->node_comm);
+        translate_mpi_error(ierr,"comex_malloc:MPI_Comm_split_type");
+      }
+      MPI_Info_create(&info);
+      MPI_Info_set(info, "alloc_shared_noncontig", "true");
+      ierr = MPI_Win_allocate_shared(
+          SHM_PAD+((tsize+SHM_PAD-1)/SHM_PAD)*SHM_PAD, 1, info,
+          igroup->node_comm, &base, &shm_win);
+      translate_mpi_error(ierr,"comex_malloc:MPI_Win_allocate_shared");
+      MPI_Info_free(&info);
+      MPI_Win_lock_all(MPI_MODE_NOCHECK,shm_win);
+      *(int*)base = 0;
+      reg_entries[comm_rank].buf = base + SHM_PAD;
+    } else {
 #ifdef USE_MPI_WIN_ALLOC
     MPI_Win_allocate(sizeof(char)*tsize,1,MPI_INFO_NULL,comm,&reg_entries[comm_rank].buf,
         &reg_entries[comm_rank].win);
 #else
     MPI_Alloc_mem(tsize,MPI_INFO_NULL,&reg_entries[comm_rank].buf);
 #endif
+    }
     MPI_Win_create(reg_entries[comm_rank].buf,tsize,1,MPI_INFO_NULL,comm,
         &reg_entries[comm_rank].win);
 
@@ -3341,6 +3890,22 @@ int comex_malloc(void *ptrs[], size_t size, comex_group_t group)
     MPI_Allgather(&src, sizeof(reg_entry_t), MPI_BYTE, reg_entries,
             sizeof(reg_entry_t), MPI_BYTE, comm);
 
+    /* find which ranks of the group share this node */
+    if (shm_win != MPI_WIN_NULL) {
+      MPI_Group comm_group, node_group;
+      int *ranks = (int*)malloc(sizeof(int)*comm_size);
+      node_ranks = (int*)malloc(sizeof(int)*comm_size);
+      for (i=0; i<comm_size; ++i) ranks[i] = i;
+      MPI_Comm_group(comm, &comm_group);
+      MPI_Comm_group(igroup->node_comm, &node_group);
+      MPI_Group_translate_ranks(comm_group, comm_size, ranks,
+          node_group, node_ranks);
+      MPI_Group_free(&node_group);
+      MPI_Group_free(&comm_group);
+      MPI_Comm_size(igroup->node_comm, &node_size);
+      free(ranks);
+    }
+
     /* assign the ptr array to return to caller */
     for (i=0; i<comm_size; ++i) {
       ptrs[i] = reg_entries[i].buf;
@@ -3351,14 +3916,28 @@ int comex_malloc(void *ptrs[], size_t size, comex_group_t group)
         reg_entries[i].win = reg_entries[comm_rank].win;
       }
       /* probably want to use commicator rank instead of world rank*/
-      reg_win_insert(world_rank,  reg_entries[i].buf, reg_entries[i].len,
-          reg_entries[i].win, igroup);
+      reg_entry_t *entry = reg_win_insert(world_rank,  reg_entries[i].buf,
+          reg_entries[i].len, reg_entries[i].win, igroup);
+      if (node_ranks != NULL && node_ranks[i] != MPI_UNDEFINED) {
+        MPI_Aint qsize;
+        int qdisp;
+        char *base;
+        MPI_Win_shared_query(shm_win, node_ranks[i], &qsize, &qdisp, &base);
+        entry->shm = base + SHM_PAD;
+        entry->shm_lock = (int*)base;
+        entry->shm_acc = (node_size == comm_size);
+        entry->shm_win = shm_win;
+      }
     }
-    comex_igroup_add_win(group,reg_entries[comm_rank].win);
+    comex_igroup_add_win(group,reg_entries[comm_rank].win,shm_win);
+    free(node_ranks);
 
     comex_wait_all(group);
     /* MPI_Win_fence(0,reg_entries[comm_rank].win); */
     MPI_Barrier(comm);
+    if (shm_win != MPI_WIN_NULL) {
+      MPI_Win_sync(shm_win);
+    }
 
     return COMEX_SUCCESS;
 #endif
@@ -3456,7 +4035,7 @@ int comex_malloc_mem_dev(void *ptrs[], size_t size, comex_group_t group,
       reg_win_insert(world_rank,  reg_entries[i].buf, reg_entries[i].len,
           reg_entries[i].win, igroup);
     }
-    comex_igroup_add_win(group,reg_entries[comm_rank].win);
+    comex_igroup_add_win(group,reg_entries[comm_rank].win,MPI_WIN_NULL);
 
     comex_wait_all(group);
     /* MPI_Win_fence(0,reg_entries[comm_rank].win); */
@@ -3480,6 +4059,7 @@ int comex_free(void *ptr, comex_group_t group)
     void **allgather_ptrs = NULL;
     int i, ierr;
     reg_entry_t *reg_win;
+    MPI_Win shm_win;
 
     /* preconditions */
     assert(ptr != NULL);
@@ -3494,6 +4074,7 @@ int comex_free(void *ptr, comex_group_t group)
     comex_group_translate_world(group,comm_rank,&world_rank);
     reg_win = reg_win_find(world_rank, ptr, 0);
     window = reg_win->win;
+    shm_win = reg_win->shm_win;
 
 #ifndef USE_MPI_WIN_ALLOC
     /* Save pointer to memory */
@@ -3519,6 +4100,9 @@ int comex_free(void *ptr, comex_group_t group)
 
     /* Remove window from group list */
     comex_igroup_delete_win(group, window);
+#ifdef USE_MPI_DEFERRED_FLUSH
+    nb_window_delete(window);
+#endif
 
     /* remove my ptr from reg cache and free ptr */
     /* comex_free_local(ptr); */
@@ -3529,10 +4113,16 @@ int comex_free(void *ptr, comex_group_t group)
     MPI_Win_unlock_all(window);
 #endif
     MPI_Win_free(&window);
+    if (shm_win != MPI_WIN_NULL) {
+      /* memory came from the shared memory window */
+      MPI_Win_unlock_all(shm_win);
+      MPI_Win_free(&shm_win);
+    } else {
 #ifndef USE_MPI_WIN_ALLOC
     /* Clear memory for this window */
     MPI_Free_mem(buf);
 #endif
+    }
 
     /* Is this needed? */
     MPI_Barrier(comm);
@@ -3593,6 +4183,9 @@ int comex_free_dev(void *ptr, comex_group_t group)
 
     /* Remove window from group list */
     comex_igroup_delete_win(group, window);
+#ifdef USE_MPI_DEFERRED_FLUSH
+    nb_window_delete(window);
+#endif
 
     /* remove my ptr from reg cache and free ptr */
     /* comex_free_local(ptr); */
@@ -10,6 +10,7 @@
 #include "groups.h"
 
 #define COMEX_MAX_NB_OUTSTANDING 256
+#define COMEX_NB_FLUSH_THRESHOLD 128
 #define SHM_NAME_SIZE 20
 
 typedef struct {
@@ -70,6 +70,7 @@ void comex_create_group_and_igroup(
     new_group_list_item->id = last_group_list_item->id + 1;
     new_group_list_item->comm = MPI_COMM_NULL;
     new_group_list_item->group = MPI_GROUP_NULL;
+    new_group_list_item->node_comm = MPI_COMM_NULL;
     new_group_list_item->next = NULL;
     new_group_list_item->win_list = NULL;
     last_group_list_item->next = new_group_list_item;
@@ -165,11 +166,21 @@ void comex_igroup_finalize(comex_igroup_t *igroup)
         }
     }
 
+    if (igroup->node_comm != MPI_COMM_NULL) {
+        status = MPI_Comm_free(&igroup->node_comm);
+        if (status != MPI_SUCCESS) {
+            comex_error("MPI_Comm_free: Failed ", status);
+        }
+    }
+
     /* Remove all windows associated with this group */
     curr_win = igroup->win_list;
     while (curr_win != NULL) {
       next_win = curr_win->next;
       MPI_Win_free(&curr_win->win);
+      if (curr_win->shm_win != MPI_WIN_NULL) {
+        MPI_Win_free(&curr_win->shm_win);
+      }
       free(curr_win);
       curr_win = next_win;
     }
@@ -286,6 +297,7 @@ void comex_group_init()
     group_list = malloc(sizeof(comex_igroup_t));
     group_list->id = COMEX_GROUP_WORLD;
     group_list->next = NULL;
+    group_list->node_comm = MPI_COMM_NULL;
     group_list->win_list = NULL;
 #ifdef USE_MPI_ERRORS_RETURN
     MPI_Comm_set_errhandler(MPI_COMM_WORLD,MPI_ERRORS_RETURN);
@@ -314,14 +326,18 @@ void comex_group_finalize()
 
     /* ok, now free the world group, but not the world comm */
     MPI_Group_free(&(group_list->group));
+    if (group_list->node_comm != MPI_COMM_NULL) {
+        MPI_Comm_free(&(group_list->node_comm));
+    }
     free(group_list);
     group_list = NULL;
 }
 
 /**
- *  Add an MPI window to the window list in the group
+ *  Add an MPI window to the window list in the group. shm_win is the shared
+ *  memory window the memory of win was allocated from, if any.
  */
-void comex_igroup_add_win(comex_group_t id, MPI_Win win)
+void comex_igroup_add_win(comex_group_t id, MPI_Win win, MPI_Win shm_win)
 {
     comex_igroup_t *current_group_list_item = group_list;
     win_link_t *curr_win = NULL;
@@ -345,12 +361,14 @@ void comex_igroup_add_win(comex_group_t id, MPI_Win win)
       new_win->next = NULL;
       new_win->prev = NULL;
       new_win->win = win;
+      new_win->shm_win = shm_win;
       current_group_list_item->win_list = new_win;
     } else {
       curr_win->next = new_win;
       new_win->next = NULL;
       new_win->prev = curr_win;
       new_win->win = win;
+      new_win->shm_win = shm_win;
     }
 }
 
@@ -16,6 +16,7 @@ typedef struct win_link {
   struct win_link *next;
   struct win_link *prev;
   MPI_Win win;
+  MPI_Win shm_win;    /**< shared memory window under win, or MPI_WIN_NULL */
 } win_link_t;
 
 typedef struct group_link {
@@ -23,13 +24,16 @@ typedef struct group_link {
     comex_group_t id;
     MPI_Comm comm;
     MPI_Group group;
+    MPI_Comm node_comm;     /**< ranks of comm sharing memory with this one,
+                              created on first use by comex_malloc */
     win_link_t *win_list;
 } comex_igroup_t;
 
 extern void comex_group_init();
 extern void comex_group_finalize();
 extern comex_igroup_t* comex_get_igroup_from_group(comex_group_t group);
-extern void comex_igroup_add_win(comex_group_t group, MPI_Win win);
+extern void comex_igroup_add_win(comex_group_t group, MPI_Win win,
+        MPI_Win shm_win);
 extern void comex_igroup_delete_win(comex_group_t group, MPI_Win win);
 
 #endif /* _COMEX_GROUPS_H_ */
@@ -548,6 +548,10 @@ reg_win_insert(int rank, void *buf, int len, MPI_Win win, comex_igroup_t *group)
     node->len = len;
     node->win = win;
     node->igroup = group;
+    node->shm = NULL;
+    node->shm_lock = NULL;
+    node->shm_acc = 0;
+    node->shm_win = MPI_WIN_NULL;
     node->next = NULL;
 
     /* push new entry to tail of linked list */
@@ -21,6 +21,12 @@ typedef struct _reg_entry_t {
     int rank;                   /**< rank where this region lives */
     void *buf;                  /**< starting address of region */
     size_t len;                 /**< length of region */
+    void *shm;                  /**< region mapped into this process if it
+                                  lives on this node, otherwise NULL */
+    int *shm_lock;              /**< accumulate lock word of the region */
+    int shm_acc;                /**< whole window is on this node, so acc and
+                                  rmw may bypass MPI as well */
+    MPI_Win shm_win;            /**< shared memory window holding region */
     struct _reg_entry_t *next;  /**< next memory region in list */
 } reg_entry_t;
 
@@ -11,13 +11,15 @@
 #include "comex.h"
 #include "comex_impl.h"
 #include "reg_cache.h"
+#include "reg_index.h"
 
 // Registration cache : Defensive Programming
 
 // nprocs: number of processes
 // size: number of entries
 
-struct _reg_entry_t **reg_cache;
+// one sorted segment index per process
+reg_index_t *reg_cache;
 
 // cache size for each process
 //
@@ -28,15 +30,13 @@ int reg_cache_init(int nprocs, int size)
 {
 
     // Allocate the registration cache:
-    reg_cache = (struct _reg_entry_t **)malloc(sizeof(struct _reg_entry_t *) * nprocs); 
+    reg_cache = (reg_index_t *)malloc(sizeof(reg_index_t) * nprocs); 
     assert(reg_cache); 
 
     int i;
 
     for (i = 0; i < nprocs; ++i) {
-        reg_cache[i] = (struct _reg_entry_t *)malloc(sizeof(struct _reg_entry_t));
-        assert(reg_cache[i]);
-        reg_cache[i]->next = NULL;
+        reg_index_init(&reg_cache[i]);
     }
     return 0;
 }
@@ -44,15 +44,18 @@ int reg_cache_init(int nprocs, int size)
 
 int reg_cache_destroy(int nprocs)
 {
-    int i;
+    int i, j;
+
+    assert(reg_cache);
 
     // TODO: Deregister all entries
     for (i = 0; i < nprocs; ++i) {
-        if (reg_cache[i])
-            free(reg_cache[i]);
+        for (j = 0; j < reg_cache[i].size; ++j) {
+            free(reg_cache[i].items[j].entry);
+        }
+        reg_index_destroy(&reg_cache[i]);
     }
 
-    assert(reg_cache);
     free(reg_cache);
 
     return 0;
@@ -60,23 +63,12 @@ int reg_cache_destroy(int nprocs)
 
 struct _reg_entry_t* reg_cache_find(int rank, void *buf, size_t len)
 {
-    struct _reg_entry_t *runner = reg_cache[rank]->next;
-
-    while (runner) {
-        if (runner->buf <= buf && runner->len >= len &&
-                ((runner->buf + runner->len) >= (buf + len))) {
-            return(runner);
-        }
-
-        runner = runner->next;
-    }
-
-    return NULL;
+    return (struct _reg_entry_t *)reg_index_find(&reg_cache[rank], buf, len);
 }
 
 int reg_cache_insert(int rank, void *buf, size_t len, int lkey, int rkey, struct ibv_mr *mr)
 {
-    struct _reg_entry_t *node, *runner = (struct _reg_entry_t *)(reg_cache[rank]);
+    struct _reg_entry_t *node;
 
     node = (struct _reg_entry_t *)malloc(sizeof(struct _reg_entry_t));
     assert(node);
@@ -85,7 +77,6 @@ int reg_cache_insert(int rank, void *buf, size_t len, int lkey, int rkey, struct
     node->len = len;
     node->lkey = lkey;
     node->rkey = rkey;
-    node->next = NULL;
 
     if (mr) {
         node->mr = mr;
@@ -95,30 +86,17 @@ int reg_cache_insert(int rank, void *buf, size_t len, int lkey, int rkey, struct
     
     
     assert(NULL == reg_cache_find(rank, buf, 0));
-    while (runner->next) {
-        runner = runner->next;
-    }
-
-    runner->next = node;
+    reg_index_insert(&reg_cache[rank], buf, len, node);
     return 0;
 }
 
 void reg_cache_delete(int rank, void *buf)
 {
-    struct _reg_entry_t *found, *runner =
-        (struct _reg_entry_t *)reg_cache[rank];
-
-    while (runner->next) {
-        if (runner->next->buf == buf) {
-            found = runner->next;
-            runner->next = runner->next->next;
-            free(found);
-            return;
-        }
-        runner = runner->next;
-    }
-    assert(0);
+    struct _reg_entry_t *found =
+        (struct _reg_entry_t *)reg_index_remove(&reg_cache[rank], buf);
 
+    assert(found);
+    free(found);
 }
 
 #if 0
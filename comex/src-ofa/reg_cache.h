@@ -9,7 +9,6 @@ struct _reg_entry_t {
     int lkey;
     int rkey;
     struct ibv_mr *mr;
-    struct _reg_entry_t *next;
 };
 
 struct _reg_entry_t *reg_cache_find(int, void *, size_t);
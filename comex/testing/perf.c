@@ -21,8 +21,12 @@ static int nproc;
 #define ITER_LARGE 100
 
 #define WARMUP 10
+#define RATE_MAX_SIZE 1024  /* largest message of the message rate test */
+#define RATE_BATCH 128      /* nonblocking operations issued per wait */
+#define RATE_ITER 100
 static void fill_array(double *arr, int count, int which);
 static void contig_test(size_t buffer_size, int op);
+static void rate_test(int op);
 
 double dclock()
 {
@@ -59,7 +63,23 @@ int main(int argc, char **argv)
         printf("#PNNL comex Accumulate Test\n");
     }
     contig_test(MAX_MESSAGE_SIZE, ACC);
-    
+
+    if (0 == me) {
+        printf("\nmsg size (bytes)     msg rate (msgs/sec)\n");
+        printf("#PNNL comex Nonblocking Put Message Rate Test\n");
+    }
+    rate_test(PUT);
+
+    if (0 == me) {
+        printf("#PNNL comex Nonblocking Get Message Rate Test\n");
+    }
+    rate_test(GET);
+
+    if (0 == me) {
+        printf("#PNNL comex Nonblocking Accumulate Message Rate Test\n");
+    }
+    rate_test(ACC);
+
     comex_finalize();
     MPI_Finalize();
 
@@ -152,3 +172,69 @@ static void contig_test(size_t buffer_size, int op)
     free(get_buf);
     free(times);
 }
+
+
+/* Issue batches of RATE_BATCH small nonblocking operations to one target
+ * and wait for all of them, the access pattern of many small GA nbget calls */
+static void rate_test(int op)
+{
+    void **dst_ptr;
+    void **loc_buf;
+    comex_request_t *hdl;
+    size_t msg_size;
+    int dst = 1;
+    double scale = 1.0;
+
+    dst_ptr = (void*)malloc(nproc * sizeof(void*));
+    loc_buf = (void*)malloc(nproc * sizeof(void*));
+    hdl = (comex_request_t*)malloc(RATE_BATCH * sizeof(comex_request_t));
+    comex_malloc(dst_ptr, RATE_MAX_SIZE*RATE_BATCH, COMEX_GROUP_WORLD);
+    comex_malloc(loc_buf, RATE_MAX_SIZE*RATE_BATCH, COMEX_GROUP_WORLD);
+    fill_array((double*)loc_buf[me], RATE_MAX_SIZE*RATE_BATCH/sizeof(double),
+            me);
+
+    for (msg_size = 8; msg_size <= RATE_MAX_SIZE; msg_size *= 2) {
+        int i, j;
+        double t_start, t_end;
+
+        if (0 == me) {
+            for (i = 0; i < RATE_ITER + WARMUP; ++i) {
+                if (WARMUP == i) {
+                    t_start = dclock();
+                }
+                for (j = 0; j < RATE_BATCH; ++j) {
+                    char *rem = (char*)dst_ptr[dst] + j*msg_size;
+                    char *loc = (char*)loc_buf[me] + j*msg_size;
+                    switch (op) {
+                        case PUT:
+                            comex_nbput(loc, rem, msg_size,
+                                    dst, COMEX_GROUP_WORLD, &hdl[j]);
+                            break;
+                        case GET:
+                            comex_nbget(rem, loc, msg_size,
+                                    dst, COMEX_GROUP_WORLD, &hdl[j]);
+                            break;
+                        case ACC:
+                            comex_nbacc(COMEX_ACC_DBL, &scale, loc, rem,
+                                    msg_size, dst, COMEX_GROUP_WORLD, &hdl[j]);
+                            break;
+                        default:
+                            comex_error("oops", 1);
+                    }
+                }
+                for (j = 0; j < RATE_BATCH; ++j) {
+                    comex_wait(&hdl[j]);
+                }
+            }
+            t_end = dclock();
+            printf("%zu\t\t%f\n", msg_size,
+                    1.0e6*RATE_ITER*RATE_BATCH/(t_end - t_start));
+        }
+        comex_barrier(COMEX_GROUP_WORLD);
+    }
+    comex_free(dst_ptr[me], COMEX_GROUP_WORLD);
+    comex_free(loc_buf[me], COMEX_GROUP_WORLD);
+    free(dst_ptr);
+    free(loc_buf);
+    free(hdl);
+}
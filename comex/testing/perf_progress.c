@@ -0,0 +1,165 @@
+/* Test progress engine throughput
+ * Every process keeps a window of nonblocking puts, gets and accumulates
+ * in flight to a different process, so all requests on a node funnel
+ * through the node's progress handlers.  Run it with different values of
+ * COMEX_PROGRESS_THREADS (MPI-PR) to see how handler throughput scales. */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <mpi.h>
+
+#include "comex.h"
+
+#define PUT 0
+#define GET 1
+#define ACC 2
+
+#define MAX_MESSAGE_SIZE 65536
+#define WINDOW 32
+#define ITERATIONS 500
+#define WARMUP 20
+
+static int me;
+static int nproc;
+static double *dst_ptr[WINDOW];
+static void **ptrs[WINDOW];
+
+static void throughput_test(int bytes, int op);
+
+double dclock()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return(tv.tv_sec * 1.0e6 + (double)tv.tv_usec);
+}
+
+int main(int argc, char **argv)
+{
+    int provided;
+    int i;
+    char *threads;
+
+    /* concurrent handlers need MPI_THREAD_MULTIPLE */
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+    comex_init_args(&argc, &argv);
+    comex_group_rank(COMEX_GROUP_WORLD, &me);
+    comex_group_size(COMEX_GROUP_WORLD, &nproc);
+
+    for (i = 0; i < WINDOW; i++) {
+        ptrs[i] = (void**)malloc(sizeof(void*) * nproc);
+        comex_malloc(ptrs[i], MAX_MESSAGE_SIZE, COMEX_GROUP_WORLD);
+        dst_ptr[i] = (double*)malloc(MAX_MESSAGE_SIZE);
+        memset(dst_ptr[i], 0, MAX_MESSAGE_SIZE);
+        memset(ptrs[i][me], 0, MAX_MESSAGE_SIZE);
+    }
+    comex_barrier(COMEX_GROUP_WORLD);
+
+    threads = getenv("COMEX_PROGRESS_THREADS");
+    if (0 == me) {
+        printf("#PNNL comex progress throughput test, %d processes\n", nproc);
+        printf("#COMEX_PROGRESS_THREADS=%s MPI_THREAD_MULTIPLE=%d\n",
+                threads ? threads : "default",
+                MPI_THREAD_MULTIPLE == provided);
+        printf("\n\n");
+    }
+
+    if (0 == me) {
+        printf("#Put\n");
+        printf("#Bytes\t\tops/sec\t\tMB/sec\n");
+    }
+    for (i = 8; i <= MAX_MESSAGE_SIZE; i *= 8) {
+        throughput_test(i, PUT);
+    }
+    if (0 == me) {
+        printf("\n\n");
+        printf("#Get\n");
+        printf("#Bytes\t\tops/sec\t\tMB/sec\n");
+    }
+    for (i = 8; i <= MAX_MESSAGE_SIZE; i *= 8) {
+        throughput_test(i, GET);
+    }
+    if (0 == me) {
+        printf("\n\n");
+        printf("#Acc\n");
+        printf("#Bytes\t\tops/sec\t\tMB/sec\n");
+    }
+    for (i = 8; i <= MAX_MESSAGE_SIZE; i *= 8) {
+        throughput_test(i, ACC);
+    }
+
+    comex_barrier(COMEX_GROUP_WORLD);
+    for (i = 0; i < WINDOW; i++) {
+        comex_free(ptrs[i][me], COMEX_GROUP_WORLD);
+        free(ptrs[i]);
+        free(dst_ptr[i]);
+    }
+
+    comex_finalize();
+    MPI_Finalize();
+
+    return 0;
+}
+
+
+static void throughput_test(int bytes, int op)
+{
+    comex_request_t handles[WINDOW];
+    double scale = 1.0;
+    double t_start = 0.0;
+    double t_end = 0.0;
+    double elapsed = 0.0;
+    double total_ops = 0.0;
+    MPI_Comm comm;
+    int target = (me + 1) % nproc;
+    int iter = 0;
+    int i = 0;
+
+    comex_barrier(COMEX_GROUP_WORLD);
+
+    for (iter = 0; iter < ITERATIONS + WARMUP; iter++) {
+        if (WARMUP == iter) {
+            comex_barrier(COMEX_GROUP_WORLD);
+            t_start = dclock();
+        }
+        /* each slot of the window targets a different segment */
+        for (i = 0; i < WINDOW; i++) {
+            switch (op) {
+                case PUT:
+                    comex_nbput(dst_ptr[i], ptrs[i][target], bytes,
+                            target, COMEX_GROUP_WORLD, &handles[i]);
+                    break;
+                case GET:
+                    comex_nbget(ptrs[i][target], dst_ptr[i], bytes,
+                            target, COMEX_GROUP_WORLD, &handles[i]);
+                    break;
+                case ACC:
+                    comex_nbacc(COMEX_ACC_DBL, &scale,
+                            dst_ptr[i], ptrs[i][target], bytes,
+                            target, COMEX_GROUP_WORLD, &handles[i]);
+                    break;
+                default:
+                    assert(0);
+            }
+        }
+        for (i = 0; i < WINDOW; i++) {
+            comex_wait(&handles[i]);
+        }
+    }
+    t_end = dclock();
+    comex_barrier(COMEX_GROUP_WORLD);
+
+    /* aggregate throughput is bounded by the slowest process */
+    elapsed = t_end - t_start;
+    comex_group_comm(COMEX_GROUP_WORLD, &comm);
+    MPI_Reduce(&elapsed, &t_end, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+    total_ops = (double)ITERATIONS * WINDOW * nproc;
+    if (0 == me) {
+        printf("%d\t\t%.3e\t%.2f\n", bytes,
+                total_ops / (t_end * 1.0e-6),
+                total_ops * bytes / t_end);
+    }
+}
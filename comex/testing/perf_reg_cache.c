@@ -0,0 +1,116 @@
+/* Test registration cache lookup cost
+ * Every process keeps allocating segments and, after each batch, times
+ * small gets and puts to randomly chosen live segments of a different
+ * process.  Every operation looks up its segment in the registration cache,
+ * so the latency reported against the number of live segments shows how
+ * the lookup cost grows. */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <mpi.h>
+
+#include "comex.h"
+
+#define MAX_SEGMENTS 1024
+#define SEGMENT_SIZE 64
+#define ITERATIONS 2000
+#define WARMUP 100
+
+static int me;
+static int nproc;
+static void **ptrs[MAX_SEGMENTS];
+
+static void lookup_test(int nsegs);
+
+double dclock()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return(tv.tv_sec * 1.0e6 + (double)tv.tv_usec);
+}
+
+int main(int argc, char **argv)
+{
+    int nsegs = 0;
+    int i;
+
+    comex_init_args(&argc, &argv);
+    comex_group_rank(COMEX_GROUP_WORLD, &me);
+    comex_group_size(COMEX_GROUP_WORLD, &nproc);
+
+    if (0 == me) {
+        printf("#PNNL comex registration cache test, %d processes\n", nproc);
+        printf("#Segments\tget (us)\tput (us)\n");
+    }
+
+    for (i = 1; i <= MAX_SEGMENTS; i *= 2) {
+        for (; nsegs < i; nsegs++) {
+            ptrs[nsegs] = (void**)malloc(sizeof(void*) * nproc);
+            comex_malloc(ptrs[nsegs], SEGMENT_SIZE, COMEX_GROUP_WORLD);
+            memset(ptrs[nsegs][me], 0, SEGMENT_SIZE);
+        }
+        lookup_test(nsegs);
+    }
+
+    comex_barrier(COMEX_GROUP_WORLD);
+    for (i = 0; i < nsegs; i++) {
+        comex_free(ptrs[i][me], COMEX_GROUP_WORLD);
+        free(ptrs[i]);
+    }
+
+    comex_finalize();
+    MPI_Finalize();
+
+    return 0;
+}
+
+
+static void lookup_test(int nsegs)
+{
+    double buf = 0.0;
+    double t_get = 0.0;
+    double t_put = 0.0;
+    double t_max[2];
+    double t_mine[2];
+    MPI_Comm comm;
+    int target = (me + 1) % nproc;
+    int iter = 0;
+    int seg = 0;
+
+    srand(me + 1);
+    comex_barrier(COMEX_GROUP_WORLD);
+
+    for (iter = 0; iter < ITERATIONS + WARMUP; iter++) {
+        double t_start = 0.0;
+        if (WARMUP == iter) {
+            t_get = 0.0;
+            t_put = 0.0;
+        }
+        seg = rand() % nsegs;
+        t_start = dclock();
+        comex_get(ptrs[seg][target], &buf, sizeof(double),
+                target, COMEX_GROUP_WORLD);
+        t_get += dclock() - t_start;
+        seg = rand() % nsegs;
+        t_start = dclock();
+        comex_put(&buf, ptrs[seg][target], sizeof(double),
+                target, COMEX_GROUP_WORLD);
+        comex_fence_proc(target, COMEX_GROUP_WORLD);
+        t_put += dclock() - t_start;
+    }
+    comex_barrier(COMEX_GROUP_WORLD);
+
+    /* report the slowest process */
+    t_mine[0] = t_get / ITERATIONS;
+    t_mine[1] = t_put / ITERATIONS;
+    comex_group_comm(COMEX_GROUP_WORLD, &comm);
+    MPI_Reduce(t_mine, t_max, 2, MPI_DOUBLE, MPI_MAX, 0, comm);
+    if (0 == me) {
+        printf("%d\t\t%.3f\t\t%.3f\n", nsegs, t_max[0], t_max[1]);
+        fflush(stdout);
+    }
+}
@@ -377,6 +377,12 @@ void pnga_initialize()
        GA[i].rank_rstrctd = (C_Integer*)0;
        GA[i].property = NO_PROPERTY;
        GA[i].mem_dev_set = 0;
+       GA[i].rcache = NULL;
+       GA[i].rcache_size = READ_CACHE_SIZE;
+       GA[i].gatscat = NULL;
+       GA[i].gplan = NULL;
+       GA[i].merge = NULL;
+       GA[i].epoch = 0;
 #ifdef ENABLE_CHECKPOINT
        GA[i].record_id = 0;
 #endif
@@ -1510,6 +1516,11 @@ Integer pnga_create_handle()
   GA[ga_handle].actv_handle = 1;
   GA[ga_handle].has_data = 1;
   GA[ga_handle].property = NO_PROPERTY;
+  GA[ga_handle].rcache = NULL;
+  GA[ga_handle].rcache_size = READ_CACHE_SIZE;
+  GA[ga_handle].gatscat = NULL;
+  GA[ga_handle].gplan = NULL;
+  GA[ga_handle].merge = NULL;
   return g_a;
 }
 
@@ -2022,6 +2033,9 @@ void pnga_set_restricted_range(Integer g_a, Integer lo_proc, Integer hi_proc)
 #endif
 void pnga_set_property(Integer g_a, char* property) {
   Integer ga_handle = g_a + GA_OFFSET;
+  gai_ghost_plan_free(ga_handle);
+  gai_merge_free(ga_handle);
+  GA[ga_handle].epoch++;
   _ga_sync_begin = 1; _ga_sync_end=1; /*remove any previous sync masking*/
   pnga_pgroup_sync(GA[ga_handle].p_handle);
   /* Check to see if property conflicts with properties already set on the
@@ -2241,7 +2255,7 @@ void pnga_set_property(Integer g_a, char* property) {
     pnga_destroy(g_tmp);
   } else if (strcmp(property, "read_cache") == 0) {
     GA[ga_handle].property = READ_CACHE;
-    GA[ga_handle].cache_head = NULL; /* (cache_struct_t *)malloc(sizeof(cache_struct_t)) */
+    GA[ga_handle].rcache = NULL;
   } else {
     pnga_error("Trying to set unknown property",0);
   }
@@ -2286,6 +2300,9 @@ void pnga_set_memory_dev(Integer g_a, char *device) {
 #endif
 void pnga_unset_property(Integer g_a) {
   Integer ga_handle = g_a + GA_OFFSET;
+  gai_ghost_plan_free(ga_handle);
+  gai_merge_free(ga_handle);
+  GA[ga_handle].epoch++;
   if (GA[ga_handle].property == READ_ONLY) {
     /* TODO: Copy global array to original configuration */
     int i, d, ndim, btot, chk;
@@ -2433,21 +2450,8 @@ void pnga_unset_property(Integer g_a) {
     }
     pnga_destroy(g_tmp);
   } else if (GA[ga_handle].property == READ_CACHE) {
-    if (GA[ga_handle].cache_head != NULL) {
-      cache_struct_t *next;
-      next = GA[ga_handle].cache_head->next;
-      if (GA[ga_handle].cache_head->cache_buf)
-        free(GA[ga_handle].cache_head->cache_buf);
-      free(GA[ga_handle].cache_head);
-      while (next) {
-        GA[ga_handle].cache_head = next;
-        next = next->next;
-        if (GA[ga_handle].cache_head->cache_buf)
-          free(GA[ga_handle].cache_head->cache_buf);
-        free(GA[ga_handle].cache_head);
-      }
-    }
-    GA[ga_handle].cache_head = NULL;
+    gai_read_cache_free(ga_handle);
+    GA[ga_handle].property = NO_PROPERTY;
   } else {
     GA[ga_handle].property = NO_PROPERTY;
   }
@@ -3740,6 +3744,10 @@ logical pnga_duplicate(Integer g_a, Integer *g_b, char* array_name)
 
   /*** if ghost cells are used, initialize ghost cache data ***/
   GA[ga_handle].cache = NULL;
+  GA[ga_handle].rcache = NULL;
+  GA[ga_handle].gatscat = NULL;
+  GA[ga_handle].gplan = NULL;
+  GA[ga_handle].merge = NULL;
   pnga_set_ghost_info(*g_b);
 
   /*** initialize and copy info for restricted arrays, if relevant ***/
@@ -3872,6 +3880,10 @@ int maplen = calc_maplen(GA_OFFSET + g_a);
       GA[ga_handle] = GA[GA_OFFSET + g_a];
       strcpy(GA[ga_handle].name, array_name);
       GA[ga_handle].ptr = save_ptr;
+      GA[ga_handle].rcache = NULL;
+      GA[ga_handle].gatscat = NULL;
+      GA[ga_handle].gplan = NULL;
+      GA[ga_handle].merge = NULL;
       if (maplen > 0) {
         GA[ga_handle].mapc = (C_Integer*)malloc((maplen+1)*sizeof(C_Integer*));
         for(i=0;i<maplen; i++)GA[ga_handle].mapc[i] = GA[GA_OFFSET+ g_a].mapc[i];
@@ -3943,23 +3955,11 @@ int local_sync_begin,local_sync_end;
        GA[ga_handle].mapc = NULL;
     } 
 
-    if (GA[ga_handle].property == READ_CACHE) {
-      if (GA[ga_handle].cache_head != NULL) {
-        cache_struct_t *next;
-        next = GA[ga_handle].cache_head->next;
-        if (GA[ga_handle].cache_head->cache_buf)
-          free(GA[ga_handle].cache_head->cache_buf);
-        free(GA[ga_handle].cache_head);
-        while (next) {
-          GA[ga_handle].cache_head = next;
-          next = next->next;
-          if (GA[ga_handle].cache_head->cache_buf)
-            free(GA[ga_handle].cache_head->cache_buf);
-          free(GA[ga_handle].cache_head);
-        }
-      }
-    }
-    GA[ga_handle].cache_head = NULL;
+    gai_read_cache_free(ga_handle);
+    gai_gatscat_free(ga_handle);
+    gai_ghost_plan_free(ga_handle);
+    gai_merge_free(ga_handle);
+    GA[ga_handle].epoch++;
 
     if (GA[ga_handle].property == READ_ONLY) {
       free(GA[ga_handle].old_mapc);
@@ -4036,23 +4036,11 @@ logical pnga_deallocate(Integer g_a)
   GA[ga_handle].cache = NULL;
   GA[ga_handle].actv = 0;     
 
-  if (GA[ga_handle].property == READ_CACHE) {
-    if (GA[ga_handle].cache_head != NULL) {
-      cache_struct_t *next;
-      next = GA[ga_handle].cache_head->next;
-      if (GA[ga_handle].cache_head->cache_buf)
-        free(GA[ga_handle].cache_head->cache_buf);
-      free(GA[ga_handle].cache_head);
-      while (next) {
-        GA[ga_handle].cache_head = next;
-        next = next->next;
-        if (GA[ga_handle].cache_head->cache_buf)
-          free(GA[ga_handle].cache_head->cache_buf);
-        free(GA[ga_handle].cache_head);
-      }
-    }
-  }
-  GA[ga_handle].cache_head = NULL;
+  gai_read_cache_free(ga_handle);
+  gai_gatscat_free(ga_handle);
+  gai_ghost_plan_free(ga_handle);
+  gai_merge_free(ga_handle);
+  GA[ga_handle].epoch++;
 
   if(GA[ga_handle].ptr[grp_me]==NULL){
     return TRUE;
@@ -5097,7 +5085,9 @@ void pnga_mask_sync(Integer begin, Integer end)
 }
 
 /**
- *  Merge all copies of a mirrored array by adding them together
+ *  Merge all copies of a mirrored array by adding them together. If dirty
+ *  tracking is turned on with ga_set_merge_dirty, only the segments written
+ *  since the last merge are added and all other segments keep their value.
  */
 #if HAVE_SYS_WEAK_ALIAS_PRAGMA
 #   pragma weak wnga_merge_mirrored =  pnga_merge_mirrored
@@ -5105,19 +5095,17 @@ void pnga_mask_sync(Integer begin, Integer end)
 
 void pnga_merge_mirrored(Integer g_a)
 {
+  int local_sync_begin, local_sync_end;
+#ifdef OPENIB
   Integer handle = GA_OFFSET + g_a;
-  Integer inode, nprocs, nnodes, zero, zproc, nblocks;
-  int *blocks;
-  C_Integer  *map, *dims, *width;
-  Integer i, j, index[MAXDIM], itmp, ndim;
+  Integer inode, zproc, nnodes, nprocs, zero;
+  C_Integer  *dims, *width;
+  Integer i, ndim;
   Integer lo[MAXDIM], hi[MAXDIM], ld[MAXDIM];
-  Integer nelem, count, type, atype=ARMCI_INT;
-  char *zptr=NULL, *bptr=NULL, *nptr=NULL;
-  Integer bytes, total;
-  int local_sync_begin, local_sync_end;
-  long bigint;
+  Integer count, type;
   int chk = 1;
   void *ptr_a;
+#endif
 
   local_sync_begin = _ga_sync_begin; local_sync_end = _ga_sync_end;
   _ga_sync_begin = 1; _ga_sync_end = 1; /*remove any previous masking */
@@ -5125,102 +5113,23 @@ void pnga_merge_mirrored(Integer g_a)
   /* don't perform update if node is not mirrored */
   if (!pnga_is_mirrored(g_a)) return;
 
+#ifdef OPENIB
   inode = pnga_cluster_nodeid();
   nnodes = pnga_cluster_nnodes(); 
   nprocs = pnga_cluster_nprocs(inode);
   zero = 0;
 
   zproc = pnga_cluster_procid(inode, zero);
-  zptr = GA[handle].ptr[zproc];
-  map = GA[handle].mapc;
-  blocks = GA[handle].nblock;
   dims = GA[handle].dims;
   width = GA[handle].width;
   type = GA[handle].type;
   ndim = GA[handle].ndim;
-  bigint = 2147483647L/GAsizeof(type);
 
-#ifdef OPENIB
   /* Check whether or not all nodes contain the same number
      of processors. */
   if (nnodes*nprocs == pnga_nnodes())  {
-    /* check to see if there is any buffer space between the data
-       associated with each processor that needs to be zeroed out
-       before performing the merge */
-    if (zproc == GAme) {
-      /* the use of nblocks instead of nprocs is designed to support a peculiar
-         coding style in which the dimensions of the block array are all set to
-         1 and all the data is restricted to the master processor on the node */
-      nblocks = 1;
-      for (i=0; i<ndim; i++) {
-        nblocks *= blocks[i];
-      }
-      for (i=0; i<nblocks; i++) {
-        /* Find out from mapc data how many elements are supposed to be located
-           on this processor. Start by converting processor number to indices */
-        itmp = i;
-        for (j=0; j<ndim; j++) {
-          index[j] = itmp%(Integer)blocks[j];
-          itmp = (itmp - index[j])/(Integer)blocks[j];
-        }
-
-        nelem = 1;
-        count = 0;
-        for (j=0; j<ndim; j++) {
-          if (index[j] < (Integer)blocks[j]-1) {
-            nelem *= (Integer)(map[index[j]+1+count] - map[index[j]+count]
-                   + 2*width[j]);
-          } else {
-            nelem *= (Integer)(dims[j] - map[index[j]+count] + 1 + 2*width[j]);
-          }
-          count += (Integer)blocks[j];
-        }
-        /* We now have the total number of elements located on this processor.
-           Find out if the location of the end of this data set matches the
-           origin of the data on the next processor. If not, then zero data in
-           the gap. */
-        nelem *= GAsizeof(type);
-        bptr = GA[handle].ptr[pnga_cluster_procid(inode, i)];
-        bptr += nelem;
-        if (i<nblocks-1) {
-          j = i+1;
-          nptr = GA[handle].ptr[pnga_cluster_procid(inode, j)];
-          if (bptr != nptr) {
-            bytes = (long)nptr - (long)bptr;
-            /* BJP printf("p[%d] Gap on proc %d is %d\n",GAme,i,bytes); */
-            bzero(bptr, bytes);
-          }
-        }
-      }
-      /* find total number of bytes containing global array */
-      total = (long)bptr - (long)zptr;
-      total /= GAsizeof(type);
-      /*convert from C data type to ARMCI type */
-      switch(type) {
-        case C_FLOAT: atype=ARMCI_FLOAT; break;
-        case C_DBL: atype=ARMCI_DOUBLE; break;
-        case C_LONG: atype=ARMCI_LONG; break;
-        case C_INT: atype=ARMCI_INT; break;
-        case C_DCPL: atype=ARMCI_DOUBLE; break;
-        case C_SCPL: atype=ARMCI_FLOAT; break;
-        default: pnga_error("type not supported",type);
-      }
-      /* now that gap data has been zeroed, do a global sum on data */
-      {
-        int i, len;
-        int nsteps = (int) ceil(((double)total)/((double)bigint));
-        long istart=0;
-        /* printf("%ld total %ld bigint %ld  nsteps %d \n",GAme,total,bigint,nsteps); */
-        for (i=0; i < nsteps; i++){
-
-          len=bigint;
-          if (istart+len > total) len=((long)(total - istart));
-          /* printf("%ld step %d of %d  len= %d total=%ld istart= %ld\n",GAme,(i+1),nsteps,len,total,istart); */
-          armci_msg_gop_scope(SCOPE_MASTERS, zptr+istart*GAsizeof(type), len, "+", atype);
-          istart+=len;
-        }
-      }
-    } 
+    /* every process reduces its own block of the node copy across nodes */
+    gai_merge_mirrored(g_a, _mirror_gop_grp);
   } else {
     Integer _ga_tmp;
     Integer idims[MAXDIM], iwidth[MAXDIM], ichunk[MAXDIM];
@@ -5283,21 +5192,7 @@ void pnga_merge_mirrored(Integer g_a)
     pnga_destroy(_ga_tmp);
   }
 #else
-  inode = GAme - zproc;
-  pnga_distribution(g_a,inode,lo,hi);
-  /* Check to make sure processor has data */
-  chk = 1;
-  nelem = 1;
-  for (i=0; i<ndim; i++) {
-    nelem *= (hi[i]-lo[i]+1);
-    if (hi[i]<lo[i]) {
-      chk = 0;
-    }
-  }
-  if (chk) {
-    pnga_access_ptr(g_a, lo, hi, &ptr_a, ld);
-    pnga_pgroup_gop(_mirror_gop_grp,type,ptr_a,nelem,"+");
-  }
+  gai_merge_mirrored(g_a, _mirror_gop_grp);
 #endif
   if (local_sync_end) pnga_sync();
 }
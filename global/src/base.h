@@ -43,12 +43,72 @@ typedef struct {
 typedef Integer C_Integer;
 typedef armci_size_t C_Long;
 
-typedef struct cache_struct{
-  int lo[MAXDIM];
-  int hi[MAXDIM];
-  void* cache_buf;
-  struct cache_struct *next;
-} cache_struct_t;
+typedef struct gai_rc_entry{
+  Integer lo[MAXDIM];              /* lower bounds of cached patch         */
+  Integer hi[MAXDIM];              /* upper bounds of cached patch         */
+  void* buf;                       /* copy of patch data                   */
+  C_Long bytes;                    /* size of buf in bytes                 */
+  struct gai_rc_entry *prev;       /* LRU list, head is most recently used */
+  struct gai_rc_entry *next;
+} gai_rc_entry_t;
+
+typedef struct gai_read_cache{
+  gai_rc_entry_t **index;          /* cached patches sorted on lo[0]       */
+  int nentry;                      /* number of cached patches             */
+  int maxentry;                    /* allocated length of index            */
+  Integer maxext;                  /* bound on hi[0]-lo[0] of any patch    */
+  gai_rc_entry_t *lru_head;        /* most recently used patch             */
+  gai_rc_entry_t *lru_tail;        /* least recently used patch            */
+  C_Long bytes;                    /* total bytes held by cache            */
+} gai_read_cache_t;
+
+typedef struct gai_gatscat{
+  int busy;                        /* scratch is in use by a call          */
+  Integer nowner;                  /* number of owners scratch is sized for*/
+  Integer *count;                  /* bucket sizes, then bucket ends       */
+  char **base;                     /* base pointer of every owner          */
+  int *owner;                      /* owner of every element of a chunk    */
+  Integer *offset;                 /* element offset in the owner's block  */
+  int *active[2];                  /* owners with elements in each chunk   */
+  int nactive[2];                  /* number of active owners              */
+  void **ptr_loc[2];               /* local pointers, bucketed by owner    */
+  void **ptr_rem[2];               /* remote pointers, bucketed by owner   */
+  armci_hdl_t *nbhandle[2];        /* one request per active owner         */
+} gai_gatscat_t;
+
+typedef struct gai_ghost_seg{
+  int proc;                        /* owner of the data, world rank        */
+  int grp_proc;                    /* owner of the data, group rank        */
+  char *ptr_rem;                   /* source in the owner's interior       */
+  char *ptr_loc;                   /* destination in local ghost cells     */
+  int stride_rem[MAXDIM];          /* strides of the source                */
+  int stride_loc[MAXDIM];          /* strides of the destination           */
+  int count[MAXDIM];               /* extents, count[0] in bytes           */
+} gai_ghost_seg_t;
+
+typedef struct gai_ghost_plan{
+  int fallback;                    /* use pnga_update_ghosts instead       */
+  int corner_flag;                 /* corner flag segments were built for  */
+  int pending;                     /* an update has been started           */
+  int p_handle;                    /* group the flags were allocated on    */
+  int nseg;                        /* number of neighbor transfers         */
+  gai_ghost_seg_t *seg;            /* one transfer per face/edge/corner    */
+  int nnbr;                        /* number of distinct neighbors         */
+  int *nbr;                        /* neighbors, world then group rank,    */
+                                   /* then number of transfers from each   */
+  long **flags;                    /* ready and done counters, by group    */
+  long ready;                      /* ready signals expected so far        */
+  long done;                       /* done signals expected so far         */
+  Integer nbhandle;                /* handle of the outstanding gets       */
+} gai_ghost_plan_t;
+
+typedef struct gai_merge{
+  C_Long seg_elems;                /* elements per merge segment           */
+  Integer nblock;                  /* number of blocks in a node copy      */
+  C_Long *seg_base;                /* first segment of every block         */
+  C_Long nseg;                     /* segments in a node copy              */
+  int *dirty;                      /* segments written since last merge    */
+} gai_merge_t;
 
 typedef struct {
        short int  ndim;             /* number of dimensions                 */
@@ -99,7 +159,12 @@ typedef struct {
 #endif
        /* new */
        int read_cache;              /* flag for read only pointer in cache  */
-       cache_struct_t *cache_head;  /* linked list of cached reads          */
+       gai_read_cache_t *rcache;    /* index of cached reads                */
+       C_Long rcache_size;          /* byte budget for cached reads         */
+       gai_gatscat_t *gatscat;      /* scratch for gather/scatter calls     */
+       gai_ghost_plan_t *gplan;     /* persistent ghost exchange plan       */
+       gai_merge_t *merge;          /* dirty segments of a mirrored array   */
+       Integer epoch;               /* bumped whenever memory is released   */
        int mem_dev_set;             /* flag for setting memory device       */
        char mem_dev[FNAM+1];        /* memory device type                   */
        int overlay;                 /* GA uses memory from another GA       */
@@ -431,3 +496,11 @@ Integer _d;                                                                    \
 
 extern void pna_access_block_grid_ptr(Integer g_a, Integer *index, void *ptr,
     Integer ld);
+extern void gai_read_cache_get(Integer g_a, Integer *lo, Integer *hi,
+    void *buf, Integer *ld);
+extern void gai_read_cache_free(Integer handle);
+extern void gai_gatscat_free(Integer handle);
+extern void gai_ghost_plan_free(Integer handle);
+extern void gai_merge_free(Integer handle);
+extern void gai_merge_mark(Integer g_a, Integer *lo, Integer *hi);
+extern void gai_merge_mirrored(Integer g_a, Integer grp);
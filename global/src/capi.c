@@ -776,6 +776,20 @@ void NGA_Set_property(int g_a, char* property)
     wnga_set_property(aa,property);
 }
 
+void GA_Set_read_cache_size(int g_a, size_t size)
+{
+    Integer aa;
+    aa = (Integer)g_a;
+    wnga_set_read_cache_size(aa,(Integer)size);
+}
+
+void NGA_Set_read_cache_size(int g_a, size_t size)
+{
+    Integer aa;
+    aa = (Integer)g_a;
+    wnga_set_read_cache_size(aa,(Integer)size);
+}
+
 void GA_Unset_property(int g_a)
 {
     Integer aa;
@@ -1435,6 +1449,30 @@ void NGA_Update_ghosts_nb(int g_a, ga_nbhdl_t *nbhandle)
     wnga_update_ghosts_nb(a,nbhandle);
 }
 
+void GA_Update_ghosts_start(int g_a)
+{
+    Integer a=(Integer)g_a;
+    wnga_update_ghosts_start(a);
+}
+
+void NGA_Update_ghosts_start(int g_a)
+{
+    Integer a=(Integer)g_a;
+    wnga_update_ghosts_start(a);
+}
+
+void GA_Update_ghosts_wait(int g_a)
+{
+    Integer a=(Integer)g_a;
+    wnga_update_ghosts_wait(a);
+}
+
+void NGA_Update_ghosts_wait(int g_a)
+{
+    Integer a=(Integer)g_a;
+    wnga_update_ghosts_wait(a);
+}
+
 void GA_Merge_mirrored(int g_a)
 {
     Integer a=(Integer)g_a;
@@ -1447,6 +1485,13 @@ void NGA_Merge_mirrored(int g_a)
     wnga_merge_mirrored(a);
 }
 
+void GA_Set_merge_dirty(int g_a, int flag)
+{
+    Integer a=(Integer)g_a;
+    logical fflag=(logical)flag;
+    wnga_set_merge_dirty(a,fflag);
+}
+
 void GA_Nblock(int g_a, int *nblock)
 {
     Integer aa, ndim;
@@ -1904,6 +1949,65 @@ void NGA_NbGet64(int g_a, int64_t lo[], int64_t hi[], void* buf, int64_t ld[],
     wnga_nbget(a, _ga_lo, _ga_hi, buf, _ga_work,(Integer *)nbhandle);
 }
 
+int NGA_Create_plan(int g_a, int lo[], int hi[], int ld[])
+{
+    Integer a=(Integer)g_a;
+    Integer ndim = wnga_ndim(a);
+    Integer _ga_lo[MAXDIM], _ga_hi[MAXDIM];
+    Integer _ga_work[MAXDIM];
+    COPYINDEX_C2F(lo,_ga_lo, ndim);
+    COPYINDEX_C2F(hi,_ga_hi, ndim);
+    COPYC2F(ld,_ga_work, ndim-1);
+    return (int)wnga_create_plan(a, _ga_lo, _ga_hi, _ga_work);
+}
+
+int NGA_Create_plan64(int g_a, int64_t lo[], int64_t hi[], int64_t ld[])
+{
+    Integer a=(Integer)g_a;
+    Integer ndim = wnga_ndim(a);
+    Integer _ga_lo[MAXDIM], _ga_hi[MAXDIM];
+    Integer _ga_work[MAXDIM];
+    COPYINDEX_C2F(lo,_ga_lo, ndim);
+    COPYINDEX_C2F(hi,_ga_hi, ndim);
+    COPYC2F(ld,_ga_work, ndim-1);
+    return (int)wnga_create_plan(a, _ga_lo, _ga_hi, _ga_work);
+}
+
+void NGA_Destroy_plan(int plan)
+{
+    wnga_destroy_plan((Integer)plan);
+}
+
+void NGA_Plan_get(int plan, void *buf)
+{
+    wnga_plan_get((Integer)plan, buf);
+}
+
+void NGA_Plan_nbget(int plan, void *buf, ga_nbhdl_t* nbhandle)
+{
+    wnga_plan_nbget((Integer)plan, buf, (Integer *)nbhandle);
+}
+
+void NGA_Plan_put(int plan, void *buf)
+{
+    wnga_plan_put((Integer)plan, buf);
+}
+
+void NGA_Plan_nbput(int plan, void *buf, ga_nbhdl_t* nbhandle)
+{
+    wnga_plan_nbput((Integer)plan, buf, (Integer *)nbhandle);
+}
+
+void NGA_Plan_acc(int plan, void *buf, void *alpha)
+{
+    wnga_plan_acc((Integer)plan, buf, alpha);
+}
+
+void NGA_Plan_nbacc(int plan, void *buf, void *alpha, ga_nbhdl_t* nbhandle)
+{
+    wnga_plan_nbacc((Integer)plan, buf, alpha, (Integer *)nbhandle);
+}
+
 void NGA_Put(int g_a, int lo[], int hi[], void* buf, int ld[])
 {
     Integer a=(Integer)g_a;
@@ -2864,6 +2968,30 @@ void NGA_Unlock(int mutex)
      wnga_unlock(m);
 }
 
+int GA_Create_counter(long ntasks)
+{
+     Integer n = (Integer)ntasks;
+     return (int)wnga_create_counter(n);
+}
+
+long GA_Next_task(int counter)
+{
+     Integer c = (Integer)counter;
+     return (long)wnga_next_task(c);
+}
+
+void GA_Reset_counter(int counter)
+{
+     Integer c = (Integer)counter;
+     wnga_reset_counter(c);
+}
+
+void GA_Destroy_counter(int counter)
+{
+     Integer c = (Integer)counter;
+     wnga_destroy_counter(c);
+}
+
 void GA_Brdcst(void *buf, int lenbuf, int root)
 {
   Integer type=GA_TYPE_BRD;
@@ -4410,6 +4538,29 @@ void GA_Summarize(int verbose)
     wnga_summarize(v);
 }
 
+void GA_Sort(int g_a)
+{
+    Integer a = (Integer)g_a;
+
+    wnga_sort(a);
+}
+
+void GA_Sort_kv(int g_a, int g_v)
+{
+    Integer a = (Integer)g_a;
+    Integer v = (Integer)g_v;
+
+    wnga_sort_kv(a, v);
+}
+
+void GA_Sort_rank(int g_a, int g_r)
+{
+    Integer a = (Integer)g_a;
+    Integer r = (Integer)g_r;
+
+    wnga_sort_rank(a, r);
+}
+
 void GA_Symmetrize(int g_a)
 {
     Integer a = (Integer)g_a;
@@ -4676,6 +4827,39 @@ void GA_Elem_minimum(int g_a, int g_b, int g_c)
     wnga_elem_minimum(a, b, c);
 }
 
+void GA_Elem_fused(int g_c, int nops, int ops[], int nin, int g_in[],
+                   void *consts)
+{
+    Integer c = (Integer)g_c;
+    Integer *_ga_ops, *_ga_in;
+    int i;
+    if (nops < 1 || nin < 1)
+        GA_Error("GA_Elem_fused: empty program or no input arrays", 0);
+    _ga_ops = (Integer*)malloc((nops+nin)*sizeof(Integer));
+    _ga_in = _ga_ops + nops;
+    for (i=0; i<nops; i++) _ga_ops[i] = (Integer)ops[i];
+    for (i=0; i<nin; i++) _ga_in[i] = (Integer)g_in[i];
+    wnga_elem_fused(c, (Integer)nops, _ga_ops, (Integer)nin, _ga_in, consts);
+    free(_ga_ops);
+}
+
+void GA_Reduce_fused(int nred, int ops[], int g_x[], int g_y[], void *result)
+{
+    Integer *_ga_ops, *_ga_x, *_ga_y;
+    int i;
+    if (nred < 1) GA_Error("GA_Reduce_fused: no reductions", 0);
+    _ga_ops = (Integer*)malloc(3*nred*sizeof(Integer));
+    _ga_x = _ga_ops + nred;
+    _ga_y = _ga_x + nred;
+    for (i=0; i<nred; i++) {
+        _ga_ops[i] = (Integer)ops[i];
+        _ga_x[i] = (Integer)g_x[i];
+        _ga_y[i] = g_y ? (Integer)g_y[i] : 0;
+    }
+    wnga_reduce_fused((Integer)nred, _ga_ops, _ga_x, _ga_y, result);
+    free(_ga_ops);
+}
+
 
 void GA_Abs_value_patch(int g_a, int *lo, int *hi)
 {
@@ -516,6 +516,7 @@
 #define nga_imerge_mirrored_ F77_FUNC_(nga_imerge_mirrored,NGA_IMERGE_MIRRORED)
 #define nga_smerge_mirrored_ F77_FUNC_(nga_smerge_mirrored,NGA_SMERGE_MIRRORED)
 #define nga_zmerge_mirrored_ F77_FUNC_(nga_zmerge_mirrored,NGA_ZMERGE_MIRRORED)
+#define ga_set_merge_dirty_ F77_FUNC_(ga_set_merge_dirty,GA_SET_MERGE_DIRTY)
 #define ga_nblock_  F77_FUNC_(ga_nblock, GA_NBLOCK)
 #define ga_cnblock_ F77_FUNC_(ga_cnblock,GA_CNBLOCK)
 #define ga_dnblock_ F77_FUNC_(ga_dnblock,GA_DNBLOCK)
@@ -972,6 +973,8 @@
 #define nga_iset_property_  F77_FUNC_(nga_iset_property, NGA_ISET_PROPERTY)
 #define nga_sset_property_  F77_FUNC_(nga_sset_property, NGA_SSET_PROPERTY)
 #define nga_zset_property_  F77_FUNC_(nga_zset_property, NGA_ZSET_PROPERTY)
+#define ga_set_read_cache_size_  F77_FUNC_(ga_set_read_cache_size, GA_SET_READ_CACHE_SIZE)
+#define nga_set_read_cache_size_  F77_FUNC_(nga_set_read_cache_size, NGA_SET_READ_CACHE_SIZE)
 #define ga_unset_property_  F77_FUNC_(ga_unset_property, GA_UNSET_PROPERTY)
 #define ga_cunset_property_  F77_FUNC_(ga_cunset_property, GA_CUNSET_PROPERTY)
 #define ga_dunset_property_  F77_FUNC_(ga_dunset_property, GA_DUNSET_PROPERTY)
@@ -1814,6 +1817,10 @@
 #define nga_ielem_minimum_ F77_FUNC_(nga_ielem_minimum,NGA_IELEM_MINIMUM)
 #define nga_selem_minimum_ F77_FUNC_(nga_selem_minimum,NGA_SELEM_MINIMUM)
 #define nga_zelem_minimum_ F77_FUNC_(nga_zelem_minimum,NGA_ZELEM_MINIMUM)
+#define ga_elem_fused_   F77_FUNC_(ga_elem_fused, GA_ELEM_FUSED)
+#define nga_elem_fused_  F77_FUNC_(nga_elem_fused, NGA_ELEM_FUSED)
+#define ga_reduce_fused_  F77_FUNC_(ga_reduce_fused, GA_REDUCE_FUSED)
+#define nga_reduce_fused_ F77_FUNC_(nga_reduce_fused, NGA_REDUCE_FUSED)
 #define ga_elem_multiply_patch_  F77_FUNC_(ga_elem_multiply_patch, GA_ELEM_MULTIPLY_PATCH)
 #define ga_celem_multiply_patch_ F77_FUNC_(ga_celem_multiply_patch,GA_CELEM_MULTIPLY_PATCH)
 #define ga_delem_multiply_patch_ F77_FUNC_(ga_delem_multiply_patch,GA_DELEM_MULTIPLY_PATCH)
@@ -2386,6 +2393,10 @@
 #define ga_zupdate_ghosts_ F77_FUNC_(ga_zupdate_ghosts,GA_ZUPDATE_GHOSTS)
 #define nga_update_ghosts_  F77_FUNC_(nga_update_ghosts, NGA_UPDATE_GHOSTS)
 #define nga_update_ghosts_nb_  F77_FUNC_(nga_update_ghosts_nb, NGA_UPDATE_GHOSTS)
+#define ga_update_ghosts_start_  F77_FUNC_(ga_update_ghosts_start, GA_UPDATE_GHOSTS_START)
+#define nga_update_ghosts_start_ F77_FUNC_(nga_update_ghosts_start, NGA_UPDATE_GHOSTS_START)
+#define ga_update_ghosts_wait_  F77_FUNC_(ga_update_ghosts_wait, GA_UPDATE_GHOSTS_WAIT)
+#define nga_update_ghosts_wait_ F77_FUNC_(nga_update_ghosts_wait, NGA_UPDATE_GHOSTS_WAIT)
 #define nga_cupdate_ghosts_ F77_FUNC_(nga_cupdate_ghosts,NGA_CUPDATE_GHOSTS)
 #define nga_dupdate_ghosts_ F77_FUNC_(nga_dupdate_ghosts,NGA_DUPDATE_GHOSTS)
 #define nga_iupdate_ghosts_ F77_FUNC_(nga_iupdate_ghosts,NGA_IUPDATE_GHOSTS)
@@ -2883,6 +2894,12 @@
 #define nga_iscale_cols_ F77_FUNC_(nga_iscale_cols,NGA_ISCALE_COLS)
 #define nga_sscale_cols_ F77_FUNC_(nga_sscale_cols,NGA_SSCALE_COLS)
 #define nga_zscale_cols_ F77_FUNC_(nga_zscale_cols,NGA_ZSCALE_COLS)
+#define ga_sort_         F77_FUNC_(ga_sort, GA_SORT)
+#define nga_sort_        F77_FUNC_(nga_sort, NGA_SORT)
+#define ga_sort_kv_      F77_FUNC_(ga_sort_kv, GA_SORT_KV)
+#define nga_sort_kv_     F77_FUNC_(nga_sort_kv, NGA_SORT_KV)
+#define ga_sort_rank_    F77_FUNC_(ga_sort_rank, GA_SORT_RANK)
+#define nga_sort_rank_   F77_FUNC_(nga_sort_rank, NGA_SORT_RANK)
 #define ga_symmetrize_  F77_FUNC_(ga_symmetrize, GA_SYMMETRIZE)
 #define ga_csymmetrize_ F77_FUNC_(ga_csymmetrize,GA_CSYMMETRIZE)
 #define ga_dsymmetrize_ F77_FUNC_(ga_dsymmetrize,GA_DSYMMETRIZE)
@@ -3210,6 +3227,20 @@
 #define nga_access_block_grid_      F77_FUNC_(nga_access_block_grid,NGA_ACCESS_BLOCK_GRID)
 #define nga_access_block_segment_   F77_FUNC_(nga_access_block_segment,NGA_ACCESS_BLOCK_SEGMENT)
 
+#define ga_create_counter_  F77_FUNC_(ga_create_counter,GA_CREATE_COUNTER)
+#define ga_destroy_counter_ F77_FUNC_(ga_destroy_counter,GA_DESTROY_COUNTER)
+#define ga_next_task_       F77_FUNC_(ga_next_task,GA_NEXT_TASK)
+#define ga_reset_counter_   F77_FUNC_(ga_reset_counter,GA_RESET_COUNTER)
+
+#define nga_create_plan_    F77_FUNC_(nga_create_plan,NGA_CREATE_PLAN)
+#define nga_destroy_plan_   F77_FUNC_(nga_destroy_plan,NGA_DESTROY_PLAN)
+#define nga_plan_get_       F77_FUNC_(nga_plan_get,NGA_PLAN_GET)
+#define nga_plan_nbget_     F77_FUNC_(nga_plan_nbget,NGA_PLAN_NBGET)
+#define nga_plan_put_       F77_FUNC_(nga_plan_put,NGA_PLAN_PUT)
+#define nga_plan_nbput_     F77_FUNC_(nga_plan_nbput,NGA_PLAN_NBPUT)
+#define nga_plan_acc_       F77_FUNC_(nga_plan_acc,NGA_PLAN_ACC)
+#define nga_plan_nbacc_     F77_FUNC_(nga_plan_nbacc,NGA_PLAN_NBACC)
+
 #define ga_pgroup_cgop_     F77_FUNC_(ga_pgroup_cgop,GA_PGROUP_CGOP)
 #define ga_pgroup_dgop_     F77_FUNC_(ga_pgroup_dgop,GA_PGROUP_DGOP)
 #define ga_pgroup_igop_     F77_FUNC_(ga_pgroup_igop,GA_PGROUP_IGOP)
@@ -0,0 +1,277 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+/*
+ * module: counter.c
+ * description: implements shared task counters for dynamic load
+ * balancing. A counter hands out the task indices [0,ntasks) exactly
+ * once across all processes. Instead of one fetch-and-add per task on a
+ * single server, which is what NXTVAL and ga_read_inc do, every SMP node
+ * keeps its own counter on the first process of the node and processes
+ * draw tasks from it. The node counter holds a batch of tasks claimed
+ * from a global batch counter, and the process that runs off the end of
+ * a batch claims the next one. Batches follow a guided schedule: each is
+ * a fraction of the remaining range, so they are large at the start and
+ * shrink to the minimum batch size near the end.
+ *
+ * DISCLAIMER
+ *
+ * This material was prepared as an account of work sponsored by an
+ * agency of the United States Government.  Neither the United States
+ * Government nor the United States Department of Energy, nor Battelle,
+ * nor any of their employees, MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR
+ * ASSUMES ANY LEGAL LIABILITY OR RESPONSIBILITY FOR THE ACCURACY,
+ * COMPLETENESS, OR USEFULNESS OF ANY INFORMATION, APPARATUS, PRODUCT,
+ * SOFTWARE, OR PROCESS DISCLOSED, OR REPRESENTS THAT ITS USE WOULD NOT
+ * INFRINGE PRIVATELY OWNED RIGHTS.
+ *
+ *
+ * ACKNOWLEDGMENT
+ *
+ * This software and its documentation were produced with United States
+ * Government support under Contract Number DE-AC06-76RLO-1830 awarded by
+ * the United States Department of Energy.  The United States Government
+ * retains a paid-up non-exclusive, irrevocable worldwide license to
+ * reproduce, prepare derivative works, perform publicly and display
+ * publicly by or for the US Government, including the right to
+ * distribute to other US Government contractors.
+ */
+#if HAVE_STDIO_H
+#   include <stdio.h>
+#endif
+#if HAVE_STDLIB_H
+#   include <stdlib.h>
+#endif
+#include "global.h"
+#include "globalp.h"
+#include "base.h"
+#include "armci.h"
+#include "ga-papi.h"
+#include "ga-wapi.h"
+
+#define MAX_COUNTERS 32
+
+/* default batch schedule: a batch is 1/(COUNTER_FACTOR*nnodes) of the
+ * remaining tasks but never less than COUNTER_MIN_BATCH tasks */
+#define COUNTER_FACTOR 2
+#define COUNTER_MIN_BATCH 1
+
+/* longest delay, in idle loop iterations, between two reads of a node
+ * ticket by a process waiting for the next batch */
+#define COUNTER_MAX_DELAY 65536
+
+/* a node ticket packs the index of the node's current batch in the high
+ * half of a long and the number of tasks drawn from it in the low half, so
+ * a single fetch-and-add both draws a task and tells which batch it is in */
+#define TICKET_BITS ((int)sizeof(long)*4)
+#define TICKET_MASK ((1L<<TICKET_BITS)-1)
+#define TICKET(batch,offset) (((long)(batch)<<TICKET_BITS) | (long)(offset))
+/* leave head room in the offset for processes that overrun a batch */
+#define MAX_BATCH (1L<<(TICKET_BITS-2))
+
+/* layout of the counter memory of each process */
+#define NODE_TICKET 0   /* used on the first process of each node */
+#define GLOBAL_BATCH 1  /* used on the global server */
+
+typedef struct {
+  int active;
+  Integer ntasks;
+  Integer nbatches;
+  Integer *start;       /* batch b covers [start[b],start[b+1]) */
+  long **ptr;           /* counter memory of every process */
+  int node_server;      /* owner of this process' node ticket */
+  int global_server;    /* owner of the global batch counter */
+} counter_t;
+
+static counter_t counters[MAX_COUNTERS];
+
+static Integer counter_env(const char *name, Integer dflt)
+{
+  char *value = getenv(name);
+  Integer ival;
+  if (value == NULL) return dflt;
+  ival = (Integer)atol(value);
+  return ival > 0 ? ival : dflt;
+}
+
+/* idle for n loop iterations without touching the network */
+static void counter_delay(long n)
+{
+  volatile long i;
+  for (i=0; i<n; i++);
+}
+
+static counter_t* counter_get(Integer counter, char *caller)
+{
+  if (counter < 0 || counter >= MAX_COUNTERS || !counters[counter].active)
+    pnga_error(caller,counter);
+  return &counters[counter];
+}
+
+/* set the node tickets and the global batch counter to their initial
+ * values: node i starts on batch i and batch nnodes is the next free one */
+static void counter_init_values(counter_t *cnt)
+{
+  Integer nnodes = pnga_cluster_nnodes();
+  Integer node = pnga_cluster_nodeid();
+  Integer batch = node < cnt->nbatches ? node : cnt->nbatches;
+  if (GAme == cnt->node_server)
+    cnt->ptr[GAme][NODE_TICKET] = TICKET(batch,0);
+  if (GAme == cnt->global_server)
+    cnt->ptr[GAme][GLOBAL_BATCH] = (long)nnodes;
+}
+
+/**
+ *  Create a task counter for the tasks [0,ntasks). Collective on the
+ *  world group. The batch schedule can be tuned with GA_COUNTER_FACTOR and
+ *  GA_COUNTER_MIN_BATCH.
+ */
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_create_counter = pnga_create_counter
+#endif
+
+Integer pnga_create_counter(Integer ntasks)
+{
+  Integer handle, nnodes, factor, min_batch, next, len, maxbatches;
+  counter_t *cnt;
+
+  if (ntasks < 0) pnga_error("ga_create_counter: invalid number of tasks",
+      ntasks);
+  for (handle=0; handle<MAX_COUNTERS; handle++) {
+    if (!counters[handle].active) break;
+  }
+  if (handle == MAX_COUNTERS)
+    pnga_error("ga_create_counter: too many counters",MAX_COUNTERS);
+  cnt = &counters[handle];
+
+  /* every process computes the same guided schedule */
+  nnodes = pnga_cluster_nnodes();
+  factor = counter_env("GA_COUNTER_FACTOR",COUNTER_FACTOR);
+  min_batch = counter_env("GA_COUNTER_MIN_BATCH",COUNTER_MIN_BATCH);
+  if (min_batch > MAX_BATCH) min_batch = MAX_BATCH;
+  maxbatches = 64;
+  cnt->start = (Integer*)malloc(maxbatches*sizeof(Integer));
+  if (!cnt->start) pnga_error("ga_create_counter: malloc failed",maxbatches);
+  cnt->nbatches = 0;
+  next = 0;
+  while (next < ntasks) {
+    len = (ntasks-next)/(factor*nnodes);
+    if (len < min_batch) len = min_batch;
+    if (len > MAX_BATCH) len = MAX_BATCH;
+    if (len > ntasks-next) len = ntasks-next;
+    if (cnt->nbatches+1 == maxbatches) {
+      maxbatches *= 2;
+      cnt->start = (Integer*)realloc(cnt->start,maxbatches*sizeof(Integer));
+      if (!cnt->start)
+        pnga_error("ga_create_counter: realloc failed",maxbatches);
+    }
+    cnt->start[cnt->nbatches++] = next;
+    next += len;
+  }
+  cnt->start[cnt->nbatches] = ntasks;
+  cnt->ntasks = ntasks;
+
+  cnt->node_server = (int)pnga_cluster_procid(pnga_cluster_nodeid(),0);
+  cnt->global_server = (int)(GAnproc-1);
+  cnt->ptr = (long**)malloc(GAnproc*sizeof(long*));
+  if (!cnt->ptr) pnga_error("ga_create_counter: malloc failed",GAnproc);
+  if (ARMCI_Malloc((void**)cnt->ptr, (armci_size_t)(2*sizeof(long))))
+    pnga_error("ga_create_counter: ARMCI_Malloc failed",GAme);
+  counter_init_values(cnt);
+  cnt->active = 1;
+  pnga_pgroup_sync(pnga_pgroup_get_world());
+
+  return handle;
+}
+
+/**
+ *  Return the next task of the counter, or ntasks once every task has
+ *  been handed out
+ */
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_next_task = pnga_next_task
+#endif
+
+Integer pnga_next_task(Integer counter)
+{
+  counter_t *cnt = counter_get(counter,"ga_next_task: invalid counter");
+  long ticket, batch, offset, len, delay;
+
+  while (1) {
+    ARMCI_Rmw(ARMCI_FETCH_AND_ADD_LONG, &ticket,
+        &cnt->ptr[cnt->node_server][NODE_TICKET], 1, cnt->node_server);
+    batch = ticket >> TICKET_BITS;
+    offset = ticket & TICKET_MASK;
+    if (batch >= cnt->nbatches) return cnt->ntasks;
+    len = (long)(cnt->start[batch+1]-cnt->start[batch]);
+    if (offset < len) return cnt->start[batch]+offset;
+
+    if (offset == len) {
+      /* first process past the end of the batch claims the next one for
+       * the node and keeps its first task */
+      long next;
+      ARMCI_Rmw(ARMCI_FETCH_AND_ADD_LONG, &next,
+          &cnt->ptr[cnt->global_server][GLOBAL_BATCH], 1, cnt->global_server);
+      if (next >= cnt->nbatches) {
+        ticket = TICKET(cnt->nbatches,0);
+      } else {
+        ticket = TICKET(next,1);
+      }
+      ARMCI_Rmw(ARMCI_SWAP_LONG, &ticket,
+          &cnt->ptr[cnt->node_server][NODE_TICKET], 0, cnt->node_server);
+      return next >= cnt->nbatches ? cnt->ntasks : cnt->start[next];
+    }
+
+    /* another process is claiming the next batch. Wait for it with plain
+     * reads and a growing delay, so that the waiters do not queue atomic
+     * operations in front of its swap. The ticket is drawn again with a
+     * fetch-and-add, so a stale read only costs another round. */
+    delay = 1;
+    while (1) {
+      ARMCI_Get(&cnt->ptr[cnt->node_server][NODE_TICKET], &ticket,
+          (int)sizeof(long), cnt->node_server);
+      if ((ticket >> TICKET_BITS) != batch) break;
+      counter_delay(delay);
+      if (delay < COUNTER_MAX_DELAY) delay *= 2;
+    }
+  }
+}
+
+/**
+ *  Make all tasks of the counter available again. Collective on the world
+ *  group.
+ */
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_reset_counter = pnga_reset_counter
+#endif
+
+void pnga_reset_counter(Integer counter)
+{
+  counter_t *cnt = counter_get(counter,"ga_reset_counter: invalid counter");
+  Integer world = pnga_pgroup_get_world();
+
+  pnga_pgroup_sync(world);
+  counter_init_values(cnt);
+  pnga_pgroup_sync(world);
+}
+
+/**
+ *  Destroy a task counter. Collective on the world group.
+ */
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_destroy_counter = pnga_destroy_counter
+#endif
+
+void pnga_destroy_counter(Integer counter)
+{
+  counter_t *cnt = counter_get(counter,"ga_destroy_counter: invalid counter");
+
+  pnga_pgroup_sync(pnga_pgroup_get_world());
+  ARMCI_Free(cnt->ptr[GAme]);
+  free(cnt->ptr);
+  free(cnt->start);
+  cnt->ptr = NULL;
+  cnt->start = NULL;
+  cnt->active = 0;
+}
@@ -1012,6 +1012,54 @@ void pnga_add_constant_patch(Integer g_a, Integer *lo, Integer *hi, void *alpha)
 
 }
 
+/*\ Whole-array operations on arrays of one shape and real type are
+ *  evaluated by the fused elementwise engine (elem_fused.c) in a single
+ *  pass.  These return 0 when the arrays do not qualify.
+\*/
+static int gai_elem_fusable(Integer n, Integer *g)
+{
+  Integer type, ndim, dims[MAXDIM], t, nd, d[MAXDIM], i, j;
+
+  pnga_inquire(g[0], &type, &ndim, dims);
+  if (type != C_INT && type != C_LONG && type != C_LONGLONG &&
+      type != C_FLOAT && type != C_DBL) return 0;
+  for (i=1; i<n; i++) {
+    pnga_inquire(g[i], &t, &nd, d);
+    if (t != type || nd != ndim) return 0;
+    for (j=0; j<ndim; j++) if (d[j] != dims[j]) return 0;
+  }
+  return 1;
+}
+
+static int gai_elem_fused1(Integer g_a, Integer op, void *alpha)
+{
+  Integer ops[5], nops = 0;
+
+  if (!gai_elem_fusable(1, &g_a)) return 0;
+  ops[nops++] = GA_EOP_LOAD; ops[nops++] = 0;
+  if (alpha) {
+    ops[nops++] = GA_EOP_CONST; ops[nops++] = 0;
+  }
+  ops[nops++] = op;
+  _ga_sync_begin = 1; /*just to be on the safe side*/
+  pnga_elem_fused(g_a, nops, ops, 1, &g_a, alpha);
+  return 1;
+}
+
+static int gai_elem_fused2(Integer g_a, Integer g_b, Integer g_c, Integer op)
+{
+  Integer ops[5], g[3];
+
+  g[0] = g_a; g[1] = g_b; g[2] = g_c;
+  if (!gai_elem_fusable(3, g)) return 0;
+  ops[0] = GA_EOP_LOAD; ops[1] = 0;
+  ops[2] = GA_EOP_LOAD; ops[3] = 1;
+  ops[4] = op;
+  _ga_sync_begin = 1; /*just to be on the safe side*/
+  pnga_elem_fused(g_c, 5, ops, 2, g, NULL);
+  return 1;
+}
+
 #if HAVE_SYS_WEAK_ALIAS_PRAGMA
 #   pragma weak wnga_abs_value = pnga_abs_value
 #endif
@@ -1020,6 +1068,8 @@ void pnga_abs_value(Integer g_a)
    Integer type, ndim;
    Integer lo[MAXDIM],hi[MAXDIM];
 
+    if (gai_elem_fused1(g_a, GA_EOP_ABS, NULL)) return;
+
     pnga_inquire(g_a,  &type, &ndim, hi);
     while(ndim){
         lo[ndim-1]=1;
@@ -1037,6 +1087,8 @@ void pnga_add_constant(Integer g_a, void *alpha)
    Integer type, ndim;
    Integer lo[MAXDIM],hi[MAXDIM];
 
+    if (gai_elem_fused1(g_a, GA_EOP_ADD, alpha)) return;
+
     pnga_inquire(g_a,  &type, &ndim, hi);
     while(ndim){
         lo[ndim-1]=1;
@@ -1054,6 +1106,8 @@ void pnga_recip(Integer g_a)
    Integer type, ndim;
    Integer lo[MAXDIM],hi[MAXDIM];
         
+    if (gai_elem_fused1(g_a, GA_EOP_RECIP, NULL)) return;
+
     pnga_inquire(g_a,  &type, &ndim, hi);
     while(ndim){
         lo[ndim-1]=1; 
@@ -2244,6 +2298,8 @@ void pnga_elem_multiply(Integer g_a, Integer g_b, Integer g_c){
    Integer blo[MAXDIM],bhi[MAXDIM];
    Integer clo[MAXDIM],chi[MAXDIM];
  
+    if (gai_elem_fused2(g_a, g_b, g_c, GA_EOP_MUL)) return;
+
     pnga_inquire(g_a,  &atype, &andim, ahi);
     pnga_inquire(g_b,  &btype, &bndim, bhi);
     pnga_inquire(g_c,  &ctype, &cndim, chi);
@@ -2275,6 +2331,8 @@ void pnga_elem_divide(Integer g_a, Integer g_b, Integer g_c){
    Integer blo[MAXDIM],bhi[MAXDIM];
    Integer clo[MAXDIM],chi[MAXDIM];
  
+    if (gai_elem_fused2(g_a, g_b, g_c, GA_EOP_DIV)) return;
+
     pnga_inquire(g_a,  &atype, &andim, ahi);
     pnga_inquire(g_b,  &btype, &bndim, bhi);
     pnga_inquire(g_c,  &ctype, &cndim, chi);
@@ -2309,6 +2367,8 @@ void pnga_elem_maximum(Integer g_a, Integer g_b, Integer g_c){
    Integer blo[MAXDIM],bhi[MAXDIM];
    Integer clo[MAXDIM],chi[MAXDIM];
 
+    if (gai_elem_fused2(g_a, g_b, g_c, GA_EOP_MAX)) return;
+
     pnga_inquire(g_a,  &atype, &andim, ahi);
     pnga_inquire(g_b,  &btype, &bndim, bhi);
     pnga_inquire(g_c,  &ctype, &cndim, chi);
@@ -2341,6 +2401,8 @@ void pnga_elem_minimum(Integer g_a, Integer g_b, Integer g_c){
    Integer blo[MAXDIM],bhi[MAXDIM];
    Integer clo[MAXDIM],chi[MAXDIM];
  
+    if (gai_elem_fused2(g_a, g_b, g_c, GA_EOP_MIN)) return;
+
     pnga_inquire(g_a,  &atype, &andim, ahi);
     pnga_inquire(g_b,  &btype, &bndim, bhi);
     pnga_inquire(g_c,  &ctype, &cndim, chi);
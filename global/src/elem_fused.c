@@ -0,0 +1,302 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+/**************************************************************
+File: elem_fused.c
+
+Fused elementwise operations on whole arrays
+
+A fused operation evaluates a short postfix program over one or
+more conforming global arrays and a list of constants, and stores
+the result in another array, in one pass over local memory:
+
+    ops = { GA_EOP_LOAD, 0, GA_EOP_LOAD, 1, GA_EOP_MUL,
+            GA_EOP_CONST, 0, GA_EOP_ADD, GA_EOP_ABS }
+
+computes c = |a*b + alpha| for g_in = { a, b } and consts = { alpha }.
+LOAD and CONST take the index of an array or constant as their
+operand; all other operators pop their arguments off the stack and
+push the result.  Constants have the type of the arrays.
+
+Local blocks are evaluated EOP_BLOCK elements at a time, so every
+intermediate result stays in cache, with branch-free loops that the
+compiler can vectorize.  Blocks are spread over threads when the
+library is compiled with OpenMP.
+
+**************************************************************/
+
+#if HAVE_STRING_H
+#   include <string.h>
+#endif
+#include "globalp.h"
+#include "ga_iterator.h"
+#include "ga-papi.h"
+#include "ga-wapi.h"
+
+#define EOP_BLOCK 512  /* elements evaluated at a time */
+#define EOP_STACK 16   /* deepest expression stack */
+#define EOP_MAXIN 16   /* most input arrays */
+
+/* One operator applied to a block of n elements of type T.  Unary and
+   binary operators read the top of the stack and write into the
+   scratch row of their result, which may be the row they read. */
+#define EOP_UNARY(EXPR)                                                    \
+            a = p[d-1]; r = s[d-1];                                        \
+            for (i=0; i<n; i++) r[i] = (EXPR);                             \
+            p[d-1] = r;                                                    \
+            break;
+#define EOP_BINARY(EXPR)                                                   \
+            a = p[d-2]; b = p[d-1]; r = s[d-2];                            \
+            for (i=0; i<n; i++) r[i] = (EXPR);                             \
+            p[d-2] = r; d--;                                               \
+            break;
+
+#define EOP_KERNEL(NAME,T)                                                 \
+static Integer gai_fused_##NAME(Integer nops, Integer *ops, char **in,     \
+        void *consts, char *out, Integer n)                                \
+{                                                                          \
+    T s[EOP_STACK][EOP_BLOCK];                                             \
+    T *p[EOP_STACK], *a, *b, *r, c;                                        \
+    Integer i, k, d = 0, nzero = 0;                                        \
+                                                                           \
+    for (k=0; k<nops; k++) {                                               \
+        switch (ops[k]) {                                                  \
+          case GA_EOP_LOAD:                                                \
+            p[d++] = (T*)in[ops[++k]];                                     \
+            break;                                                         \
+          case GA_EOP_CONST:                                               \
+            c = ((T*)consts)[ops[++k]]; r = s[d];                          \
+            for (i=0; i<n; i++) r[i] = c;                                  \
+            p[d++] = r;                                                    \
+            break;                                                         \
+          case GA_EOP_ADD: EOP_BINARY(a[i] + b[i])                         \
+          case GA_EOP_SUB: EOP_BINARY(a[i] - b[i])                         \
+          case GA_EOP_MUL: EOP_BINARY(a[i] * b[i])                         \
+          case GA_EOP_DIV:                                                 \
+            b = p[d-1];                                                    \
+            for (i=0; i<n; i++) nzero += (b[i] == (T)0);                   \
+            EOP_BINARY(a[i] / (b[i] != (T)0 ? b[i] : (T)1))                \
+          case GA_EOP_MAX: EOP_BINARY(a[i] >= b[i] ? a[i] : b[i])          \
+          case GA_EOP_MIN: EOP_BINARY(a[i] <= b[i] ? a[i] : b[i])          \
+          case GA_EOP_ABS: EOP_UNARY(a[i] >= (T)0 ? a[i] : -a[i])          \
+          case GA_EOP_NEG: EOP_UNARY(-a[i])                                \
+          case GA_EOP_RECIP:                                               \
+            a = p[d-1];                                                    \
+            for (i=0; i<n; i++) nzero += (a[i] == (T)0);                   \
+            EOP_UNARY((T)1 / (a[i] != (T)0 ? a[i] : (T)1))                 \
+        }                                                                  \
+    }                                                                      \
+    if ((char*)p[0] != out) memcpy(out, p[0], n*sizeof(T));               \
+    return nzero;                                                          \
+}
+
+EOP_KERNEL(int, int)
+EOP_KERNEL(long, long)
+EOP_KERNEL(longlong, long long)
+EOP_KERNEL(float, float)
+EOP_KERNEL(double, double)
+
+#undef EOP_KERNEL
+#undef EOP_UNARY
+#undef EOP_BINARY
+
+
+/*\ check that a program is well formed
+\*/
+static void gai_fused_check(Integer nops, Integer *ops, Integer nin)
+{
+  Integer k, d = 0;
+
+  if (nops < 1) pnga_error("ga_elem_fused: empty program ", nops);
+  for (k=0; k<nops; k++) {
+    switch (ops[k]) {
+      case GA_EOP_LOAD:
+        if (k+1 >= nops || ops[k+1] < 0 || ops[k+1] >= nin)
+          pnga_error("ga_elem_fused: bad array index at op ", k);
+        k++; d++;
+        break;
+      case GA_EOP_CONST:
+        if (k+1 >= nops || ops[k+1] < 0)
+          pnga_error("ga_elem_fused: bad constant index at op ", k);
+        k++; d++;
+        break;
+      case GA_EOP_ADD: case GA_EOP_SUB: case GA_EOP_MUL:
+      case GA_EOP_DIV: case GA_EOP_MAX: case GA_EOP_MIN:
+        if (d < 2) pnga_error("ga_elem_fused: stack underflow at op ", k);
+        d--;
+        break;
+      case GA_EOP_ABS: case GA_EOP_NEG: case GA_EOP_RECIP:
+        if (d < 1) pnga_error("ga_elem_fused: stack underflow at op ", k);
+        break;
+      default:
+        pnga_error("ga_elem_fused: unknown operator ", ops[k]);
+    }
+    if (d > EOP_STACK) pnga_error("ga_elem_fused: stack overflow at op ", k);
+  }
+  if (d != 1) pnga_error("ga_elem_fused: program leaves values on stack ", d);
+}
+
+
+/*\ evaluate a program over n contiguous elements, returning the number
+ *  of zero divisors found
+\*/
+static Integer gai_fused_run(Integer type, Integer nops, Integer *ops,
+        Integer nin, char **in, void *consts, char *out, Integer n)
+{
+  Integer nblk = (n + EOP_BLOCK - 1)/EOP_BLOCK;
+  Integer size = GAsizeofM(type);
+  Integer blk, nzero = 0;
+
+#ifdef _OPENMP
+# pragma omp parallel for schedule(static) reduction(+:nzero) if(nblk > 8)
+#endif
+  for (blk=0; blk<nblk; blk++) {
+    char *bin[EOP_MAXIN];
+    Integer j, off = blk*EOP_BLOCK*size;
+    Integer len = GA_MIN(EOP_BLOCK, n - blk*EOP_BLOCK);
+
+    for (j=0; j<nin; j++) bin[j] = in[j] + off;
+    switch (type) {
+      case C_INT:
+        nzero += gai_fused_int(nops, ops, bin, consts, out+off, len);
+        break;
+      case C_LONG:
+        nzero += gai_fused_long(nops, ops, bin, consts, out+off, len);
+        break;
+      case C_LONGLONG:
+        nzero += gai_fused_longlong(nops, ops, bin, consts, out+off, len);
+        break;
+      case C_FLOAT:
+        nzero += gai_fused_float(nops, ops, bin, consts, out+off, len);
+        break;
+      case C_DBL:
+        nzero += gai_fused_double(nops, ops, bin, consts, out+off, len);
+        break;
+    }
+  }
+  return nzero;
+}
+
+
+/*\ Evaluate the postfix program ops over the arrays g_in and the
+ *  constants consts, storing the result in g_c.  All arrays must have
+ *  the shape and the (real) type of g_c; g_c may be one of the inputs.
+ *  Inputs that are not distributed like g_c are copied first.
+\*/
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_elem_fused = pnga_elem_fused
+#endif
+void pnga_elem_fused(Integer g_c, Integer nops, Integer *ops, Integer nin,
+                     Integer *g_in, void *consts)
+{
+  Integer ctype, cndim, cdims[MAXDIM], type, ndim, dims[MAXDIM];
+  Integer g_x[EOP_MAXIN], created[EOP_MAXIN];
+  Integer loC[MAXDIM], hiC[MAXDIM], ldC[MAXDIM];
+  Integer lo[MAXDIM], hi[MAXDIM], ld[EOP_MAXIN][MAXDIM];
+  Integer me = pnga_nodeid(), size, i, j, nzero = 0, compatible;
+  _iterator_hdl hdl_c, hdl[EOP_MAXIN];
+  char *C_ptr, *ptr[EOP_MAXIN];
+  char *tempname = "temp";
+  int local_sync_begin, local_sync_end;
+
+  local_sync_begin = _ga_sync_begin; local_sync_end = _ga_sync_end;
+  _ga_sync_begin = 1; _ga_sync_end=1; /*remove any previous masking*/
+  if(local_sync_begin)pnga_sync();
+
+  pnga_check_handle(g_c, "ga_elem_fused");
+  pnga_inquire(g_c, &ctype, &cndim, cdims);
+  if (ctype != C_INT && ctype != C_LONG && ctype != C_LONGLONG &&
+      ctype != C_FLOAT && ctype != C_DBL)
+    pnga_error("ga_elem_fused: type not supported ", ctype);
+  if (nin < 1 || nin > EOP_MAXIN)
+    pnga_error("ga_elem_fused: bad number of input arrays ", nin);
+  gai_fused_check(nops, ops, nin);
+  size = GAsizeofM(ctype);
+
+  /* inputs must match g_c; copy those that are distributed differently */
+  for (i=0; i<nin; i++) {
+    pnga_check_handle(g_in[i], "ga_elem_fused");
+    pnga_inquire(g_in[i], &type, &ndim, dims);
+    if (type != ctype) pnga_error("ga_elem_fused: types mismatch ", i);
+    if (ndim != cndim) pnga_error("ga_elem_fused: shapes mismatch ", i);
+    for (j=0; j<ndim; j++)
+      if (dims[j] != cdims[j]) pnga_error("ga_elem_fused: shapes mismatch ", i);
+
+    g_x[i] = g_in[i];
+    created[i] = 0;
+    for (j=0; j<i; j++) {
+      if (g_in[j] == g_in[i]) {
+        g_x[i] = g_x[j];
+        break;
+      }
+    }
+    if (j < i || g_in[i] == g_c) continue;
+
+    compatible = 0;
+    if (pnga_total_blocks(g_in[i]) < 0 && pnga_total_blocks(g_c) < 0) {
+      pnga_distribution(g_in[i], me, lo, hi);
+      pnga_distribution(g_c, me, loC, hiC);
+      compatible = pnga_comp_patch(ndim, lo, hi, cndim, loC, hiC);
+    }
+    pnga_gop(pnga_type_f2c(MT_F_INT), &compatible, 1, "&&");
+    if (!compatible) {
+      if (!pnga_duplicate(g_c, &g_x[i], tempname))
+        pnga_error("ga_elem_fused: dup failed", 0L);
+      pnga_copy(g_in[i], g_x[i]);
+      created[i] = 1;
+    }
+  }
+
+  /* walk the local blocks of all arrays in step */
+  pnga_local_iterator_init(g_c, &hdl_c);
+  for (i=0; i<nin; i++) pnga_local_iterator_init(g_x[i], &hdl[i]);
+  while (pnga_local_iterator_next(&hdl_c, loC, hiC, &C_ptr, ldC)) {
+    Integer nrow, nelem, contig = 1, row, idx, off;
+    char *rin[EOP_MAXIN];
+
+    for (i=0; i<nin; i++)
+      pnga_local_iterator_next(&hdl[i], lo, hi, &ptr[i], ld[i]);
+
+    for (j=0; j<cndim-1; j++) {
+      if (ldC[j] != hiC[j]-loC[j]+1) contig = 0;
+      for (i=0; i<nin; i++) if (ld[i][j] != hiC[j]-loC[j]+1) contig = 0;
+    }
+    nelem = hiC[0]-loC[0]+1;
+    nrow = 1; for (j=1; j<cndim; j++) nrow *= hiC[j]-loC[j]+1;
+    if (contig) {
+      nzero += gai_fused_run(ctype, nops, ops, nin, ptr, consts, C_ptr,
+                             nelem*nrow);
+      continue;
+    }
+
+    /* blocks with ghost cells or padding are done a row at a time */
+    for (row=0; row<nrow; row++) {
+      Integer rem = row, stride = 1;
+      off = 0;
+      for (j=1; j<cndim; j++) {
+        idx = rem % (hiC[j]-loC[j]+1);
+        rem /= hiC[j]-loC[j]+1;
+        stride *= ldC[j-1];
+        off += idx*stride;
+      }
+      for (i=0; i<nin; i++) {
+        Integer ioff = 0, istride = 1;
+        rem = row;
+        for (j=1; j<cndim; j++) {
+          idx = rem % (hiC[j]-loC[j]+1);
+          rem /= hiC[j]-loC[j]+1;
+          istride *= ld[i][j-1];
+          ioff += idx*istride;
+        }
+        rin[i] = ptr[i] + ioff*size;
+      }
+      nzero += gai_fused_run(ctype, nops, ops, nin, rin, consts,
+                             C_ptr + off*size, nelem);
+    }
+  }
+
+  for (i=0; i<nin; i++) if (created[i]) pnga_destroy(g_x[i]);
+  if (nzero) pnga_error("ga_elem_fused: zero divisors found ", nzero);
+  if(local_sync_end)pnga_sync();
+}
@@ -322,6 +322,26 @@ logical FATR nga_destroy_mutexes_()
   return wnga_destroy_mutexes();
 }
 
+Integer FATR ga_create_counter_(Integer *ntasks)
+{
+  return wnga_create_counter(*ntasks);
+}
+
+void FATR ga_destroy_counter_(Integer *counter)
+{
+  wnga_destroy_counter(*counter);
+}
+
+Integer FATR ga_next_task_(Integer *counter)
+{
+  return wnga_next_task(*counter);
+}
+
+void FATR ga_reset_counter_(Integer *counter)
+{
+  wnga_reset_counter(*counter);
+}
+
 void FATR ga_distribution_(Integer *g_a, Integer *proc, Integer *ilo,
                            Integer *ihi, Integer *jlo, Integer *jhi)
 {
@@ -689,6 +709,11 @@ void FATR nga_merge_mirrored_(Integer *g_a)
   wnga_merge_mirrored(*g_a);
 }
 
+void FATR ga_set_merge_dirty_(Integer *g_a, logical *flag)
+{
+  wnga_set_merge_dirty(*g_a, *flag);
+}
+
 void FATR ga_nblock_(Integer *g_a, Integer *nblock)
 {
   wnga_nblock(*g_a, nblock);
@@ -1075,6 +1100,16 @@ void FATR nga_set_property_(Integer *g_a, char *property, int slen)
   wnga_set_property(*g_a, buf);
 }
 
+void FATR ga_set_read_cache_size_(Integer *g_a, Integer *size)
+{
+  wnga_set_read_cache_size(*g_a, *size);
+}
+
+void FATR nga_set_read_cache_size_(Integer *g_a, Integer *size)
+{
+  wnga_set_read_cache_size(*g_a, *size);
+}
+
 void FATR ga_unset_property_(Integer *g_a)
 {
   wnga_unset_property(*g_a);
@@ -1339,6 +1374,48 @@ void FATR nga_nbget_(Integer *g_a, Integer *lo,
   wnga_nbget(*g_a, lo, hi, buf, ld, nbhandle);
 }
 
+Integer FATR nga_create_plan_(Integer *g_a, Integer *lo, Integer *hi,
+                              Integer *ld)
+{
+  return wnga_create_plan(*g_a, lo, hi, ld);
+}
+
+void FATR nga_destroy_plan_(Integer *plan)
+{
+  wnga_destroy_plan(*plan);
+}
+
+void FATR nga_plan_get_(Integer *plan, void *buf)
+{
+  wnga_plan_get(*plan, buf);
+}
+
+void FATR nga_plan_nbget_(Integer *plan, void *buf, Integer *nbhandle)
+{
+  wnga_plan_nbget(*plan, buf, nbhandle);
+}
+
+void FATR nga_plan_put_(Integer *plan, void *buf)
+{
+  wnga_plan_put(*plan, buf);
+}
+
+void FATR nga_plan_nbput_(Integer *plan, void *buf, Integer *nbhandle)
+{
+  wnga_plan_nbput(*plan, buf, nbhandle);
+}
+
+void FATR nga_plan_acc_(Integer *plan, void *buf, void *alpha)
+{
+  wnga_plan_acc(*plan, buf, alpha);
+}
+
+void FATR nga_plan_nbacc_(Integer *plan, void *buf, void *alpha,
+                          Integer *nbhandle)
+{
+  wnga_plan_nbacc(*plan, buf, alpha, nbhandle);
+}
+
 void FATR ga_nbput_(Integer *g_a, Integer *ilo, Integer *ihi,
                     Integer *jlo, Integer *jhi, void *buf,
                     Integer *ld, Integer *nbhandle)
@@ -1922,6 +1999,30 @@ void FATR nga_elem_minimum_(Integer *g_a, Integer *g_b, Integer *g_c)
     wnga_elem_minimum(*g_a, *g_b, *g_c);
 }
 
+void FATR ga_elem_fused_(Integer *g_c, Integer *nops, Integer *ops,
+                         Integer *nin, Integer *g_in, void *consts)
+{
+    wnga_elem_fused(*g_c, *nops, ops, *nin, g_in, consts);
+}
+
+void FATR nga_elem_fused_(Integer *g_c, Integer *nops, Integer *ops,
+                          Integer *nin, Integer *g_in, void *consts)
+{
+    wnga_elem_fused(*g_c, *nops, ops, *nin, g_in, consts);
+}
+
+void FATR ga_reduce_fused_(Integer *nred, Integer *ops, Integer *g_x,
+                           Integer *g_y, void *result)
+{
+    wnga_reduce_fused(*nred, ops, g_x, g_y, result);
+}
+
+void FATR nga_reduce_fused_(Integer *nred, Integer *ops, Integer *g_x,
+                            Integer *g_y, void *result)
+{
+    wnga_reduce_fused(*nred, ops, g_x, g_y, result);
+}
+
 void FATR ga_elem_multiply_patch_(Integer *g_a,Integer *alo,Integer *ahi,Integer *g_b,Integer *blo,Integer *bhi,Integer *g_c,Integer *clo,Integer *chi)
 {
     wnga_elem_multiply_patch(*g_a,alo,ahi,*g_b,blo,bhi,*g_c,clo,chi);
@@ -2216,6 +2317,26 @@ void FATR nga_update_ghosts_nb_(Integer *g_a, Integer *nb)
     wnga_update_ghosts_nb(*g_a, nb);
 }
 
+void FATR ga_update_ghosts_start_(Integer *g_a)
+{
+    wnga_update_ghosts_start(*g_a);
+}
+
+void FATR nga_update_ghosts_start_(Integer *g_a)
+{
+    wnga_update_ghosts_start(*g_a);
+}
+
+void FATR ga_update_ghosts_wait_(Integer *g_a)
+{
+    wnga_update_ghosts_wait(*g_a);
+}
+
+void FATR nga_update_ghosts_wait_(Integer *g_a)
+{
+    wnga_update_ghosts_wait(*g_a);
+}
+
 logical FATR ga_update6_ghosts_(Integer *g_a)
 {
     return wnga_update6_ghosts(*g_a);
@@ -3335,6 +3456,38 @@ void FATR nga_scale_cols_(Integer *g_a, Integer *g_v)
     wnga_scale_cols(*g_a, *g_v);
 }
 
+/* Routines from sort.c */
+
+void FATR ga_sort_(Integer *g_a)
+{
+    wnga_sort(*g_a);
+}
+
+void FATR nga_sort_(Integer *g_a)
+{
+    wnga_sort(*g_a);
+}
+
+void FATR ga_sort_kv_(Integer *g_a, Integer *g_v)
+{
+    wnga_sort_kv(*g_a, *g_v);
+}
+
+void FATR nga_sort_kv_(Integer *g_a, Integer *g_v)
+{
+    wnga_sort_kv(*g_a, *g_v);
+}
+
+void FATR ga_sort_rank_(Integer *g_a, Integer *g_r)
+{
+    wnga_sort_rank(*g_a, *g_r);
+}
+
+void FATR nga_sort_rank_(Integer *g_a, Integer *g_r)
+{
+    wnga_sort_rank(*g_a, *g_r);
+}
+
 /* Routines from ga_symmetr.c */
 
 void FATR ga_symmetrize_(Integer *g_a)
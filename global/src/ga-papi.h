@@ -83,6 +83,7 @@ extern logical pnga_memory_limited();
 extern void pnga_merge_distr_patch(Integer g_a, Integer *alo, Integer *ahi,
                                    Integer g_b, Integer *blo, Integer *bhi);
 extern void pnga_merge_mirrored(Integer g_a);
+extern void pnga_set_merge_dirty(Integer g_a, logical flag);
 extern void pnga_nblock(Integer g_a, Integer *nblock);
 
 extern Integer pnga_nnodes();
@@ -122,6 +123,7 @@ extern void pnga_set_pgroup(Integer g_a, Integer p_handle);
 extern void pnga_set_restricted(Integer g_a, Integer *list, Integer size);
 extern void pnga_set_restricted_range(Integer g_a, Integer lo_proc, Integer hi_proc);
 extern void pnga_set_property(Integer g_a, char *property);
+extern void pnga_set_read_cache_size(Integer g_a, Integer size);
 extern void pnga_unset_property(Integer g_a);
 extern void pnga_set_memory_dev(Integer g_a, char *device);
 extern void pnga_terminate();
@@ -153,6 +155,9 @@ extern void pnga_access_block_segment_idx(Integer g_a, Integer proc,
 extern void pnga_access_block_segment_ptr(Integer g_a, Integer proc,
                                           void* ptr, Integer *len);
 extern void pnga_alloc_gatscat_buf(Integer nelems);
+extern Integer pnga_create_plan(Integer g_a, Integer *lo, Integer *hi,
+                                Integer *ld);
+extern void pnga_destroy_plan(Integer plan);
 extern void pnga_fence();
 extern void pnga_free_gatscat_buf();
 extern void pnga_gather2d(Integer g_a, void *v, Integer *i, Integer *j,
@@ -172,6 +177,13 @@ extern void pnga_nbput_notify(Integer g_a, Integer *lo, Integer *hi, void *buf,
 extern void pnga_nbwait_notify(Integer *nbhandle);
 extern Integer pnga_nbtest(Integer *nbhandle);
 extern void pnga_nbwait(Integer *nbhandle);
+extern void pnga_plan_get(Integer plan, void *buf);
+extern void pnga_plan_nbget(Integer plan, void *buf, Integer *nbhandle);
+extern void pnga_plan_put(Integer plan, void *buf);
+extern void pnga_plan_nbput(Integer plan, void *buf, Integer *nbhandle);
+extern void pnga_plan_acc(Integer plan, void *buf, void *alpha);
+extern void pnga_plan_nbacc(Integer plan, void *buf, void *alpha,
+                            Integer *nbhandle);
 extern void pnga_put(Integer g_a, Integer *lo, Integer *hi, void *buf,
                      Integer *ld);
 extern void pnga_pgroup_sync(Integer grp_id);
@@ -236,6 +248,17 @@ extern void pnga_step_max_patch(Integer g_a, Integer *alo, Integer *ahi, Integer
 extern void pnga_step_max(Integer g_a, Integer g_b, void *retval);
 extern void pnga_step_bound_info(Integer g_xx, Integer g_vv, Integer g_xxll, Integer g_xxuu, void *boundmin, void *wolfemin, void *boundmax);
 
+/* Routines from elem_fused.c */
+extern void pnga_elem_fused(Integer g_c, Integer nops, Integer *ops, Integer nin, Integer *g_in, void *consts);
+
+/* Routines from reduce_fused.c */
+extern void pnga_reduce_fused(Integer nred, Integer *ops, Integer *g_x, Integer *g_y, void *result);
+
+/* Routines from sort.c */
+extern void pnga_sort(Integer g_a);
+extern void pnga_sort_kv(Integer g_a, Integer g_v);
+extern void pnga_sort_rank(Integer g_a, Integer g_r);
+
 /* Routines from ga_solve_seq.c */
 extern void pnga_lu_solve_seq(char *trans, Integer g_a, Integer g_b);
 
@@ -278,6 +301,8 @@ extern logical pnga_update5_ghosts(Integer g_a);
 extern logical pnga_set_update5_info(Integer g_a);
 extern void pnga_update_ghosts(Integer g_a);
 extern void pnga_update_ghosts_nb(Integer g_a, Integer *nbhandle);
+extern void pnga_update_ghosts_start(Integer g_a);
+extern void pnga_update_ghosts_wait(Integer g_a);
 extern logical pnga_update6_ghosts(Integer g_a);
 extern logical pnga_update7_ghosts(Integer g_a);
 extern void pnga_ghost_barrier();
@@ -372,6 +397,13 @@ extern Integer pnga_llt_solve(Integer g_a, Integer g_b);
 extern Integer pnga_solve(Integer g_a, Integer g_b);
 extern Integer pnga_spd_invert(Integer g_a);
 
+/* Routines from counter.c */
+
+extern Integer pnga_create_counter(Integer ntasks);
+extern void pnga_destroy_counter(Integer counter);
+extern Integer pnga_next_task(Integer counter);
+extern void pnga_reset_counter(Integer counter);
+
 /* Routines from DP.c */
 
 extern void pnga_copy_patch_dp(char *t_a, Integer g_a, Integer ailo, Integer aihi, Integer ajlo, Integer ajhi, Integer g_b, Integer bilo, Integer bihi, Integer bjlo, Integer bjhi);
@@ -35,11 +35,13 @@ extern int           GA_Cluster_procid(int x, int y);
 extern int           GA_Cluster_proc_nodeid(int proc);
 extern int           GA_Compare_distr(int g_a, int g_b); 
 extern void          GA_Copy(int g_a, int g_b); 
+extern int           GA_Create_counter(long ntasks);
 extern int           GA_Create_handle(void);
 extern int           GA_Create_mutexes(int number);
 extern int           GA_Deallocate(int g_a); 
 extern double        GA_Ddot(int g_a, int g_b); 
 extern void          GA_Destroy(int g_a);
+extern void          GA_Destroy_counter(int counter);
 extern int           GA_Destroy_mutexes(void);
 extern void          GA_Dgemm(char ta, char tb, int m, int n, int k, double alpha, int g_a, int g_b, double beta, int g_c );
 extern void          GA_Dgop(double x[], int n, char *op);
@@ -51,6 +53,7 @@ extern void          GA_Diag_std_seq(int g_a, int g_v, void *eval);
 extern int           GA_Duplicate(int g_a, char* array_name);
 extern void          GA_Elem_divide(int g_a, int g_b, int g_c);
 extern void          GA_Elem_divide_patch(int g_a,int *alo,int *ahi, int g_b,int *blo,int *bhi,int g_c,int *clo,int *chi);
+extern void          GA_Elem_fused(int g_c, int nops, int ops[], int nin, int g_in[], void *consts);
 extern void          GA_Elem_maximum(int g_a, int g_b, int g_c);
 extern void          GA_Elem_maximum_patch(int g_a,int *alo,int *ahi, int g_b,int *blo,int *bhi,int g_c,int *clo,int *chi);
 extern void          GA_Elem_minimum(int g_a, int g_b, int g_c);
@@ -101,6 +104,7 @@ extern int           GA_Memory_limited(void);
 extern void          GA_Merge_mirrored(int g_a);
 extern void          GA_Nblock(int g_a, int *nblock);
 extern int           GA_Ndim(int g_a);
+extern long          GA_Next_task(int counter);
 extern int           GA_Nnodes(void);
 extern int           GA_Nodeid(void);
 extern void          GA_Norm1(int g_a, double *nm);
@@ -136,7 +140,9 @@ extern void          GA_Print_stats(void);
 extern void          GA_Randomize(int g_a, void *value);
 extern void          GA_Recip(int g_a);
 extern void          GA_Recip_patch(int g_a,int *lo, int *hi);
+extern void          GA_Reduce_fused(int nred, int ops[], int g_x[], int g_y[], void *result);
 extern void          GA_Register_stack_memory(void * (*ext_alloc)(size_t, int, char *), void (*ext_free)(void *));
+extern void          GA_Reset_counter(int counter);
 extern void          GA_Scale_cols(int g_a, int g_v);
 extern void          GA_Scale(int g_a, void *value); 
 extern void          GA_Scale_rows(int g_a, int g_v);
@@ -155,17 +161,22 @@ extern void          GA_Set_ghost_corner_flag(int g_a, int flag);
 extern void          GA_Set_ghosts(int g_a, int width[]);
 extern void          GA_Set_irreg_distr(int g_a, int map[], int block[]);
 extern void          GA_Set_irreg_flag(int g_a, int flag);
+extern void          GA_Set_merge_dirty(int g_a, int flag);
 extern void          GA_Set_memory_limit(size_t limit);
 extern void          GA_Set_memory_dev(int g_a, char *device);
 extern void          GA_Set_pgroup(int g_a, int p_handle);
 extern void          GA_Set_restricted(int g_a, int list[], int size);
 extern void          GA_Set_restricted_range(int g_a, int lo_proc, int hi_proc);
 extern void          GA_Set_property(int g_a, char *property);
+extern void          GA_Set_read_cache_size(int g_a, size_t size);
 extern void          GA_Unset_property(int g_a);
 extern void          GA_Sgemm(char ta, char tb, int m, int n, int k, float alpha, int g_a, int g_b, float beta, int g_c );
 extern void          GA_Shift_diagonal(int g_a, void *c);
 extern int           GA_Solve(int g_a, int g_b);
 extern int           GA_Spd_invert(int g_a);
+extern void          GA_Sort(int g_a);
+extern void          GA_Sort_kv(int g_a, int g_v);
+extern void          GA_Sort_rank(int g_a, int g_r);
 extern void          GA_Step_bound_info(int g_xx, int g_vv, int g_xxll, int g_xxuu, void *boundmin, void *wolfemin, void *boundmax);
 extern void          GA_Step_bound_info_patch(int g_xx, int *xxlo, int *xxhi, int g_vv, int *vvlo, int *vvhi, int g_xxll, int *xxlllo, int *xxllhi, int g_xxuu, int *xxuulo, int *xxuuhi, void *boundmin, void *wolfemin, void *boundmax);
 extern void          GA_Step_max(int g_a, int g_b, void *step);
@@ -178,6 +189,8 @@ extern int           GA_Total_blocks(int g_a);
 extern void          GA_Transpose(int g_a, int g_b);
 extern void          GA_Unlock(int mutex);
 extern void          GA_Update_ghosts(int g_a);
+extern void          GA_Update_ghosts_start(int g_a);
+extern void          GA_Update_ghosts_wait(int g_a);
 extern int           GA_Uses_fapi(void);
 extern int           GA_Uses_ma(void);
 extern int           GA_Uses_proc_grid(int g_a);
@@ -211,11 +224,13 @@ extern int           NGA_Create(int type,int ndim,int dims[], char *name, int ch
 extern int           NGA_Create(int type,int ndim,int dims[], char *name, int chunk[]);
 extern int           NGA_Create_irreg_config(int type,int ndim,int dims[],char *name, int block[], int map[], int p_handle);
 extern int           NGA_Create_irreg(int type,int ndim,int dims[],char *name, int block[], int map[]);
+extern int           NGA_Create_plan(int g_a, int lo[], int hi[], int ld[]);
 extern int           NGA_Create_handle(void);
 extern int           NGA_Deallocate(int g_a); 
 extern int           NGA_Deregister_type(int type);
 extern void          NGA_Destroy(int g_a);
 extern int           NGA_Destroy_mutexes(void);
+extern void          NGA_Destroy_plan(int plan);
 extern double        NGA_Ddot_patch(int g_a, char t_a, int alo[], int ahi[], int g_b, char t_b, int blo[], int bhi[]);
 extern void          NGA_Dgop(double x[], int n, char *op);
 extern void          NGA_Distribution(int g_a, int iproc, int lo[], int hi[]); 
@@ -299,6 +314,12 @@ extern int           NGA_Pgroup_split(int grp_id, int num_group);
 extern int           NGA_Pgroup_split_irreg(int grp_id, int color);
 extern void          NGA_Pgroup_sync(int grp_id);
 extern void          NGA_Pgroup_zgop(int grp, DoubleComplex x[], int n, char *op);
+extern void          NGA_Plan_acc(int plan, void *buf, void *alpha);
+extern void          NGA_Plan_get(int plan, void *buf);
+extern void          NGA_Plan_nbacc(int plan, void *buf, void *alpha, ga_nbhdl_t* nbhandle);
+extern void          NGA_Plan_nbget(int plan, void *buf, ga_nbhdl_t* nbhandle);
+extern void          NGA_Plan_nbput(int plan, void *buf, ga_nbhdl_t* nbhandle);
+extern void          NGA_Plan_put(int plan, void *buf);
 extern void          NGA_Print_patch(int g_a, int lo[], int hi[], int pretty);
 extern void          NGA_Proc_topology(int g_a, int proc, int coord[]);
 extern void          NGA_Put(int g_a, int lo[], int hi[], void* buf, int ld[]); 
@@ -339,6 +360,7 @@ extern void          NGA_Set_memory_limit(size_t limit);
 extern void          NGA_Set_memory_dev(int g_a, char *device);
 extern void          NGA_Set_pgroup(int g_a, int p_handle);
 extern void          NGA_Set_property(int g_a, char *property);
+extern void          NGA_Set_read_cache_size(int g_a, size_t size);
 extern void          NGA_Set_restricted(int g_a, int list[], int size);
 extern void          NGA_Set_restricted_range(int g_a, int lo_proc, int hi_proc);
 extern void          NGA_Strided_acc(int g_a, int lo[], int hi[], int skip[], void* buf, int ld[], void *alpha); 
@@ -352,6 +374,8 @@ extern void          NGA_Unset_property(int g_a);
 extern void          NGA_Update_ghosts(int g_a);
 extern int           NGA_Update_ghost_dir(int g_a, int dimension, int idir, int flag);
 extern void          NGA_Update_ghosts_nb(int g_a, ga_nbhdl_t *nbhandle);
+extern void          NGA_Update_ghosts_start(int g_a);
+extern void          NGA_Update_ghosts_wait(int g_a);
 extern int           NGA_Uses_ma(void);
 extern int           NGA_Uses_proc_grid(int g_a);
 extern int           NGA_Valid_handle(int g_a);
@@ -412,6 +436,7 @@ extern int           NGA_Create_ghosts_irreg64(int type,int ndim,int64_t dims[],
 extern int           NGA_Create_ghosts_irreg_config64(int type,int ndim,int64_t dims[], int64_t width[], char *name, int64_t nblock[], int64_t map[], int p_handle);
 extern int           NGA_Create_irreg64(int type,int ndim,int64_t dims[],char *name, int64_t block[], int64_t map[]);
 extern int           NGA_Create_irreg_config64(int type,int ndim,int64_t dims[],char *name, int64_t block[], int64_t map[], int p_handle);
+extern int           NGA_Create_plan64(int g_a, int64_t lo[], int64_t hi[], int64_t ld[]);
 extern double        NGA_Ddot_patch64(int g_a, char t_a, int64_t alo[], int64_t ahi[], int g_b, char t_b, int64_t blo[], int64_t bhi[]);
 extern void          NGA_Distribution64(int g_a, int iproc, int64_t lo[], int64_t hi[]);
 extern float         NGA_Fdot_patch64(int g_a, char t_a, int64_t alo[], int64_t ahi[], int g_b, char t_b, int64_t blo[], int64_t bhi[]);
@@ -4,6 +4,8 @@
 #include "macommon.h"
 
 #define GA_MAX_DIM 7
+/* deprecated: no longer used, the read cache is sized with
+   GA_Set_read_cache_size */
 #define GA_MAX_CACHE 10
 
 #define GA_VERSION_MAJOR 5
@@ -29,4 +31,26 @@
 #define F_REAL     MT_F_REAL
 #define F_SCPL     MT_F_SCPL
 
+/* operators of fused elementwise programs (ga_elem_fused) */
+#define GA_EOP_LOAD   1
+#define GA_EOP_CONST  2
+#define GA_EOP_ADD    3
+#define GA_EOP_SUB    4
+#define GA_EOP_MUL    5
+#define GA_EOP_DIV    6
+#define GA_EOP_MAX    7
+#define GA_EOP_MIN    8
+#define GA_EOP_ABS    9
+#define GA_EOP_NEG   10
+#define GA_EOP_RECIP 11
+
+/* reductions of fused reductions (ga_reduce_fused) */
+#define GA_ROP_SUM    1
+#define GA_ROP_DOT    2
+#define GA_ROP_ASUM   3
+#define GA_ROP_SUMSQ  4
+#define GA_ROP_AMAX   5
+#define GA_ROP_MAX    6
+#define GA_ROP_MIN    7
+
 #endif /* GACOMMON_H_ */
@@ -32,7 +32,7 @@
  * storing data in global arrays (not temporary buffers!)  */
 #define AVOID_MA_STORAGE
 
-/* maxiumum accesses stored for read cache*/
-#define MAXCACHE GA_MAX_CACHE
+/* default number of bytes per array that can be held in the read cache */
+#define READ_CACHE_SIZE 67108864
  
 #endif /* _GACONFIG_H */
@@ -2919,6 +2919,344 @@ void pnga_update_ghosts_nb(Integer g_a, Integer *nbhandle)
   return;
 }
 
+/* layout of the flag memory of each process used by ghost plans */
+#define GPLAN_READY 0
+#define GPLAN_DONE  1
+
+/*\ FREE THE PERSISTENT GHOST EXCHANGE PLAN OF AN ARRAY. COLLECTIVE ON THE
+ *  GROUP OF THE ARRAY IF THE PLAN HOLDS FLAG MEMORY
+\*/
+void gai_ghost_plan_free(Integer handle)
+{
+  gai_ghost_plan_t *plan = GA[handle].gplan;
+  Integer grp_me;
+  if (plan == NULL) return;
+  if (plan->pending && !plan->fallback) nga_wait_internal(&plan->nbhandle);
+  if (plan->flags != NULL) {
+    grp_me = GAme;
+    if (plan->p_handle > 0)
+      grp_me = PGRP_LIST[plan->p_handle].map_proc_list[GAme];
+#ifdef MSG_COMMS_MPI
+    if (plan->p_handle > 0) {
+      ARMCI_Free_group(plan->flags[grp_me],
+          &PGRP_LIST[plan->p_handle].group);
+    } else
+#endif
+      ARMCI_Free(plan->flags[grp_me]);
+    free(plan->flags);
+  }
+  if (plan->seg) free(plan->seg);
+  if (plan->nbr) free(plan->nbr);
+  free(plan);
+  GA[handle].gplan = NULL;
+}
+
+/*\ COMPUTE THE TRANSFERS OF A GHOST EXCHANGE PLAN. EVERY FACE, EDGE AND
+ *  CORNER OF THE LOCAL BLOCK (ONLY FACES IF CORNER UPDATES ARE TURNED OFF)
+ *  IS FILLED BY ONE STRIDED GET FROM THE INTERIOR OF ITS NEIGHBOR, USING
+ *  THE SAME GEOMETRY AS pnga_update_ghosts_nb
+\*/
+static void gai_ghost_plan_segments(Integer g_a, gai_ghost_plan_t *plan)
+{
+  Integer idx, ipx, np, handle=GA_OFFSET + g_a, proc_rem;
+  Integer ntot, mask[MAXDIM];
+  Integer size, ndim, i, itmp, nmask;
+  Integer width[MAXDIM], dims[MAXDIM];
+  Integer lo_loc[MAXDIM], hi_loc[MAXDIM];
+  Integer plo_loc[MAXDIM], phi_loc[MAXDIM];
+  Integer tlo_rem[MAXDIM], thi_rem[MAXDIM];
+  Integer plo_rem[MAXDIM];
+  Integer ld_loc[MAXDIM], ld_rem[MAXDIM];
+  logical mask0;
+  Integer p_handle = GA[handle].p_handle;
+  Integer me = GAme;
+  Integer *_ga_map = NULL;
+  Integer *_ga_proclist = NULL;
+  gai_ghost_seg_t *seg;
+
+  if (p_handle > 0) me = PGRP_LIST[p_handle].map_proc_list[GAme];
+  size = GA[handle].elemsize;
+  ndim = GA[handle].ndim;
+  for (idx=0; idx < ndim; idx++) {
+    width[idx] = (Integer)GA[handle].width[idx];
+    dims[idx] = (Integer)GA[handle].dims[idx];
+  }
+  ntot = 1;
+  for (idx=0; idx < ndim; idx++) ntot *= 3;
+
+  if (plan->seg) free(plan->seg);
+  if (plan->nbr) free(plan->nbr);
+  plan->seg = (gai_ghost_seg_t*)malloc(ntot*sizeof(gai_ghost_seg_t));
+  plan->nbr = (int*)malloc(3*ntot*sizeof(int));
+  if (!plan->seg || !plan->nbr)
+    pnga_error("ga_update_ghosts_start: malloc failed",ntot);
+  plan->nseg = 0;
+  plan->nnbr = 0;
+  plan->corner_flag = GA[handle].corner_flag;
+
+  _ga_map = malloc((GAnproc*2*MAXDIM+1)*sizeof(Integer));
+  if(!_ga_map) pnga_error("ga_update_ghosts_start:malloc failed (_ga_map)",0);
+  _ga_proclist = malloc(GAnproc*sizeof(Integer));
+  if(!_ga_proclist)
+    pnga_error("ga_update_ghosts_start:malloc failed (_ga_proclist)",0);
+
+  pnga_distribution(g_a,me,lo_loc,hi_loc);
+
+  for (ipx=0; ipx < ntot; ipx++) {
+    /* Convert ipx to corresponding mask values, skip the mask of all
+       zeros, blocks of zero width and, without corners, everything but
+       faces */
+    itmp = ipx;
+    mask0 = TRUE;
+    nmask = 0;
+    for (idx = 0; idx < ndim; idx++) {
+      i = itmp%3;
+      mask[idx] = i-1;
+      if (mask[idx] != 0) {
+        mask0 = FALSE;
+        nmask++;
+        if (width[idx] == 0) break;
+      }
+      itmp = (itmp-i)/3;
+    }
+    if (mask0 || idx < ndim) continue;
+    if (!plan->corner_flag && nmask > 1) continue;
+
+    /* find the data that fills this block, wrapping around the
+       boundaries of the array */
+    for (idx = 0; idx < ndim; idx++) {
+      if (mask[idx] == 0) {
+        tlo_rem[idx] = lo_loc[idx];
+        thi_rem[idx] = hi_loc[idx];
+      } else if (mask[idx] == -1) {
+        if (lo_loc[idx] > 1) {
+          tlo_rem[idx] = lo_loc[idx]-width[idx];
+          thi_rem[idx] = lo_loc[idx]-1;
+        } else {
+          tlo_rem[idx] = dims[idx]-width[idx]+1;
+          thi_rem[idx] = dims[idx];
+        }
+      } else {
+        if (hi_loc[idx] < dims[idx]) {
+          tlo_rem[idx] = hi_loc[idx] + 1;
+          thi_rem[idx] = hi_loc[idx] + width[idx];
+        } else {
+          tlo_rem[idx] = 1;
+          thi_rem[idx] = width[idx];
+        }
+      }
+    }
+    if (!pnga_locate_region(g_a, tlo_rem, thi_rem, _ga_map,
+       _ga_proclist, &np)) ga_RegionError(pnga_ndim(g_a),
+       tlo_rem, thi_rem, g_a);
+    proc_rem = _ga_proclist[0];
+    pnga_distribution(g_a, proc_rem, tlo_rem, thi_rem);
+    for (idx = 0; idx < ndim; idx++) {
+      if (mask[idx] == 0) {
+        plo_loc[idx] = width[idx];
+        phi_loc[idx] = hi_loc[idx]-lo_loc[idx]+width[idx];
+        plo_rem[idx] = plo_loc[idx];
+      } else if (mask[idx] == -1) {
+        plo_loc[idx] = 0;
+        phi_loc[idx] = width[idx]-1;
+        plo_rem[idx] = thi_rem[idx]-tlo_rem[idx]+1;
+      } else {
+        plo_loc[idx] = hi_loc[idx]-lo_loc[idx]+width[idx]+1;
+        phi_loc[idx] = hi_loc[idx]-lo_loc[idx]+2*width[idx];
+        plo_rem[idx] = width[idx];
+      }
+    }
+
+    seg = &plan->seg[plan->nseg++];
+    gam_LocationWithGhosts(me, handle, plo_loc, &seg->ptr_loc, ld_loc);
+    gam_LocationWithGhosts(proc_rem, handle, plo_rem, &seg->ptr_rem, ld_rem);
+    gam_setstride(ndim, size, ld_loc, ld_rem, seg->stride_rem,
+                  seg->stride_loc);
+    gam_ComputeCount(ndim, plo_loc, phi_loc, seg->count);
+    seg->count[0] *= size;
+    seg->grp_proc = (int)proc_rem;
+    if (p_handle >= 0) {
+      proc_rem = PGRP_LIST[p_handle].inv_map_proc_list[proc_rem];
+    }
+    seg->proc = (int)proc_rem;
+
+    /* neighbors are signalled once per step with the number of transfers
+       they take part in */
+    for (i=0; i<plan->nnbr; i++) {
+      if (plan->nbr[3*i] == seg->proc) break;
+    }
+    if (i == plan->nnbr) {
+      plan->nbr[3*i] = seg->proc;
+      plan->nbr[3*i+1] = seg->grp_proc;
+      plan->nbr[3*i+2] = 0;
+      plan->nnbr++;
+    }
+    plan->nbr[3*i+2]++;
+  }
+
+  free(_ga_map);
+  free(_ga_proclist);
+}
+
+/*\ RETURN THE GHOST EXCHANGE PLAN OF AN ARRAY, BUILDING IT ON FIRST USE.
+ *  COLLECTIVE ON THE GROUP OF THE ARRAY THE FIRST TIME
+\*/
+static gai_ghost_plan_t* gai_ghost_plan_get(Integer g_a)
+{
+  Integer handle = GA_OFFSET + g_a;
+  Integer idx, nblocks, grp_me, p_handle = GA[handle].p_handle;
+  gai_ghost_plan_t *plan = GA[handle].gplan;
+  int status;
+
+  if (plan != NULL) {
+    /* corner flag changed since the segments were computed */
+    if (!plan->fallback && plan->corner_flag != GA[handle].corner_flag)
+      gai_ghost_plan_segments(g_a, plan);
+    return plan;
+  }
+
+  plan = (gai_ghost_plan_t*)malloc(sizeof(gai_ghost_plan_t));
+  if (!plan) pnga_error("ga_update_ghosts_start: malloc failed",g_a);
+  plan->pending = 0;
+  plan->nseg = 0;
+  plan->seg = NULL;
+  plan->nnbr = 0;
+  plan->nbr = NULL;
+  plan->flags = NULL;
+  plan->ready = 0;
+  plan->done = 0;
+  plan->p_handle = (int)p_handle;
+  plan->corner_flag = GA[handle].corner_flag;
+  GA[handle].gplan = plan;
+
+  /* the plan needs a regular distribution in which every process of the
+     group owns a block that is at least as wide as the ghost cells */
+  nblocks = 1;
+  for (idx=0; idx<GA[handle].ndim; idx++) nblocks *= GA[handle].nblock[idx];
+  plan->fallback = GA[handle].distr_type != REGULAR
+    || pnga_is_mirrored(g_a) || GA[handle].num_rstrctd > 0
+    || nblocks != pnga_pgroup_nnodes(p_handle)
+    || !gai_check_ghost_distr(g_a);
+  if (plan->fallback) return plan;
+
+  gai_ghost_plan_segments(g_a, plan);
+
+  grp_me = GAme;
+  if (p_handle > 0) grp_me = PGRP_LIST[p_handle].map_proc_list[GAme];
+  plan->flags = (long**)malloc(nblocks*sizeof(long*));
+  if (!plan->flags) pnga_error("ga_update_ghosts_start: malloc failed",nblocks);
+#ifdef MSG_COMMS_MPI
+  if (p_handle > 0) {
+    status = ARMCI_Malloc_group((void**)plan->flags,
+        (armci_size_t)(2*sizeof(long)), &PGRP_LIST[p_handle].group);
+  } else
+#endif
+    status = ARMCI_Malloc((void**)plan->flags, (armci_size_t)(2*sizeof(long)));
+  if (status || plan->flags[grp_me] == NULL)
+    pnga_error("ga_update_ghosts_start: ARMCI_Malloc failed",GAme);
+  plan->flags[grp_me][GPLAN_READY] = 0;
+  plan->flags[grp_me][GPLAN_DONE] = 0;
+  pnga_pgroup_sync(p_handle);
+  return plan;
+}
+
+/* add the number of shared transfers to a counter on every neighbor of
+ * the plan. Neighbor relations are symmetric, so every process receives
+ * as many signals per step as it has transfers. */
+static void gai_ghost_plan_signal(gai_ghost_plan_t *plan, int which)
+{
+  int i;
+  long old;
+  for (i=0; i<plan->nnbr; i++) {
+    ARMCI_Rmw(ARMCI_FETCH_AND_ADD_LONG, &old,
+        &plan->flags[plan->nbr[3*i+1]][which], plan->nbr[3*i+2],
+        plan->nbr[3*i]);
+  }
+}
+
+/* wait until the local counter has received every expected signal. The
+ * counter is read with a remote atomic so that runtimes which need the
+ * caller to drive progress still deliver the signals of the neighbors */
+static void gai_ghost_plan_poll(gai_ghost_plan_t *plan, int which,
+    long expect)
+{
+  long value;
+  Integer grp_me = GAme;
+  if (plan->p_handle > 0)
+    grp_me = PGRP_LIST[plan->p_handle].map_proc_list[GAme];
+  do {
+    ARMCI_Rmw(ARMCI_FETCH_AND_ADD_LONG, &value,
+        &plan->flags[grp_me][which], 0, (int)GAme);
+  } while (value < expect);
+}
+
+/*\ START UPDATING THE GHOST CELLS OF A GLOBAL ARRAY WITH A PERSISTENT PLAN.
+ *  The neighbor geometry is computed once per array. Each process tells
+ *  its neighbors that its interior is ready, waits only for the ready
+ *  signals of its own neighbors and then posts a non-blocking strided get
+ *  for every face, edge and corner. The call returns without waiting for
+ *  the data, so computation that does not touch the ghost cells can
+ *  overlap the exchange. The locally held interior must not be modified
+ *  until ga_update_ghosts_wait returns, since neighbors may be reading it.
+\*/
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_update_ghosts_start = pnga_update_ghosts_start
+#endif
+void pnga_update_ghosts_start(Integer g_a)
+{
+  Integer handle = GA_OFFSET + g_a;
+  gai_ghost_plan_t *plan;
+  int i, ndim;
+
+  if (!pnga_has_ghosts(g_a)) return;
+  if (GA[handle].gplan != NULL && GA[handle].gplan->pending)
+    pnga_error("ga_update_ghosts_start: update already started",g_a);
+  plan = gai_ghost_plan_get(g_a);
+  plan->pending = 1;
+  if (plan->fallback) {
+    pnga_update_ghosts(g_a);
+    return;
+  }
+
+  ndim = (int)GA[handle].ndim;
+  gai_ghost_plan_signal(plan, GPLAN_READY);
+  plan->ready += plan->nseg;
+  gai_ghost_plan_poll(plan, GPLAN_READY, plan->ready);
+
+  ga_init_nbhandle(&plan->nbhandle);
+  for (i=0; i<plan->nseg; i++) {
+    gai_ghost_seg_t *seg = &plan->seg[i];
+    ARMCI_NbGetS(seg->ptr_rem, seg->stride_rem, seg->ptr_loc,
+        seg->stride_loc, seg->count, ndim-1, seg->proc,
+        (armci_hdl_t*)get_armci_nbhandle(&plan->nbhandle));
+  }
+}
+
+/*\ COMPLETE A GHOST CELL UPDATE STARTED WITH ga_update_ghosts_start. On
+ *  return the ghost cells hold the data of the neighbors and no neighbor
+ *  is still reading the local interior.
+\*/
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_update_ghosts_wait = pnga_update_ghosts_wait
+#endif
+void pnga_update_ghosts_wait(Integer g_a)
+{
+  Integer handle = GA_OFFSET + g_a;
+  gai_ghost_plan_t *plan;
+
+  if (!pnga_has_ghosts(g_a)) return;
+  plan = GA[handle].gplan;
+  if (plan == NULL || !plan->pending)
+    pnga_error("ga_update_ghosts_wait: no update was started",g_a);
+  plan->pending = 0;
+  if (plan->fallback) return;
+
+  nga_wait_internal(&plan->nbhandle);
+  gai_ghost_plan_signal(plan, GPLAN_DONE);
+  plan->done += plan->nseg;
+  gai_ghost_plan_poll(plan, GPLAN_DONE, plan->done);
+}
+
 /*\ UPDATE GHOST CELLS OF GLOBAL ARRAY ALONG ONE SIDE OF ARRAY
 \*/
 #if HAVE_SYS_WEAK_ALIAS_PRAGMA
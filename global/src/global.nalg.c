@@ -416,6 +416,23 @@ Integer bndim, bdims[MAXDIM];
      pnga_error("Both arrays must be defined on same group",0L);
    me = pnga_pgroup_nodeid(a_grp);
 
+   /* real arrays of the same shape are reduced by the fused engine */
+   if (Type != C_DCPL && Type != C_SCPL &&
+       !pnga_is_mirrored(g_a) && !pnga_is_mirrored(g_b)) {
+     pnga_inquire(g_a, &type, &andim, adims);
+     pnga_inquire(g_b, &atype, &bndim, bdims);
+     if(type != Type) pnga_error("type not correct", g_a);
+     if(atype != Type) pnga_error("type not correct", g_b);
+     if (andim == bndim) {
+       for (i=0; i<andim; i++) if (adims[i] != bdims[i]) break;
+       if (i == andim) {
+         Integer op = GA_ROP_DOT;
+         pnga_reduce_fused(1, &op, &g_a, &g_b, value);
+         return;
+       }
+     }
+   }
+
    /* Check to see if either GA is block cyclic distributed */
    num_blocks_a = pnga_total_blocks(g_a);
    num_blocks_b = pnga_total_blocks(g_b);
@@ -905,42 +922,88 @@ int local_sync_begin,local_sync_end;
 }
 
 
-static 
-void snga_local_transpose(Integer type, char *ptra, Integer n, Integer stride, char *ptrb)
+/* Local transpose of an m x n column-major block a (leading dimension
+   lda) into the n x m block b (leading dimension ldb).  The block is
+   halved along its longer side until the pieces are at most TR_TILE
+   elements on each side, which keeps both the rows read and the columns
+   written in cache at every level without tuning for any of them.  Full
+   tiles are copied with fixed trip count loops that the compiler can
+   unroll and vectorize. */
+#define TR_TILE 8       /* side of the innermost tile */
+#define TR_CHUNK 256    /* rows of the source given to one thread */
+#define TR_PROW 1024    /* rows of a local block transposed at a time */
+#define TR_PCOL 512     /* columns of a local block transposed at a time */
+
+#define TR_KERNEL(NAME,T)                                                  \
+static void gai_transpose_tile_##NAME(char *a, Integer lda, char *b,       \
+        Integer ldb, Integer m, Integer n)                                 \
+{                                                                          \
+    T *pa = (T*)a, *pb = (T*)b;                                            \
+    Integer i, j;                                                          \
+    if (m == TR_TILE && n == TR_TILE) {                                    \
+        for (j=0; j<TR_TILE; j++)                                          \
+            for (i=0; i<TR_TILE; i++) pb[j+i*ldb] = pa[i+j*lda];           \
+    } else {                                                               \
+        for (j=0; j<n; j++)                                                \
+            for (i=0; i<m; i++) pb[j+i*ldb] = pa[i+j*lda];                 \
+    }                                                                      \
+}
+
+TR_KERNEL(int,int)
+TR_KERNEL(long,long)
+TR_KERNEL(longlong,long long)
+TR_KERNEL(float,float)
+TR_KERNEL(double,double)
+TR_KERNEL(scpl,SingleComplex)
+TR_KERNEL(dcpl,DoubleComplex)
+
+
+static void gai_transpose_rec(Integer type, Integer size, char *a,
+        Integer lda, char *b, Integer ldb, Integer m, Integer n)
 {
-Integer i;
-    switch(type){
-
-       case C_INT:
-            for(i = 0; i< n; i++, ptrb+= stride) 
-               *(int*)ptrb= ((int*)ptra)[i];
-            break;
-       case C_DCPL:
-            for(i = 0; i< n; i++, ptrb+= stride) 
-               *(DoubleComplex*)ptrb= ((DoubleComplex*)ptra)[i];
-            break;
-       case C_SCPL:
-            for(i = 0; i< n; i++, ptrb+= stride) 
-               *(SingleComplex*)ptrb= ((SingleComplex*)ptra)[i];
-            break;
-       case C_DBL:
-            for(i = 0; i< n; i++, ptrb+= stride) 
-               *(double*)ptrb= ((double*)ptra)[i];
-            break;
-       case C_FLOAT:
-            for(i = 0; i< n; i++, ptrb+= stride)
-               *(float*)ptrb= ((float*)ptra)[i];
-            break;      
-       case C_LONG:
-            for(i = 0; i< n; i++, ptrb+= stride)
-               *(long*)ptrb= ((long*)ptra)[i];
-            break;                                 
-       case C_LONGLONG:
-            for(i = 0; i< n; i++, ptrb+= stride)
-               *(long long*)ptrb= ((long long*)ptra)[i];
-            break;                                 
-       default: pnga_error("bad type:",type);
+  Integer h;
+
+  if (m <= TR_TILE && n <= TR_TILE) {
+    switch (type) {
+      case C_INT: gai_transpose_tile_int(a,lda,b,ldb,m,n); break;
+      case C_LONG: gai_transpose_tile_long(a,lda,b,ldb,m,n); break;
+      case C_LONGLONG: gai_transpose_tile_longlong(a,lda,b,ldb,m,n); break;
+      case C_FLOAT: gai_transpose_tile_float(a,lda,b,ldb,m,n); break;
+      case C_DBL: gai_transpose_tile_double(a,lda,b,ldb,m,n); break;
+      case C_SCPL: gai_transpose_tile_scpl(a,lda,b,ldb,m,n); break;
+      case C_DCPL: gai_transpose_tile_dcpl(a,lda,b,ldb,m,n); break;
+      default: pnga_error("bad type:",type);
     }
+    return;
+  }
+  /* split on a tile boundary so that the pieces are full tiles */
+  if (m >= n) {
+    h = ((m/2 + TR_TILE - 1)/TR_TILE)*TR_TILE;
+    gai_transpose_rec(type, size, a, lda, b, ldb, h, n);
+    gai_transpose_rec(type, size, a+h*size, lda, b+h*ldb*size, ldb, m-h, n);
+  } else {
+    h = ((n/2 + TR_TILE - 1)/TR_TILE)*TR_TILE;
+    gai_transpose_rec(type, size, a, lda, b, ldb, m, h);
+    gai_transpose_rec(type, size, a+h*lda*size, lda, b+h*size, ldb, m, n-h);
+  }
+}
+
+
+static void gai_local_transpose(Integer type, char *a, Integer lda,
+        char *b, Integer ldb, Integer m, Integer n)
+{
+  Integer size = GAsizeofM(type);
+  Integer nchunk = (m + TR_CHUNK - 1)/TR_CHUNK;
+  Integer k;
+
+#ifdef _OPENMP
+# pragma omp parallel for schedule(static) if(nchunk > 1 && m*n > 65536)
+#endif
+  for (k=0; k<nchunk; k++) {
+    Integer r = k*TR_CHUNK;
+    gai_transpose_rec(type, size, a+r*size, lda, b+r*ldb*size, ldb,
+        GA_MIN(TR_CHUNK, m-r), n);
+  }
 }
 
 
@@ -949,14 +1012,11 @@ Integer i;
 #endif
 void pnga_transpose(Integer g_a, Integer g_b)
 {
-Integer me = pnga_nodeid();
-Integer _ld[MAXDIM-1];
-Integer nproc = pnga_nnodes(); 
 Integer atype, btype, andim, adims[MAXDIM], bndim, bdims[MAXDIM];
-Integer lo[2],hi[2],ld[2];
+Integer lo[2],hi[2],ld[2],blo[2],bhi[2];
 int local_sync_begin,local_sync_end;
-Integer num_blocks_a;
-char *ptr_tmp, *ptr_a;
+int direct;
+char *ptr_a;
 _iterator_hdl hdl;
 
     
@@ -972,155 +1032,54 @@ _iterator_hdl hdl;
     if(bndim != 2 || andim != 2) pnga_error("dimension must be 2",0);
     if(atype != btype ) pnga_error("array type mismatch ", 0L);
 
-#if 1
+    /* pieces of g_b owned by this process are transposed into place */
+    direct = pnga_total_blocks(g_b) < 0;
+    if (direct) pnga_distribution(g_b, pnga_nodeid(), blo, bhi);
+
+    /* Each local block of g_a is transposed TR_PROW x TR_PCOL elements at
+       a time.  Pieces owned by others go out with a nonblocking put from
+       one of two buffers, so the next piece is transposed while the
+       previous one is in flight. */
     pnga_local_iterator_init(g_a, &hdl);
     while (pnga_local_iterator_next(&hdl,lo,hi,&ptr_a,ld)) {
-      Integer idx;
-      Integer block_dims[MAXDIM];
-      Integer nelem, lob[2], hib[2], nrow, ncol;
-      int i, size=GAsizeofM(atype);
-
-      nelem = (hi[0]-lo[0]+1)*(hi[1]-lo[1]+1);
-      ptr_tmp = (char *) ga_malloc(nelem, atype, "transpose_tmp");
-
-      nrow   = hi[0] -lo[0]+1;
-      ncol   = hi[1] -lo[1]+1; 
-      nelem  = nrow*ncol;
-      lob[0] = lo[1]; lob[1] = lo[0];
-      hib[0] = hi[1]; hib[1] = hi[0];
-      for(i = 0; i < ncol; i++){
-        char *ptr = ptr_tmp + i*size;
-
-        snga_local_transpose(atype, ptr_a, nrow, ncol*size, ptr);
-        ptr_a += ld[0]*size;
-      }
-      pnga_put(g_b, lob, hib, ptr_tmp ,&ncol);
-      ga_free(ptr_tmp);
-    }
-#else
-    num_blocks_a = pnga_total_blocks(g_a);
-
-    if (num_blocks_a < 0) {
-      pnga_distribution(g_a, me, lo, hi);
-
-      if(lo[0]>0){
-        Integer nelem, lob[2], hib[2], nrow, ncol;
-        int i, size=GAsizeofM(atype);
-
-        nrow   = hi[0] -lo[0]+1;
-        ncol   = hi[1] -lo[1]+1; 
-        nelem  = nrow*ncol;
-        lob[0] = lo[1]; lob[1] = lo[0];
-        hib[0] = hi[1]; hib[1] = hi[0];
-
-        /* allocate memory for transposing elements locally */
-        ptr_tmp = (char *) ga_malloc(nelem, atype, "transpose_tmp");
-
-        /* get access to local data */
-        pnga_access_ptr(g_a, lo, hi, &ptr_a, _ld);
-
-        for(i = 0; i < ncol; i++){
-          char *ptr = ptr_tmp + i*size;
-
-          snga_local_transpose(atype, ptr_a, nrow, ncol*size, ptr);
-          ptr_a += _ld[0]*size;
-        }
-
-        pnga_release(g_a, lo, hi); 
-
-        pnga_put(g_b, lob, hib, ptr_tmp ,&ncol);
-
-        ga_free(ptr_tmp);
-      }
-    } else {
-      Integer idx;
-      Integer blocks[MAXDIM], block_dims[MAXDIM];
-      Integer nelem, lob[2], hib[2], nrow, ncol;
-      int i, size=GAsizeofM(atype);
-
-      /* allocate memory for transposing elements locally */
-      pnga_get_block_info(g_a, blocks, block_dims);
-
-      /* Simple block-cyclic data distribution */
-      nelem = block_dims[0]*block_dims[1];
-      ptr_tmp = (char *) ga_malloc(nelem, atype, "transpose_tmp");
-      if (!pnga_uses_proc_grid(g_a)) {
-        for (idx = me; idx < num_blocks_a; idx += nproc) {
-          pnga_distribution(g_a, idx, lo, hi);
-          pnga_access_block_ptr(g_a, idx, &ptr_a, _ld);
-
-          nrow   = hi[0] -lo[0]+1;
-          ncol   = hi[1] -lo[1]+1; 
-          nelem  = nrow*ncol;
-          lob[0] = lo[1]; lob[1] = lo[0];
-          hib[0] = hi[1]; hib[1] = hi[0];
-          for(i = 0; i < ncol; i++){
-            char *ptr = ptr_tmp + i*size;
-
-            snga_local_transpose(atype, ptr_a, nrow, ncol*size, ptr);
-            ptr_a += _ld[0]*size;
-          }
-          pnga_put(g_b, lob, hib, ptr_tmp ,&ncol);
-
-          pnga_release_update_block(g_a, idx);
-        }
-      } else {
-        /* Uses scalapack block-cyclic data distribution */
-        Integer chk;
-        Integer proc_index[MAXDIM], index[MAXDIM];
-        Integer topology[MAXDIM], ichk;
-
-        pnga_get_proc_index(g_a, me, proc_index);
-        pnga_get_proc_index(g_a, me, index);
-        pnga_get_block_info(g_a, blocks, block_dims);
-        pnga_get_proc_grid(g_a, topology);
-        /* Verify that processor has data */
-        ichk = 1;
-        for (i=0; i<andim; i++) {
-          if (index[i]<0 || index[i] >= blocks[i]) {
-            ichk = 0;
-          }
-        }
-
-        if (ichk) {
-          pnga_access_block_grid_ptr(g_a, index, &ptr_a, _ld);
-          while (index[andim-1] < blocks[andim-1]) {
-            /* find bounding coordinates of block */
-            chk = 1;
-            for (i = 0; i < andim; i++) {
-              lo[i] = index[i]*block_dims[i]+1;
-              hi[i] = (index[i] + 1)*block_dims[i];
-              if (hi[i] > adims[i]) hi[i] = adims[i];
-              if (hi[i] < lo[i]) chk = 0;
-            }
-            if (chk) {
-              pnga_access_block_grid_ptr(g_a, index, &ptr_a, _ld);
-              nrow   = hi[0] -lo[0]+1;
-              ncol   = hi[1] -lo[1]+1; 
-              nelem  = nrow*ncol;
-              lob[0] = lo[1]; lob[1] = lo[0];
-              hib[0] = hi[1]; hib[1] = hi[0];
-              for(i = 0; i < ncol; i++){
-                char *ptr = ptr_tmp + i*size;
-                snga_local_transpose(atype, ptr_a, nrow, block_dims[0]*size, ptr);
-                ptr_a += _ld[0]*size;
-              }
-              pnga_put(g_b, lob, hib, ptr_tmp ,&block_dims[0]);
-              pnga_release_update_block_grid(g_a, index);
-            }
-            /* increment index to get next block on processor */
-            index[0] += topology[0];
-            for (i = 0; i < andim; i++) {
-              if (index[i] >= blocks[i] && i<andim-1) {
-                index[i] = proc_index[i];
-                index[i+1] += topology[i+1];
-              }
+      Integer size = GAsizeofM(atype);
+      Integer nrow = hi[0]-lo[0]+1, ncol = hi[1]-lo[1]+1;
+      Integer prow = GA_MIN(nrow, TR_PROW), pcol = GA_MIN(ncol, TR_PCOL);
+      Integer lob[2], hib[2], ldb, m, n, i, j, nbhdl[2];
+      int multi = prow < nrow || pcol < ncol;
+      int k = 0, pending[2] = {0, 0};
+      char *buf[2] = {NULL, NULL}, *ptr_b;
+
+      for (j = 0; j < ncol; j += pcol) {
+        for (i = 0; i < nrow; i += prow) {
+          m = GA_MIN(prow, nrow-i);
+          n = GA_MIN(pcol, ncol-j);
+          lob[0] = lo[1]+j; hib[0] = lob[0]+n-1;
+          lob[1] = lo[0]+i; hib[1] = lob[1]+m-1;
+          if (direct && lob[0] >= blo[0] && hib[0] <= bhi[0]
+              && lob[1] >= blo[1] && hib[1] <= bhi[1]) {
+            pnga_access_ptr(g_b, lob, hib, &ptr_b, &ldb);
+            gai_local_transpose(atype, ptr_a+(i+j*ld[0])*size, ld[0],
+                ptr_b, ldb, m, n);
+            pnga_release_update(g_b, lob, hib);
+          } else {
+            if (buf[k] == NULL) {
+              buf[k] = (char*)ga_malloc(prow*pcol, atype, "transpose_tmp");
+            } else if (pending[k]) {
+              pnga_nbwait(&nbhdl[k]);
             }
+            gai_local_transpose(atype, ptr_a+(i+j*ld[0])*size, ld[0],
+                buf[k], n, m, n);
+            pnga_nbput(g_b, lob, hib, buf[k], &n, &nbhdl[k]);
+            pending[k] = 1;
+            if (multi) k = 1-k;
           }
         }
       }
-      ga_free(ptr_tmp);
+      for (k = 1; k >= 0; k--) {
+        if (pending[k]) pnga_nbwait(&nbhdl[k]);
+        if (buf[k] != NULL) ga_free(buf[k]);
+      }
     }
-#endif
     if(local_sync_end)pnga_sync();
 }
@@ -313,6 +313,19 @@ int i;
                    GAbytes.gattot - GAbytes.gatloc,
                    GAbytes.rditot - GAbytes.rdiloc);
 
+     if(GAstat.numrch || GAstat.numrcp || GAstat.numrcm) {
+        printf("read cache:              hit      partial  miss     evicted\n");
+        printf("                         %.2e %.2e %.2e %.2e\n",
+                   (double)GAstat.numrch, (double)GAstat.numrcp,
+                   (double)GAstat.numrcm, (double)GAstat.numrce);
+     }
+
+     if(GAstat.maxnbh) {
+        printf("non-blocking handles:    max      forced\n");
+        printf("                         %.2e %.2e\n",
+                   (double)GAstat.maxnbh, (double)GAstat.numnbf);
+     }
+
      printf("Max memory consumed for GA by this process: %ld bytes\n",GAstat.maxmem);
      if(GAstat.numser)
         printf("Number of requests serviced: %ld\n",GAstat.numser);
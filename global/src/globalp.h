@@ -94,6 +94,12 @@ struct ga_stat_t {
          long   numacc_procs;
          long   numsca_procs;
          long   numgat_procs;
+         long   numrch;
+         long   numrcp;
+         long   numrcm;
+         long   numrce;
+         long   numnbf;
+         long   maxnbh;
 };
 
 struct ga_bytes_t{ 
@@ -1056,6 +1056,249 @@ static void gai_matmul_irreg(transa, transb, alpha, beta, atype,
   /* ----------------------------------------- */
 }
 
+/*\ read the dynamic matmul settings from the environment
+ *  GA_MATMUL_DYNAMIC=1 turns the engine on, GA_MATMUL_PIPELINE_DEPTH sets the
+ *  number of panels kept in flight
+\*/
+static int gai_matmul_dynamic_depth()
+{
+  char *value;
+  int depth = MATMUL_PIPELINE_DEPTH;
+
+  value = getenv("GA_MATMUL_DYNAMIC");
+  if (NULL == value || 0 == atoi(value)) return 0;
+  value = getenv("GA_MATMUL_PIPELINE_DEPTH");
+  if (NULL != value) {
+    depth = atoi(value);
+    if (depth < 1 || depth > MATMUL_MAX_PIPELINE_DEPTH)
+      pnga_error("GA_MATMUL_PIPELINE_DEPTH out of range",depth);
+  }
+  return depth;
+}
+
+/*\ claim the next (i,j,k) panel, starting with the caller's own C block and
+ *  then stealing from the others. Returns 0 once every counter is drained.
+\*/
+static int gai_matmul_next_task(Integer g_cnt, matmul_owner_t *owners,
+                                Integer nowners, Integer *victim,
+                                Integer *ntried, Integer *task)
+{
+  Integer subscript;
+
+  while (*ntried < nowners) {
+    if (owners[*victim].ntasks > 0) {
+      subscript = *victim + 1;
+      *task = pnga_read_inc(g_cnt, &subscript, 1);
+      if (*task < owners[*victim].ntasks) return 1;
+    }
+    *victim = (*victim+1)%nowners;
+    (*ntried)++;
+  }
+  return 0;
+}
+
+/*\ claim a panel for a pipeline stage and issue the gets for its A and B
+\*/
+static void gai_matmul_fill_stage(matmul_stage_t *st, Integer g_cnt,
+                                  matmul_owner_t *owners, Integer nowners,
+                                  Integer *victim, Integer *ntried,
+                                  Integer Ichunk, Integer Jchunk,
+                                  Integer Kchunk, Integer k,
+                                  Integer g_a, Integer ailo, Integer ajlo,
+                                  Integer g_b, Integer bilo, Integer bjlo,
+                                  Integer cilo, Integer cjlo,
+                                  char *transa, char *transb)
+{
+  matmul_owner_t *own;
+  Integer task, ib, jb, kb, i0, i1, j0, j1, k0, k1;
+
+  st->active = gai_matmul_next_task(g_cnt, owners, nowners, victim, ntried,
+                                    &task);
+  if (!st->active) return;
+
+  /* tasks of a block are numbered k fastest, then i, then j */
+  own = &owners[*victim];
+  kb = task%own->nblk[2];
+  ib = (task/own->nblk[2])%own->nblk[0];
+  jb = task/(own->nblk[2]*own->nblk[0]);
+
+  i0 = own->lo[0] + ib*Ichunk; i1 = GA_MIN(own->hi[0], i0+Ichunk-1);
+  j0 = own->lo[1] + jb*Jchunk; j1 = GA_MIN(own->hi[1], j0+Jchunk-1);
+  k0 = kb*Kchunk;              k1 = GA_MIN(k-1, k0+Kchunk-1);
+
+  st->chunkA.lo[0] = i0; st->chunkA.hi[0] = i1;
+  st->chunkA.lo[1] = k0; st->chunkA.hi[1] = k1;
+  st->chunkA.dim[0] = i1-i0+1; st->chunkA.dim[1] = k1-k0+1;
+  st->chunkB.lo[0] = k0; st->chunkB.hi[0] = k1;
+  st->chunkB.lo[1] = j0; st->chunkB.hi[1] = j1;
+  st->chunkB.dim[0] = k1-k0+1; st->chunkB.dim[1] = j1-j0+1;
+
+  st->clo[0] = cilo+i0; st->chi[0] = cilo+i1;
+  st->clo[1] = cjlo+j0; st->chi[1] = cjlo+j1;
+
+  GET_BLOCK(g_a, &st->chunkA, st->a, transa, ailo, ajlo, &st->adim, &st->nbA);
+  GET_BLOCK(g_b, &st->chunkB, st->b, transb, bilo, bjlo, &st->bdim, &st->nbB);
+}
+
+/*\ Dynamic matmul. Every process publishes the (i,j,k) panels of its own C
+ *  block through a shared task counter. Processes drain their own counter
+ *  first and then steal panels from the others, so nobody idles while work
+ *  is left. Gets of A and B run a configurable number of panels ahead of
+ *  the dgemm, and the C tiles go back through nonblocking accumulates.
+ *
+ *  Returns 0, on every process, if the pipeline does not fit in memory; the
+ *  caller then falls back to the static algorithms.
+\*/
+static int gai_matmul_dynamic(transa, transb, alpha, beta, atype,
+			      g_a, ailo, aihi, ajlo, ajhi,
+			      g_b, bilo, bihi, bjlo, bjhi,
+			      g_c, cilo, cihi, cjlo, cjhi,
+			      Ichunk, Kchunk, Jchunk, need_scaling, depth)
+
+     Integer g_a, ailo, aihi, ajlo, ajhi;    /* patch of g_a */
+     Integer g_b, bilo, bihi, bjlo, bjhi;    /* patch of g_b */
+     Integer g_c, cilo, cihi, cjlo, cjhi;    /* patch of g_c */
+     Integer Ichunk, Kchunk, Jchunk, atype;
+     void    *alpha, *beta;
+     char    *transa, *transb;
+     short int need_scaling;
+     int depth;
+{
+  Integer a_grp = pnga_get_pgroup(g_a);
+  Integer grp_me = pnga_pgroup_nodeid(a_grp);
+  Integer nowners = pnga_pgroup_nnodes(a_grp);
+  Integer m = aihi-ailo+1, n = bjhi-bjlo+1, k = ajhi-ajlo+1;
+  Integer clo[2], chi[2], lo[2], hi[2];
+  Integer g_cnt, max_chunk, stage_elems, avail, elems, p, victim, ntried;
+  Integer nprocs = nowners, one = 1, size = GAsizeofM(atype);
+  Integer factor = sizeof(DoubleComplex)/size;
+  DoubleComplex ONE, *buf;
+  SingleComplex ONE_CF;
+  void *scale;
+  matmul_owner_t *owners;
+  matmul_stage_t stages[MATMUL_MAX_PIPELINE_DEPTH];
+  int s, active;
+  double temp;
+
+  /* size panels so that every process has about MINTASKS of them to hand
+     out, but never larger than the static algorithm would use */
+  temp = (k*(double)(m*(double)n)) / (MINTASKS * nowners);
+  max_chunk = (Integer)pow(temp, (1.0/3.0) );
+  if (max_chunk < MIN_CHUNK_SIZE) max_chunk = MIN_CHUNK_SIZE;
+  Ichunk = GA_MIN(Ichunk, max_chunk);
+  Jchunk = GA_MIN(Jchunk, max_chunk);
+  Kchunk = GA_MIN(Kchunk, max_chunk);
+
+  /* shrink the pipeline until it fits, consistently across the group */
+  stage_elems = Ichunk*Kchunk + Kchunk*Jchunk + Ichunk*Jchunk + 3*factor;
+  avail = pnga_memory_avail_type(atype);
+  if ((Integer)(avail*0.9) < depth*stage_elems)
+    depth = (int)((avail*0.9)/stage_elems);
+  elems = depth;
+  pnga_pgroup_gop(a_grp, pnga_type_f2c(MT_F_INT), &elems, (Integer)1, "min");
+  depth = (int)elems;
+  if (depth < 1) return 0;
+
+  buf = (DoubleComplex*) ga_malloc(depth*stage_elems, atype,
+                                   "GA matmul pipeline");
+  for (s=0; s<depth; s++) {
+    stages[s].a = buf;
+    stages[s].b = stages[s].a + (Ichunk*Kchunk)/factor + 1;
+    stages[s].c = stages[s].b + (Kchunk*Jchunk)/factor + 1;
+    buf = stages[s].c + (Ichunk*Jchunk)/factor + 1;
+    stages[s].active = 0;
+    stages[s].acc_pending = 0;
+    init_task_list(&stages[s].chunkA);
+    init_task_list(&stages[s].chunkB);
+  }
+
+  /* panels of every process' C block, relative to the C patch */
+  owners = (matmul_owner_t*)malloc(nowners*sizeof(matmul_owner_t));
+  if (!owners) pnga_error("gai_matmul_dynamic: malloc failed", nowners);
+  for (p=0; p<nowners; p++) {
+    pnga_distribution(g_c, p, lo, hi);
+    owners[p].lo[0] = GA_MAX(lo[0], cilo) - cilo;
+    owners[p].hi[0] = GA_MIN(hi[0], cihi) - cilo;
+    owners[p].lo[1] = GA_MAX(lo[1], cjlo) - cjlo;
+    owners[p].hi[1] = GA_MIN(hi[1], cjhi) - cjlo;
+    owners[p].ntasks = 0;
+    if (owners[p].lo[0] > owners[p].hi[0] ||
+        owners[p].lo[1] > owners[p].hi[1]) continue;
+    owners[p].nblk[0] = (owners[p].hi[0]-owners[p].lo[0])/Ichunk + 1;
+    owners[p].nblk[1] = (owners[p].hi[1]-owners[p].lo[1])/Jchunk + 1;
+    owners[p].nblk[2] = (k-1)/Kchunk + 1;
+    owners[p].ntasks = owners[p].nblk[0]*owners[p].nblk[1]*owners[p].nblk[2];
+  }
+
+  /* one task counter per process, each living on its process */
+  if (!pnga_create_config(pnga_type_f2c(MT_F_INT), 1, &nprocs,
+        "matmul task counters", &one, a_grp, &g_cnt))
+    pnga_error("gai_matmul_dynamic: could not create task counters", 0L);
+  pnga_zero(g_cnt);
+
+  /* every panel is accumulated, so C must start out as beta*C */
+  if (need_scaling == UNSET) {
+    clo[0] = cilo; clo[1] = cjlo;
+    chi[0] = cihi; chi[1] = cjhi;
+    pnga_zero_patch(g_c, clo, chi);
+  }
+
+  ONE.real =1.;    ONE.imag =0.;
+  ONE_CF.real =1.; ONE_CF.imag =0.;
+  if (atype == C_FLOAT || atype == C_SCPL) scale = &ONE_CF;
+  else scale = &ONE;
+
+  /*************************************************
+   * Fill the pipeline, then keep it full: wait for
+   * the oldest stage, multiply, accumulate and
+   * refill it with the next panel.
+   *************************************************/
+  victim = grp_me; ntried = 0;
+  active = 0;
+  for (s=0; s<depth; s++) {
+    gai_matmul_fill_stage(&stages[s], g_cnt, owners, nowners, &victim,
+                          &ntried, Ichunk, Jchunk, Kchunk, k,
+                          g_a, ailo, ajlo, g_b, bilo, bjlo, cilo, cjlo,
+                          transa, transb);
+    if (stages[s].active) active++;
+  }
+
+  s = 0;
+  while (active) {
+    matmul_stage_t *st = &stages[s];
+    s = (s+1)%depth;
+    if (!st->active) continue;
+
+    WAIT_GET_BLOCK(&st->nbA);
+    WAIT_GET_BLOCK(&st->nbB);
+    if (st->acc_pending) pnga_nbwait(&st->nbC);
+
+    st->cdim = st->chunkA.dim[0];
+    GAI_DGEMM(atype, transa, transb, st->chunkA.dim[0], st->chunkB.dim[1],
+              st->chunkA.dim[1], alpha, st->a, st->adim, st->b, st->bdim,
+              st->c, st->cdim);
+    pnga_nbacc(g_c, st->clo, st->chi, st->c, &st->cdim, scale, &st->nbC);
+    st->acc_pending = 1;
+
+    gai_matmul_fill_stage(st, g_cnt, owners, nowners, &victim,
+                          &ntried, Ichunk, Jchunk, Kchunk, k,
+                          g_a, ailo, ajlo, g_b, bilo, bjlo, cilo, cjlo,
+                          transa, transb);
+    if (!st->active) active--;
+  }
+
+  for (s=0; s<depth; s++) {
+    if (stages[s].acc_pending) pnga_nbwait(&stages[s].nbC);
+  }
+
+  /* all accumulates must land before C is released to the caller */
+  pnga_pgroup_sync(a_grp);
+  pnga_destroy(g_cnt);
+  free(owners);
+  ga_free(stages[0].a);
+  return 1;
+}
+
 #if DEBUG_
 
 static void check_result(cond, transa, transb, alpha, beta, atype,
@@ -1312,6 +1555,7 @@ void pnga_matmul(transa, transb, alpha, beta,
     Integer c_grp=pnga_get_pgroup(g_c);
     Integer numblocks;
     Integer clo[2], chi[2];
+    int dynamic_depth = 0;
 
     /* OPTIMIZATIONS FLAGS. To unset an optimization, replace SET by UNSET) */
     CYCLIC_DISTR_OPT_FLAG  = UNSET;
@@ -1410,6 +1654,9 @@ void pnga_matmul(transa, transb, alpha, beta,
 #    endif
     }
 
+    /* mirrored arrays have no single owner to steal panels from */
+    if(!pnga_is_mirrored(g_c)) dynamic_depth = gai_matmul_dynamic_depth();
+
     /* if block cyclic, then use regular algorithm. This is turned on for now
      * to test block cyclic */ 
     numblocks = pnga_total_blocks(g_c);
@@ -1436,36 +1683,63 @@ void pnga_matmul(transa, transb, alpha, beta,
 #endif
     }
     
-    /****************************************************************
-     * Get the memory (i.e.static or dynamic) for temporary buffers 
-     ****************************************************************/
-
     /* to skip accumulate and exploit data locality:
        get chunks according to "C" matrix distribution*/
     pnga_distribution(g_a, me, loA, hiA);
     pnga_distribution(g_b, me, loB, hiB);
     pnga_distribution(g_c, me, loC, hiC);
 
-       {
-	  Integer elems, factor=sizeof(DoubleComplex)/GAsizeofM(atype);
-	  short int nbuf=1;
-	  DoubleComplex *tmp = NULL;
-
-	  Ichunk = GA_MIN( (hiC[0]-loC[0]+1), (hiA[0]-loA[0]+1) );
-	  Jchunk = GA_MIN( (hiC[1]-loC[1]+1), (hiB[1]-loB[1]+1) );
-	  Kchunk = GA_MIN( (hiA[1]-loA[1]+1), (hiB[0]-loB[0]+1) );
+    Ichunk = GA_MIN( (hiC[0]-loC[0]+1), (hiA[0]-loA[0]+1) );
+    Jchunk = GA_MIN( (hiC[1]-loC[1]+1), (hiB[1]-loB[1]+1) );
+    Kchunk = GA_MIN( (hiA[1]-loA[1]+1), (hiB[0]-loB[0]+1) );
 
 #if KCHUNK_OPTIMIZATION /*works great for m=1000,n=1000,k=4000 kinda cases*/
-	  pnga_distribution(g_a, me, loC, hiC);
-	  Kchunk = hiC[1]-loC[1]+1;
-	  pnga_distribution(g_b, me, loC, hiC);
-	  Kchunk = GA_MIN(Kchunk, (hiC[0]-loC[0]+1));
+    pnga_distribution(g_a, me, loC, hiC);
+    Kchunk = hiC[1]-loC[1]+1;
+    pnga_distribution(g_b, me, loC, hiC);
+    Kchunk = GA_MIN(Kchunk, (hiC[0]-loC[0]+1));
 #endif
 
-	  /* Just to avoid divide by zero error */
-          if(Ichunk<=0) Ichunk = 1;
-          if(Jchunk<=0) Jchunk = 1;
-          if(Kchunk<=0) Kchunk = 1;
+    /* Just to avoid divide by zero error */
+    if(Ichunk<=0) Ichunk = 1;
+    if(Jchunk<=0) Jchunk = 1;
+    if(Kchunk<=0) Kchunk = 1;
+
+    /** check if there is a need for scaling the data. 
+        Note: if beta=0, then need_scaling=0  */
+    if(atype==C_DCPL){
+       if((((DoubleComplex*)beta)->real == 0) && 
+	  (((DoubleComplex*)beta)->imag ==0)) need_scaling =0;} 
+    else if(atype==C_SCPL){
+       if((((SingleComplex*)beta)->real == 0) && 
+	  (((SingleComplex*)beta)->imag ==0)) need_scaling =0;} 
+    else if(atype==C_DBL){
+       if(*(DoublePrecision *)beta == 0) need_scaling =0;}
+    else if( *(float*)beta ==0) need_scaling =0;
+
+    clo[0] = cilo; clo[1] = cjlo;
+    chi[0] = cihi; chi[1] = cjhi;
+    if(need_scaling) pnga_scale_patch(g_c, clo, chi, beta);
+
+    /* dynamic engine, if requested. It sizes and allocates its own
+       pipeline and declines, on every process, if that does not fit */
+    if(dynamic_depth &&
+       gai_matmul_dynamic(transa, transb, alpha, beta, atype,
+			  g_a, ailo, aihi, ajlo, ajhi,
+			  g_b, bilo, bihi, bjlo, bjhi,
+			  g_c, cilo, cihi, cjlo, cjhi,
+			  Ichunk, Kchunk, Jchunk, need_scaling,
+			  dynamic_depth)) {
+       /* C is complete */
+    }
+    else {
+       /****************************************************************
+	* Get the memory (i.e.static or dynamic) for temporary buffers 
+	****************************************************************/
+       {
+	  Integer elems, factor=sizeof(DoubleComplex)/GAsizeofM(atype);
+	  short int nbuf=1;
+	  DoubleComplex *tmp = NULL;
 
 	  {
 	     Integer irreg=0;
@@ -1508,22 +1782,6 @@ void pnga_matmul(transa, transb, alpha, beta,
 	  
 	  c_ar[0] = c = tmp + (Kchunk*Jchunk)/factor + 1;
        }
-       
-       /** check if there is a need for scaling the data. 
-	   Note: if beta=0, then need_scaling=0  */
-       if(atype==C_DCPL){
-	  if((((DoubleComplex*)beta)->real == 0) && 
-	     (((DoubleComplex*)beta)->imag ==0)) need_scaling =0;} 
-       else if(atype==C_SCPL){
-	  if((((SingleComplex*)beta)->real == 0) && 
-	     (((SingleComplex*)beta)->imag ==0)) need_scaling =0;} 
-       else if(atype==C_DBL){
-	  if(*(DoublePrecision *)beta == 0) need_scaling =0;}
-       else if( *(float*)beta ==0) need_scaling =0;
-
-       clo[0] = cilo; clo[1] = cjlo;
-       chi[0] = cihi; chi[1] = cjhi;
-       if(need_scaling) pnga_scale_patch(g_c, clo, chi, beta);
 
        /********************************************************************
 	* Parallel Matrix Multiplication Starts Here.
@@ -1556,12 +1814,13 @@ void pnga_matmul(transa, transb, alpha, beta,
 				g_c, cilo, cihi, cjlo, cjhi,
 				Ichunk, Kchunk, Jchunk, a_ar, b_ar, c_ar, 
 				need_scaling, irregular);
-     }
+	  }
        }
 	     
        a = a_ar[0];
        if(use_armci_memory == SET) ARMCI_Free_local(a);
        else ga_free(a);
+    }
        
 #if DEBUG_
        Integer grp_me;
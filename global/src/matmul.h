@@ -39,6 +39,28 @@ typedef struct {
   short int do_put;
 }task_list_t;
 
+/* dynamic matmul: default and max number of (i,j,k) panels in flight */
+#define MATMUL_PIPELINE_DEPTH 3
+#define MATMUL_MAX_PIPELINE_DEPTH 16
+
+/* C block of one process, as seen by the dynamic matmul task counters */
+typedef struct {
+  Integer lo[2], hi[2]; /* C patch owned by the process, 0-based in patch */
+  Integer nblk[3];      /* number of i, j and k panels */
+  Integer ntasks;
+}matmul_owner_t;
+
+/* one stage of the dynamic matmul prefetch pipeline */
+typedef struct {
+  int active;
+  task_list_t chunkA, chunkB;
+  Integer clo[2], chi[2];       /* C tile the stage accumulates into */
+  Integer adim, bdim, cdim;
+  Integer nbA, nbB, nbC;
+  short int acc_pending;
+  DoubleComplex *a, *b, *c;
+}matmul_stage_t;
+
 #define VECTORCHECK(rank,dims,dim1,dim2, ilo, ihi, jlo, jhi) \
   if(rank>2)  pnga_error("rank is greater than 2",rank); \
   else if(rank==2) {dim1=dims[0]; dim2=dims[1];} \
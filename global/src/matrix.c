@@ -931,9 +931,16 @@ void pnga_norm_infinity(Integer g_a, double *nm)
   }
 
 #if 1
-  pnga_local_iterator_init(g_a, &hdl);
-  while (pnga_local_iterator_next(&hdl,lo,hi,&ptr,&ld)) {
-    sgai_norm_infinity_block(g_a, ptr, lo, hi, ld, type, ndim, dims, buf);
+  if (type != C_DCPL && type != C_SCPL) {
+    /* real arrays are reduced by the fused engine (reduce_fused.c) */
+    Integer op = GA_ROP_AMAX;
+    _ga_sync_begin = 0;
+    pnga_reduce_fused(1, &op, &g_a, &g_a, buf);
+  } else {
+    pnga_local_iterator_init(g_a, &hdl);
+    while (pnga_local_iterator_next(&hdl,lo,hi,&ptr,&ld)) {
+      sgai_norm_infinity_block(g_a, ptr, lo, hi, ld, type, ndim, dims, buf);
+    }
   }
 #else
   num_blocks_a = pnga_total_blocks(g_a);
@@ -991,33 +998,20 @@ void pnga_norm_infinity(Integer g_a, double *nm)
 #endif
 
 
-  /*calculate the global value buf[j] for each column */
+  /*calculate the global value of complex arrays; real arrays were
+    combined by pnga_reduce_fused */
   switch (type)
   {
-    case C_INT:
-      armci_msg_igop (&isum, 1, "max");
-      break;
-    case C_DBL:
-      armci_msg_dgop (&dsum, 1, "max");
-      break;
     case C_DCPL:
       dval = zsum.real;
       armci_msg_dgop (&dval, 1, "max");
       zsum.real = dval;
       break;
-    case C_FLOAT:
-      armci_msg_fgop (&fsum, 1, "max");
-      break;
     case C_SCPL:
       fval = csum.real;
       armci_msg_fgop (&fval, 1, "max");
       csum.real = fval;
       break;
-    case C_LONG:
-      armci_msg_lgop (&lsum, 1, "max");
-      break;
-    default:
-      pnga_error("ga_norm_infinity_: wrong data type ", type);
   }
 
   /*evaluate the norm infinity for the matrix g_a */
@@ -1240,9 +1234,16 @@ void pnga_norm1(Integer g_a, double *nm)
   }
 
 #if 1
-  pnga_local_iterator_init(g_a, &hdl);
-  while (pnga_local_iterator_next(&hdl,lo,hi,&ptr,&ld)) {
-    sgai_norm1_block(g_a, ptr, lo, hi, ld, type, ndim, dims, buf);
+  if (type != C_DCPL && type != C_SCPL) {
+    /* real arrays are reduced by the fused engine (reduce_fused.c) */
+    Integer op = GA_ROP_ASUM;
+    _ga_sync_begin = 0;
+    pnga_reduce_fused(1, &op, &g_a, &g_a, buf);
+  } else {
+    pnga_local_iterator_init(g_a, &hdl);
+    while (pnga_local_iterator_next(&hdl,lo,hi,&ptr,&ld)) {
+      sgai_norm1_block(g_a, ptr, lo, hi, ld, type, ndim, dims, buf);
+    }
   }
 #else
   num_blocks_a = pnga_total_blocks(g_a);
@@ -1299,33 +1300,20 @@ void pnga_norm1(Integer g_a, double *nm)
   }
 #endif
 
-  /*calculate the global value buf[j] for each column */
+  /*calculate the global value of complex arrays; real arrays were
+    combined by pnga_reduce_fused */
   switch (type)
   {
-    case C_INT:
-      armci_msg_igop (&isum, 1, "+");
-      break;
-    case C_DBL:
-      armci_msg_dgop (&dsum, 1, "+");
-      break;
     case C_DCPL:
       dval = zsum.real;
       armci_msg_dgop (&dval, 1, "+");
       zsum.real = dval;
       break;
-    case C_FLOAT:
-      armci_msg_fgop (&fsum, 1, "+");
-      break;
     case C_SCPL:
       fval = csum.real;
       armci_msg_fgop (&fval, 1, "+");
       csum.real = fval;
       break;
-    case C_LONG:
-      armci_msg_lgop (&lsum, 1, "+");
-      break;
-    default:
-      pnga_error("ga_norm1_: wrong data type ", type);
   }
 
   /*evaluate the norm1 for the matrix g_a */
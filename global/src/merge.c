@@ -0,0 +1,296 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+/*
+ * module: merge.c
+ * description: implements the merge of the node copies of mirrored
+ * arrays. Every process of a node owns one block of the node copy, and
+ * the processes that own the same block on different nodes reduce it
+ * together, so the reduction work of a node is spread over all of its
+ * processes. Each block is reduced in segments of GA_MERGE_SEGMENT bytes
+ * with up to GA_MERGE_DEPTH segments in flight, which keeps the temporary
+ * memory of the message-passing library small and overlaps the transfers
+ * of consecutive segments. Optionally, the segments written by one-sided
+ * operations are tracked so that a merge only reduces the segments that
+ * were written since the previous merge.
+ *
+ * DISCLAIMER
+ *
+ * This material was prepared as an account of work sponsored by an
+ * agency of the United States Government.  Neither the United States
+ * Government nor the United States Department of Energy, nor Battelle,
+ * nor any of their employees, MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR
+ * ASSUMES ANY LEGAL LIABILITY OR RESPONSIBILITY FOR THE ACCURACY,
+ * COMPLETENESS, OR USEFULNESS OF ANY INFORMATION, APPARATUS, PRODUCT,
+ * SOFTWARE, OR PROCESS DISCLOSED, OR REPRESENTS THAT ITS USE WOULD NOT
+ * INFRINGE PRIVATELY OWNED RIGHTS.
+ *
+ *
+ * ACKNOWLEDGMENT
+ *
+ * This software and its documentation were produced with United States
+ * Government support under Contract Number DE-AC06-76RLO-1830 awarded by
+ * the United States Department of Energy.  The United States Government
+ * retains a paid-up non-exclusive, irrevocable worldwide license to
+ * reproduce, prepare derivative works, perform publicly and display
+ * publicly by or for the US Government, including the right to
+ * distribute to other US Government contractors.
+ */
+#if HAVE_STDIO_H
+#   include <stdio.h>
+#endif
+#if HAVE_STRING_H
+#   include <string.h>
+#endif
+#if HAVE_STDLIB_H
+#   include <stdlib.h>
+#endif
+#include "global.h"
+#include "globalp.h"
+#include "base.h"
+#include "ga-papi.h"
+#include "ga-wapi.h"
+
+#ifdef MSG_COMMS_MPI
+#   include <mpi.h>
+#   include "ga-mpi.h"
+#endif
+
+/* default segment size in bytes and number of segments in flight */
+#define MERGE_SEGMENT 1048576
+#define MERGE_DEPTH 4
+
+/* upper bound on the elements of a segment, so that complex segments still
+ * fit into the int counts of the message-passing layer */
+#define MERGE_MAX_ELEMS (1L<<29)
+
+static C_Long merge_env(const char *name, C_Long dflt)
+{
+  char *value = getenv(name);
+  C_Long ival;
+  if (value == NULL) return dflt;
+  ival = (C_Long)atol(value);
+  return ival > 0 ? ival : dflt;
+}
+
+/* offset of element sub from the first element of the block [lo,hi] in the
+ * local memory of the block, which is padded with ghost cells */
+static C_Long merge_offset(Integer handle, Integer *sub, Integer *lo,
+    Integer *hi)
+{
+  Integer d;
+  C_Long offset = 0, factor = 1;
+  for (d=0; d<GA[handle].ndim; d++) {
+    offset += (C_Long)(sub[d]-lo[d])*factor;
+    factor *= (C_Long)(hi[d]-lo[d]+1+2*GA[handle].width[d]);
+  }
+  return offset;
+}
+
+/* number of elements from the first to the last element of block k of a
+ * node copy, or zero if the block is empty */
+static C_Long merge_span(Integer g_a, Integer k, Integer *lo, Integer *hi)
+{
+  Integer handle = GA_OFFSET + g_a;
+  Integer d;
+  pnga_distribution(g_a, k, lo, hi);
+  for (d=0; d<GA[handle].ndim; d++) {
+    if (hi[d] < lo[d]) return 0;
+  }
+  return merge_offset(handle, hi, lo, hi) + 1;
+}
+
+/**
+ *  Free the dirty segment map of an array
+ */
+void gai_merge_free(Integer handle)
+{
+  gai_merge_t *mg = GA[handle].merge;
+  if (mg == NULL) return;
+  free(mg->seg_base);
+  free(mg->dirty);
+  free(mg);
+  GA[handle].merge = NULL;
+}
+
+/**
+ *  Record that the patch [lo,hi] of a mirrored array has been written on
+ *  this process. A NULL lo marks the whole array.
+ */
+void gai_merge_mark(Integer g_a, Integer *lo, Integer *hi)
+{
+  Integer handle = GA_OFFSET + g_a;
+  gai_merge_t *mg = GA[handle].merge;
+  Integer k, d, ndim;
+  Integer blo[MAXDIM], bhi[MAXDIM], plo[MAXDIM], phi[MAXDIM];
+  C_Long first, last, s;
+
+  if (mg == NULL) return;
+  if (lo == NULL) {
+    for (s=0; s<mg->nseg; s++) mg->dirty[s] = 1;
+    return;
+  }
+  ndim = GA[handle].ndim;
+  for (k=0; k<mg->nblock; k++) {
+    if (mg->seg_base[k] == mg->seg_base[k+1]) continue;
+    pnga_distribution(g_a, k, blo, bhi);
+    for (d=0; d<ndim; d++) {
+      plo[d] = lo[d] > blo[d] ? lo[d] : blo[d];
+      phi[d] = hi[d] < bhi[d] ? hi[d] : bhi[d];
+      if (phi[d] < plo[d]) break;
+    }
+    if (d < ndim) continue;
+    first = merge_offset(handle, plo, blo, bhi)/mg->seg_elems;
+    last = merge_offset(handle, phi, blo, bhi)/mg->seg_elems;
+    for (s=first; s<=last; s++) mg->dirty[mg->seg_base[k]+s] = 1;
+  }
+}
+
+/**
+ *  Turn tracking of the segments written between merges of a mirrored
+ *  array on or off. With tracking on, ga_merge_mirrored only adds up the
+ *  segments that were written by put, accumulate, scatter or read-increment
+ *  calls, or released with ga_release_update, on any process since the
+ *  previous merge. Segments that nobody wrote keep their value, which is
+ *  what a full merge computes as long as they are zero, e.g. when the array
+ *  was zeroed before contributions were accumulated into it. Must be called
+ *  by all processes. Has no effect on arrays that are not mirrored.
+ */
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_set_merge_dirty = pnga_set_merge_dirty
+#endif
+
+void pnga_set_merge_dirty(Integer g_a, logical flag)
+{
+  Integer handle = GA_OFFSET + g_a;
+  Integer k, d, lo[MAXDIM], hi[MAXDIM];
+  gai_merge_t *mg;
+  C_Long s;
+
+  ga_check_handleM(g_a, "ga_set_merge_dirty");
+  /* on a single node mirrored arrays are ordinary arrays */
+  if (!pnga_is_mirrored(g_a)) return;
+  if (!flag) {
+    gai_merge_free(handle);
+    return;
+  }
+  if (GA[handle].merge != NULL) return;
+
+  mg = (gai_merge_t*)malloc(sizeof(gai_merge_t));
+  if (!mg) pnga_error("ga_set_merge_dirty: malloc failed",g_a);
+  mg->seg_elems = merge_env("GA_MERGE_SEGMENT",MERGE_SEGMENT)
+    /GA[handle].elemsize;
+  if (mg->seg_elems < 1) mg->seg_elems = 1;
+  if (mg->seg_elems > MERGE_MAX_ELEMS) mg->seg_elems = MERGE_MAX_ELEMS;
+  mg->nblock = 1;
+  for (d=0; d<GA[handle].ndim; d++) mg->nblock *= GA[handle].nblock[d];
+  mg->seg_base = (C_Long*)malloc((mg->nblock+1)*sizeof(C_Long));
+  if (!mg->seg_base) pnga_error("ga_set_merge_dirty: malloc failed",g_a);
+  mg->seg_base[0] = 0;
+  for (k=0; k<mg->nblock; k++) {
+    s = merge_span(g_a, k, lo, hi);
+    mg->seg_base[k+1] = mg->seg_base[k] + (s+mg->seg_elems-1)/mg->seg_elems;
+  }
+  mg->nseg = mg->seg_base[mg->nblock];
+  mg->dirty = (int*)malloc((mg->nseg > 0 ? mg->nseg : 1)*sizeof(int));
+  if (!mg->dirty) pnga_error("ga_set_merge_dirty: malloc failed",mg->nseg);
+  /* nothing is known about earlier writes, so the first merge is full */
+  for (s=0; s<mg->nseg; s++) mg->dirty[s] = 1;
+  GA[handle].merge = mg;
+}
+
+/**
+ *  Add up the node copies of a mirrored array. grp is the group of the
+ *  processes that own the same block on every node.
+ */
+void gai_merge_mirrored(Integer g_a, Integer grp)
+{
+  Integer handle = GA_OFFSET + g_a;
+  Integer type = GA[handle].type;
+  Integer size = GA[handle].elemsize;
+  gai_merge_t *mg = GA[handle].merge;
+  Integer inode, blk, lo[MAXDIM], hi[MAXDIM], ld[MAXDIM];
+  C_Long span, seg, nseg, s, off, len;
+  char *ptr;
+#if defined(MSG_COMMS_MPI) && defined(MPI_VERSION) && (MPI_VERSION >= 3)
+  MPI_Comm comm;
+  MPI_Datatype dtype = MPI_DATATYPE_NULL;
+  MPI_Request *req;
+  int mult = 1, depth, head = 0, nreq = 0;
+#endif
+
+  /* a single copy is already merged */
+  if (pnga_cluster_nnodes() == 1) {
+    if (mg) memset(mg->dirty, 0, mg->nseg*sizeof(int));
+    return;
+  }
+
+  /* a segment is dirty if it was written on any process */
+  if (mg && mg->nseg > 0)
+    pnga_pgroup_gop(pnga_pgroup_get_world(), C_INT, mg->dirty,
+        (Integer)mg->nseg, "max");
+
+  inode = pnga_cluster_nodeid();
+  blk = GAme - pnga_cluster_procid(inode, 0);
+  span = merge_span(g_a, blk, lo, hi);
+  if (span == 0) {
+    if (mg) memset(mg->dirty, 0, mg->nseg*sizeof(int));
+    return;
+  }
+  pnga_access_ptr(g_a, lo, hi, &ptr, ld);
+
+  if (mg) {
+    seg = mg->seg_elems;
+  } else {
+    seg = merge_env("GA_MERGE_SEGMENT",MERGE_SEGMENT)/size;
+    if (seg < 1) seg = 1;
+    if (seg > MERGE_MAX_ELEMS) seg = MERGE_MAX_ELEMS;
+  }
+  nseg = (span+seg-1)/seg;
+
+#if defined(MSG_COMMS_MPI) && defined(MPI_VERSION) && (MPI_VERSION >= 3)
+  switch (type) {
+    case C_INT: dtype = MPI_INT; break;
+    case C_LONG: dtype = MPI_LONG; break;
+    case C_LONGLONG: dtype = MPI_LONG_LONG; break;
+    case C_FLOAT: dtype = MPI_FLOAT; break;
+    case C_DBL: dtype = MPI_DOUBLE; break;
+    case C_SCPL: dtype = MPI_FLOAT; mult = 2; break;
+    case C_DCPL: dtype = MPI_DOUBLE; mult = 2; break;
+    default: pnga_error("ga_merge_mirrored: type not supported",type);
+  }
+  comm = GA_MPI_Comm_pgroup((int)grp);
+  depth = (int)merge_env("GA_MERGE_DEPTH",MERGE_DEPTH);
+  req = (MPI_Request*)malloc(depth*sizeof(MPI_Request));
+  if (!req) pnga_error("ga_merge_mirrored: malloc failed",depth);
+  for (s=0; s<nseg; s++) {
+    if (mg && !mg->dirty[mg->seg_base[blk]+s]) continue;
+    off = s*seg;
+    len = span-off < seg ? span-off : seg;
+    if (nreq == depth) {
+      MPI_Wait(&req[head], MPI_STATUS_IGNORE);
+      head = (head+1)%depth;
+      nreq--;
+    }
+    MPI_Iallreduce(MPI_IN_PLACE, ptr+off*size, (int)(len*mult), dtype,
+        MPI_SUM, comm, &req[(head+nreq)%depth]);
+    nreq++;
+  }
+  while (nreq > 0) {
+    MPI_Wait(&req[head], MPI_STATUS_IGNORE);
+    head = (head+1)%depth;
+    nreq--;
+  }
+  free(req);
+#else
+  for (s=0; s<nseg; s++) {
+    if (mg && !mg->dirty[mg->seg_base[blk]+s]) continue;
+    off = s*seg;
+    len = span-off < seg ? span-off : seg;
+    pnga_pgroup_gop(grp, type, ptr+off*size, (Integer)len, "+");
+  }
+#endif
+
+  if (mg) memset(mg->dirty, 0, mg->nseg*sizeof(int));
+}
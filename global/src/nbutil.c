@@ -13,51 +13,63 @@
 #endif
 #define DEBUG 0
 
-/* WARNING: The maximum value MAX_NUM_NB_HDLS can assume is 256. If it is any larger,
- * the 8-bit field defined in gai_hbhdl_t will exceed its upper limit of 255 in
- * some parts of the nbutil.c code */
-#define MAX_NUM_NB_HDLS 256
-static int nb_max_outstanding = MAX_NUM_NB_HDLS;
+/* Handles are kept in slabs of NB_CHUNK entries that are allocated as needed
+ * and never moved, so links between entries stay valid when a slab is added.
+ * The number of outstanding GA handles is bounded by NB_MAX_HANDLES, by the
+ * width of the index field of gai_nbhdl_t and by GA_NB_MAX_HANDLES, if it is
+ * set. */
+#define NB_CHUNK_BITS 8
+#define NB_CHUNK (1<<NB_CHUNK_BITS)
+#define NB_MAX_HANDLES (1<<16)
 
 /**
  *                      NOTES
- * The non-blocking GA handle indexes into a list of structs that point to a
- * linked list of non-blocking ARMCI calls. The first link in the list is
- * contained in the GA struct. Conversely, each link in the non-blocking list
- * points to the GA handle that contains the head of the list. When a new GA
- * non-blocking call is created, the code looks at the list of GA handles and
- * tries to find one that is not currently being used. If it can't find one, it
- * calls wait on an existing call and recycles that handle for the new call.
+ * The non-blocking GA handle indexes into a table of structs that point to a
+ * linked list of non-blocking ARMCI calls. Conversely, each link in the
+ * non-blocking list points to the GA handle that contains the head of the
+ * list. Free GA handles are kept in a FIFO list and free ARMCI links in a
+ * LIFO list, and both tables grow by a slab when their free list is empty.
  *
- * Similarly, each GA call consists of multiple ARMCI non-blocking calls. The
- * handles for each of these calls are assembled into a list. If no handle is
- * available, the ARMCI_Wait function is called on a handle, freeing it for use.
- * The handle is also removed from the linked list pointed to by the original GA
- * struct. It is possible in this scheme that a GA struct has a linked list that
- * contains no links. When wait of test is called in this case, the struct is
- * marked as inactive and then returns without performing any ARMCI operations.
+ * Every GA handle has a generation that is advanced whenever the handle
+ * completes. The non-blocking handle returned to the user records the
+ * generation it was issued with, so wait or test on a handle whose calls
+ * already completed, and whose entry may have been handed out again, sees a
+ * different generation and returns immediately. Because free handles are
+ * recycled in FIFO order, an entry is only reissued after every other free
+ * entry has been used.
+ *
+ * Only when the maximum number of outstanding GA handles is reached is an
+ * existing request forced to complete. Handles with no outstanding ARMCI
+ * calls, which are kept in a list of their own, are reclaimed first. Forced
+ * completions are counted in the GA statistics.
  */
 
 /* The structure of gai_nbhdl_t (this is our internal handle). It maps directly
- * to a 32-bit integer*/
+ * to the Fortran integer of the build. The generation keeps at least the 24
+ * bits of the original tag, which leaves 4-byte integers one slab of handles */
+#if SIZEOF_F77_INTEGER >= 8
+typedef struct {
+    unsigned int ihdl_index;
+    unsigned int ga_nbgen;
+} gai_nbhdl_t;
+#define NB_INDEX_LIMIT NB_MAX_HANDLES
+#define NB_GEN_MASK 0xffffffffu
+#else
 typedef struct {
     unsigned int ihdl_index:8;
-    unsigned int ga_nbtag:24;
+    unsigned int ga_nbgen:24;
 } gai_nbhdl_t;
+#define NB_INDEX_LIMIT (1<<8)
+#define NB_GEN_MASK 0xffffffu
+#endif
 
 
-/* We create an array of type struct_armci_hdl_t. This list represents the
- * number of available ARMCI non-blocking calls that are available to create
- * non-blocking GA calls. Each element in the armci handle linked list is of
- * type ga_armcihdl_t.
+/* Each element in the armci handle linked list is of type ga_armcihdl_t.
  * handle: int handle or gai_nbhdl_t struct that represents ARMCI handle for
  *         non-blocking call
- * next: pointer to next element in list
+ * next: pointer to next element in list, or in free list
  * previous: pointer to previous element in list
- * ga_hdlarr_index: index that points back to ga_nbhdl_array list.
- *                  This can be used to remove this link from GA linked list if
- *                  this armci request must be cleared to make room for a new
- *                  request.
+ * ga_hdlarr_index: index that points back to the GA handle table.
  * active: indicates that this represents an outstanding ARMCI non-blocking
  * request
  */
@@ -70,49 +82,179 @@ typedef struct struct_armcihdl_t {
 } ga_armcihdl_t;
 
 
-/* We create an array of type ga_nbhdl_array_t. Each of the elements in this
- * array is the head of the armci handle linked list that is associated with
- * each GA call.
+/* Each element of the GA handle table is the head of the armci handle linked
+ * list that is associated with each GA call.
  * ahandle: head node in a linked list of ARMCI handles
  * count: total number of ARMCI handles in linked list
- * ga_nbtag: unique tag that matches tag in handle (gai_nbhdl_t)
- * If count is 0 or ahandle is null, there are no outstanding armci calls
- * associated with this GA handle
+ * ga_nbgen: generation that matches generation in handle (gai_nbhdl_t)
+ * active: handle has been issued and not yet completed
+ * next_free: next entry in the free list
+ * idle: handle is active and has no ARMCI calls
+ * next_idle, prev_idle: neighbors in the list of idle handles
  */
 typedef struct{
     ga_armcihdl_t *ahandle;
     int count;
-    int ga_nbtag;
+    unsigned int ga_nbgen;
     int active;
+    int next_free;
+    int idle;
+    int next_idle;
+    int prev_idle;
 } ga_nbhdl_array_t;
 
+static ga_nbhdl_array_t **ga_ihdl_chunks = NULL;
+static int ga_ihdl_nchunks = 0;
+static int ga_ihdl_free_head = -1;
+static int ga_ihdl_free_tail = -1;
+static int ga_ihdl_idle = -1;
+static int ga_ihdl_nactive = 0;
+
+static ga_armcihdl_t **armci_ihdl_chunks = NULL;
+static int armci_ihdl_nchunks = 0;
+static ga_armcihdl_t *armci_ihdl_free = NULL;
+
+static int nb_max_handles = NB_INDEX_LIMIT;
+static int nb_last_forced = -1;
+
+#define GA_IHDL(i) (&ga_ihdl_chunks[(i)>>NB_CHUNK_BITS][(i)&(NB_CHUNK-1)])
+
+/* number of GA handle table entries */
+#define GA_IHDL_SIZE (ga_ihdl_nchunks*NB_CHUNK)
+
+static void nb_push_free(int idx)
+{
+  GA_IHDL(idx)->next_free = -1;
+  if (ga_ihdl_free_tail < 0) {
+    ga_ihdl_free_head = idx;
+  } else {
+    GA_IHDL(ga_ihdl_free_tail)->next_free = idx;
+  }
+  ga_ihdl_free_tail = idx;
+}
+
+static int nb_pop_free()
+{
+  int idx = ga_ihdl_free_head;
+  if (idx >= 0) {
+    ga_ihdl_free_head = GA_IHDL(idx)->next_free;
+    if (ga_ihdl_free_head < 0) ga_ihdl_free_tail = -1;
+  }
+  return idx;
+}
+
+static void nb_push_idle(int idx)
+{
+  ga_nbhdl_array_t *hdl = GA_IHDL(idx);
+  hdl->idle = 1;
+  hdl->prev_idle = -1;
+  hdl->next_idle = ga_ihdl_idle;
+  if (ga_ihdl_idle >= 0) GA_IHDL(ga_ihdl_idle)->prev_idle = idx;
+  ga_ihdl_idle = idx;
+}
+
+static void nb_remove_idle(int idx)
+{
+  ga_nbhdl_array_t *hdl = GA_IHDL(idx);
+  if (!hdl->idle) return;
+  if (hdl->prev_idle >= 0) {
+    GA_IHDL(hdl->prev_idle)->next_idle = hdl->next_idle;
+  } else {
+    ga_ihdl_idle = hdl->next_idle;
+  }
+  if (hdl->next_idle >= 0) GA_IHDL(hdl->next_idle)->prev_idle = hdl->prev_idle;
+  hdl->idle = 0;
+}
+
 /**
- * Array of headers for non-blocking GA calls. The ihdl_index element of the
- * non-blocking handle indexes into this array. The maximum number of
- * outstanding non-blocking GA calls is nb_max_outstanding.
+ * Add a slab to the GA handle table. Return 0 if the table is at its maximum
+ * size.
  */
-static ga_nbhdl_array_t ga_ihdl_array[MAX_NUM_NB_HDLS];
+static int nb_grow_ga_table()
+{
+  int i, base = GA_IHDL_SIZE;
+  ga_nbhdl_array_t *chunk;
+  if (base+NB_CHUNK > nb_max_handles) return 0;
+  ga_ihdl_chunks = (ga_nbhdl_array_t**)realloc(ga_ihdl_chunks,
+      (ga_ihdl_nchunks+1)*sizeof(ga_nbhdl_array_t*));
+  chunk = (ga_nbhdl_array_t*)malloc(NB_CHUNK*sizeof(ga_nbhdl_array_t));
+  if (!ga_ihdl_chunks || !chunk)
+    pnga_error("nbutil: cannot allocate non-blocking handles",base);
+  ga_ihdl_chunks[ga_ihdl_nchunks++] = chunk;
+  for (i=0; i<NB_CHUNK; i++) {
+    chunk[i].ahandle = NULL;
+    chunk[i].count = 0;
+    chunk[i].ga_nbgen = 0;
+    chunk[i].active = 0;
+    chunk[i].idle = 0;
+    nb_push_free(base+i);
+  }
+  return 1;
+}
 
 /**
- * Array of armci handles. This is used to construct linked lists of ARMCI
- * non-blocking calls. The maximum number of outstanding ARMCI non-blocking
- * calls is nb_max_outstanding.
+ * Add a slab of ARMCI handle links to the free list
  */
-static ga_armcihdl_t armci_ihdl_array[MAX_NUM_NB_HDLS];
+static void nb_grow_armci_table()
+{
+  int i;
+  ga_armcihdl_t *chunk;
+  armci_ihdl_chunks = (ga_armcihdl_t**)realloc(armci_ihdl_chunks,
+      (armci_ihdl_nchunks+1)*sizeof(ga_armcihdl_t*));
+  chunk = (ga_armcihdl_t*)malloc(NB_CHUNK*sizeof(ga_armcihdl_t));
+  if (!armci_ihdl_chunks || !chunk)
+    pnga_error("nbutil: cannot allocate ARMCI handles",armci_ihdl_nchunks);
+  armci_ihdl_chunks[armci_ihdl_nchunks++] = chunk;
+  for (i=NB_CHUNK-1; i>=0; i--) {
+    chunk[i].previous = NULL;
+    chunk[i].active = 0;
+    ARMCI_INIT_HANDLE(&chunk[i].handle);
+    chunk[i].next = armci_ihdl_free;
+    armci_ihdl_free = &chunk[i];
+  }
+}
 
-static int lastGAhandle = -1; /* last assigned ga handle */
-static int lastARMCIhandle = -1; /* last assigned armci handle */
+/**
+ * Return a completed ARMCI link to the free list
+ */
+static void nb_release_armci(ga_armcihdl_t *link)
+{
+  link->previous = NULL;
+  link->active = 0;
+  ARMCI_INIT_HANDLE(&link->handle);
+  link->next = armci_ihdl_free;
+  armci_ihdl_free = link;
+}
 
 /**
- * get a unique tag for each individual ARMCI call. These tags currently repeat
- * after 16777216=2^24 non-blocking calls
+ * Retire a GA handle whose calls have all completed. Advancing the
+ * generation invalidates every copy of the handle held by the user.
  */
-static unsigned int ga_nb_tag = -1;
-unsigned int get_next_tag(){
-  ga_nb_tag++;
-  ga_nb_tag = ga_nb_tag%16777216;
-  return ga_nb_tag;
-  /* return(++ga_nb_tag); */
+static void nb_release_ga(int idx)
+{
+  ga_nbhdl_array_t *hdl = GA_IHDL(idx);
+  nb_remove_idle(idx);
+  hdl->ahandle = NULL;
+  hdl->count = 0;
+  hdl->active = 0;
+  hdl->ga_nbgen = (hdl->ga_nbgen+1)&NB_GEN_MASK;
+  ga_ihdl_nactive--;
+  nb_push_free(idx);
+}
+
+/**
+ * Find the table entry of nbhandle. Return NULL if the handle has already
+ * completed.
+ */
+static ga_nbhdl_array_t* nb_lookup(Integer *nbhandle)
+{
+  gai_nbhdl_t *inbhandle = (gai_nbhdl_t *)nbhandle;
+  int index = inbhandle->ihdl_index;
+  ga_nbhdl_array_t *hdl;
+  if (index < 0 || index >= GA_IHDL_SIZE) return NULL;
+  hdl = GA_IHDL(index);
+  if (!hdl->active || hdl->ga_nbgen != inbhandle->ga_nbgen) return NULL;
+  return hdl;
 }
 
 /**
@@ -122,93 +264,69 @@ void gai_nb_init()
 {
   int i;
   char *value;
-  /* This is a hideous kluge, but some users want to be able to set this
-   * externally. The fact that only integer handles are exchanged between GA and
-   * the underlying runtime make it very difficult to handle in a more elegant
-   * manner. */
-  nb_max_outstanding = MAX_NUM_NB_HDLS; /* default */
-  value = getenv("COMEX_MAX_NB_OUTSTANDING");
+  /* Earlier versions limited GA to COMEX_MAX_NB_OUTSTANDING handles. The
+   * runtime still honors that limit for its own requests, but GA handles are
+   * bounded by NB_MAX_HANDLES, the index field and GA_NB_MAX_HANDLES */
+  nb_max_handles = NB_INDEX_LIMIT; /* default */
+  value = getenv("GA_NB_MAX_HANDLES");
   if (NULL != value) {
-    nb_max_outstanding = atoi(value);
-  }
-  if (nb_max_outstanding <1 || nb_max_outstanding > MAX_NUM_NB_HDLS) {
-    pnga_error("Illegal number of outstanding Non-block requests specified",
-        nb_max_outstanding);
-  }
-  for (i=0; i<nb_max_outstanding; i++) {
-    ga_ihdl_array[i].ahandle = NULL;
-    ga_ihdl_array[i].count = 0;
-    ga_ihdl_array[i].active = 0;
-    ga_ihdl_array[i].ga_nbtag = -1;
-    armci_ihdl_array[i].next = NULL;
-    armci_ihdl_array[i].previous = NULL;
-    armci_ihdl_array[i].active = 0;
-    ARMCI_INIT_HANDLE(&armci_ihdl_array[i].handle);
+    nb_max_handles = atoi(value);
+    if (nb_max_handles < 1 || nb_max_handles > NB_INDEX_LIMIT) {
+      pnga_error("Illegal number of outstanding Non-block requests specified",
+          nb_max_handles);
+    }
+    /* the table grows by whole slabs */
+    nb_max_handles = ((nb_max_handles+NB_CHUNK-1)/NB_CHUNK)*NB_CHUNK;
   }
+  for (i=0; i<ga_ihdl_nchunks; i++) free(ga_ihdl_chunks[i]);
+  for (i=0; i<armci_ihdl_nchunks; i++) free(armci_ihdl_chunks[i]);
+  free(ga_ihdl_chunks);
+  free(armci_ihdl_chunks);
+  ga_ihdl_chunks = NULL;
+  armci_ihdl_chunks = NULL;
+  ga_ihdl_nchunks = 0;
+  armci_ihdl_nchunks = 0;
+  ga_ihdl_free_head = -1;
+  ga_ihdl_free_tail = -1;
+  ga_ihdl_idle = -1;
+  ga_ihdl_nactive = 0;
+  armci_ihdl_free = NULL;
+  nb_last_forced = -1;
+  nb_grow_ga_table();
+  nb_grow_armci_table();
 }
 
 /**
  * Called from ga_put/get before every call to a non-blocking armci request.
- * Find an available armic non-blocking handle. If none is available,
- * complete an existing outstanding armci request and return the
- * corresponding handle.
+ * Take a free ARMCI handle link, adding a slab if there is none, and add it
+ * to the list of nbhandle.
  */
 armci_hdl_t* get_armci_nbhandle(Integer *nbhandle)
 {
-  int i, top, idx, iloc;
   gai_nbhdl_t *inbhandle = (gai_nbhdl_t *)nbhandle;
   int index = inbhandle->ihdl_index;
-  ga_armcihdl_t* next = ga_ihdl_array[index].ahandle;
-
-  lastARMCIhandle++;
-  lastARMCIhandle = lastARMCIhandle%nb_max_outstanding;
-  top = lastARMCIhandle+nb_max_outstanding;
-  /* default index if no handles are available */
-  iloc = lastARMCIhandle;
-  for (i=lastARMCIhandle; i<top; i++) {
-    idx = i%nb_max_outstanding;
-    if (armci_ihdl_array[idx].active == 0) {
-      iloc = idx;
-      break;
-    }
-  }
-  /* if selected handle represents an outstanding request, complete it */
-  if (armci_ihdl_array[iloc].active == 1) {
-    int iga_hdl = armci_ihdl_array[iloc].ga_hdlarr_index;
-    ARMCI_Wait(&armci_ihdl_array[iloc].handle);
-    /* clean up linked list that this handle used to be a link in */
-    if (armci_ihdl_array[iloc].previous != NULL) {
-      /* link is not first in linked list */
-      armci_ihdl_array[iloc].previous->next = armci_ihdl_array[iloc].next;
-      if (armci_ihdl_array[iloc].next != NULL) {
-        armci_ihdl_array[iloc].next->previous = armci_ihdl_array[iloc].previous;
-      }
-    } else {
-      /* link is first in linked list. Need to update header */
-      ga_ihdl_array[iga_hdl].ahandle = armci_ihdl_array[iloc].next;
-      if (armci_ihdl_array[iloc].next != NULL) {
-        armci_ihdl_array[iloc].next->previous = NULL;
-      }
-    }
-    ga_ihdl_array[iga_hdl].count--;
-  }
+  ga_nbhdl_array_t *hdl = GA_IHDL(index);
+  ga_armcihdl_t *link;
+
+  if (armci_ihdl_free == NULL) nb_grow_armci_table();
+  nb_remove_idle(index);
+  link = armci_ihdl_free;
+  armci_ihdl_free = link->next;
+
   /* Initialize armci handle and add this operation to the linked list
    * corresponding to nbhandle */
-  ARMCI_INIT_HANDLE(&armci_ihdl_array[iloc].handle);
-  armci_ihdl_array[iloc].active = 1;
-  armci_ihdl_array[iloc].previous = NULL;
-  if (ga_ihdl_array[index].ahandle) {
-    ga_ihdl_array[index].ahandle->previous = &armci_ihdl_array[iloc];
+  ARMCI_INIT_HANDLE(&link->handle);
+  link->active = 1;
+  link->previous = NULL;
+  if (hdl->ahandle) {
+    hdl->ahandle->previous = link;
   }
-  armci_ihdl_array[iloc].next = ga_ihdl_array[index].ahandle;
-  ga_ihdl_array[index].ahandle =  &armci_ihdl_array[iloc];
-  armci_ihdl_array[iloc].ga_hdlarr_index = index;
-  ga_ihdl_array[index].count++;
-
-  /* reset lastARMCIhandle to iloc */
-  lastARMCIhandle = iloc;
+  link->next = hdl->ahandle;
+  hdl->ahandle = link;
+  link->ga_hdlarr_index = index;
+  hdl->count++;
 
-  return &armci_ihdl_array[iloc].handle;
+  return &link->handle;
 }
 
 /**
@@ -217,33 +335,22 @@ armci_hdl_t* get_armci_nbhandle(Integer *nbhandle)
  */ 
 int nga_wait_internal(Integer *nbhandle){
   gai_nbhdl_t *inbhandle = (gai_nbhdl_t *)nbhandle;
-  int index = inbhandle->ihdl_index;
+  ga_nbhdl_array_t *hdl = nb_lookup(nbhandle);
   int retval = 0;
-  int tag = inbhandle->ga_nbtag;
-  /* check if tags match. If they don't then this request was already completed
-   * so the handle can be used for another GA non-blocking call. Just return in
-   * this case */
-  if (tag == ga_ihdl_array[index].ga_nbtag) {
-    if (ga_ihdl_array[index].active == 0) {
-      printf("p[%ld] nga_wait_internal: GA NB handle %d inactive slot: %d tag: %d\n",
-          GAme,*inbhandle,index,tag);
-    }
-    ga_armcihdl_t* next = ga_ihdl_array[index].ahandle;
+  /* if the generations don't match, this request was already completed and
+   * the entry may have been reused for another GA non-blocking call. Just
+   * return in this case */
+  if (hdl) {
+    ga_armcihdl_t* next = hdl->ahandle;
     /* Loop over linked list and complete all remaining armci non-blocking calls */
     while(next) {
       ga_armcihdl_t* tmp = next->next;
       /* Complete the call */
       ARMCI_Wait(&next->handle);
-      /* reinitialize armci_hlt_t data structure */
-      next->next = NULL;
-      next->previous = NULL;
-      next->active = 0;
-      ARMCI_INIT_HANDLE(&next->handle);
+      nb_release_armci(next);
       next = tmp;
     }
-    ga_ihdl_array[index].ahandle = NULL;
-    ga_ihdl_array[index].count = 0;
-    ga_ihdl_array[index].active = 0;
+    nb_release_ga(inbhandle->ihdl_index);
   }
 
   return(retval);
@@ -257,15 +364,13 @@ int nga_wait_internal(Integer *nbhandle){
 int nga_test_internal(Integer *nbhandle)
 {
   gai_nbhdl_t *inbhandle = (gai_nbhdl_t *)nbhandle;
-  int index = inbhandle->ihdl_index;
+  ga_nbhdl_array_t *hdl = nb_lookup(nbhandle);
   int retval = 0;
-  int tag = inbhandle->ga_nbtag;
 
-  /* check if tags match. If they don't then this request was already completed
-   * so the handle can be used for another GA non-blocking call. Just return in
-   * this case */
-  if (tag == ga_ihdl_array[index].ga_nbtag) {
-    ga_armcihdl_t* next = ga_ihdl_array[index].ahandle;
+  /* if the generations don't match, this request was already completed so
+   * just return in this case */
+  if (hdl) {
+    ga_armcihdl_t* next = hdl->ahandle;
     /* Loop over linked list and test all remaining armci non-blocking calls */
     while(next) {
       int ret = ARMCI_Test(&next->handle);
@@ -280,64 +385,69 @@ int nga_test_internal(Integer *nbhandle)
           }
         } else {
           /* operation is first element in list */
-          ga_ihdl_array[index].ahandle = next->next;
+          hdl->ahandle = next->next;
           if (next->next != NULL) {
             next->next->previous = NULL;
           }
         }
-        next->previous = NULL;
-        next->next = NULL;
-        next->active = 0;
-        ga_ihdl_array[index].count--;
+        nb_release_armci(next);
+        hdl->count--;
       }
       next = tmp;
     }
-    if (ga_ihdl_array[index].count == 0) {
-      ga_ihdl_array[index].ahandle = NULL;
-      ga_ihdl_array[index].active = 0;
+    if (hdl->count > 0) {
+      retval = 1;
+    } else {
+      nb_release_ga(inbhandle->ihdl_index);
     }
-    if (ga_ihdl_array[index].count > 0) retval = 1;
   }
 
   return(retval);
 }
 
+/**
+ * Make room for a new GA handle when the table is at its maximum size.
+ * Handles without outstanding ARMCI calls are reclaimed first. If there are
+ * none, every entry is active and the next one in round-robin order is
+ * completed.
+ */
+static void nb_reclaim()
+{
+  int size = GA_IHDL_SIZE;
+  Integer itmp;
+  gai_nbhdl_t *oldhdl = (gai_nbhdl_t*)&itmp;
+
+  while (ga_ihdl_idle >= 0) nb_release_ga(ga_ihdl_idle);
+  if (ga_ihdl_free_head >= 0) return;
+
+  do {
+    nb_last_forced = (nb_last_forced+1)%size;
+  } while (!GA_IHDL(nb_last_forced)->active);
+  oldhdl->ihdl_index = nb_last_forced;
+  oldhdl->ga_nbgen = GA_IHDL(nb_last_forced)->ga_nbgen;
+  nga_wait_internal(&itmp);
+  GAstat.numnbf++;
+}
+
 /**
  * Find a free GA non-blocking handle.
  */
 void ga_init_nbhandle(Integer *nbhandle)
 {
-  int i, top, idx, iloc;
+  int idx;
   gai_nbhdl_t *inbhandle = (gai_nbhdl_t *)nbhandle;
-  lastGAhandle++;
-  lastGAhandle = lastGAhandle%nb_max_outstanding;
-  top = lastGAhandle+nb_max_outstanding;
-  /* default index if no handles are available */
-  idx = lastGAhandle;
-  for (i=lastGAhandle; i<top; i++) {
-    iloc = i%nb_max_outstanding;
-    if (ga_ihdl_array[iloc].ahandle == NULL) {
-      idx = iloc;
-      break;
-    }
-  }
-  /* If no free handle is found, clear the oldest handle */
-  if (ga_ihdl_array[idx].ahandle != NULL) {
-    Integer itmp;
-    /* find value of itmp corresponding to oldest handle */
-    gai_nbhdl_t *oldhdl = (gai_nbhdl_t*)&itmp;
-    oldhdl->ihdl_index = idx;
-    oldhdl->ga_nbtag = ga_ihdl_array[idx].ga_nbtag;
-    nga_wait_internal(&itmp);
-  }
+  ga_nbhdl_array_t *hdl;
+
+  if (ga_ihdl_free_head < 0 && !nb_grow_ga_table()) nb_reclaim();
+  idx = nb_pop_free();
+  hdl = GA_IHDL(idx);
   inbhandle->ihdl_index = idx;
-  inbhandle->ga_nbtag = get_next_tag();
-  ga_ihdl_array[idx].ahandle = NULL;
-  ga_ihdl_array[idx].count = 0;
-  ga_ihdl_array[idx].active = 1;
-  ga_ihdl_array[idx].ga_nbtag = inbhandle->ga_nbtag;
-
-  /* reset lastGAhandle to idx */
-  lastGAhandle = idx;
+  inbhandle->ga_nbgen = hdl->ga_nbgen;
+  hdl->ahandle = NULL;
+  hdl->count = 0;
+  hdl->active = 1;
+  nb_push_idle(idx);
+  ga_ihdl_nactive++;
+  if (ga_ihdl_nactive > GAstat.maxnbh) GAstat.maxnbh = ga_ihdl_nactive;
   return;
 }
@@ -356,7 +356,11 @@ Integer _d, _factor;                                                           \
 
 Integer pnga_nbtest(Integer *nbhandle) 
 {
-    return !nga_test_internal((Integer *)nbhandle);
+    Integer done;
+    GA_Internal_Threadsafe_Lock();
+    done = !nga_test_internal((Integer *)nbhandle);
+    GA_Internal_Threadsafe_Unlock();
+    return done;
 } 
 
 /**
@@ -571,6 +575,7 @@ void ngai_put_common(Integer g_a,
   _stride_loc[0] = field_size;
   _count[0] = field_size;
 
+  if (GA[handle].merge) gai_merge_mark(g_a, lo, hi);
 
   gai_iterator_init(g_a, lo, hi, &it_hdl);
 
@@ -1166,136 +1171,7 @@ void pnga_get(Integer g_a, Integer *lo, Integer *hi,
     ngai_get_common(g_a,lo,hi,buf,ld,0,-1,(Integer *)NULL);
     GA_Internal_Threadsafe_Unlock();
   } else {
-    int i;
-    int nelem;
-    int ndim = GA[handle].ndim;
-    Integer nstart[MAXDIM], ncount[MAXDIM], nld[MAXDIM];
-    Integer bstart[MAXDIM];
-    /* ngai_get_common(g_a,lo,hi,buf,ld,0,-1,(Integer *)NULL); */
-
-    /* cache is empty condition */
-    if (GA[handle].cache_head == NULL) {
-      GA[handle].cache_head = malloc(sizeof(cache_struct_t));
-      nelem = 1;
-      for (i=0; i<ndim; i++) {
-        GA[handle].cache_head -> lo[i] = lo[i];
-        GA[handle].cache_head -> hi[i] = hi[i];
-        nelem *= (hi[i]-lo[i]+1);
-      }
-      GA[handle].cache_head -> cache_buf = malloc(GA[handle].elemsize*nelem);
-      GA[handle].cache_head -> next = NULL;
-
-        void *new_buf = GA[handle].cache_head->cache_buf;
-
-      /* place data to receive buffer */
-      ngai_get_common(g_a,lo,hi,buf,ld,0,-1,(Integer*)NULL);
-   
-      for (i=0; i<ndim; i++) {
-        nstart[i] = 0;
-        bstart[i] = 0;
-        nld[i] = (hi[i]-lo[i]+1);
-        ncount[i] = nld[i];
-      }
-      gai_mem_copy(GA[handle].elemsize,ndim,buf,bstart,ncount,ld,new_buf,
-          nstart, nld);
-    } else {
-
-      cache_struct_t * cache_temp_pointer = GA[handle].cache_head;
-      int match = 0;
-      while (cache_temp_pointer != NULL) {
-        int chk;
-        int sub_chk;
-        int temp_lo[MAXDIM];
-        int temp_hi[MAXDIM];
-        void *temp_buf = cache_temp_pointer->cache_buf;
-        for (i=0; i<ndim; i++) {
-          temp_lo[i] = cache_temp_pointer->lo[i];
-          temp_hi[i] = cache_temp_pointer->hi[i];
-        }
-
-        //match
-        chk = 1;
-        for (i=0; i<ndim; i++) {
-          if (!(temp_lo[i] <= lo[i] && temp_hi[i] >= hi[i])) {
-            chk = 0;
-            break;
-          }
-        }
-        //match
-        if (chk) {
-          nelem = 1;
-          for (i=0; i<ndim; i++) {
-            nelem *= (hi[i]-lo[i]+1);
-          }
-          for (i=0; i<ndim; i++) {
-            nstart[i] = (lo[i]-temp_lo[i]);
-            bstart[i] = 0;
-            nld[i] = (temp_hi[i]-temp_lo[i]+1);
-            ncount[i] = (hi[i]-lo[i]+1);
-          }
-          /* copy data to recieve buffer */
-          gai_mem_copy(GA[handle].elemsize,ndim,temp_buf,nstart,ncount,nld,buf,
-              bstart, ncount /*ld*/);
-          match = 1;
-          break;
-        }
-
-        cache_temp_pointer = cache_temp_pointer->next;
-
-      }
-
-      //no match condition
-      if (match == 0) {
-        void *new_buf;
-        /* create new node on cache list*/
-        cache_struct_t *cache_new = malloc(sizeof(cache_struct_t));
-        nelem = 1;
-        for (i=0; i<ndim; i++) {
-          cache_new -> lo[i] = lo[i];
-          cache_new -> hi[i] = hi[i];
-          nelem *= (hi[i]-lo[i]+1);
-        }
-        cache_new -> cache_buf = malloc(GA[handle].elemsize*nelem);
-        new_buf = cache_new->cache_buf;
-        cache_new -> next = GA[handle].cache_head;
-        GA[handle].cache_head = cache_new;
-
-
-        //place data to recieve buffer
-        ngai_get_common(g_a,lo,hi,buf,ld,0,-1,(Integer *)NULL);
-
-        for (i=0; i<ndim; i++) {
-          nstart[i] = 0;
-          bstart[i] = 0;
-          nld[i] = (hi[i]-lo[i]+1);
-          ncount[i] = nld[i];
-        }
-        gai_mem_copy(GA[handle].elemsize,ndim,buf,bstart,ncount,ld,new_buf,
-            nstart, nld);
-      }
-    }
-
-    /* check number of items cached */
-    cache_struct_t * cache_temp_pointer = GA[handle].cache_head;
-    int cache_size = 0;
-
-    /* check number of items cached */
-    while (cache_temp_pointer != NULL) {
-      if (cache_size > MAXCACHE) {
-        cache_struct_t *last = cache_temp_pointer;
-        cache_struct_t *next = last->next;
-        last->next = NULL;
-        cache_temp_pointer = next;
-        while (next) {
-          next = cache_temp_pointer->next;
-          free(cache_temp_pointer->cache_buf);
-          free(cache_temp_pointer);
-        }
-        break;
-      }
-      cache_size++;
-    }
-    /* end */
+    gai_read_cache_get(g_a,lo,hi,buf,ld);
   }
 }
 
@@ -1378,6 +1254,8 @@ void ngai_acc_common(Integer g_a,
   else if(type==C_LONG)optype= ARMCI_ACC_LNG;
   else pnga_error("type not supported",type);
 
+  if (GA[handle].merge) gai_merge_mark(g_a, lo, hi);
+
   gai_iterator_init(g_a, lo, hi, &it_hdl);
 
 #ifndef NO_GA_STATS
@@ -1500,6 +1378,323 @@ void pnga_nbacc(Integer g_a,
     ngai_acc_common(g_a,lo,hi,buf,ld,alpha,nbhndl);
 }
 
+/*\ ACCESS PLANS
+ *  A plan records what the patch get, put and acc routines recompute on
+ *  every call: the owners of the patch, the address of the patch on every
+ *  owner and the counts and strides of the strided transfers. Executing a
+ *  plan only issues the stored transfers. A plan stays valid as long as the
+ *  memory of its array; once the array is destroyed, deallocated or given a
+ *  new property, executing the plan is an error.
+\*/
+
+#define PLAN_GET 0
+#define PLAN_PUT 1
+#define PLAN_ACC 2
+
+typedef struct {
+  int proc;
+  char *prem;                     /* patch location on proc */
+  Integer offset;                 /* byte offset of patch in user buffer */
+  int count[MAXDIM];
+  int stride_rem[MAXDIM], stride_loc[MAXDIM];
+} plan_seg_t;
+
+typedef struct {
+  Integer g_a;
+  Integer epoch;                  /* epoch of g_a when plan was built */
+  int ndim;
+  int optype;
+  Integer lo[MAXDIM], hi[MAXDIM]; /* patch of the plan */
+  int nseg;
+  plan_seg_t *seg;                /* remote owners first, then SMP owners */
+  double bytes;
+  double locbytes;
+} plan_t;
+
+static plan_t **GA_plans = NULL;
+static Integer GA_max_plans = 0;
+
+static plan_t* plan_get(Integer plan, char *caller)
+{
+  plan_t *pl;
+  Integer handle;
+  if (plan < 0 || plan >= GA_max_plans || GA_plans[plan] == NULL)
+    pnga_error(caller,plan);
+  pl = GA_plans[plan];
+  handle = pl->g_a + GA_OFFSET;
+  if (!GA[handle].actv || GA[handle].epoch != pl->epoch)
+    pnga_error("plan refers to an array that was destroyed or reallocated",
+        pl->g_a);
+  return pl;
+}
+
+/**
+ *  Create a plan for moving the patch [lo,hi] of g_a to and from a local
+ *  buffer with leading dimensions ld. Plans are local to the calling
+ *  process. Plans do not go through the read cache of an array with the
+ *  "read_cache" property.
+ */
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_create_plan = pnga_create_plan
+#endif
+
+Integer pnga_create_plan(Integer g_a, Integer *lo, Integer *hi, Integer *ld)
+{
+  Integer handle = GA_OFFSET + g_a, plan, elems, size, type;
+  int proc, ndim, loop, cond, nseg, i;
+  Integer ldrem[MAXDIM];
+  Integer idx_buf, *plo, *phi;
+  char *prem;
+  plan_t *pl;
+  plan_seg_t *seg;
+  _iterator_hdl it_hdl;
+
+  GA_Internal_Threadsafe_Lock();
+  ga_check_handleM(g_a, "ga_create_plan");
+
+  for (plan=0; plan<GA_max_plans; plan++) {
+    if (GA_plans[plan] == NULL) break;
+  }
+  if (plan == GA_max_plans) {
+    Integer newmax = GA_max_plans ? 2*GA_max_plans : 16;
+    GA_plans = (plan_t**)realloc(GA_plans,newmax*sizeof(plan_t*));
+    if (!GA_plans) pnga_error("ga_create_plan: realloc failed",newmax);
+    for (i=GA_max_plans; i<newmax; i++) GA_plans[i] = NULL;
+    GA_max_plans = newmax;
+  }
+
+  size = GA[handle].elemsize;
+  type = GA[handle].type;
+  ndim = GA[handle].ndim;
+  pl = (plan_t*)malloc(sizeof(plan_t));
+  if (!pl) pnga_error("ga_create_plan: malloc failed",0);
+  pl->g_a = g_a;
+  pl->epoch = GA[handle].epoch;
+  pl->ndim = ndim;
+  for (i=0; i<ndim; i++) {
+    pl->lo[i] = lo[i];
+    pl->hi[i] = hi[i];
+  }
+  if(type==C_DBL) pl->optype= ARMCI_ACC_DBL;
+  else if(type==C_FLOAT) pl->optype= ARMCI_ACC_FLT;
+  else if(type==C_DCPL)pl->optype= ARMCI_ACC_DCP;
+  else if(type==C_SCPL)pl->optype= ARMCI_ACC_CPL;
+  else if(type==C_INT)pl->optype= ARMCI_ACC_INT;
+  else if(type==C_LONG)pl->optype= ARMCI_ACC_LNG;
+  else pl->optype = -1;
+  gam_CountElems(ndim, lo, hi, &elems);
+  pl->bytes = (double)size*elems;
+  pl->locbytes = 0.0;
+
+  gai_iterator_init(g_a, lo, hi, &it_hdl);
+  nseg = 0;
+  while (gai_iterator_next(&it_hdl, &proc, &plo, &phi, &prem, ldrem)) nseg++;
+  pl->nseg = nseg;
+  pl->seg = (plan_seg_t*)malloc((nseg > 0 ? nseg : 1)*sizeof(plan_seg_t));
+  if (!pl->seg) pnga_error("ga_create_plan: malloc failed",nseg);
+
+  /* same order as the patch routines: remote owners first so that their
+   * transfers are under way while SMP owners are served */
+  seg = pl->seg;
+  for (loop=0; loop<2; loop++) {
+    gai_iterator_reset(&it_hdl);
+    while (gai_iterator_next(&it_hdl, &proc, &plo, &phi, &prem, ldrem)) {
+      cond = armci_domain_same_id(ARMCI_DOMAIN_SMP,proc);
+      if (loop==0) cond = !cond;
+      if (!cond) continue;
+      seg->proc = proc;
+      seg->prem = prem;
+      gam_ComputePatchIndex(ndim, lo, plo, ld, &idx_buf);
+      seg->offset = size*idx_buf;
+      gam_ComputeCount(ndim, plo, phi, seg->count);
+      seg->count[0] *= size;
+      gam_setstride(ndim, size, ld, ldrem, seg->stride_rem, seg->stride_loc);
+      if (proc == GAme) {
+        gam_CountElems(ndim, plo, phi, &elems);
+        pl->locbytes += (double)size*elems;
+      }
+      seg++;
+    }
+  }
+  gai_iterator_destroy(&it_hdl);
+
+  GA_plans[plan] = pl;
+  GA_Internal_Threadsafe_Unlock();
+  return plan;
+}
+
+/**
+ *  Destroy a plan
+ */
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_destroy_plan = pnga_destroy_plan
+#endif
+
+void pnga_destroy_plan(Integer plan)
+{
+  GA_Internal_Threadsafe_Lock();
+  if (plan < 0 || plan >= GA_max_plans || GA_plans[plan] == NULL)
+    pnga_error("ga_destroy_plan: invalid plan",plan);
+  free(GA_plans[plan]->seg);
+  free(GA_plans[plan]);
+  GA_plans[plan] = NULL;
+  GA_Internal_Threadsafe_Unlock();
+}
+
+/**
+ *  Issue the transfers of a plan. Blocking calls complete before returning,
+ *  non-blocking calls attach every transfer to nbhandle.
+ */
+static void gai_plan_exec(int op, Integer plan, void *buf, void *alpha,
+    Integer *nbhandle)
+{
+  plan_t *pl;
+  plan_seg_t *seg;
+  armci_hdl_t *hdl;
+  Integer ga_nbhandle;
+  int i, levels;
+
+  GA_Internal_Threadsafe_Lock();
+  pl = plan_get(plan,"ga_plan: invalid plan");
+  levels = pl->ndim-1;
+  if (op == PLAN_ACC && pl->optype < 0)
+    pnga_error("ga_plan_acc: type not supported",pl->g_a);
+  if (op != PLAN_GET && GA[GA_OFFSET+pl->g_a].merge)
+    gai_merge_mark(pl->g_a, pl->lo, pl->hi);
+
+#ifndef NO_GA_STATS
+  if (op == PLAN_GET) {
+    GAbytes.gettot += pl->bytes;
+    GAbytes.getloc += pl->locbytes;
+    GAstat.numget++;
+  } else if (op == PLAN_PUT) {
+    GAbytes.puttot += pl->bytes;
+    GAbytes.putloc += pl->locbytes;
+    GAstat.numput++;
+  } else {
+    GAbytes.acctot += pl->bytes;
+    GAbytes.accloc += pl->locbytes;
+    GAstat.numacc++;
+  }
+#endif
+
+  /* blocking gets go through a local handle, as ngai_gets does */
+  if (nbhandle) ga_init_nbhandle(nbhandle);
+  else if (op == PLAN_GET) ga_init_nbhandle(&ga_nbhandle);
+
+  for (i=0; i<pl->nseg; i++) {
+    char *pbuf;
+    seg = &pl->seg[i];
+    pbuf = (char*)buf + seg->offset;
+    if (op != PLAN_GET && GA_fence_set) fence_array[seg->proc]=1;
+    if (nbhandle) {
+      hdl = (armci_hdl_t*)get_armci_nbhandle(nbhandle);
+    } else if (op == PLAN_GET) {
+      hdl = (armci_hdl_t*)get_armci_nbhandle(&ga_nbhandle);
+    } else {
+      hdl = NULL;
+    }
+    switch (op) {
+      case PLAN_GET:
+        ARMCI_NbGetS(seg->prem, seg->stride_rem, pbuf, seg->stride_loc,
+            seg->count, levels, seg->proc, hdl);
+        break;
+      case PLAN_PUT:
+        if (hdl) {
+          ARMCI_NbPutS(pbuf, seg->stride_loc, seg->prem, seg->stride_rem,
+              seg->count, levels, seg->proc, hdl);
+        } else {
+          ARMCI_PutS(pbuf, seg->stride_loc, seg->prem, seg->stride_rem,
+              seg->count, levels, seg->proc);
+        }
+        break;
+      default:
+        if (hdl) {
+          ARMCI_NbAccS(pl->optype, alpha, pbuf, seg->stride_loc, seg->prem,
+              seg->stride_rem, seg->count, levels, seg->proc, hdl);
+        } else {
+          ARMCI_AccS(pl->optype, alpha, pbuf, seg->stride_loc, seg->prem,
+              seg->stride_rem, seg->count, levels, seg->proc);
+        }
+        break;
+    }
+  }
+  if (!nbhandle && op == PLAN_GET) nga_wait_internal(&ga_nbhandle);
+  GA_Internal_Threadsafe_Unlock();
+}
+
+/**
+ *  Get the patch of a plan into buf
+ */
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_plan_get = pnga_plan_get
+#endif
+
+void pnga_plan_get(Integer plan, void *buf)
+{
+  gai_plan_exec(PLAN_GET,plan,buf,NULL,NULL);
+}
+
+/**
+ *  (Non-blocking) Get the patch of a plan into buf
+ */
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_plan_nbget = pnga_plan_nbget
+#endif
+
+void pnga_plan_nbget(Integer plan, void *buf, Integer *nbhandle)
+{
+  gai_plan_exec(PLAN_GET,plan,buf,NULL,nbhandle);
+}
+
+/**
+ *  Put buf into the patch of a plan
+ */
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_plan_put = pnga_plan_put
+#endif
+
+void pnga_plan_put(Integer plan, void *buf)
+{
+  gai_plan_exec(PLAN_PUT,plan,buf,NULL,NULL);
+}
+
+/**
+ *  (Non-blocking) Put buf into the patch of a plan
+ */
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_plan_nbput = pnga_plan_nbput
+#endif
+
+void pnga_plan_nbput(Integer plan, void *buf, Integer *nbhandle)
+{
+  gai_plan_exec(PLAN_PUT,plan,buf,NULL,nbhandle);
+}
+
+/**
+ *  Accumulate alpha*buf into the patch of a plan
+ */
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_plan_acc = pnga_plan_acc
+#endif
+
+void pnga_plan_acc(Integer plan, void *buf, void *alpha)
+{
+  gai_plan_exec(PLAN_ACC,plan,buf,alpha,NULL);
+}
+
+/**
+ *  (Non-blocking) Accumulate alpha*buf into the patch of a plan
+ */
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_plan_nbacc = pnga_plan_nbacc
+#endif
+
+void pnga_plan_nbacc(Integer plan, void *buf, void *alpha, Integer *nbhandle)
+{
+  gai_plan_exec(PLAN_ACC,plan,buf,alpha,nbhandle);
+}
+
 /**
  * Return a pointer to local data in a Global Array
  */
@@ -2219,7 +2414,9 @@ void pnga_release(Integer g_a, Integer *lo, Integer *hi)
 #endif
 
 void pnga_release_update(Integer g_a, Integer *lo, Integer *hi)
-{}
+{
+  if (GA[GA_OFFSET+g_a].merge) gai_merge_mark(g_a, lo, hi);
+}
 
 /**
  *  Release access to a block in a block-cyclic Global Array
@@ -2434,6 +2631,7 @@ void pnga_scatter2d(Integer g_a, void *v, Integer *i, Integer *j, Integer nv)
     ga_check_handleM(g_a, "ga_scatter");
     
     GAstat.numsca++;
+    if (GA[handle].merge) gai_merge_mark(g_a, NULL, NULL);
     /* determine how many processors are associated with array */
     p_handle = GA[handle].p_handle;
     if (p_handle < 0) {
@@ -2709,6 +2907,7 @@ Integer subscrpt[2];
   ga_check_handleM(g_a, "ga_scatter_acc");
   
   GAstat.numsca++;
+  if (GA[GA_OFFSET+g_a].merge) gai_merge_mark(g_a, NULL, NULL);
 
   int_ptr = (Integer*) ga_malloc(nv, MT_F_INT, "ga_scatter_acc--p");
 
@@ -3389,6 +3588,299 @@ void pnga_free_gatscat_buf()
   }                                                  \
 }
 
+/* number of elements bucketed and transferred together by the gather/scatter
+ * engine for regular distributions */
+#define GATSCAT_CHUNK 16384
+
+static void gs_destroy(gai_gatscat_t *gs)
+{
+  int b;
+  free(gs->count);
+  free(gs->base);
+  free(gs->owner);
+  free(gs->offset);
+  for (b=0; b<2; b++) {
+    free(gs->active[b]);
+    free(gs->ptr_loc[b]);
+    free(gs->ptr_rem[b]);
+    free(gs->nbhandle[b]);
+  }
+  free(gs);
+}
+
+/**
+ *  Release the gather/scatter scratch of array handle
+ */
+void gai_gatscat_free(Integer handle)
+{
+  if (GA[handle].gatscat == NULL) return;
+  gs_destroy(GA[handle].gatscat);
+  GA[handle].gatscat = NULL;
+}
+
+/**
+ *  Allocate gather/scatter scratch for nowner owners
+ */
+static gai_gatscat_t* gs_create(Integer nowner)
+{
+  gai_gatscat_t *gs = (gai_gatscat_t*)malloc(sizeof(gai_gatscat_t));
+  Integer i;
+  int b;
+  if (!gs) pnga_error("gs_create: malloc failed",0);
+  gs->busy = 0;
+  gs->nowner = nowner;
+  gs->count = (Integer*)malloc(nowner*sizeof(Integer));
+  gs->base = (char**)malloc(nowner*sizeof(char*));
+  gs->owner = (int*)malloc(GATSCAT_CHUNK*sizeof(int));
+  gs->offset = (Integer*)malloc(GATSCAT_CHUNK*sizeof(Integer));
+  if (!gs->count || !gs->base || !gs->owner || !gs->offset)
+    pnga_error("gs_create: malloc failed",nowner);
+  for (i=0; i<nowner; i++) gs->count[i] = 0;
+  for (b=0; b<2; b++) {
+    gs->active[b] = (int*)malloc(nowner*sizeof(int));
+    gs->nactive[b] = 0;
+    gs->ptr_loc[b] = (void**)malloc(GATSCAT_CHUNK*sizeof(void*));
+    gs->ptr_rem[b] = (void**)malloc(GATSCAT_CHUNK*sizeof(void*));
+    gs->nbhandle[b] = (armci_hdl_t*)malloc(nowner*sizeof(armci_hdl_t));
+    if (!gs->active[b] || !gs->ptr_loc[b] || !gs->ptr_rem[b]
+        || !gs->nbhandle[b])
+      pnga_error("gs_create: malloc failed",nowner);
+  }
+  return gs;
+}
+
+/**
+ *  Claim the scratch of array handle for one call. The scratch is kept
+ *  with the array and reused by later calls; a call that finds it busy on
+ *  another thread gets a private copy instead.
+ */
+static gai_gatscat_t* gs_claim(Integer handle, Integer nowner)
+{
+  gai_gatscat_t *gs;
+  GA_Internal_Threadsafe_Lock();
+  gs = GA[handle].gatscat;
+  if (gs && !gs->busy && gs->nowner != nowner) {
+    /* the distribution changed, e.g. by setting a property */
+    gai_gatscat_free(handle);
+    gs = NULL;
+  }
+  if (gs == NULL) {
+    gs = gs_create(nowner);
+    GA[handle].gatscat = gs;
+  } else if (gs->busy) {
+    gs = gs_create(nowner);
+  }
+  gs->busy = 1;
+  GA_Internal_Threadsafe_Unlock();
+  return gs;
+}
+
+static void gs_release(Integer handle, gai_gatscat_t *gs)
+{
+  GA_Internal_Threadsafe_Lock();
+  if (GA[handle].gatscat == gs) {
+    gs->busy = 0;
+  } else {
+    gs_destroy(gs);
+  }
+  GA_Internal_Threadsafe_Unlock();
+}
+
+/**
+ *  Wait for the requests issued from buffer b of the scratch
+ */
+static void gs_wait(gai_gatscat_t *gs, int b)
+{
+  int j;
+  for (j=0; j<gs->nactive[b]; j++) ARMCI_Wait(&gs->nbhandle[b][j]);
+  gs->nactive[b] = 0;
+}
+
+/**
+ *  World rank of the process that owns block o of a regular array
+ */
+static Integer gs_world_proc(Integer handle, Integer o)
+{
+  Integer p_handle = GA[handle].p_handle;
+  if (GA[handle].num_rstrctd > 0) return GA[handle].rstrctd_list[o];
+  if (p_handle < 0) return o;
+  return PGRP_LIST[p_handle].inv_map_proc_list[o];
+}
+
+/**
+ *  Gather/scatter for arrays with a regular distribution. Elements are
+ *  processed in chunks of GATSCAT_CHUNK. The owner and the offset within
+ *  the owner's block are computed directly from the distribution map for
+ *  every element of a chunk, the elements are bucketed by owner with a
+ *  counting pass and one nonblocking vector operation is issued per owner.
+ *  Bucketing of the next chunk overlaps with the transfers of the previous
+ *  one.
+ */
+static void gai_gatscat_regular(int op, Integer g_a, void* v, void *subscript,
+    Integer c_flag, Integer nv, double *locbytes, double* totbytes,
+    void *alpha)
+{
+  Integer handle = g_a+GA_OFFSET;
+  int ndim = GA[handle].ndim;
+  int item_size = GA[handle].elemsize;
+  int type = GA[handle].type;
+  int *nblock = GA[handle].nblock;
+  Integer p_handle = GA[handle].p_handle;
+  Integer num_rstrctd = GA[handle].num_rstrctd;
+  Integer me = pnga_nodeid();
+  Integer nowner, first, nlocal = 0;
+  Integer dims[MAXDIM], width[MAXDIM];
+  double scale[MAXDIM];
+  C_Integer *map[MAXDIM];
+  int optype = -1;
+  int b = 0, d;
+  gai_gatscat_t *gs;
+
+  /* local copies of the distribution, the element loop below stores
+   * through pointers that could otherwise alias it */
+  nowner = 1;
+  for (d=0; d<ndim; d++) {
+    dims[d] = GA[handle].dims[d];
+    width[d] = (Integer)GA[handle].width[d];
+    scale[d] = GA[handle].scale[d];
+    map[d] = d == 0 ? GA[handle].mapc : map[d-1]+nblock[d-1];
+    nowner *= nblock[d];
+  }
+
+  if (op == SCATTER_ACC) {
+    if(type==C_DBL) optype= ARMCI_ACC_DBL;
+    else if(type==C_DCPL)optype= ARMCI_ACC_DCP;
+    else if(type==C_SCPL)optype= ARMCI_ACC_CPL;
+    else if(type==C_INT)optype= ARMCI_ACC_INT;
+    else if(type==C_LONG)optype= ARMCI_ACC_LNG;
+    else if(type==C_FLOAT)optype= ARMCI_ACC_FLT; 
+    else pnga_error("type not supported",type);
+  }
+
+  gs = gs_claim(handle, nowner);
+
+  for (first=0; first<nv; first+=GATSCAT_CHUNK) {
+    Integer n = nv-first < GATSCAT_CHUNK ? nv-first : GATSCAT_CHUNK;
+    Integer *count = gs->count;
+    int *owner = gs->owner;
+    Integer *offset = gs->offset;
+    int *active = gs->active[b];
+    void **ptr_loc = gs->ptr_loc[b];
+    void **ptr_rem = gs->ptr_rem[b];
+    int nactive = 0;
+    Integer k, pos;
+    int j;
+
+    /* buffer b is reused, so its transfers from two chunks ago must be
+     * done */
+    gs_wait(gs, b);
+
+    /* owner and offset in the owner's block of every element */
+    for (k=0; k<n; k++) {
+      Integer index[MAXDIM], *sub;
+      Integer o = 0, stride = 1, off = 0, factor = 1;
+      if (c_flag) {
+        gam_c2f_index(((int**)subscript)[first+k], index, ndim);
+        sub = index;
+      } else {
+        sub = ((Integer*)subscript)+(first+k)*ndim;
+      }
+      for (d=0; d<ndim; d++) {
+        C_Integer *dmap = map[d];
+        Integer s = sub[d], lo, hi;
+        int nb = nblock[d];
+        int blk;
+        if (s < 1 || s > dims[d]) {
+          gai_print_subscript("invalid subscript",ndim, sub,"\n");
+          pnga_error("failed -element:",first+k);
+        }
+        /* the distribution is close to uniform, so the guess from scale is
+         * at most a few blocks off */
+        blk = (int)(scale[d]*s);
+        if (blk > nb-1) blk = nb-1;
+        while (blk > 0 && dmap[blk] > s) blk--;
+        while (blk < nb-1 && dmap[blk+1] <= s) blk++;
+        lo = dmap[blk];
+        hi = blk == nb-1 ? dims[d] : dmap[blk+1]-1;
+        off += (s-lo+width[d])*factor;
+        factor *= hi-lo+1+2*width[d];
+        o += blk*stride;
+        stride *= nb;
+      }
+      owner[k] = (int)o;
+      offset[k] = off;
+      if (count[o]++ == 0) active[nactive++] = (int)o;
+    }
+
+    /* turn bucket sizes into bucket starts */
+    pos = 0;
+    for (j=0; j<nactive; j++) {
+      Integer o = active[j], iproc = o, len = count[o];
+      if (p_handle == 0) iproc = PGRP_LIST[p_handle].inv_map_proc_list[iproc];
+      if (num_rstrctd > 0) iproc = GA[handle].rstrctd_list[iproc];
+      gs->base[o] = GA[handle].ptr[iproc];
+      count[o] = pos;
+      pos += len;
+      if (gs_world_proc(handle, o) == me) nlocal += len;
+    }
+
+    /* bucket the local and remote pointers by owner */
+    for (k=0; k<n; k++) {
+      Integer o = owner[k];
+      pos = count[o]++;
+      ptr_rem[pos] = gs->base[o] + offset[k]*item_size;
+      ptr_loc[pos] = ((char*)v) + (first+k)*item_size;
+    }
+
+    /* one vector operation per owner, count[o] is the end of its bucket */
+    pos = 0;
+    for (j=0; j<nactive; j++) {
+      Integer o = active[j], tproc = gs_world_proc(handle, o);
+      armci_giov_t desc;
+      armci_hdl_t *nbhandle = &gs->nbhandle[b][j];
+      int rc = 0;
+
+      desc.bytes = item_size;
+      desc.ptr_array_len = (int)(count[o]-pos);
+      ARMCI_INIT_HANDLE(nbhandle);
+      switch(op) {
+        case GATHER:
+          desc.src_ptr_array = ptr_rem+pos;
+          desc.dst_ptr_array = ptr_loc+pos;
+          rc=ARMCI_NbGetV(&desc, 1, (int)tproc, nbhandle);
+          if(rc) pnga_error("gather failed in armci",rc);
+          break;
+        case SCATTER:
+          desc.src_ptr_array = ptr_loc+pos;
+          desc.dst_ptr_array = ptr_rem+pos;
+          if(GA_fence_set) fence_array[tproc]=1;
+          rc=ARMCI_NbPutV(&desc, 1, (int)tproc, nbhandle);
+          if(rc) pnga_error("scatter failed in armci",rc);
+          break;
+        case SCATTER_ACC:
+          desc.src_ptr_array = ptr_loc+pos;
+          desc.dst_ptr_array = ptr_rem+pos;
+          if(GA_fence_set) fence_array[tproc]=1;
+          rc=ARMCI_NbAccV(optype, alpha, &desc, 1, (int)tproc, nbhandle);
+          if(rc) pnga_error("scatter_acc failed in armci",rc);
+          break;
+        default: pnga_error("operation not supported",op);
+      }
+      pos = count[o];
+      count[o] = 0;
+    }
+    gs->nactive[b] = nactive;
+    b = 1-b;
+  }
+
+  gs_wait(gs, 0);
+  gs_wait(gs, 1);
+  gs_release(handle, gs);
+
+  *totbytes = item_size * nv;
+  *locbytes = item_size * nlocal;
+}
+
 /*\ GATHER OPERATION elements from the global array into v
 \*/
 void gai_gatscat_new(int op, Integer g_a, void* v, void *subscript,
@@ -3413,6 +3905,12 @@ void gai_gatscat_new(int op, Integer g_a, void* v, void *subscript,
 
     
 
+    if (GA[handle].distr_type == REGULAR && (op != SCATTER_ACC || alpha)) {
+      gai_gatscat_regular(op, g_a, v, subscript, c_flag, nv, locbytes,
+          totbytes, alpha);
+      return;
+    }
+
     me = pnga_nodeid();
     num_rstrctd = GA[handle].num_rstrctd;
     nblock = GA[handle].nblock;
@@ -3645,6 +4143,8 @@ void pnga_scatter(Integer g_a, void* v, void *subscript, Integer c_flag, Integer
   ga_check_handleM(g_a, "nga_scatter");
   
   GAstat.numsca++;
+  /* scattered elements are not tracked individually */
+  if (GA[GA_OFFSET+g_a].merge) gai_merge_mark(g_a, NULL, NULL);
 
 #ifdef USE_GATSCAT_NEW
   gai_gatscat_new(SCATTER,g_a,v,subscript,c_flag,nv,&GAbytes.scatot,&GAbytes.scaloc, NULL);
@@ -3670,6 +4170,7 @@ void pnga_scatter_acc(Integer g_a, void* v, void *subscript, Integer c_flag,
   ga_check_handleM(g_a, "nga_scatter_acc");
   
   GAstat.numsca++;
+  if (GA[GA_OFFSET+g_a].merge) gai_merge_mark(g_a, NULL, NULL);
 
 #ifdef USE_GATSCAT_NEW
   gai_gatscat_new(SCATTER_ACC, g_a, v, subscript, c_flag, nv, &GAbytes.scatot,
@@ -3990,6 +4491,7 @@ void *pval;
 
     GAstat.numrdi++;
     GAbytes.rditot += (double)sizeof(Integer);
+    if (GA[handle].merge) gai_merge_mark(g_a, subscript, subscript);
     p_handle = GA[handle].p_handle;
     ndim = GA[handle].ndim;
 
@@ -4264,6 +4766,7 @@ void pnga_strided_put(Integer g_a, Integer *lo, Integer *hi, Integer *skip,
   ndim = GA[handle].ndim;
   nproc = pnga_nnodes();
   p_handle = GA[handle].p_handle;
+  if (GA[handle].merge) gai_merge_mark(g_a, lo, hi);
 
   /* check values of skips to make sure they are legitimate */
   for (i = 0; i<ndim; i++) {
@@ -4428,6 +4931,7 @@ void pnga_strided_acc(Integer g_a, Integer *lo, Integer *hi, Integer *skip,
   type = GA[handle].type;
   nproc = pnga_nnodes();
   p_handle = GA[handle].p_handle;
+  if (GA[handle].merge) gai_merge_mark(g_a, lo, hi);
 
   if (type == C_DBL) optype = ARMCI_ACC_DBL;
   else if (type == C_FLOAT) optype = ARMCI_ACC_FLT;
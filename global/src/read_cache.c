@@ -0,0 +1,390 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+/*
+ * module: read_cache.c
+ * description: implements the local cache used by pnga_get for arrays
+ * that have the "read_cache" property. Cached patches are kept in an
+ * index sorted on the lower bound of the first dimension and in an LRU
+ * list that is trimmed to a per-array byte budget. A request can be
+ * assembled from several overlapping cached patches plus a single remote
+ * get for whatever part of the request is not covered.
+ *
+ * DISCLAIMER
+ *
+ * This material was prepared as an account of work sponsored by an
+ * agency of the United States Government.  Neither the United States
+ * Government nor the United States Department of Energy, nor Battelle,
+ * nor any of their employees, MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR
+ * ASSUMES ANY LEGAL LIABILITY OR RESPONSIBILITY FOR THE ACCURACY,
+ * COMPLETENESS, OR USEFULNESS OF ANY INFORMATION, APPARATUS, PRODUCT,
+ * SOFTWARE, OR PROCESS DISCLOSED, OR REPRESENTS THAT ITS USE WOULD NOT
+ * INFRINGE PRIVATELY OWNED RIGHTS.
+ *
+ *
+ * ACKNOWLEDGMENT
+ *
+ * This software and its documentation were produced with United States
+ * Government support under Contract Number DE-AC06-76RLO-1830 awarded by
+ * the United States Department of Energy.  The United States Government
+ * retains a paid-up non-exclusive, irrevocable worldwide license to
+ * reproduce, prepare derivative works, perform publicly and display
+ * publicly by or for the US Government, including the right to
+ * distribute to other US Government contractors.
+ */
+#if HAVE_STDIO_H
+#   include <stdio.h>
+#endif
+#if HAVE_STRING_H
+#   include <string.h>
+#endif
+#if HAVE_STDLIB_H
+#   include <stdlib.h>
+#endif
+#include "global.h"
+#include "globalp.h"
+#include "base.h"
+#include "macdecls.h"
+#include "ga-papi.h"
+#include "ga-wapi.h"
+#include "thread-safe.h"
+
+/* from onesided.c */
+extern void ngai_get_common(Integer g_a, Integer *lo, Integer *hi, void *buf,
+    Integer *ld, Integer field_off, Integer field_size, Integer *nbhandle);
+extern void gai_mem_copy(int elemsize, int ndim, void *src_ptr,
+    Integer *src_start, Integer *count, Integer *src_ld, void *dst_ptr,
+    Integer *dst_start, Integer *dst_ld);
+
+/* maximum number of cached patches that can be used to assemble a request */
+#define RC_MAX_OVERLAP 64
+
+/**
+ *  Create an empty cache for array handle
+ */
+static gai_read_cache_t* rc_create()
+{
+  gai_read_cache_t *rc = (gai_read_cache_t*)malloc(sizeof(gai_read_cache_t));
+  if (!rc) pnga_error("rc_create: malloc failed",0);
+  rc->index = NULL;
+  rc->nentry = 0;
+  rc->maxentry = 0;
+  rc->maxext = 0;
+  rc->lru_head = NULL;
+  rc->lru_tail = NULL;
+  rc->bytes = 0;
+  return rc;
+}
+
+/**
+ *  Remove entry from LRU list
+ */
+static void rc_lru_unlink(gai_read_cache_t *rc, gai_rc_entry_t *e)
+{
+  if (e->prev) e->prev->next = e->next;
+  else rc->lru_head = e->next;
+  if (e->next) e->next->prev = e->prev;
+  else rc->lru_tail = e->prev;
+  e->prev = e->next = NULL;
+}
+
+/**
+ *  Mark entry as most recently used
+ */
+static void rc_lru_touch(gai_read_cache_t *rc, gai_rc_entry_t *e)
+{
+  if (rc->lru_head == e) return;
+  rc_lru_unlink(rc,e);
+  e->next = rc->lru_head;
+  if (rc->lru_head) rc->lru_head->prev = e;
+  rc->lru_head = e;
+  if (!rc->lru_tail) rc->lru_tail = e;
+}
+
+/**
+ *  Find the first position in the index whose entry has lo[0] > val
+ */
+static int rc_upper_bound(gai_read_cache_t *rc, Integer val)
+{
+  int lo = 0, hi = rc->nentry;
+  while (lo < hi) {
+    int mid = (lo+hi)/2;
+    if (rc->index[mid]->lo[0] <= val) lo = mid+1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+/**
+ *  Remove entry from index and LRU list and free its storage
+ */
+static void rc_remove(gai_read_cache_t *rc, gai_rc_entry_t *e)
+{
+  int i;
+  int pos = rc_upper_bound(rc,e->lo[0]);
+  for (i=pos-1; i>=0; i--) {
+    if (rc->index[i] == e) break;
+  }
+  if (i < 0) pnga_error("rc_remove: entry not found in read cache index",0);
+  memmove(&rc->index[i],&rc->index[i+1],
+      (rc->nentry-i-1)*sizeof(gai_rc_entry_t*));
+  rc->nentry--;
+  rc_lru_unlink(rc,e);
+  rc->bytes -= e->bytes;
+  if (rc->nentry == 0) rc->maxext = 0;
+  free(e->buf);
+  free(e);
+}
+
+/**
+ *  Add entry to index and make it the most recently used entry
+ */
+static void rc_insert(gai_read_cache_t *rc, gai_rc_entry_t *e)
+{
+  int pos;
+  if (rc->nentry == rc->maxentry) {
+    int newmax = rc->maxentry > 0 ? 2*rc->maxentry : 16;
+    gai_rc_entry_t **tmp = (gai_rc_entry_t**)realloc(rc->index,
+        newmax*sizeof(gai_rc_entry_t*));
+    if (!tmp) pnga_error("rc_insert: realloc failed",newmax);
+    rc->index = tmp;
+    rc->maxentry = newmax;
+  }
+  pos = rc_upper_bound(rc,e->lo[0]);
+  memmove(&rc->index[pos+1],&rc->index[pos],
+      (rc->nentry-pos)*sizeof(gai_rc_entry_t*));
+  rc->index[pos] = e;
+  rc->nentry++;
+  if (e->hi[0]-e->lo[0] > rc->maxext) rc->maxext = e->hi[0]-e->lo[0];
+  e->prev = NULL;
+  e->next = rc->lru_head;
+  if (rc->lru_head) rc->lru_head->prev = e;
+  rc->lru_head = e;
+  if (!rc->lru_tail) rc->lru_tail = e;
+  rc->bytes += e->bytes;
+}
+
+/**
+ *  Find all cached patches that intersect the patch [lo,hi]. The index is
+ *  sorted on lo[0] and no entry extends more than maxext past its lower
+ *  bound in the first dimension, so only a short range of the index needs
+ *  to be examined. Returns the number of entries found.
+ */
+static int rc_find_overlap(gai_read_cache_t *rc, int ndim, Integer *lo,
+    Integer *hi, gai_rc_entry_t **list, int maxlist)
+{
+  int i, d, n = 0;
+  for (i=rc_upper_bound(rc,hi[0])-1; i>=0 && n<maxlist; i--) {
+    gai_rc_entry_t *e = rc->index[i];
+    if (e->lo[0] + rc->maxext < lo[0]) break;
+    for (d=0; d<ndim; d++) {
+      if (e->hi[d] < lo[d] || e->lo[d] > hi[d]) break;
+    }
+    if (d == ndim) list[n++] = e;
+  }
+  return n;
+}
+
+/**
+ *  Copy the intersection of cached patch e and [lo,hi] into buf
+ */
+static void rc_copy_out(Integer handle, gai_rc_entry_t *e, Integer *lo,
+    Integer *hi, void *buf, Integer *ld)
+{
+  int d, ndim = GA[handle].ndim;
+  Integer src_start[MAXDIM], dst_start[MAXDIM], count[MAXDIM];
+  Integer src_ld[MAXDIM];
+  for (d=0; d<ndim; d++) {
+    Integer ilo = GA_MAX(lo[d],e->lo[d]);
+    Integer ihi = GA_MIN(hi[d],e->hi[d]);
+    src_start[d] = ilo - e->lo[d];
+    dst_start[d] = ilo - lo[d];
+    count[d] = ihi - ilo + 1;
+    src_ld[d] = e->hi[d] - e->lo[d] + 1;
+  }
+  gai_mem_copy(GA[handle].elemsize,ndim,e->buf,src_start,count,src_ld,
+      buf,dst_start,ld);
+}
+
+/**
+ *  Evict least recently used entries until an additional nbytes fits in
+ *  the budget for array handle
+ */
+static void rc_make_room(Integer handle, gai_read_cache_t *rc, C_Long nbytes)
+{
+  while (rc->lru_tail && rc->bytes + nbytes > GA[handle].rcache_size) {
+    rc_remove(rc,rc->lru_tail);
+    GAstat.numrce++;
+  }
+}
+
+/**
+ *  Shrink the residual patch [rlo,rhi] by removing slabs that are completely
+ *  covered by one of the cached patches in list. A patch that covers the
+ *  residue in every dimension but d and overlaps one end of the residue
+ *  along d lets that end be moved in. Every patch that is used to trim the
+ *  residue is flagged in used. Returns 1 if the residue is empty.
+ */
+static int rc_trim_residue(int ndim, Integer *rlo, Integer *rhi,
+    gai_rc_entry_t **list, int nlist, int *used)
+{
+  int i, d, dd, ncut, changed = 1;
+  while (changed) {
+    changed = 0;
+    for (i=0; i<nlist; i++) {
+      gai_rc_entry_t *e = list[i];
+      ncut = 0;
+      dd = -1;
+      for (d=0; d<ndim; d++) {
+        if (e->lo[d] > rlo[d] || e->hi[d] < rhi[d]) {
+          ncut++;
+          dd = d;
+        }
+      }
+      if (ncut == 0) {
+        used[i] = 1;
+        return 1;
+      } else if (ncut == 1) {
+        if (e->lo[dd] <= rlo[dd] && e->hi[dd] >= rlo[dd]) {
+          rlo[dd] = e->hi[dd]+1;
+          used[i] = 1;
+          changed = 1;
+        } else if (e->hi[dd] >= rhi[dd] && e->lo[dd] <= rhi[dd]) {
+          rhi[dd] = e->lo[dd]-1;
+          used[i] = 1;
+          changed = 1;
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+/**
+ *  Get the patch [lo,hi] of a read_cache array, using cached data wherever
+ *  it is available
+ */
+void gai_read_cache_get(Integer g_a, Integer *lo, Integer *hi, void *buf,
+    Integer *ld)
+{
+  Integer handle = GA_OFFSET + g_a;
+  int i, d, ndim = GA[handle].ndim;
+  int elemsize = GA[handle].elemsize;
+  int nlist, nused, empty;
+  int used[RC_MAX_OVERLAP];
+  gai_rc_entry_t *list[RC_MAX_OVERLAP];
+  gai_read_cache_t *rc;
+  Integer rlo[MAXDIM], rhi[MAXDIM];
+  Integer nelem, offset, factor;
+
+  GA_Internal_Threadsafe_Lock();
+  if (GA[handle].rcache == NULL) GA[handle].rcache = rc_create();
+  rc = GA[handle].rcache;
+
+  /* find cached patches that overlap request and trim the part of the
+   * request that still has to come from the array */
+  nlist = rc_find_overlap(rc,ndim,lo,hi,list,RC_MAX_OVERLAP);
+  for (d=0; d<ndim; d++) {
+    rlo[d] = lo[d];
+    rhi[d] = hi[d];
+  }
+  for (i=0; i<nlist; i++) used[i] = 0;
+  empty = rc_trim_residue(ndim,rlo,rhi,list,nlist,used);
+  for (d=0; d<ndim && !empty; d++) {
+    if (rhi[d] < rlo[d]) empty = 1;
+  }
+
+  /* copy cached pieces into buffer */
+  nused = 0;
+  for (i=0; i<nlist; i++) {
+    if (used[i]) {
+      rc_copy_out(handle,list[i],lo,hi,buf,ld);
+      rc_lru_touch(rc,list[i]);
+      nused++;
+    }
+  }
+
+  if (empty) {
+    GAstat.numrch++;
+    GA_Internal_Threadsafe_Unlock();
+    return;
+  }
+  if (nused > 0) GAstat.numrcp++;
+  else GAstat.numrcm++;
+
+  /* fetch residue directly into its location in the user buffer */
+  offset = 0;
+  factor = 1;
+  for (d=0; d<ndim; d++) {
+    offset += (rlo[d]-lo[d])*factor;
+    if (d<ndim-1) factor *= ld[d];
+  }
+  ngai_get_common(g_a,rlo,rhi,(char*)buf+offset*elemsize,ld,0,-1,
+      (Integer*)NULL);
+
+  /* add residue to cache. Cached patches that lie inside the residue are
+   * now redundant and are dropped */
+  gam_CountElems(ndim, rlo, rhi, &nelem);
+  if ((C_Long)nelem*elemsize <= GA[handle].rcache_size) {
+    gai_rc_entry_t *e;
+    Integer src_start[MAXDIM], count[MAXDIM], nld[MAXDIM], nstart[MAXDIM];
+    for (i=0; i<nlist; i++) {
+      if (used[i]) continue;
+      for (d=0; d<ndim; d++) {
+        if (list[i]->lo[d] < rlo[d] || list[i]->hi[d] > rhi[d]) break;
+      }
+      if (d == ndim) rc_remove(rc,list[i]);
+    }
+    rc_make_room(handle,rc,(C_Long)nelem*elemsize);
+    e = (gai_rc_entry_t*)malloc(sizeof(gai_rc_entry_t));
+    if (!e) pnga_error("gai_read_cache_get: malloc failed",0);
+    e->bytes = (C_Long)nelem*elemsize;
+    e->buf = malloc(e->bytes);
+    if (!e->buf) pnga_error("gai_read_cache_get: malloc failed",e->bytes);
+    for (d=0; d<ndim; d++) {
+      e->lo[d] = rlo[d];
+      e->hi[d] = rhi[d];
+      src_start[d] = rlo[d]-lo[d];
+      nstart[d] = 0;
+      count[d] = rhi[d]-rlo[d]+1;
+      nld[d] = count[d];
+    }
+    gai_mem_copy(elemsize,ndim,buf,src_start,count,ld,e->buf,nstart,nld);
+    rc_insert(rc,e);
+  }
+  GA_Internal_Threadsafe_Unlock();
+}
+
+/**
+ *  Release all cached patches for array handle
+ */
+void gai_read_cache_free(Integer handle)
+{
+  gai_read_cache_t *rc = GA[handle].rcache;
+  if (rc == NULL) return;
+  while (rc->lru_head) rc_remove(rc,rc->lru_head);
+  if (rc->index) free(rc->index);
+  free(rc);
+  GA[handle].rcache = NULL;
+}
+
+/**
+ *  Set the maximum number of bytes that the read cache for g_a can hold.
+ *  Cached patches are evicted in least recently used order if the current
+ *  contents exceed the new limit.
+ */
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_set_read_cache_size = pnga_set_read_cache_size
+#endif
+
+void pnga_set_read_cache_size(Integer g_a, Integer size)
+{
+  Integer handle = GA_OFFSET + g_a;
+  ga_check_handleM(g_a, "pnga_set_read_cache_size");
+  if (size < 0) pnga_error("Read cache size must be non-negative",size);
+  GA_Internal_Threadsafe_Lock();
+  GA[handle].rcache_size = (C_Long)size;
+  if (GA[handle].rcache) rc_make_room(handle,GA[handle].rcache,0);
+  GA_Internal_Threadsafe_Unlock();
+}
@@ -0,0 +1,516 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+/**************************************************************
+File: reduce_fused.c
+
+Fused reductions over whole arrays
+
+A fused reduction computes several reductions over one or more
+conforming global arrays in one pass over local memory and combines
+all of them with one global operation for the sums and one for the
+extreme values:
+
+    ops = { GA_ROP_DOT, GA_ROP_SUMSQ, GA_ROP_ASUM, GA_ROP_AMAX }
+    g_x = { r, r, r, r }
+    g_y = { z, 0, 0, 0 }
+
+returns r.z, r.r, |r|_1 and |r|_inf.  Reduction k is applied to
+g_x[k]; GA_ROP_DOT also reads g_y[k], which is ignored otherwise.
+Results have the type of the arrays.
+
+Local blocks are reduced RED_BLOCK elements at a time: every
+reduction makes a branch-free pass over a block while it is in cache.
+Sums of real arrays are accumulated in double precision and keep the
+rounding error of every addition (compensated summation).  With
+GA_REDUCE_REPRODUCIBLE=1 in the environment, processes instead exchange
+their partial results by rank, RED_SLOTS values at a time, so the final
+sums are added in the same order on every process and in every run.
+Runs are spread over threads when the library is compiled with OpenMP;
+the partial results of the threads are combined in a fixed order.
+
+**************************************************************/
+
+#if HAVE_STDLIB_H
+#   include <stdlib.h>
+#endif
+#if HAVE_STRING_H
+#   include <string.h>
+#endif
+#if HAVE_MATH_H
+#   include <math.h>
+#endif
+#include <float.h>
+#include <limits.h>
+#ifdef _OPENMP
+#   include <omp.h>
+#endif
+#include "globalp.h"
+#include "ga_iterator.h"
+#include "ga-papi.h"
+#include "ga-wapi.h"
+
+#define RED_BLOCK 512     /* elements reduced at a time */
+#define RED_MAX 16        /* most reductions, and most distinct arrays */
+#define RED_MAXCHUNK 32   /* most threads sharing a run */
+#define RED_SLOTS 4096    /* largest exchange of partial results by rank */
+
+/* partial result of one reduction: a compensated sum (s,c) or extreme
+   value s for real arrays, an exact sum or extreme value l for integer
+   arrays */
+typedef struct {
+  double s, c;
+  long long l;
+} red_acc_t;
+
+static void gai_acc_add(red_acc_t *acc, double x)
+{
+  double t = acc->s + x;
+  if (fabs(acc->s) >= fabs(x)) acc->c += (acc->s - t) + x;
+  else acc->c += (x - t) + acc->s;
+  acc->s = t;
+}
+
+#define RED_IS_INT(type) ((type) == C_INT || (type) == C_LONG \
+    || (type) == C_LONGLONG)
+
+/*\ initial value of a partial result
+\*/
+static void gai_acc_init(Integer type, Integer op, red_acc_t *acc)
+{
+  acc->s = 0.0; acc->c = 0.0; acc->l = 0;
+  if (op == GA_ROP_MAX) { acc->s = -DBL_MAX; acc->l = LLONG_MIN; }
+  if (op == GA_ROP_MIN) { acc->s = DBL_MAX; acc->l = LLONG_MAX; }
+}
+
+/*\ fold partial result b into a
+\*/
+static void gai_acc_merge(Integer type, Integer op, red_acc_t *a,
+        red_acc_t *b)
+{
+  switch (op) {
+    case GA_ROP_AMAX: case GA_ROP_MAX:
+      if (b->s > a->s) a->s = b->s;
+      if (b->l > a->l) a->l = b->l;
+      break;
+    case GA_ROP_MIN:
+      if (b->s < a->s) a->s = b->s;
+      if (b->l < a->l) a->l = b->l;
+      break;
+    default:
+      if (RED_IS_INT(type)) {
+        a->l += b->l;
+      } else {
+        gai_acc_add(a, b->s);
+        gai_acc_add(a, b->c);
+      }
+  }
+}
+
+/* All reductions over n contiguous elements of type T.  Sums of a block
+   are formed in type S with SUM and then added into the partial result;
+   extreme values are kept in field F.  Compensated sums keep the exact
+   rounding error of every addition (TwoSum, which needs no branches) and
+   run in RED_LANES independent lanes, so that consecutive elements do
+   not wait on each other; the lanes are added in a fixed order. */
+#define RED_LANES 8
+#define RED_SUM_INT(EXPR)                                                  \
+            for (i=0; i<len; i++) s[0] += (EXPR);                          \
+            acc[k].l += s[0];                                              \
+            break;
+#define RED_TWO_SUM(L)                                                     \
+            u = s[L] + x; z = u - s[L];                                    \
+            c[L] += (s[L] - (u - z)) + (x - z);                            \
+            s[L] = u;
+#define RED_SUM_CMP(EXPR)                                                  \
+            {                                                              \
+            Integer j;                                                     \
+            double x, u, z;                                                \
+            for (j=0; j+RED_LANES<=len; j+=RED_LANES) {                    \
+                for (l=0; l<RED_LANES; l++) {                              \
+                    i = j+l; x = (EXPR);                                   \
+                    RED_TWO_SUM(l)                                         \
+                }                                                          \
+            }                                                              \
+            for (i=j; i<len; i++) {                                        \
+                x = (EXPR);                                                \
+                RED_TWO_SUM(0)                                             \
+            }                                                              \
+            for (l=0; l<RED_LANES; l++) {                                  \
+                gai_acc_add(&acc[k], s[l]);                                \
+                gai_acc_add(&acc[k], c[l]);                                \
+            }                                                              \
+            }                                                              \
+            break;
+#define RED_EXT(EXPR, CMP, F)                                              \
+            i = 0; m = (EXPR);                                             \
+            for (i=1; i<len; i++) { t = (EXPR); m = t CMP m ? t : m; }     \
+            if (m CMP acc[k].F) acc[k].F = m;                              \
+            break;
+
+#define RED_KERNEL(NAME,T,S,F,SUM)                                         \
+static void gai_reduce_##NAME(Integer nred, Integer *ops, Integer *ix,     \
+        Integer *iy, char **in, Integer n, red_acc_t *acc)                 \
+{                                                                          \
+    Integer i, k, l, off, len;                                             \
+    T *a, *b, m, t;                                                        \
+    S s[RED_LANES], c[RED_LANES];                                          \
+                                                                           \
+    for (off=0; off<n; off+=RED_BLOCK) {                                   \
+        len = GA_MIN(RED_BLOCK, n-off);                                    \
+        for (k=0; k<nred; k++) {                                           \
+            a = (T*)in[ix[k]] + off;                                       \
+            b = iy[k] < 0 ? a : (T*)in[iy[k]] + off;                       \
+            for (l=0; l<RED_LANES; l++) s[l] = c[l] = 0;                   \
+            switch (ops[k]) {                                              \
+              case GA_ROP_SUM: SUM((S)a[i])                                \
+              case GA_ROP_DOT: SUM((S)a[i]*(S)b[i])                        \
+              case GA_ROP_ASUM: SUM((S)(a[i] >= 0 ? a[i] : -a[i]))         \
+              case GA_ROP_SUMSQ: SUM((S)a[i]*(S)a[i])                      \
+              case GA_ROP_AMAX: RED_EXT(a[i] >= 0 ? a[i] : -a[i], >, F)    \
+              case GA_ROP_MAX: RED_EXT(a[i], >, F)                         \
+              case GA_ROP_MIN: RED_EXT(a[i], <, F)                         \
+            }                                                              \
+        }                                                                  \
+    }                                                                      \
+}
+
+RED_KERNEL(int, int, long long, l, RED_SUM_INT)
+RED_KERNEL(long, long, long long, l, RED_SUM_INT)
+RED_KERNEL(longlong, long long, long long, l, RED_SUM_INT)
+RED_KERNEL(float, float, double, s, RED_SUM_CMP)
+RED_KERNEL(double, double, double, s, RED_SUM_CMP)
+
+#undef RED_KERNEL
+#undef RED_SUM_INT
+#undef RED_SUM_CMP
+#undef RED_TWO_SUM
+#undef RED_EXT
+#undef RED_LANES
+
+
+/*\ reduce n contiguous elements of every array into acc
+\*/
+static void gai_reduce_run(Integer type, Integer nred, Integer *ops,
+        Integer *ix, Integer *iy, char **in, Integer nin, Integer n,
+        red_acc_t *acc)
+{
+  red_acc_t part[RED_MAXCHUNK][RED_MAX];
+  Integer nblk = (n + RED_BLOCK - 1)/RED_BLOCK;
+  Integer size = GAsizeofM(type);
+  Integer nchunk = 1, c, k;
+
+#ifdef _OPENMP
+  if (nblk > 8) nchunk = GA_MIN(omp_get_max_threads(), RED_MAXCHUNK);
+#endif
+  for (c=0; c<nchunk; c++)
+    for (k=0; k<nred; k++) gai_acc_init(type, ops[k], &part[c][k]);
+
+  /* each chunk is a fixed range of blocks, so that the partial results
+     are combined in the same order in every run */
+#ifdef _OPENMP
+# pragma omp parallel for schedule(static) if(nchunk > 1)
+#endif
+  for (c=0; c<nchunk; c++) {
+    char *cin[RED_MAX];
+    Integer j, first = (c*nblk/nchunk)*RED_BLOCK;
+    Integer len = GA_MIN(((c+1)*nblk/nchunk)*RED_BLOCK, n) - first;
+
+    if (len <= 0) continue;
+    for (j=0; j<nin; j++) cin[j] = in[j] + first*size;
+    switch (type) {
+      case C_INT:
+        gai_reduce_int(nred, ops, ix, iy, cin, len, part[c]);
+        break;
+      case C_LONG:
+        gai_reduce_long(nred, ops, ix, iy, cin, len, part[c]);
+        break;
+      case C_LONGLONG:
+        gai_reduce_longlong(nred, ops, ix, iy, cin, len, part[c]);
+        break;
+      case C_FLOAT:
+        gai_reduce_float(nred, ops, ix, iy, cin, len, part[c]);
+        break;
+      case C_DBL:
+        gai_reduce_double(nred, ops, ix, iy, cin, len, part[c]);
+        break;
+    }
+  }
+  for (c=0; c<nchunk; c++)
+    for (k=0; k<nred; k++) gai_acc_merge(type, ops[k], &acc[k], &part[c][k]);
+}
+
+
+/*\ Combine the partial results of all processes in group grp in rank
+ *  order.  Every process contributes its results in its own slot of a
+ *  buffer that is summed over the group, which exchanges them exactly;
+ *  they are then combined in rank order.  Groups whose results do not fit
+ *  in RED_SLOTS values are exchanged in windows of consecutive ranks, one
+ *  operation per window, so the order of the additions does not depend on
+ *  the number of processes beyond that.
+\*/
+static void gai_reduce_combine_ranked(Integer grp, Integer type,
+        Integer nred, Integer *ops, red_acc_t *acc)
+{
+  Integer isint = RED_IS_INT(type);
+  Integer nper = isint ? 1 : 2;
+  Integer me = pnga_pgroup_nodeid(grp), nproc = pnga_pgroup_nnodes(grp);
+  Integer gtype = isint ? C_LONGLONG : C_DBL;
+  Integer nval = nper*nred, nslot, first, nwin, i, k, p;
+  red_acc_t tot[RED_MAX], other;
+  double *dbuf;
+  long long *lbuf;
+  void *buf;
+
+  /* processes exchanged at a time */
+  nslot = GA_MIN(GA_MAX(1, RED_SLOTS/nval), nproc);
+  buf = malloc(nslot*nval*(isint ? sizeof(long long) : sizeof(double)));
+  if (buf == NULL) pnga_error("ga_reduce_fused: malloc failed ", nslot);
+  dbuf = (double*)buf; lbuf = (long long*)buf;
+  for (k=0; k<nred; k++) gai_acc_init(type, ops[k], &tot[k]);
+
+  for (first=0; first<nproc; first+=nslot) {
+    nwin = GA_MIN(nslot, nproc-first);
+    for (i=0; i<nwin*nval; i++) {
+      if (isint) lbuf[i] = 0;
+      else dbuf[i] = 0.0;
+    }
+    if (me >= first && me < first+nwin) {
+      p = me-first;
+      for (k=0; k<nred; k++) {
+        if (isint) {
+          lbuf[p*nval+k] = acc[k].l;
+        } else {
+          dbuf[p*nval+2*k] = acc[k].s;
+          dbuf[p*nval+2*k+1] = acc[k].c;
+        }
+      }
+    }
+    pnga_pgroup_gop(grp, gtype, buf, nwin*nval, "+");
+    for (p=0; p<nwin; p++) {
+      for (k=0; k<nred; k++) {
+        gai_acc_init(type, ops[k], &other);
+        if (isint) {
+          other.l = lbuf[p*nval+k];
+        } else {
+          other.s = dbuf[p*nval+2*k];
+          other.c = dbuf[p*nval+2*k+1];
+        }
+        gai_acc_merge(type, ops[k], &tot[k], &other);
+      }
+    }
+  }
+  for (k=0; k<nred; k++) acc[k] = tot[k];
+  free(buf);
+}
+
+
+/*\ Combine the partial results of all processes in group grp with one
+ *  summation over the group for the sums, whose (s,c) pairs are summed
+ *  separately, and one maximum for the extreme values, of which the
+ *  minima are negated.  The rank-ordered exchange is used instead if
+ *  GA_REDUCE_REPRODUCIBLE is set to a nonzero value.
+\*/
+static void gai_reduce_combine(Integer grp, Integer type, Integer nred,
+        Integer *ops, red_acc_t *acc)
+{
+  Integer isint = RED_IS_INT(type);
+  Integer gtype = isint ? C_LONGLONG : C_DBL;
+  Integer nsum = 0, next = 0, k;
+  double dsum[2*RED_MAX], dext[RED_MAX];
+  long long lsum[RED_MAX], lext[RED_MAX];
+  char *value;
+
+  value = getenv("GA_REDUCE_REPRODUCIBLE");
+  if (NULL != value && 0 != atoi(value)) {
+    gai_reduce_combine_ranked(grp, type, nred, ops, acc);
+    return;
+  }
+
+  /* ~l reverses the order of integers without overflow */
+  for (k=0; k<nred; k++) {
+    switch (ops[k]) {
+      case GA_ROP_AMAX: case GA_ROP_MAX:
+        if (isint) lext[next++] = acc[k].l;
+        else dext[next++] = acc[k].s;
+        break;
+      case GA_ROP_MIN:
+        if (isint) lext[next++] = ~acc[k].l;
+        else dext[next++] = -acc[k].s;
+        break;
+      default:
+        if (isint) {
+          lsum[nsum++] = acc[k].l;
+        } else {
+          dsum[nsum++] = acc[k].s;
+          dsum[nsum++] = acc[k].c;
+        }
+    }
+  }
+  if (nsum) pnga_pgroup_gop(grp, gtype, isint ? (void*)lsum : (void*)dsum,
+      nsum, "+");
+  if (next) pnga_pgroup_gop(grp, gtype, isint ? (void*)lext : (void*)dext,
+      next, "max");
+
+  for (k=0, nsum=0, next=0; k<nred; k++) {
+    switch (ops[k]) {
+      case GA_ROP_AMAX: case GA_ROP_MAX:
+        if (isint) acc[k].l = lext[next++];
+        else acc[k].s = dext[next++];
+        break;
+      case GA_ROP_MIN:
+        if (isint) acc[k].l = ~lext[next++];
+        else acc[k].s = -dext[next++];
+        break;
+      default:
+        if (isint) {
+          acc[k].l = lsum[nsum++];
+        } else {
+          acc[k].s = dsum[nsum++];
+          acc[k].c = dsum[nsum++];
+        }
+    }
+  }
+}
+
+
+/*\ Compute the nred reductions ops[k] of the arrays g_x[k] (and g_y[k]
+ *  for GA_ROP_DOT) in one pass over local data, and store the results,
+ *  which have the (real) type of the arrays, in result.  All arrays
+ *  must have the same shape and type and belong to the same group.
+ *  Arrays that are not distributed like g_x[0] are copied first.
+\*/
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_reduce_fused = pnga_reduce_fused
+#endif
+void pnga_reduce_fused(Integer nred, Integer *ops, Integer *g_x,
+                       Integer *g_y, void *result)
+{
+  Integer type, ndim, dims[MAXDIM], rtype, rndim, rdims[MAXDIM];
+  Integer g_in[RED_MAX], g_d[RED_MAX], created[RED_MAX];
+  Integer ix[RED_MAX], iy[RED_MAX];
+  Integer lo[MAXDIM], hi[MAXDIM], ld[RED_MAX][MAXDIM];
+  Integer loR[MAXDIM], hiR[MAXDIM];
+  Integer grp, me, size, nin = 0, i, j, k, compatible;
+  red_acc_t acc[RED_MAX];
+  _iterator_hdl hdl[RED_MAX];
+  char *ptr[RED_MAX];
+  char *tempname = "temp";
+  int local_sync_begin;
+
+  local_sync_begin = _ga_sync_begin;
+  _ga_sync_begin = 1; _ga_sync_end=1; /*remove any previous masking*/
+
+  if (nred < 1 || nred > RED_MAX)
+    pnga_error("ga_reduce_fused: bad number of reductions ", nred);
+  pnga_check_handle(g_x[0], "ga_reduce_fused");
+  grp = pnga_get_pgroup(g_x[0]);
+  me = pnga_pgroup_nodeid(grp);
+  if(local_sync_begin)pnga_pgroup_sync(grp);
+
+  pnga_inquire(g_x[0], &rtype, &rndim, rdims);
+  if (!RED_IS_INT(rtype) && rtype != C_FLOAT && rtype != C_DBL)
+    pnga_error("ga_reduce_fused: type not supported ", rtype);
+  size = GAsizeofM(rtype);
+
+  /* list the distinct arrays and check that they conform */
+  for (k=0; k<nred; k++) {
+    if (ops[k] < GA_ROP_SUM || ops[k] > GA_ROP_MIN)
+      pnga_error("ga_reduce_fused: unknown reduction ", ops[k]);
+    iy[k] = -1;
+    for (j=0; j<2; j++) {
+      Integer g = j ? g_y[k] : g_x[k];
+      if (j && ops[k] != GA_ROP_DOT) break;
+      for (i=0; i<nin; i++) if (g_in[i] == g) break;
+      if (i == nin) {
+        if (nin == RED_MAX)
+          pnga_error("ga_reduce_fused: too many arrays ", nin);
+        pnga_check_handle(g, "ga_reduce_fused");
+        pnga_inquire(g, &type, &ndim, dims);
+        if (type != rtype) pnga_error("ga_reduce_fused: types mismatch ", k);
+        if (ndim != rndim) pnga_error("ga_reduce_fused: shapes mismatch ", k);
+        for (i=0; i<ndim; i++)
+          if (dims[i] != rdims[i])
+            pnga_error("ga_reduce_fused: shapes mismatch ", k);
+        if (pnga_get_pgroup(g) != grp)
+          pnga_error("ga_reduce_fused: arrays on different groups ", k);
+        if (pnga_is_mirrored(g))
+          pnga_error("ga_reduce_fused: mirrored arrays not supported ", k);
+        i = nin;
+        g_in[nin++] = g;
+      }
+      if (j) iy[k] = i;
+      else ix[k] = i;
+    }
+    gai_acc_init(rtype, ops[k], &acc[k]);
+  }
+
+  /* copy arrays that are distributed differently from the first one */
+  for (i=0; i<nin; i++) {
+    g_d[i] = g_in[i];
+    created[i] = 0;
+    if (i == 0) continue;
+    compatible = 0;
+    if (pnga_total_blocks(g_in[i]) < 0 && pnga_total_blocks(g_in[0]) < 0) {
+      pnga_distribution(g_in[i], me, lo, hi);
+      pnga_distribution(g_in[0], me, loR, hiR);
+      compatible = pnga_comp_patch(rndim, lo, hi, rndim, loR, hiR);
+    }
+    pnga_pgroup_gop(grp, pnga_type_f2c(MT_F_INT), &compatible, 1, "&&");
+    if (!compatible) {
+      if (!pnga_duplicate(g_in[0], &g_d[i], tempname))
+        pnga_error("ga_reduce_fused: dup failed", 0L);
+      pnga_copy(g_in[i], g_d[i]);
+      created[i] = 1;
+    }
+  }
+
+  /* walk the local blocks of all arrays in step */
+  for (i=0; i<nin; i++) pnga_local_iterator_init(g_d[i], &hdl[i]);
+  while (pnga_local_iterator_next(&hdl[0], loR, hiR, &ptr[0], ld[0])) {
+    Integer nrow, nelem, contig = 1, row, idx, rem, off, stride;
+    char *rin[RED_MAX];
+
+    for (i=1; i<nin; i++)
+      pnga_local_iterator_next(&hdl[i], lo, hi, &ptr[i], ld[i]);
+
+    for (j=0; j<rndim-1; j++)
+      for (i=0; i<nin; i++) if (ld[i][j] != hiR[j]-loR[j]+1) contig = 0;
+    nelem = hiR[0]-loR[0]+1;
+    nrow = 1; for (j=1; j<rndim; j++) nrow *= hiR[j]-loR[j]+1;
+    if (contig) {
+      gai_reduce_run(rtype, nred, ops, ix, iy, ptr, nin, nelem*nrow, acc);
+      continue;
+    }
+
+    /* blocks with ghost cells or padding are done a row at a time */
+    for (row=0; row<nrow; row++) {
+      for (i=0; i<nin; i++) {
+        rem = row; off = 0; stride = 1;
+        for (j=1; j<rndim; j++) {
+          idx = rem % (hiR[j]-loR[j]+1);
+          rem /= hiR[j]-loR[j]+1;
+          stride *= ld[i][j-1];
+          off += idx*stride;
+        }
+        rin[i] = ptr[i] + off*size;
+      }
+      gai_reduce_run(rtype, nred, ops, ix, iy, rin, nin, nelem, acc);
+    }
+  }
+
+  for (i=nin-1; i>=0; i--) if (created[i]) pnga_destroy(g_d[i]);
+
+  gai_reduce_combine(grp, rtype, nred, ops, acc);
+  for (k=0; k<nred; k++) {
+    double d = acc[k].s + acc[k].c;
+    switch (rtype) {
+      case C_INT: ((int*)result)[k] = (int)acc[k].l; break;
+      case C_LONG: ((long*)result)[k] = (long)acc[k].l; break;
+      case C_LONGLONG: ((long long*)result)[k] = acc[k].l; break;
+      case C_FLOAT: ((float*)result)[k] = (float)d; break;
+      case C_DBL: ((double*)result)[k] = d; break;
+    }
+  }
+}
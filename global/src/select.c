@@ -28,7 +28,7 @@ typedef struct {
         SingleComplex extra2;      
 } elem_info_t;
 
-static void snga_select_elem(Integer type, char* op, void *ptr, Integer elems, elem_info_t *info,
+static void snga_select_elem(Integer type, int is_min, void *ptr, Integer elems, elem_info_t *info,
                       Integer *ind)
 {
   Integer i;
@@ -44,7 +44,7 @@ static void snga_select_elem(Integer type, char* op, void *ptr, Integer elems, e
     case C_INT:
     ia = (int*)ptr;
     ival = *ia;
-    if (strncmp(op,"min",3) == 0)
+    if (is_min)
       for(i=0;i<elems;i++){ if(ival > ia[i]) {ival=ia[i];*ind=i; } } 
     else
       for(i=0;i<elems;i++){ if(ival < ia[i]) {ival=ia[i];*ind=i; } }
@@ -55,7 +55,7 @@ static void snga_select_elem(Integer type, char* op, void *ptr, Integer elems, e
     case C_DCPL:
     ca = (DoubleComplex*)ptr;
     dval=ca->real*ca->real + ca->imag*ca->imag;
-    if (strncmp(op,"min",3) == 0)
+    if (is_min)
       for(i=0;i<elems;i++, ca+=1 ){
         DoublePrecision tmp = ca->real*ca->real + ca->imag*ca->imag; 
         if(dval > tmp){dval = tmp; *ind = i;}
@@ -73,7 +73,7 @@ static void snga_select_elem(Integer type, char* op, void *ptr, Integer elems, e
     case C_SCPL:
        cfa = (SingleComplex*)ptr;
        fval=cfa->real*cfa->real + cfa->imag*cfa->imag;
-       if (strncmp(op,"min",3) == 0)
+       if (is_min)
           for(i=0;i<elems;i++, cfa+=1 ){
              float tmp = cfa->real*cfa->real + cfa->imag*cfa->imag;
              if(fval > tmp){fval = tmp; *ind = i;}
@@ -91,7 +91,7 @@ static void snga_select_elem(Integer type, char* op, void *ptr, Integer elems, e
     case C_DBL:
     da = (double*)ptr;
     dval = *da;
-    if (strncmp(op,"min",3) == 0)
+    if (is_min)
       for(i=0;i<elems;i++){ if(dval > da[i]) {dval=da[i];*ind=i; } }
     else
       for(i=0;i<elems;i++){ if(dval < da[i]) {dval=da[i];*ind=i; } }
@@ -103,7 +103,7 @@ static void snga_select_elem(Integer type, char* op, void *ptr, Integer elems, e
     fa = (float*)ptr;
     fval = *fa;
 
-    if (strncmp(op,"min",3) == 0)
+    if (is_min)
       for(i=0;i<elems;i++){ if(fval > fa[i]) {fval=fa[i];*ind=i; } }
     else
       for(i=0;i<elems;i++){ if(fval < fa[i]) {fval=fa[i];*ind=i; } }
@@ -114,7 +114,7 @@ static void snga_select_elem(Integer type, char* op, void *ptr, Integer elems, e
     la = (long*)ptr;
     lval = *la;
 
-    if (strncmp(op,"min",3) == 0)
+    if (is_min)
       for(i=0;i<elems;i++){ if(lval > la[i]) {lval=la[i];*ind=i; } }
     else
       for(i=0;i<elems;i++){ if(lval < la[i]) {lval=la[i];*ind=i; } }
@@ -125,7 +125,7 @@ static void snga_select_elem(Integer type, char* op, void *ptr, Integer elems, e
     lla = (long long*)ptr;
     llval = *lla;
 
-    if (strncmp(op,"min",3) == 0)
+    if (is_min)
       for(i=0;i<elems;i++){ if(llval > lla[i]) {llval=lla[i];*ind=i; } }
     else
       for(i=0;i<elems;i++){ if(llval < lla[i]) {llval=lla[i];*ind=i; } }
@@ -147,6 +147,7 @@ void pnga_select_elem(Integer g_a, char* op, void* val, Integer *subscript)
   elem_info_t info;
   Integer num_blocks;
   int     participate=0;
+  int     is_min=0;
   int local_sync_begin;
 
   local_sync_begin = _ga_sync_begin; 
@@ -157,8 +158,9 @@ void pnga_select_elem(Integer g_a, char* op, void* val, Integer *subscript)
 
   pnga_check_handle(g_a, "ga_select_elem");
 
-  if (strncmp(op,"min",3) == 0);
-  else if (strncmp(op,"max",3) == 0);
+  /* decode the operator once */
+  if (strncmp(op,"min",3) == 0) is_min = 1;
+  else if (strncmp(op,"max",3) == 0) is_min = 0;
   else pnga_error("operator not recognized",0);
 
   pnga_inquire(g_a, &type, &ndim, dims);
@@ -176,7 +178,7 @@ void pnga_select_elem(Integer g_a, char* op, void* val, Integer *subscript)
       participate =1;
 
       /* select local element */
-      snga_select_elem(type, op, ptr, elems, &info, &ind);
+      snga_select_elem(type, is_min, ptr, elems, &info, &ind);
 
       /* release access to the data */
       pnga_release(g_a, lo, hi);
@@ -197,7 +199,7 @@ void pnga_select_elem(Integer g_a, char* op, void* val, Integer *subscript)
       participate =1;
 
       /* select local element */
-      snga_select_elem(type, op, ptr, elems, &info, &ind);
+      snga_select_elem(type, is_min, ptr, elems, &info, &ind);
 
       /* release access to the data */
       pnga_release_block_segment(g_a, me);
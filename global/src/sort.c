@@ -0,0 +1,610 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+/**************************************************************
+File: sort.c
+
+Distributed sort of one-dimensional arrays
+
+ga_sort sorts the contents of a 1-D array of integers or reals in
+ascending order, ga_sort_kv also applies the same permutation to a
+second array of any type (so that enumerating it first returns the
+sorting permutation), and ga_sort_rank stores, for every element, the
+number of elements that precede it in sorted order.  The sort is
+stable: equal keys keep the order of their subscripts.
+
+The data is sorted with a sample sort by regular sampling:
+
+ 1. every process sorts its elements and takes evenly spaced samples of
+    the sorted keys (as many as there are processes, up to
+    SORT_SAMPLES in all), and the samples of all processes are exchanged
+    by rank in one global operation;
+ 2. nproc-1 splitters picked from the sorted samples cut the keys into
+    one bucket per process; ties are broken by subscript, so that equal
+    keys cannot pile up in one bucket.  Sampling sorted keys bounds the
+    size of every bucket whatever the order of the input;
+ 3. every process reserves room for its part of each bucket, then sends
+    it with nonblocking one-sided puts to a scratch array with one block
+    per process, of the size of its bucket;
+ 4. every process merges the sorted runs it received and puts its
+    bucket in its place in the array.
+
+The local sort is a least significant digit radix sort on keys mapped to
+unsigned integers that sort in the same order, one byte per pass, that
+skips passes in which all keys have the same byte.  When the library is
+compiled with OpenMP, each pass is spread over threads, each with its
+own histogram, as are the pairwise merges of the runs.
+
+**************************************************************/
+
+#if HAVE_STDLIB_H
+#   include <stdlib.h>
+#endif
+#if HAVE_STRING_H
+#   include <string.h>
+#endif
+#ifdef _OPENMP
+#   include <omp.h>
+#endif
+#include "globalp.h"
+#include "ga-papi.h"
+#include "ga-wapi.h"
+
+#define SORT_OVERSAMPLE 32   /* fewest samples taken by each process */
+#define SORT_SAMPLES 65536   /* most samples over all processes */
+#define SORT_NBMAX 16        /* most puts in flight */
+#define SORT_PARMIN 65536    /* fewest keys sorted with threads */
+#define SORT_MAXTHR 64       /* most threads sharing a sort */
+
+typedef unsigned long long sort_key_t;
+
+/* A key and the subscript of its element, ordered by key, then subscript */
+typedef struct {
+  sort_key_t key;
+  Integer idx;
+} sort_pair_t;
+
+static int gai_sort_pair_cmp(const void *a, const void *b)
+{
+  const sort_pair_t *p = (const sort_pair_t*)a, *q = (const sort_pair_t*)b;
+  if (p->key != q->key) return p->key < q->key ? -1 : 1;
+  if (p->idx != q->idx) return p->idx < q->idx ? -1 : 1;
+  return 0;
+}
+
+
+/* Map keys of type T to unsigned integers that sort in the same order,
+   and back.  Integers have their sign bit flipped; for reals, negative
+   numbers have all bits flipped so that larger magnitudes sort first. */
+#define SORT_KEY_INT(NAME,T,U)                                             \
+static void gai_sort_encode_##NAME(T *a, sort_key_t *u, Integer n)         \
+{                                                                          \
+    const U sign = (U)1 << (8*sizeof(U)-1);                                \
+    Integer i;                                                             \
+    for (i=0; i<n; i++) u[i] = (sort_key_t)((U)a[i] ^ sign);               \
+}                                                                          \
+static void gai_sort_decode_##NAME(sort_key_t *u, T *a, Integer n)         \
+{                                                                          \
+    const U sign = (U)1 << (8*sizeof(U)-1);                                \
+    Integer i;                                                             \
+    for (i=0; i<n; i++) a[i] = (T)((U)u[i] ^ sign);                        \
+}
+
+#define SORT_KEY_REAL(NAME,T,U)                                            \
+static void gai_sort_encode_##NAME(T *a, sort_key_t *u, Integer n)         \
+{                                                                          \
+    const U sign = (U)1 << (8*sizeof(U)-1);                                \
+    Integer i;                                                             \
+    U b;                                                                   \
+    for (i=0; i<n; i++) {                                                  \
+        memcpy(&b, &a[i], sizeof(U));                                      \
+        u[i] = (sort_key_t)(b & sign ? ~b : b ^ sign);                     \
+    }                                                                      \
+}                                                                          \
+static void gai_sort_decode_##NAME(sort_key_t *u, T *a, Integer n)         \
+{                                                                          \
+    const U sign = (U)1 << (8*sizeof(U)-1);                                \
+    Integer i;                                                             \
+    U b;                                                                   \
+    for (i=0; i<n; i++) {                                                  \
+        b = (U)u[i];                                                       \
+        b = b & sign ? b ^ sign : ~b;                                      \
+        memcpy(&a[i], &b, sizeof(U));                                      \
+    }                                                                      \
+}
+
+SORT_KEY_INT(int, int, unsigned int)
+SORT_KEY_INT(long, long, unsigned long)
+SORT_KEY_INT(longlong, long long, unsigned long long)
+SORT_KEY_REAL(float, float, unsigned int)
+SORT_KEY_REAL(double, double, unsigned long long)
+
+#undef SORT_KEY_INT
+#undef SORT_KEY_REAL
+
+static void gai_sort_encode(Integer type, void *a, sort_key_t *u, Integer n)
+{
+  switch (type) {
+    case C_INT: gai_sort_encode_int((int*)a, u, n); break;
+    case C_LONG: gai_sort_encode_long((long*)a, u, n); break;
+    case C_LONGLONG: gai_sort_encode_longlong((long long*)a, u, n); break;
+    case C_FLOAT: gai_sort_encode_float((float*)a, u, n); break;
+    case C_DBL: gai_sort_encode_double((double*)a, u, n); break;
+  }
+}
+
+static void gai_sort_decode(Integer type, sort_key_t *u, void *a, Integer n)
+{
+  switch (type) {
+    case C_INT: gai_sort_decode_int(u, (int*)a, n); break;
+    case C_LONG: gai_sort_decode_long(u, (long*)a, n); break;
+    case C_LONGLONG: gai_sort_decode_longlong(u, (long long*)a, n); break;
+    case C_FLOAT: gai_sort_decode_float(u, (float*)a, n); break;
+    case C_DBL: gai_sort_decode_double(u, (double*)a, n); break;
+  }
+}
+
+
+/*\ number of threads for n keys
+\*/
+static Integer gai_sort_nthreads(Integer n)
+{
+  Integer nt = 1;
+#ifdef _OPENMP
+  if (n >= SORT_PARMIN) nt = GA_MIN(omp_get_max_threads(), SORT_MAXTHR);
+#endif
+  return nt;
+}
+
+
+/*\ Stable radix sort of the n keys u, of nbytes significant bytes.  If
+ *  perm is not NULL it is permuted along with the keys.  ut and pt are
+ *  scratch space of the same sizes.
+\*/
+static void gai_sort_radix(Integer n, Integer nbytes, sort_key_t *u,
+        sort_key_t *ut, Integer *perm, Integer *pt)
+{
+  Integer nt = gai_sort_nthreads(n);
+  Integer *hist, b, d, t, sum;
+  sort_key_t *src = u, *dst = ut, *ktmp;
+  Integer *psrc = perm, *pdst = pt, *itmp;
+
+  if (n == 0) return;
+  hist = (Integer*)malloc(nt*256*sizeof(Integer));
+  if (hist == NULL) pnga_error("ga_sort: malloc failed ", nt);
+
+  for (b=0; b<nbytes; b++) {
+    int shift = 8*(int)b;
+
+    /* each thread counts the digits of its range of keys */
+#ifdef _OPENMP
+#   pragma omp parallel for schedule(static,1) if(nt > 1)
+#endif
+    for (t=0; t<nt; t++) {
+      Integer i, *h = hist + t*256;
+      Integer first = t*n/nt, last = (t+1)*n/nt;
+      for (i=0; i<256; i++) h[i] = 0;
+      for (i=first; i<last; i++) h[(src[i] >> shift) & 0xff]++;
+    }
+
+    /* skip the pass if all keys have the same digit */
+    d = (src[0] >> shift) & 0xff;
+    for (t=0, sum=0; t<nt; t++) sum += hist[t*256+d];
+    if (sum == n) continue;
+
+    /* turn the counts into offsets, by digit and then by thread */
+    for (d=0, sum=0; d<256; d++) {
+      for (t=0; t<nt; t++) {
+        Integer c = hist[t*256+d];
+        hist[t*256+d] = sum;
+        sum += c;
+      }
+    }
+
+#ifdef _OPENMP
+#   pragma omp parallel for schedule(static,1) if(nt > 1)
+#endif
+    for (t=0; t<nt; t++) {
+      Integer i, j, *h = hist + t*256;
+      Integer first = t*n/nt, last = (t+1)*n/nt;
+      for (i=first; i<last; i++) {
+        j = h[(src[i] >> shift) & 0xff]++;
+        dst[j] = src[i];
+        if (psrc) pdst[j] = psrc[i];
+      }
+    }
+    ktmp = src; src = dst; dst = ktmp;
+    itmp = psrc; psrc = pdst; pdst = itmp;
+  }
+
+  if (src != u) {
+    memcpy(u, src, n*sizeof(sort_key_t));
+    if (perm) memcpy(perm, psrc, n*sizeof(Integer));
+  }
+  free(hist);
+}
+
+
+/*\ Stable merge of the nrun sorted runs of keys u that start at run[r]
+ *  (run[nrun] is n); if perm is not NULL it is permuted along with the
+ *  keys.  ut and pt are scratch space of the same sizes.  Runs are merged
+ *  pairwise, and the merges of a round are spread over threads.
+\*/
+static void gai_sort_merge(Integer n, Integer nrun, Integer *run,
+        sort_key_t *u, sort_key_t *ut, Integer *perm, Integer *pt)
+{
+  sort_key_t *src = u, *dst = ut, *ktmp;
+  Integer *psrc = perm, *pdst = pt, *itmp;
+  Integer w, r;
+
+  for (w=1; w<nrun; w*=2) {
+#ifdef _OPENMP
+#   pragma omp parallel for schedule(dynamic) if(n >= SORT_PARMIN)
+#endif
+    for (r=0; r<nrun; r+=2*w) {
+      Integer i = run[r], m = run[GA_MIN(r+w, nrun)];
+      Integer e = run[GA_MIN(r+2*w, nrun)], j = m, o = i;
+      /* on equal keys the left run, from lower subscripts, goes first */
+      while (i < m && j < e) {
+        if (src[j] < src[i]) {
+          if (psrc) pdst[o] = psrc[j];
+          dst[o++] = src[j++];
+        } else {
+          if (psrc) pdst[o] = psrc[i];
+          dst[o++] = src[i++];
+        }
+      }
+      for (; i<m; i++, o++) {
+        if (psrc) pdst[o] = psrc[i];
+        dst[o] = src[i];
+      }
+      for (; j<e; j++, o++) {
+        if (psrc) pdst[o] = psrc[j];
+        dst[o] = src[j];
+      }
+    }
+    ktmp = src; src = dst; dst = ktmp;
+    itmp = psrc; psrc = pdst; pdst = itmp;
+  }
+
+  if (src != u) {
+    memcpy(u, src, n*sizeof(sort_key_t));
+    if (perm) memcpy(perm, psrc, n*sizeof(Integer));
+  }
+}
+
+
+/*\ Gather n elements of size bytes: dst[i] = src[pos[i]]
+\*/
+#define SORT_MOVE(T)                                                       \
+  for (i=0; i<n; i++) ((T*)dst)[i] = ((T*)src)[pos[i]];                   \
+  break;
+
+static void gai_sort_move(char *src, char *dst, Integer *pos, Integer n,
+        Integer size)
+{
+  Integer i;
+
+  switch (size) {
+    case 4: SORT_MOVE(int)
+    case 8: SORT_MOVE(double)
+    case 16: SORT_MOVE(DoubleComplex)
+    default:
+      for (i=0; i<n; i++) memcpy(dst + i*size, src + pos[i]*size, size);
+  }
+}
+#undef SORT_MOVE
+
+
+/*\ Sort the keys of g_a.  If g_v is not zero, its elements are permuted
+ *  along with the keys; if g_r is not zero, the keys stay in place and
+ *  the rank of every key is stored in g_r instead.
+\*/
+static void gai_sort(Integer g_a, Integer g_v, Integer g_r)
+{
+  Integer type, ndim, dims, vtype = 0, vndim, vdims, rtype, itype;
+  Integer grp, me, nproc, size, vsize = 0, nval, i, j, k, p, n;
+  Integer lo, hi, ld, nme, nsamp, ns, nr, start, cap, nblock, one = 1;
+  Integer tlo, thi, g_cnt, g_kbuf, g_vbuf = 0, cdim;
+  Integer nbhdl[SORT_NBMAX], nb = 0;
+  Integer *cnt, *off, *tot, *map, *run, *perm;
+  sort_pair_t *spl, *samp;
+  sort_key_t *u, *ut;
+  long long *sbuf;
+  char *keys, *vals = NULL, *skeys, *svals = NULL, *ptr;
+
+  grp = pnga_get_pgroup(g_a);
+  me = pnga_pgroup_nodeid(grp);
+  nproc = pnga_pgroup_nnodes(grp);
+  itype = pnga_type_f2c(MT_F_INT);
+
+  pnga_check_handle(g_a, "ga_sort");
+  pnga_inquire(g_a, &type, &ndim, &dims);
+  if (ndim != 1) pnga_error("ga_sort: 1-dim array required ", ndim);
+  if (type != C_INT && type != C_LONG && type != C_LONGLONG &&
+      type != C_FLOAT && type != C_DBL)
+    pnga_error("ga_sort: type not supported ", type);
+  if (pnga_total_blocks(g_a) >= 0)
+    pnga_error("ga_sort: block-cyclic arrays not supported ", g_a);
+  size = GAsizeofM(type);
+  if (g_v) {
+    pnga_check_handle(g_v, "ga_sort");
+    pnga_inquire(g_v, &vtype, &vndim, &vdims);
+    if (vndim != 1 || vdims != dims)
+      pnga_error("ga_sort: value array must match the keys ", g_v);
+    vsize = GAsizeofM(vtype);
+  }
+  if (g_r) {
+    pnga_check_handle(g_r, "ga_sort");
+    pnga_inquire(g_r, &rtype, &vndim, &vdims);
+    if (vndim != 1 || vdims != dims)
+      pnga_error("ga_sort: rank array must match the keys ", g_r);
+    if (rtype != C_INT && rtype != C_LONG && rtype != C_LONGLONG)
+      pnga_error("ga_sort: rank array must be integer ", rtype);
+    /* the subscripts of the keys travel with them as values */
+    vtype = itype;
+    vsize = sizeof(Integer);
+  }
+  if ((g_v && pnga_get_pgroup(g_v) != grp) ||
+      (g_r && pnga_get_pgroup(g_r) != grp))
+    pnga_error("ga_sort: arrays on different groups ", g_a);
+  nval = g_v || g_r;
+
+  _ga_sync_begin = 1; _ga_sync_end=1; /*remove any previous masking*/
+  pnga_pgroup_sync(grp);
+
+  /* copy local keys (and values) and sort them locally */
+  pnga_distribution(g_a, me, &lo, &hi);
+  nme = (lo > 0 && hi >= lo) ? hi-lo+1 : 0;
+  n = GA_MAX(nme,1);
+  u = (sort_key_t*)malloc(n*sizeof(sort_key_t));
+  ut = (sort_key_t*)malloc(n*sizeof(sort_key_t));
+  perm = (Integer*)malloc(2*n*sizeof(Integer));
+  if (u == NULL || ut == NULL || perm == NULL)
+    pnga_error("ga_sort: malloc failed ", nme);
+  if (g_v) {
+    vals = (char*)malloc(n*vsize);
+    if (vals == NULL) pnga_error("ga_sort: malloc failed ", nme);
+  }
+  if (nme > 0) {
+    pnga_access_ptr(g_a, &lo, &hi, &ptr, &ld);
+    gai_sort_encode(type, ptr, u, nme);
+    pnga_release(g_a, &lo, &hi);
+    if (g_v) pnga_get(g_v, &lo, &hi, vals, &one);
+  }
+  for (i=0; i<nme; i++) perm[i] = i;
+  gai_sort_radix(nme, size, u, ut, perm, perm + n);
+  free(ut);
+
+  /* 1. exchange regular samples of the sorted keys by rank; subscript 0
+     is no sample */
+  nsamp = GA_MAX(1, GA_MIN(GA_MAX(nproc, SORT_OVERSAMPLE),
+        SORT_SAMPLES/nproc));
+  sbuf = (long long*)calloc(2*nproc*nsamp, sizeof(long long));
+  if (sbuf == NULL) pnga_error("ga_sort: malloc failed ", nproc*nsamp);
+  for (k=0; k<nsamp && nme>0; k++) {
+    i = ((2*k+1)*nme)/(2*nsamp);
+    sbuf[2*(me*nsamp+k)] = (long long)u[i];
+    sbuf[2*(me*nsamp+k)+1] = (long long)(lo+perm[i]);
+  }
+  pnga_pgroup_gop(grp, C_LONGLONG, sbuf, 2*nproc*nsamp, "+");
+
+  /* 2. pick the splitters from the sorted samples */
+  samp = (sort_pair_t*)malloc(nproc*nsamp*sizeof(sort_pair_t));
+  spl = (sort_pair_t*)malloc(nproc*sizeof(sort_pair_t));
+  if (samp == NULL || spl == NULL) pnga_error("ga_sort: malloc failed ", nproc);
+  for (k=0, ns=0; k<nproc*nsamp; k++) {
+    if (sbuf[2*k+1] == 0) continue;
+    samp[ns].key = (sort_key_t)sbuf[2*k];
+    samp[ns].idx = (Integer)sbuf[2*k+1];
+    ns++;
+  }
+  free(sbuf);
+  qsort(samp, ns, sizeof(sort_pair_t), gai_sort_pair_cmp);
+  for (p=1; p<nproc; p++) spl[p-1] = samp[(p*ns)/nproc];
+  free(samp);
+
+  /* bucket p holds the keys above splitter p-1 and up to splitter p; the
+     sorted local keys of a bucket are contiguous */
+  cnt = (Integer*)malloc((5*nproc+1)*sizeof(Integer));
+  if (cnt == NULL) pnga_error("ga_sort: malloc failed ", nproc);
+  off = cnt + nproc;
+  tot = off + nproc;
+  map = tot + nproc;
+  run = map + nproc;
+  for (p=0, i=0; p<nproc; p++) {
+    Integer l = i, h = nme, m;
+    if (p < nproc-1) {
+      /* first key above (splitter key, subscript) */
+      while (l < h) {
+        sort_pair_t e;
+        m = (l+h)/2;
+        e.key = u[m]; e.idx = lo+perm[m];
+        if (gai_sort_pair_cmp(&e, &spl[p]) <= 0) l = m+1;
+        else h = m;
+      }
+    } else {
+      l = nme;
+    }
+    cnt[p] = l-i;
+    i = l;
+  }
+  free(spl);
+  skeys = (char*)malloc(n*size);
+  if (skeys == NULL) pnga_error("ga_sort: malloc failed ", nme);
+  gai_sort_decode(type, u, skeys, nme);
+  if (nval) {
+    svals = (char*)malloc(n*vsize);
+    if (svals == NULL) pnga_error("ga_sort: malloc failed ", nme);
+    if (g_v) {
+      gai_sort_move(vals, svals, perm, nme, vsize);
+      free(vals);
+    } else {
+      for (i=0; i<nme; i++) ((Integer*)svals)[i] = lo+perm[i];
+    }
+  }
+  free(perm);
+
+  /* 3. reserve room in each bucket.  Every process owns one row of
+     counts; the owner of bucket p gathers column p, turns it into the
+     offsets of the runs by rank and scatters them back, and everyone
+     reads the offsets in its own row */
+  for (p=0; p<nproc; p++) map[p] = p*nproc + 1;
+  cdim = nproc*nproc;
+  nblock = nproc;
+  if (!pnga_create_irreg_config(itype, 1, &cdim, "sort_counts", map,
+        &nblock, grp, &g_cnt))
+    pnga_error("ga_sort: failed to create counts array ", nproc);
+  tlo = me*nproc + 1; thi = tlo + nproc - 1;
+  pnga_put(g_cnt, &tlo, &thi, cnt, &one);
+  for (p=0; p<nproc; p++) tot[p] = cnt[p];
+  pnga_pgroup_gop(grp, itype, tot, nproc, "+");
+  pnga_pgroup_sync(grp);
+  for (p=0; p<nproc; p++) map[p] += me;
+  pnga_gather(g_cnt, off, map, 0, nproc);
+  for (p=0, nr=0; p<nproc; p++) {
+    Integer c = off[p];
+    run[p] = off[p] = nr;
+    nr += c;
+  }
+  run[nproc] = nr;
+  pnga_scatter(g_cnt, off, map, 0, nproc);
+  pnga_pgroup_sync(grp);
+  pnga_get(g_cnt, &tlo, &thi, off, &one);
+  pnga_destroy(g_cnt);
+
+  /* scratch arrays with one block per process, of the size of its
+     bucket (empty buckets get one element, as blocks cannot be empty) */
+  for (p=0, start=0; p<me; p++) start += tot[p];
+  for (p=0, cap=0; p<nproc; p++) {
+    map[p] = cap + 1;
+    cap += GA_MAX(tot[p], 1);
+  }
+  cdim = cap;
+  nblock = nproc;
+  if (!pnga_create_irreg_config(type, 1, &cdim, "sort_keys", map, &nblock,
+        grp, &g_kbuf))
+    pnga_error("ga_sort: failed to create scratch array ", cap);
+  if (nval && !pnga_create_irreg_config(vtype, 1, &cdim, "sort_values",
+        map, &nblock, grp, &g_vbuf))
+    pnga_error("ga_sort: failed to create scratch array ", cap);
+
+  /* send each bucket's part with nonblocking puts */
+  for (p=0, i=0; p<nproc; p++) {
+    if (cnt[p] == 0) continue;
+    tlo = map[p] + off[p];
+    thi = tlo + cnt[p] - 1;
+    if (nb+1+nval > SORT_NBMAX) {
+      for (k=0; k<nb; k++) pnga_nbwait(&nbhdl[k]);
+      nb = 0;
+    }
+    pnga_nbput(g_kbuf, &tlo, &thi, skeys + i*size, &one, &nbhdl[nb++]);
+    if (nval)
+      pnga_nbput(g_vbuf, &tlo, &thi, svals + i*vsize, &one, &nbhdl[nb++]);
+    i += cnt[p];
+  }
+  for (k=0; k<nb; k++) pnga_nbwait(&nbhdl[k]);
+  free(skeys);
+  if (nval) free(svals);
+  pnga_pgroup_sync(grp);
+
+  /* 4. merge the sorted runs received from every process and put the
+     bucket in place */
+  if (nr > 0) {
+    keys = (char*)malloc(nr*size);
+    u = (sort_key_t*)realloc(u, nr*sizeof(sort_key_t));
+    ut = (sort_key_t*)malloc(nr*sizeof(sort_key_t));
+    if (keys == NULL || u == NULL || ut == NULL)
+      pnga_error("ga_sort: malloc failed ", nr);
+    perm = NULL;
+    if (nval) {
+      perm = (Integer*)malloc(2*nr*sizeof(Integer));
+      if (perm == NULL) pnga_error("ga_sort: malloc failed ", nr);
+      for (i=0; i<nr; i++) perm[i] = i;
+    }
+    tlo = map[me]; thi = tlo + nr - 1;
+    pnga_access_ptr(g_kbuf, &tlo, &thi, &ptr, &ld);
+    gai_sort_encode(type, ptr, u, nr);
+    pnga_release(g_kbuf, &tlo, &thi);
+    gai_sort_merge(nr, nproc, run, u, ut, perm, perm ? perm + nr : NULL);
+    free(ut);
+
+    lo = start+1; hi = start+nr;
+    if (nval) {
+      vals = (char*)malloc(nr*vsize);
+      if (vals == NULL) pnga_error("ga_sort: malloc failed ", nr);
+      pnga_access_ptr(g_vbuf, &tlo, &thi, &ptr, &ld);
+      gai_sort_move(ptr, vals, perm, nr, vsize);
+      pnga_release(g_vbuf, &tlo, &thi);
+    }
+    if (g_r) {
+      /* element vals[j] of the array has rank start+j */
+      char *rank = (char*)malloc(nr*GAsizeofM(rtype));
+      if (rank == NULL) pnga_error("ga_sort: malloc failed ", nr);
+      for (j=0; j<nr; j++) {
+        switch (rtype) {
+          case C_INT: ((int*)rank)[j] = (int)(start+j); break;
+          case C_LONG: ((long*)rank)[j] = (long)(start+j); break;
+          case C_LONGLONG: ((long long*)rank)[j] = (long long)(start+j); break;
+        }
+      }
+      pnga_scatter(g_r, rank, (Integer*)vals, 0, nr);
+      free(rank);
+    } else {
+      gai_sort_decode(type, u, keys, nr);
+      pnga_put(g_a, &lo, &hi, keys, &one);
+      if (g_v) pnga_put(g_v, &lo, &hi, vals, &one);
+    }
+    if (nval) {
+      free(vals);
+      free(perm);
+    }
+    free(keys);
+  }
+  free(u);
+  free(cnt);
+
+  if (nval) pnga_destroy(g_vbuf);
+  pnga_destroy(g_kbuf);
+  pnga_pgroup_sync(grp);
+}
+
+
+/*\ Sort the elements of the 1-D array g_a in ascending order
+\*/
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_sort = pnga_sort
+#endif
+void pnga_sort(Integer g_a)
+{
+  gai_sort(g_a, 0, 0);
+}
+
+
+/*\ Sort the elements of the 1-D array g_a in ascending order and
+ *  reorder the elements of g_v, which has the same length, in the same
+ *  way.  Equal keys keep their order.
+\*/
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_sort_kv = pnga_sort_kv
+#endif
+void pnga_sort_kv(Integer g_a, Integer g_v)
+{
+  if (g_a == g_v) pnga_error("ga_sort_kv: arrays have to be different ", 0L);
+  gai_sort(g_a, g_v, 0);
+}
+
+
+/*\ Store in the integer array g_r the rank of each element of the 1-D
+ *  array g_a: the number of elements that precede it in sorted order,
+ *  with ties broken by subscript.  g_a is not changed.
+\*/
+#if HAVE_SYS_WEAK_ALIAS_PRAGMA
+#   pragma weak wnga_sort_rank = pnga_sort_rank
+#endif
+void pnga_sort_rank(Integer g_a, Integer g_r)
+{
+  if (g_a == g_r) pnga_error("ga_sort_rank: arrays have to be different ", 0L);
+  gai_sort(g_a, 0, g_r);
+}
@@ -0,0 +1,148 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#if HAVE_STDIO_H
+#   include <stdio.h>
+#endif
+#include <stdlib.h>
+
+#include "ga.h"
+#include "macdecls.h"
+#include "mp3.h"
+
+#define N 200       /* dimension of test array */
+#define W 7         /* width of test patches */
+
+/* value of element (i,j) of the test array */
+#define VALUE(i,j) ((double)((i)*N+(j)))
+
+static void check(double *buf, double *ref, int n, char *what)
+{
+  int i;
+
+  for (i=0; i<n; i++) {
+    if (buf[i] != ref[i]) {
+      printf("%s: element %d is %g, expected %g\n",what,i,buf[i],ref[i]);
+      GA_Error("access plan disagrees with NGA_Get",i);
+    }
+  }
+}
+
+/* Build plans for patches that straddle several owners and check blocking
+ * and non-blocking plan get, put and acc against NGA_Get */
+void do_work()
+{
+  int g_a, plan;
+  int me = GA_Nodeid(), nproc = GA_Nnodes();
+  int i, j, dims[2], lo[2], hi[2], ld[2];
+  double buf[W*W], ref[W*W], alpha = 2.0;
+  double *local;
+  ga_nbhdl_t nbh;
+
+  dims[0] = N;
+  dims[1] = N;
+  g_a = NGA_Create(C_DBL,2,dims,"A",NULL);
+  if (!g_a) GA_Error("create failed",0);
+
+  /* fill the array */
+  NGA_Distribution(g_a,me,lo,hi);
+  if (lo[0] <= hi[0] && lo[1] <= hi[1]) {
+    NGA_Access(g_a,lo,hi,&local,ld);
+    for (i=lo[0]; i<=hi[0]; i++) {
+      for (j=lo[1]; j<=hi[1]; j++) {
+        local[(i-lo[0])*ld[0]+j-lo[1]] = VALUE(i,j);
+      }
+    }
+    NGA_Release_update(g_a,lo,hi);
+  }
+  GA_Sync();
+
+  /* a patch around the center of the array touches every owner of the
+   * center, and its position differs on each process */
+  lo[0] = N/2-W/2-me%3;
+  lo[1] = N/2-W/2-(me/3)%3;
+  hi[0] = lo[0]+W-1;
+  hi[1] = lo[1]+W-1;
+  ld[0] = W;
+  plan = NGA_Create_plan(g_a,lo,hi,ld);
+  for (i=0; i<W; i++) {
+    for (j=0; j<W; j++) ref[i*W+j] = VALUE(lo[0]+i,lo[1]+j);
+  }
+
+  NGA_Plan_get(plan,buf);
+  check(buf,ref,W*W,"plan get");
+  for (i=0; i<W*W; i++) buf[i] = 0.0;
+  NGA_Plan_nbget(plan,buf,&nbh);
+  NGA_NbWait(&nbh);
+  check(buf,ref,W*W,"plan nbget");
+  GA_Sync();
+  if (me == 0) printf("Completed test of plan get\n");
+
+  /* only process 0 writes, everybody checks */
+  if (me == 0) {
+    for (i=0; i<W*W; i++) buf[i] = -ref[i];
+    NGA_Plan_put(plan,buf);
+  }
+  GA_Sync();
+  if (me == 0) {
+    NGA_Get(g_a,lo,hi,buf,ld);
+    for (i=0; i<W*W; i++) ref[i] = -ref[i];
+    check(buf,ref,W*W,"plan put");
+    for (i=0; i<W*W; i++) buf[i] = -ref[i];
+    NGA_Plan_nbput(plan,buf,&nbh);
+    NGA_NbWait(&nbh);
+    for (i=0; i<W*W; i++) ref[i] = -ref[i];
+    printf("Completed test of plan put\n");
+  }
+  GA_Sync();
+
+  /* every process adds alpha times the original values to its patch */
+  for (i=0; i<W; i++) {
+    for (j=0; j<W; j++) buf[i*W+j] = VALUE(lo[0]+i,lo[1]+j);
+  }
+  NGA_Plan_acc(plan,buf,&alpha);
+  NGA_Plan_nbacc(plan,buf,&alpha,&nbh);
+  NGA_NbWait(&nbh);
+  GA_Sync();
+  if (nproc == 1) {
+    NGA_Get(g_a,lo,hi,ref,ld);
+    for (i=0; i<W*W; i++) buf[i] *= 1.0+2.0*alpha;
+    check(ref,buf,W*W,"plan acc");
+    printf("Completed test of plan acc\n");
+  }
+  NGA_Destroy_plan(plan);
+
+  GA_Destroy(g_a);
+}
+
+
+int main(int argc, char **argv)
+{
+int heap=20000, stack=20000;
+int me, nproc;
+
+    MP_INIT(argc,argv);
+
+    GA_INIT(argc,argv);                            /* initialize GA */
+    me=GA_Nodeid();
+    nproc=GA_Nnodes();
+    if(me==0) {
+       printf("Using %ld processes\n",(long)nproc);
+       fflush(stdout);
+    }
+
+    heap /= nproc;
+    stack /= nproc;
+    if(! MA_init(MT_F_DBL, stack, heap))
+       GA_Error("MA_init failed",stack+heap);  /* initialize memory allocator*/
+
+    do_work();
+
+    if (me == 0) printf("All tests successful\n");
+    GA_Terminate();
+
+    MP_FINALIZE();
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#if HAVE_STDIO_H
+#   include <stdio.h>
+#endif
+#include <stdlib.h>
+
+#include "ga.h"
+#include "macdecls.h"
+#include "mp3.h"
+
+#define N 200       /* dimension of the array */
+#define NSMALL 4    /* default width of the patches */
+#define NTIMES 20000
+
+/* Time repeated gets of a small patch that straddles two owners with
+ * NGA_Get and with a persistent access plan. The patch width is taken
+ * from the first argument. */
+int main(int argc, char **argv)
+{
+  int heap=20000, stack=20000;
+  int me, nproc, nsmall = NSMALL, i, iter, g_a, plan;
+  int dims[2], lo[2], hi[2], ld[1];
+  double one = 1.0, t, *buf;
+
+  MP_INIT(argc,argv);
+  GA_INIT(argc,argv);
+  me=GA_Nodeid();
+  nproc=GA_Nnodes();
+  heap /= nproc;
+  stack /= nproc;
+  if(! MA_init(MT_F_DBL, stack, heap))
+    GA_Error("MA_init failed",stack+heap);
+  if (argc > 1) nsmall = atoi(argv[1]);
+  if (nsmall < 1 || nsmall > N) GA_Error("patch width out of range",nsmall);
+
+  dims[0] = N;
+  dims[1] = N;
+  g_a = NGA_Create(C_DBL,2,dims,"A",NULL);
+  if (!g_a) GA_Error("create failed",0);
+  GA_Fill(g_a,&one);
+  buf = (double*)malloc(nsmall*nsmall*sizeof(double));
+
+  lo[0] = (me*nsmall*5)%(N-nsmall+1);
+  lo[1] = N/2-nsmall/2;
+  hi[0] = lo[0]+nsmall-1;
+  hi[1] = lo[1]+nsmall-1;
+  ld[0] = nsmall;
+  plan = NGA_Create_plan(g_a,lo,hi,ld);
+  if (me == 0) {
+    printf("Repeated %dx%d patch gets on %d processors\n\n",nsmall,nsmall,
+        nproc);
+    printf("%10s %12s %14s\n","method","time (s)","gets/s");
+  }
+  for (iter=0; iter<2; iter++) {
+    GA_Sync();
+    t = GA_Wtime();
+    for (i=0; i<NTIMES; i++) {
+      if (iter == 0) NGA_Get(g_a,lo,hi,buf,ld);
+      else NGA_Plan_get(plan,buf);
+    }
+    t = GA_Wtime()-t;
+    GA_Dgop(&t,1,"max");
+    if (me == 0) printf("%10s %12.4f %14.0f\n",iter == 0 ? "NGA_Get" : "plan",
+        t,NTIMES/t);
+  }
+  NGA_Destroy_plan(plan);
+
+  free(buf);
+  GA_Destroy(g_a);
+  GA_Terminate();
+  MP_FINALIZE();
+  return 0;
+}
@@ -0,0 +1,174 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#if HAVE_STDIO_H
+#   include <stdio.h>
+#endif
+#include <stdlib.h>
+
+#include "ga.h"
+#include "macdecls.h"
+#include "mp3.h"
+
+#define N 1000      /* dimension of test arrays */
+
+/* values of element (i,j) of the input arrays */
+#define AVAL(i,j) ((double)((i)-(j))*0.5)
+#define BVAL(i,j) ((double)(((i)+3*(j))%17) - 8.0)
+
+static void fill(int g, int which)
+{
+  int me = GA_Nodeid(), lo[2], hi[2], ld[1], i, j;
+  double *p;
+
+  NGA_Distribution(g,me,lo,hi);
+  if (lo[0] > hi[0] || lo[1] > hi[1]) return;
+  NGA_Access(g,lo,hi,&p,ld);
+  for (i=lo[0]; i<=hi[0]; i++) {
+    for (j=lo[1]; j<=hi[1]; j++) {
+      p[(i-lo[0])*ld[0]+(j-lo[1])] = which ? BVAL(i,j) : AVAL(i,j);
+    }
+  }
+  NGA_Release_update(g,lo,hi);
+}
+
+/* every element of g must be |a*b + alpha| */
+static void check(int g, double alpha, char *what)
+{
+  int me = GA_Nodeid(), lo[2], hi[2], ld[1], i, j, ok = 1;
+  double *p, ref;
+
+  NGA_Distribution(g,me,lo,hi);
+  if (lo[0] <= hi[0] && lo[1] <= hi[1]) {
+    NGA_Access(g,lo,hi,&p,ld);
+    for (i=lo[0]; i<=hi[0] && ok; i++) {
+      for (j=lo[1]; j<=hi[1]; j++) {
+        ref = AVAL(i,j)*BVAL(i,j) + alpha;
+        if (ref < 0.0) ref = -ref;
+        if (p[(i-lo[0])*ld[0]+(j-lo[1])] != ref) {
+          printf("%s: element (%d,%d) is %g, expected %g\n",what,i,j,
+              p[(i-lo[0])*ld[0]+(j-lo[1])],ref);
+          ok = 0;
+          break;
+        }
+      }
+    }
+    NGA_Release(g,lo,hi);
+  }
+  GA_Igop(&ok,1,"min");
+  if (!ok) GA_Error("fused elementwise operation gave wrong result",0);
+  if (me == 0) printf("Completed test of %s\n",what);
+}
+
+/* Evaluate c = |a*b + alpha| with GA_Elem_fused on regular arrays, in
+ * place, on an array with ghost cells and with an input distributed
+ * differently from the output, and check the whole-array wrappers on an
+ * integer array */
+void do_work()
+{
+  int g_a, g_b, g_c, g_g, g_r, g_i, g_j;
+  int me = GA_Nodeid(), nproc = GA_Nnodes();
+  int dims[2], width[2], block[2], *map, in[2];
+  int ops[] = { GA_EOP_LOAD, 0, GA_EOP_LOAD, 1, GA_EOP_MUL,
+                GA_EOP_CONST, 0, GA_EOP_ADD, GA_EOP_ABS };
+  int nops = sizeof(ops)/sizeof(ops[0]);
+  int ival = 7;
+  double alpha = -3.25;
+
+  dims[0] = N;
+  dims[1] = N;
+  g_a = NGA_Create(C_DBL,2,dims,"A",NULL);
+  g_b = NGA_Create(C_DBL,2,dims,"B",NULL);
+  g_c = NGA_Create(C_DBL,2,dims,"C",NULL);
+  if (!g_a || !g_b || !g_c) GA_Error("create failed",0);
+  fill(g_a,0);
+  fill(g_b,1);
+
+  /* regular arrays, and in place */
+  in[0] = g_a; in[1] = g_b;
+  GA_Elem_fused(g_c,nops,ops,2,in,&alpha);
+  check(g_c,alpha,"fused operation");
+  GA_Copy(g_a,g_c);
+  in[0] = g_c;
+  GA_Elem_fused(g_c,nops,ops,2,in,&alpha);
+  check(g_c,alpha,"fused operation in place");
+
+  /* output with ghost cells, walked a row at a time */
+  width[0] = 2; width[1] = 1;
+  g_g = NGA_Create_ghosts(C_DBL,2,dims,width,"G",NULL);
+  in[0] = g_a; in[1] = g_b;
+  GA_Elem_fused(g_g,nops,ops,2,in,&alpha);
+  check(g_g,alpha,"fused operation with ghost cells");
+
+  /* input distributed differently from the output */
+  block[0] = nproc > 1 ? 2 : 1;
+  block[1] = 1;
+  map = (int*)malloc((block[0]+block[1])*sizeof(int));
+  map[0] = 0;
+  if (block[0] > 1) map[1] = N/3;
+  map[block[0]] = 0;
+  g_r = NGA_Create_irreg(C_DBL,2,dims,"R",block,map);
+  free(map);
+  GA_Copy(g_b,g_r);
+  in[0] = g_a; in[1] = g_r;
+  GA_Elem_fused(g_c,nops,ops,2,in,&alpha);
+  check(g_c,alpha,"fused operation, irregular input");
+
+  /* the separate calls give the same result */
+  GA_Elem_multiply(g_a,g_b,g_c);
+  GA_Add_constant(g_c,&alpha);
+  GA_Abs_value(g_c);
+  check(g_c,alpha,"separate calls");
+
+  /* whole-array wrappers on an integer array */
+  g_i = NGA_Create(C_INT,2,dims,"I",NULL);
+  g_j = NGA_Create(C_INT,2,dims,"J",NULL);
+  GA_Fill(g_i,&ival);
+  GA_Add_constant(g_i,&ival);
+  GA_Fill(g_j,&ival);
+  GA_Elem_divide(g_i,g_j,g_j);
+  GA_Elem_maximum(g_i,g_j,g_i);
+  if (GA_Idot(g_i,g_j) != 2*14*N*N)
+    GA_Error("integer elementwise wrappers gave wrong result",0);
+  if (me == 0) printf("Completed test of integer wrappers\n");
+
+  GA_Destroy(g_j);
+  GA_Destroy(g_i);
+  GA_Destroy(g_r);
+  GA_Destroy(g_g);
+  GA_Destroy(g_c);
+  GA_Destroy(g_b);
+  GA_Destroy(g_a);
+}
+
+
+int main(int argc, char **argv)
+{
+int heap=20000, stack=20000;
+int me, nproc;
+
+    MP_INIT(argc,argv);
+
+    GA_INIT(argc,argv);                            /* initialize GA */
+    me=GA_Nodeid();
+    nproc=GA_Nnodes();
+    if(me==0) {
+       printf("Using %ld processes\n",(long)nproc);
+       fflush(stdout);
+    }
+
+    heap /= nproc;
+    stack /= nproc;
+    if(! MA_init(MT_F_DBL, stack, heap))
+       GA_Error("MA_init failed",stack+heap);  /* initialize memory allocator*/
+
+    do_work();
+
+    if (me == 0) printf("All tests successful\n");
+    GA_Terminate();
+
+    MP_FINALIZE();
+
+    return 0;
+}
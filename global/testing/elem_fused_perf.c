@@ -0,0 +1,73 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#if HAVE_STDIO_H
+#   include <stdio.h>
+#endif
+#include <stdlib.h>
+
+#include "ga.h"
+#include "macdecls.h"
+#include "mp3.h"
+
+#define N 1000      /* default dimension of the arrays */
+#define NTIMES 20
+
+/* Time c = |a*b + alpha| on n x n arrays with one GA_Elem_fused call
+ * against GA_Elem_multiply, GA_Add_constant and GA_Abs_value called in
+ * turn. The dimension is taken from the first argument. */
+int main(int argc, char **argv)
+{
+  int heap=20000, stack=20000;
+  int me, nproc, n = N, i, dims[2], g_a, g_b, g_c, in[2];
+  int ops[] = { GA_EOP_LOAD, 0, GA_EOP_LOAD, 1, GA_EOP_MUL,
+                GA_EOP_CONST, 0, GA_EOP_ADD, GA_EOP_ABS };
+  int nops = sizeof(ops)/sizeof(ops[0]);
+  double one = 1.0, two = -2.0, alpha = -3.25, t, tfused, tsep;
+
+  MP_INIT(argc,argv);
+  GA_INIT(argc,argv);
+  me=GA_Nodeid();
+  nproc=GA_Nnodes();
+  heap /= nproc;
+  stack /= nproc;
+  if(! MA_init(MT_F_DBL, stack, heap))
+    GA_Error("MA_init failed",stack+heap);
+  if (argc > 1) n = atoi(argv[1]);
+
+  dims[0] = n;
+  dims[1] = n;
+  g_a = NGA_Create(C_DBL,2,dims,"A",NULL);
+  g_b = NGA_Create(C_DBL,2,dims,"B",NULL);
+  g_c = NGA_Create(C_DBL,2,dims,"C",NULL);
+  if (!g_a || !g_b || !g_c) GA_Error("create failed",n);
+  GA_Fill(g_a,&one);
+  GA_Fill(g_b,&two);
+  in[0] = g_a; in[1] = g_b;
+
+  GA_Sync();
+  t = GA_Wtime();
+  for (i=0; i<NTIMES; i++) GA_Elem_fused(g_c,nops,ops,2,in,&alpha);
+  tfused = GA_Wtime() - t;
+  GA_Sync();
+  t = GA_Wtime();
+  for (i=0; i<NTIMES; i++) {
+    GA_Elem_multiply(g_a,g_b,g_c);
+    GA_Add_constant(g_c,&alpha);
+    GA_Abs_value(g_c);
+  }
+  tsep = GA_Wtime() - t;
+  if (me == 0) {
+    printf("|a*b + alpha| on %dx%d, %d times\n",n,n,NTIMES);
+    printf("  fused      %10.4f s\n",tfused);
+    printf("  separate   %10.4f s\n",tsep);
+  }
+
+  GA_Destroy(g_c);
+  GA_Destroy(g_b);
+  GA_Destroy(g_a);
+  GA_Terminate();
+  MP_FINALIZE();
+  return 0;
+}
@@ -15,6 +15,53 @@
 #include "mp3.h"
 
 #define N 100            /* dimension of matrices */
+#define NB 256           /* dimension of matrix of random elements */
+#define NRAND 10000      /* default random elements per process */
+#define NREP 3           /* repetitions of each operation when timed */
+
+/* run nrep calls of gather (op=0), scatter (op=1) or scatter-accumulate
+ * (op=2) and, if timed, report elements per second of the slowest process */
+static void bench(int g_a, double *values, int **indices, int n, int op,
+    char *name, int nrep, int timed)
+{
+  int i, me = GA_Nodeid(), nproc = GA_Nnodes();
+  double t, alpha = 1.0;
+
+  GA_Sync();
+  t = GA_Wtime();
+  for (i=0; i<nrep; i++) {
+    if (op == 0) NGA_Gather(g_a, values, indices, n);
+    else if (op == 1) NGA_Scatter(g_a, values, indices, n);
+    else NGA_Scatter_acc(g_a, values, indices, n, &alpha);
+  }
+  GA_Sync();
+  t = (GA_Wtime()-t)/nrep;
+  GA_Dgop(&t,1,"max");
+  if (timed && me == 0) printf("%16s %12.4f %14.3e %14.3e\n",name,t,n/t,
+      ((double)n)*nproc/t);
+}
+
+/* check that every local element of g_b is expected(element, hits) */
+#define CHECK_LOCAL(g_b, what, expected) { \
+    int _lo[2], _hi[2], _ld, _i, _j, _e; \
+    double *_p; \
+    NGA_Distribution(g_b, me, _lo, _hi); \
+    if (_lo[0] <= _hi[0] && _lo[1] <= _hi[1]) { \
+      NGA_Access(g_b, _lo, _hi, &_p, &_ld); \
+      for (_i=_lo[0]; _i<=_hi[0]; _i++) { \
+        for (_j=_lo[1]; _j<=_hi[1]; _j++) { \
+          _e = _i*NB+_j; \
+          if (_p[(_i-_lo[0])*_ld+_j-_lo[1]] != (expected)) { \
+            printf("p[%d] (%s) element %d expected: %f actual: %f\n", \
+                me, what, _e, (double)(expected), \
+                _p[(_i-_lo[0])*_ld+_j-_lo[1]]); \
+            GA_Error("wrong value",_e); \
+          } \
+        } \
+      } \
+      NGA_Release(g_b, _lo, _hi); \
+    } \
+  }
 
 
 int main( int argc, char **argv ) {
@@ -166,6 +213,84 @@ int main( int argc, char **argv ) {
   NGA_Free_gatscat_buf();
 
   GA_Destroy(g_a);
+
+  /* Gather, scatter and scatter-accumulate of random elements. With an
+   * argument, that many elements per process are timed. */
+  {
+    int g_b, nrand = NRAND, nrep = 1, timed = 0;
+    int bdims[2] = {NB,NB};
+    int *subs, **bindices, *hits;
+    double *bvalues, *bptr;
+
+    if (argc > 1) {
+      nrand = atoi(argv[1]);
+      nrep = NREP;
+      timed = 1;
+    }
+    subs = (int*)malloc(2*nrand*sizeof(int));
+    bindices = (int**)malloc(nrand*sizeof(int*));
+    bvalues = (double*)malloc(nrand*sizeof(double));
+    hits = (int*)malloc(NB*NB*sizeof(int));
+
+    g_b = NGA_Create(C_DBL, 2, bdims, "B", NULL);
+    if(!g_b) GA_Error("create failed: B",NB);
+    NGA_Distribution(g_b, me, lo, hi);
+    if (lo[0] <= hi[0] && lo[1] <= hi[1]) {
+      NGA_Access(g_b, lo, hi, &bptr, &ld);
+      for (i=lo[0]; i<=hi[0]; i++) {
+        for (j=lo[1]; j<=hi[1]; j++) {
+          bptr[(i-lo[0])*ld+j-lo[1]] = (double)(i*NB+j);
+        }
+      }
+      NGA_Release_update(g_b, lo, hi);
+    }
+
+    /* the elements are hit by several processes, some several times */
+    srand(me+1);
+    for (i=0; i<NB*NB; i++) hits[i] = 0;
+    for (i=0; i<nrand; i++) {
+      subs[2*i] = rand()%NB;
+      subs[2*i+1] = rand()%NB;
+      bindices[i] = &subs[2*i];
+      hits[subs[2*i]*NB+subs[2*i+1]]++;
+    }
+    GA_Igop(hits,NB*NB,"+");
+
+    if (timed && me==0) {
+      printf("\nGather/scatter of %d random elements per process\n\n",
+          nrand);
+      printf("%16s %12s %14s %14s\n","operation","time (s)",
+          "elements/s","total/s");
+    }
+    bench(g_b, bvalues, bindices, nrand, 0, "gather", nrep, timed);
+    for (i=0; i<nrand; i++) {
+      if (bvalues[i] != (double)(subs[2*i]*NB+subs[2*i+1])) {
+        printf("p[%d] (Gather) element %d expected: %d actual: %f\n",me,i,
+            subs[2*i]*NB+subs[2*i+1],bvalues[i]);
+        GA_Error("gather returned wrong values",i);
+      }
+    }
+    if (me==0) printf("\nCompleted test of NGA_Gather of random elements\n");
+
+    /* every process writes the same value to an element */
+    for (i=0; i<nrand; i++) bvalues[i] = -(double)(subs[2*i]*NB+subs[2*i+1]);
+    bench(g_b, bvalues, bindices, nrand, 1, "scatter", nrep, timed);
+    CHECK_LOCAL(g_b, "Scatter", hits[_e] ? -(double)_e : (double)_e);
+    if (me==0) printf("\nCompleted test of NGA_Scatter of random elements\n");
+
+    for (i=0; i<nrand; i++) bvalues[i] = 1.0;
+    bench(g_b, bvalues, bindices, nrand, 2, "scatter_acc", nrep, timed);
+    CHECK_LOCAL(g_b, "Scatter_acc",
+        (hits[_e] ? -(double)_e : (double)_e) + nrep*hits[_e]);
+    if (me==0)
+      printf("\nCompleted test of NGA_Scatter_acc of random elements\n");
+
+    GA_Destroy(g_b);
+    free(hits);
+    free(bvalues);
+    free(bindices);
+    free(subs);
+  }
   if(me==0)printf("\nSuccess\n");
   GA_Terminate();
 #endif
@@ -0,0 +1,147 @@
+/**
+ * Test and benchmark the merge of mirrored arrays. Checks a full merge
+ * and a merge with dirty segment tracking turned on and, on more than one
+ * node, times both on an array in which only one small patch was written.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpi.h"
+#include "ga.h"
+#include "macdecls.h"
+
+#define N 400       /* dimension of test array */
+#define W 10        /* width of the patch written by every process */
+#define NBIG 2000   /* dimension of benchmark array */
+#define NTIMES 10
+
+/* upper left corner of the patch written by process p */
+#define CORNER(p) (((p)*37)%(N-W))
+
+/* compare the whole mirrored array with ref */
+static int check(int g_a, double *ref, char *what)
+{
+  int i, lo[2], hi[2], ld, ok = 1;
+  double *buf = (double*)malloc(N*N*sizeof(double));
+
+  lo[0] = lo[1] = 0;
+  hi[0] = hi[1] = N-1;
+  ld = N;
+  NGA_Get(g_a,lo,hi,buf,&ld);
+  for (i=0; i<N*N; i++) {
+    if (buf[i] != ref[i]) {
+      printf("p[%d] %s: element %d is %g, expected %g\n",GA_Nodeid(),what,i,
+          buf[i],ref[i]);
+      ok = 0;
+      break;
+    }
+  }
+  free(buf);
+  GA_Igop(&ok,1,"min");
+  return ok;
+}
+
+int main(int argc, char **argv)
+{
+  int g_a, g_big, mirror;
+  int me, nproc, ok = 1;
+  int i, j, p, iter, dims[2], lo[2], hi[2], ld;
+  double one = 1.0, t;
+  double *ref, patch[W*W];
+
+  MPI_Init(&argc, &argv);
+  MA_init(C_DBL, 1000, 100000);
+  GA_Initialize();
+
+  me = GA_Nodeid();
+  nproc = GA_Nnodes();
+  mirror = GA_Pgroup_get_mirror();
+
+  dims[0] = N;
+  dims[1] = N;
+  g_a = NGA_Create_config(C_DBL,2,dims,"A",NULL,mirror);
+  if (!g_a) GA_Error("create failed",0);
+  ref = (double*)malloc(N*N*sizeof(double));
+
+  /* every process adds its patch, the merged array holds the sum of the
+   * patches of all processes */
+  for (i=0; i<W*W; i++) patch[i] = 1.0+me;
+  for (i=0; i<N*N; i++) ref[i] = 0.0;
+  for (p=0; p<nproc; p++) {
+    for (i=0; i<W; i++) {
+      for (j=0; j<W; j++) ref[(CORNER(p)+i)*N+CORNER(p)+j] += 1.0+p;
+    }
+  }
+  lo[0] = lo[1] = CORNER(me);
+  hi[0] = hi[1] = CORNER(me)+W-1;
+  ld = W;
+
+  GA_Zero(g_a);
+  NGA_Acc(g_a,lo,hi,patch,&ld,&one);
+  GA_Merge_mirrored(g_a);
+  if (!check(g_a,ref,"full merge")) ok = 0;
+
+  /* the same with dirty tracking */
+  GA_Set_merge_dirty(g_a,1);
+  GA_Zero(g_a);
+  GA_Merge_mirrored(g_a);
+  NGA_Acc(g_a,lo,hi,patch,&ld,&one);
+  GA_Merge_mirrored(g_a);
+  if (!check(g_a,ref,"dirty merge")) ok = 0;
+  /* nothing was written, so nothing changes */
+  GA_Merge_mirrored(g_a);
+  if (!check(g_a,ref,"clean merge")) ok = 0;
+  /* a put marks its patch as well */
+  GA_Zero(g_a);
+  for (i=0; i<N*N; i++) ref[i] = 0.0;
+  for (i=0; i<W; i++) {
+    for (j=0; j<W; j++) ref[(CORNER(0)+i)*N+CORNER(0)+j] = 1.0;
+  }
+  if (me == 0) NGA_Put(g_a,lo,hi,patch,&ld);
+  GA_Merge_mirrored(g_a);
+  if (!check(g_a,ref,"merge after put")) ok = 0;
+  GA_Set_merge_dirty(g_a,0);
+  GA_Destroy(g_a);
+  free(ref);
+
+  if (ok) {
+    if (me == 0) printf("\nMirrored merges are correct\n");
+  } else {
+    GA_Error("mirrored merge test failed",0);
+  }
+
+  /* time full merges against dirty merges after writing one patch. On a
+   * single node there is only one copy and nothing to time */
+  if (GA_Cluster_nnodes() > 1) {
+    dims[0] = NBIG;
+    dims[1] = NBIG;
+    g_big = NGA_Create_config(C_DBL,2,dims,"B",NULL,mirror);
+    if (!g_big) GA_Error("create failed",1);
+    GA_Zero(g_big);
+    if (me == 0) {
+      printf("\nMerge of a %dx%d mirrored array on %d processors, %d nodes\n\n",
+          NBIG,NBIG,nproc,GA_Cluster_nnodes());
+      printf("%8s %12s\n","merge","time (s)");
+    }
+    for (iter=0; iter<2; iter++) {
+      GA_Set_merge_dirty(g_big,iter);
+      GA_Merge_mirrored(g_big);
+      t = 0.0;
+      for (i=0; i<NTIMES; i++) {
+        if (me == 0) NGA_Acc(g_big,lo,hi,patch,&ld,&one);
+        GA_Sync();
+        t -= GA_Wtime();
+        GA_Merge_mirrored(g_big);
+        t += GA_Wtime();
+      }
+      t /= NTIMES;
+      GA_Dgop(&t,1,"max");
+      if (me == 0) printf("%8s %12.6f\n",iter == 0 ? "full" : "dirty",t);
+    }
+    GA_Destroy(g_big);
+  }
+
+  GA_Terminate();
+  MPI_Finalize();
+  return 0;
+}
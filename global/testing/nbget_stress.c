@@ -0,0 +1,104 @@
+/**
+ * Stress test for non-blocking handle management. Every process keeps
+ * NOUT single element NGA_NbGet calls outstanding at once, spread over all
+ * owners of the array, and then completes them in a different order than
+ * they were issued. Handles are also checked after a wait and after a test
+ * reported completion, when their table entries may already be reused.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpi.h"
+#include "ga.h"
+#include "macdecls.h"
+
+#define N 100000
+#define NOUT 100000
+
+int main(int argc, char **argv)
+{
+  int g_a, me, nproc, ok = 1;
+  int i, lo, hi, ld = 1, idx;
+  double *buf, *local, t;
+  ga_nbhdl_t *hdl, extra;
+
+  MPI_Init(&argc, &argv);
+  MA_init(C_DBL, 1000, 1000);
+  GA_Initialize();
+
+  me = GA_Nodeid();
+  nproc = GA_Nnodes();
+
+  lo = N;
+  g_a = NGA_Create(C_DBL,1,&lo,"A",NULL);
+  if (!g_a) GA_Error("create failed",0);
+  NGA_Distribution(g_a,me,&lo,&hi);
+  if (lo <= hi) {
+    NGA_Access(g_a,&lo,&hi,&local,&ld);
+    for (i=lo; i<=hi; i++) local[i-lo] = (double)i;
+    NGA_Release_update(g_a,&lo,&hi);
+  }
+  GA_Sync();
+
+  buf = (double*)malloc(NOUT*sizeof(double));
+  hdl = (ga_nbhdl_t*)malloc(NOUT*sizeof(ga_nbhdl_t));
+
+  t = GA_Wtime();
+  for (i=0; i<NOUT; i++) {
+    idx = (int)(((long)i*7919+me*104729)%N);
+    buf[i] = -1.0;
+    NGA_NbGet(g_a,&idx,&idx,&buf[i],&ld,&hdl[i]);
+  }
+  /* complete the odd handles from the back, then test the even ones until
+   * they report completion */
+  for (i=NOUT-1; i>=0; i--) {
+    if (i%2) NGA_NbWait(&hdl[i]);
+  }
+  for (i=0; i<NOUT; i+=2) {
+    while (!NGA_NbTest(&hdl[i]));
+  }
+  t = GA_Wtime()-t;
+
+  for (i=0; i<NOUT; i++) {
+    idx = (int)(((long)i*7919+me*104729)%N);
+    if (buf[i] != (double)idx) {
+      printf("p[%d] get %d returned %g, expected %d\n",me,i,buf[i],idx);
+      ok = 0;
+      break;
+    }
+  }
+
+  /* completed handles must stay completed after their entries are reused */
+  idx = 0;
+  NGA_NbGet(g_a,&idx,&idx,&buf[0],&ld,&extra);
+  for (i=0; i<NOUT; i++) {
+    if (!NGA_NbTest(&hdl[i])) {
+      printf("p[%d] completed handle %d reports pending\n",me,i);
+      ok = 0;
+      break;
+    }
+    NGA_NbWait(&hdl[i]);
+  }
+  NGA_NbWait(&extra);
+  if (buf[0] != 0.0) ok = 0;
+
+  GA_Dgop(&t,1,"max");
+  GA_Igop(&ok,1,"min");
+  if (me == 0) {
+    printf("\n%d outstanding NGA_NbGet calls per process on %d processors\n",
+        NOUT,nproc);
+    printf("time %.4f s, %.0f gets/s per process\n",t,NOUT/t);
+  }
+  if (ok) {
+    if (me == 0) printf("\nAll non-blocking gets completed correctly\n");
+  } else {
+    GA_Error("non-blocking handle test failed",0);
+  }
+
+  free(hdl);
+  free(buf);
+  GA_Destroy(g_a);
+  GA_Terminate();
+  MPI_Finalize();
+  return 0;
+}
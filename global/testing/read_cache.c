@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpi.h"
+#include "ga.h"
+#include "macdecls.h"
+
+#define DIM 256
+#define NLOOP 2000
+
+/* Convenience function to check that something is true on all processors */
+int trueEverywhere(int flag)
+{
+  int tflag, nprocs;
+  if (flag) tflag = 1;
+  else tflag = 0;
+  nprocs = GA_Nnodes();
+  GA_Igop(&tflag,1,"+");
+  if (nprocs == tflag) return 1;
+  return 0;
+}
+
+/* Get patch [lo,hi] from g_a and check it against the fill pattern */
+int checkPatch(int g_a, int lo[], int hi[])
+{
+  int i, j, ok = 1;
+  int ld = hi[1]-lo[1]+1;
+  int *buf = (int*)malloc(sizeof(int)*ld*(hi[0]-lo[0]+1));
+  NGA_Get(g_a,lo,hi,buf,&ld);
+  for (i=lo[0]; i<=hi[0]; i++) {
+    for (j=lo[1]; j<=hi[1]; j++) {
+      int idx = (i-lo[0])*ld+(j-lo[1]);
+      if (buf[idx] != i*DIM+j) {
+        if (ok) printf("p[%d] (%d,%d) expected: %d actual: %d\n",
+            GA_Nodeid(),i,j,i*DIM+j,buf[idx]);
+        ok = 0;
+      }
+    }
+  }
+  free(buf);
+  return ok;
+}
+
+int main(int argc, char * argv[])
+{
+  int g_a;
+  int me, nproc;
+  int dims[2], lo[2], hi[2], ld;
+  int i, j, n, ok;
+  int *ptr;
+
+  MPI_Init(&argc, &argv);
+  MA_init(C_INT, 1000, 1000);
+  GA_Initialize();
+
+  me = GA_Nodeid();
+  nproc = GA_Nnodes();
+  if (me == 0) {
+    printf("\nTest read cache on %d processors with %d X %d array\n",
+        nproc,DIM,DIM);
+  }
+
+  /* create and fill array */
+  dims[0] = DIM;
+  dims[1] = DIM;
+  g_a = NGA_Create_handle();
+  NGA_Set_data(g_a,2,dims,C_INT);
+  NGA_Allocate(g_a);
+  NGA_Distribution(g_a,me,lo,hi);
+  NGA_Access(g_a,lo,hi,&ptr,&ld);
+  for (i=lo[0]; i<=hi[0]; i++) {
+    for (j=lo[1]; j<=hi[1]; j++) {
+      ptr[(i-lo[0])*ld+(j-lo[1])] = i*DIM+j;
+    }
+  }
+  NGA_Release(g_a,lo,hi);
+  GA_Sync();
+  NGA_Set_property(g_a,"read_cache");
+
+  /* patch that is fetched and then cached */
+  ok = 1;
+  lo[0] = 10; hi[0] = 100;
+  lo[1] = 20; hi[1] = 60;
+  ok = ok && checkPatch(g_a,lo,hi);
+  /* patch contained in cached patch */
+  lo[0] = 30; hi[0] = 40;
+  lo[1] = 25; hi[1] = 50;
+  ok = ok && checkPatch(g_a,lo,hi);
+  /* patch that partially overlaps cached patch */
+  lo[0] = 50; hi[0] = 150;
+  lo[1] = 30; hi[1] = 60;
+  ok = ok && checkPatch(g_a,lo,hi);
+  /* patch assembled from two cached patches */
+  lo[0] = 20; hi[0] = 140;
+  lo[1] = 35; hi[1] = 55;
+  ok = ok && checkPatch(g_a,lo,hi);
+  /* patch that straddles all cached patches */
+  lo[0] = 0; hi[0] = 200;
+  lo[1] = 0; hi[1] = 80;
+  ok = ok && checkPatch(g_a,lo,hi);
+  if (trueEverywhere(ok)) {
+    if (me == 0) printf("\nOverlapping read cache gets succeeded\n");
+  } else {
+    if (me == 0) printf("\nOverlapping read cache gets FAILED\n");
+    GA_Error("read cache test failed",0);
+  }
+
+  /* random gets with a budget small enough to force eviction */
+  NGA_Set_read_cache_size(g_a,16*DIM*sizeof(int));
+  srand(me+1);
+  ok = 1;
+  for (n=0; n<NLOOP && ok; n++) {
+    for (i=0; i<2; i++) {
+      int len = rand()%16+1;
+      lo[i] = rand()%(DIM-len);
+      hi[i] = lo[i]+len-1;
+    }
+    ok = checkPatch(g_a,lo,hi);
+  }
+  if (trueEverywhere(ok)) {
+    if (me == 0) printf("\nRandom read cache gets succeeded\n");
+  } else {
+    if (me == 0) printf("\nRandom read cache gets FAILED\n");
+    GA_Error("read cache test failed",0);
+  }
+
+  if (me == 0) GA_Print_stats();
+  NGA_Unset_property(g_a);
+  GA_Destroy(g_a);
+
+  GA_Terminate();
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,199 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#if HAVE_STDIO_H
+#   include <stdio.h>
+#endif
+#include <stdlib.h>
+
+#include "ga.h"
+#include "macdecls.h"
+#include "mp3.h"
+
+#define N 1000      /* dimension of test arrays */
+#define M 100000    /* number of triples in the cancellation test */
+#define NRED 7
+
+/* values of element (i,j) of the input arrays; all sums are exact */
+#define AVAL(i,j) ((double)((i)-(j))*0.5)
+#define BVAL(i,j) ((double)(((i)+3*(j))%17) - 8.0)
+
+static void fill(int g, int which)
+{
+  int me = GA_Nodeid(), lo[2], hi[2], ld[1], i, j;
+  double *p;
+
+  NGA_Distribution(g,me,lo,hi);
+  if (lo[0] > hi[0] || lo[1] > hi[1]) return;
+  NGA_Access(g,lo,hi,&p,ld);
+  for (i=lo[0]; i<=hi[0]; i++) {
+    for (j=lo[1]; j<=hi[1]; j++) {
+      p[(i-lo[0])*ld[0]+(j-lo[1])] = which ? BVAL(i,j) : AVAL(i,j);
+    }
+  }
+  NGA_Release_update(g,lo,hi);
+}
+
+static void check(double *val, double *ref, int n, char *what)
+{
+  int i;
+
+  for (i=0; i<n; i++) {
+    if (val[i] != ref[i]) {
+      printf("%s: reduction %d is %.17g, expected %.17g\n",what,i,
+          val[i],ref[i]);
+      GA_Error("fused reduction returned wrong value",i);
+    }
+  }
+  if (GA_Nodeid() == 0) printf("Completed test of %s\n",what);
+}
+
+/* Compute a dot product, a sum of squares, a sum, the 1-norm, the largest
+ * magnitude and the maximum and minimum of arrays with GA_Reduce_fused on
+ * regular arrays, on arrays with ghost cells and on an array with a
+ * different distribution, check GA_Ddot, GA_Norm1, GA_Norm_infinity, an
+ * integer array and a sum with heavy cancellation */
+void do_work()
+{
+  int g_a, g_b, g_g, g_r, g_i, g_c;
+  int me = GA_Nodeid(), nproc = GA_Nnodes(), i, j;
+  int dims[2], width[2], block[2], *map, lo[1], hi[1], ld[1];
+  int ops[NRED] = { GA_ROP_DOT, GA_ROP_SUMSQ, GA_ROP_SUM, GA_ROP_ASUM,
+                    GA_ROP_AMAX, GA_ROP_MAX, GA_ROP_MIN };
+  int g_x[NRED], g_y[NRED], ival[NRED], three = 3;
+  double ref[NRED], val[NRED], a, b, *p;
+
+  /* exact results, computed on every process */
+  for (i=0; i<NRED; i++) ref[i] = 0.0;
+  ref[5] = AVAL(0,0); ref[6] = AVAL(0,0);
+  for (i=0; i<N; i++) {
+    for (j=0; j<N; j++) {
+      a = AVAL(i,j); b = BVAL(i,j);
+      ref[0] += a*b;
+      ref[1] += a*a;
+      ref[2] += b;
+      ref[3] += a >= 0 ? a : -a;
+      if ((b >= 0 ? b : -b) > ref[4]) ref[4] = b >= 0 ? b : -b;
+      if (a > ref[5]) ref[5] = a;
+      if (a < ref[6]) ref[6] = a;
+    }
+  }
+
+  dims[0] = N;
+  dims[1] = N;
+  g_a = NGA_Create(C_DBL,2,dims,"A",NULL);
+  g_b = NGA_Create(C_DBL,2,dims,"B",NULL);
+  if (!g_a || !g_b) GA_Error("create failed",0);
+  fill(g_a,0);
+  fill(g_b,1);
+
+  /* regular arrays */
+  for (i=0; i<NRED; i++) { g_x[i] = g_a; g_y[i] = 0; }
+  g_y[0] = g_b; g_x[2] = g_b; g_x[4] = g_b;
+  GA_Reduce_fused(NRED,ops,g_x,g_y,val);
+  check(val,ref,NRED,"fused reductions");
+
+  /* arrays with ghost cells, walked a row at a time */
+  width[0] = 2; width[1] = 1;
+  g_g = NGA_Create_ghosts(C_DBL,2,dims,width,"G",NULL);
+  GA_Copy(g_a,g_g);
+  for (i=0; i<NRED; i++) if (g_x[i] == g_a) g_x[i] = g_g;
+  GA_Reduce_fused(NRED,ops,g_x,g_y,val);
+  check(val,ref,NRED,"fused reductions with ghost cells");
+
+  /* an array distributed differently from the others */
+  block[0] = nproc > 1 ? 2 : 1;
+  block[1] = 1;
+  map = (int*)malloc((block[0]+block[1])*sizeof(int));
+  map[0] = 0;
+  if (block[0] > 1) map[1] = N/3;
+  map[block[0]] = 0;
+  g_r = NGA_Create_irreg(C_DBL,2,dims,"R",block,map);
+  free(map);
+  GA_Copy(g_b,g_r);
+  for (i=0; i<NRED; i++) {
+    if (g_x[i] == g_g) g_x[i] = g_a;
+    if (g_x[i] == g_b) g_x[i] = g_r;
+  }
+  g_y[0] = g_r;
+  GA_Reduce_fused(NRED,ops,g_x,g_y,val);
+  check(val,ref,NRED,"fused reductions, irregular input");
+
+  /* the same with the rank-ordered exchange of partial results */
+  setenv("GA_REDUCE_REPRODUCIBLE","1",1);
+  GA_Reduce_fused(NRED,ops,g_x,g_y,val);
+  check(val,ref,NRED,"reproducible fused reductions");
+  unsetenv("GA_REDUCE_REPRODUCIBLE");
+
+  /* the single reductions built on the engine */
+  val[0] = GA_Ddot(g_a,g_b);
+  val[1] = GA_Ddot(g_a,g_a);
+  GA_Norm1(g_a,&val[2]);
+  GA_Norm_infinity(g_b,&val[3]);
+  a = ref[2]; ref[2] = ref[3]; ref[3] = ref[4];
+  check(val,ref,4,"dot, norm1, norm_infinity");
+  ref[4] = ref[3]; ref[3] = ref[2]; ref[2] = a;
+
+  /* integer array */
+  g_i = NGA_Create(C_INT,2,dims,"I",NULL);
+  GA_Fill(g_i,&three);
+  for (i=0; i<NRED; i++) { g_x[i] = g_i; g_y[i] = g_i; }
+  GA_Reduce_fused(NRED,ops,g_x,g_y,ival);
+  for (i=0; i<NRED; i++) val[i] = ival[i];
+  ref[0] = ref[1] = 9.0*N*N; ref[2] = ref[3] = 3.0*N*N;
+  ref[4] = ref[5] = ref[6] = 3.0;
+  check(val,ref,NRED,"fused reductions, integer array");
+
+  /* 1e16 + 1 - 1e16 repeated: a plain sum loses every 1 */
+  dims[0] = 3*M;
+  g_c = NGA_Create(C_DBL,1,dims,"C",NULL);
+  NGA_Distribution(g_c,me,lo,hi);
+  if (lo[0] <= hi[0]) {
+    NGA_Access(g_c,lo,hi,&p,ld);
+    for (i=lo[0]; i<=hi[0]; i++)
+      p[i-lo[0]] = i%3 == 0 ? 1.0e16 : i%3 == 1 ? 1.0 : -1.0e16;
+    NGA_Release_update(g_c,lo,hi);
+  }
+  GA_Reduce_fused(1,&ops[2],&g_c,NULL,val);
+  ref[0] = (double)M;
+  check(val,ref,1,"compensated sum");
+
+  GA_Destroy(g_c);
+  GA_Destroy(g_i);
+  GA_Destroy(g_r);
+  GA_Destroy(g_g);
+  GA_Destroy(g_b);
+  GA_Destroy(g_a);
+}
+
+
+int main(int argc, char **argv)
+{
+int heap=20000, stack=20000;
+int me, nproc;
+
+    MP_INIT(argc,argv);
+
+    GA_INIT(argc,argv);                            /* initialize GA */
+    me=GA_Nodeid();
+    nproc=GA_Nnodes();
+    if(me==0) {
+       printf("Using %ld processes\n",(long)nproc);
+       fflush(stdout);
+    }
+
+    heap /= nproc;
+    stack /= nproc;
+    if(! MA_init(MT_F_DBL, stack, heap))
+       GA_Error("MA_init failed",stack+heap);  /* initialize memory allocator*/
+
+    do_work();
+
+    if (me == 0) printf("All tests successful\n");
+    GA_Terminate();
+
+    MP_FINALIZE();
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#if HAVE_STDIO_H
+#   include <stdio.h>
+#endif
+#include <stdlib.h>
+
+#include "ga.h"
+#include "macdecls.h"
+#include "mp3.h"
+
+#define N 1000      /* default dimension of the arrays */
+#define NTIMES 20
+
+/* Time a dot product, sum of squares, 1-norm and max norm of n x n arrays
+ * with one GA_Reduce_fused call against the four separate calls. The
+ * dimension is taken from the first argument. */
+int main(int argc, char **argv)
+{
+  int heap=20000, stack=20000;
+  int me, nproc, n = N, i, dims[2], g_a, g_b;
+  int ops[4] = { GA_ROP_DOT, GA_ROP_SUMSQ, GA_ROP_ASUM, GA_ROP_AMAX };
+  int g_x[4], g_y[4];
+  double one = 1.0, two = 2.0, val[4], t, tfused, tsep;
+
+  MP_INIT(argc,argv);
+  GA_INIT(argc,argv);
+  me=GA_Nodeid();
+  nproc=GA_Nnodes();
+  heap /= nproc;
+  stack /= nproc;
+  if(! MA_init(MT_F_DBL, stack, heap))
+    GA_Error("MA_init failed",stack+heap);
+  if (argc > 1) n = atoi(argv[1]);
+
+  dims[0] = n;
+  dims[1] = n;
+  g_a = NGA_Create(C_DBL,2,dims,"A",NULL);
+  g_b = NGA_Create(C_DBL,2,dims,"B",NULL);
+  if (!g_a || !g_b) GA_Error("create failed",n);
+  GA_Fill(g_a,&one);
+  GA_Fill(g_b,&two);
+  g_x[0] = g_a; g_y[0] = g_b;
+  for (i=1; i<4; i++) { g_x[i] = g_a; g_y[i] = 0; }
+
+  GA_Sync();
+  t = GA_Wtime();
+  for (i=0; i<NTIMES; i++) GA_Reduce_fused(4,ops,g_x,g_y,val);
+  tfused = GA_Wtime() - t;
+  GA_Sync();
+  t = GA_Wtime();
+  for (i=0; i<NTIMES; i++) {
+    val[0] = GA_Ddot(g_a,g_b);
+    val[1] = GA_Ddot(g_a,g_a);
+    GA_Norm1(g_a,&val[2]);
+    GA_Norm_infinity(g_a,&val[3]);
+  }
+  tsep = GA_Wtime() - t;
+  if (me == 0) {
+    printf("dot, sum of squares, 1-norm and max norm on %dx%d, %d times\n",
+        n,n,NTIMES);
+    printf("  fused      %10.4f s\n",tfused);
+    printf("  separate   %10.4f s\n",tsep);
+  }
+
+  GA_Destroy(g_b);
+  GA_Destroy(g_a);
+  GA_Terminate();
+  MP_FINALIZE();
+  return 0;
+}
@@ -0,0 +1,258 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#if HAVE_STDIO_H
+#   include <stdio.h>
+#endif
+#include <stdlib.h>
+
+#include "ga.h"
+#include "macdecls.h"
+#include "mp3.h"
+
+#define N 100000        /* length of test arrays */
+#define NVAL 2001       /* keys are in [-NVAL/2,NVAL/2] */
+
+/* keys of element i: mixed, all equal, or descending */
+static double key(long i, int mode)
+{
+  if (mode == 0) return (double)((i*7919+13)%NVAL - NVAL/2);
+  if (mode == 1) return 5.0;
+  return (double)(-i/3);
+}
+
+static double get(void *p, int type, long i)
+{
+  switch (type) {
+    case C_INT: return (double)((int*)p)[i];
+    case C_LONG: return (double)((long*)p)[i];
+    case C_LONGLONG: return (double)((long long*)p)[i];
+    case C_FLOAT: return (double)((float*)p)[i];
+    case C_DBL: return ((double*)p)[i];
+  }
+  return 0.0;
+}
+
+static void fill(int g, int type, int mode)
+{
+  int me = GA_Nodeid();
+  int64_t lo, hi, ld;
+  long i;
+  void *p;
+
+  NGA_Distribution64(g,me,&lo,&hi);
+  if (lo > hi) return;
+  NGA_Access64(g,&lo,&hi,&p,&ld);
+  for (i=lo; i<=hi; i++) {
+    double v = key(i,mode);
+    switch (type) {
+      case C_INT: ((int*)p)[i-lo] = (int)v; break;
+      case C_LONG: ((long*)p)[i-lo] = (long)v; break;
+      case C_LONGLONG: ((long long*)p)[i-lo] = (long long)v; break;
+      case C_FLOAT: ((float*)p)[i-lo] = (float)v; break;
+      case C_DBL: ((double*)p)[i-lo] = v; break;
+    }
+  }
+  NGA_Release_update64(g,&lo,&hi);
+}
+
+static void report(int ok, char *what)
+{
+  GA_Igop(&ok,1,"min");
+  if (!ok) GA_Error("sort gave wrong result",0);
+  if (GA_Nodeid() == 0) printf("Completed test of %s\n",what);
+}
+
+/* Check that g_a is sorted and, for mode 0, holds the keys it was filled
+   with. If g_v is not zero, it must hold the subscripts of the keys, in
+   increasing order for equal keys. */
+static int check(int g_a, int g_v, int type, int64_t n, int mode)
+{
+  int me = GA_Nodeid(), ok = 1;
+  int64_t lo, hi, ld, prev;
+  long i, *v = NULL, vprev = -1;
+  double kprev = 0.0, k;
+  int hist[NVAL];
+  void *p;
+  char buf[16];
+
+  for (i=0; i<NVAL; i++) hist[i] = 0;
+  NGA_Distribution64(g_a,me,&lo,&hi);
+  if (lo <= hi) {
+    NGA_Access64(g_a,&lo,&hi,&p,&ld);
+    if (g_v) {
+      /* g_v may be distributed differently from g_a */
+      v = (long*)malloc((hi-lo+1)*sizeof(long));
+      NGA_Get64(g_v,&lo,&hi,v,&ld);
+    }
+    if (lo > 0) {
+      prev = lo-1;
+      NGA_Get64(g_a,&prev,&prev,buf,&ld);
+      kprev = get(buf,type,0);
+      if (g_v) NGA_Get64(g_v,&prev,&prev,&vprev,&ld);
+    }
+    for (i=0; i<=hi-lo; i++) {
+      k = get(p,type,i);
+      if ((i > 0 || lo > 0) &&
+          (k < kprev || (g_v && k == kprev && v[i] <= vprev))) {
+        printf("p[%d]: element %ld out of order\n",me,(long)(lo+i));
+        ok = 0;
+        break;
+      }
+      if (g_v && (v[i] < 0 || v[i] >= n || key(v[i],mode) != k)) {
+        printf("p[%d]: element %ld has wrong subscript %ld\n",me,
+            (long)(lo+i),v[i]);
+        ok = 0;
+        break;
+      }
+      if (mode == 0) hist[(int)k + NVAL/2]++;
+      kprev = k;
+      if (g_v) vprev = v[i];
+    }
+    if (g_v) free(v);
+    NGA_Release64(g_a,&lo,&hi);
+  }
+  if (mode == 0) {
+    /* the sorted keys must be the keys that went in */
+    GA_Igop(hist,NVAL,"+");
+    for (i=0; i<n; i++) hist[(int)key(i,0) + NVAL/2]--;
+    for (i=0; i<NVAL; i++) if (hist[i] != 0) ok = 0;
+  }
+  return ok;
+}
+
+/* Check that the ranks in g_r match the permutation g_v returned by
+   GA_Sort_kv: the element with subscript v[k] has rank k. */
+static int check_rank(int g_r, int g_v)
+{
+  int me = GA_Nodeid(), lo, hi, ld, i, ok = 1;
+  int *subs, **sp;
+  long *v, *r;
+
+  NGA_Distribution(g_v,me,&lo,&hi);
+  if (lo > hi) return 1;
+  subs = (int*)malloc((hi-lo+1)*sizeof(int));
+  sp = (int**)malloc((hi-lo+1)*sizeof(int*));
+  r = (long*)malloc((hi-lo+1)*sizeof(long));
+  NGA_Access(g_v,&lo,&hi,&v,&ld);
+  for (i=0; i<=hi-lo; i++) {
+    subs[i] = (int)v[i];
+    sp[i] = &subs[i];
+  }
+  NGA_Gather(g_r,r,sp,hi-lo+1);
+  for (i=0; i<=hi-lo; i++) {
+    if (r[i] != lo+i) {
+      printf("p[%d]: element %ld has rank %ld, expected %d\n",me,v[i],r[i],
+          lo+i);
+      ok = 0;
+      break;
+    }
+  }
+  NGA_Release(g_v,&lo,&hi);
+  free(r);
+  free(sp);
+  free(subs);
+  return ok;
+}
+
+/* Sort, sort with values and rank g_a, of length n, filled with mode */
+static void test(int g_a, int type, int n, int mode, char *what)
+{
+  int g_v, g_r;
+  long start = 0, inc = 1;
+  char name[64];
+
+  g_v = NGA_Create(C_LONG,1,&n,"values",NULL);
+  g_r = NGA_Create(C_LONG,1,&n,"ranks",NULL);
+  if (!g_v || !g_r) GA_Error("create failed",0);
+
+  fill(g_a,type,mode);
+  GA_Sort(g_a);
+  sprintf(name,"%s, sort",what);
+  report(check(g_a,0,type,n,mode),name);
+
+  fill(g_a,type,mode);
+  GA_Patch_enum(g_v,0,n-1,&start,&inc);
+  GA_Sort_kv(g_a,g_v);
+  sprintf(name,"%s, sort_kv",what);
+  report(check(g_a,g_v,type,n,mode),name);
+
+  fill(g_a,type,mode);
+  GA_Sort_rank(g_a,g_r);
+  sprintf(name,"%s, sort_rank",what);
+  report(check_rank(g_r,g_v),name);
+
+  GA_Destroy(g_r);
+  GA_Destroy(g_v);
+}
+
+/* For every key type, sort a 1-D array holding many equal and negative
+ * keys with GA_Sort, GA_Sort_kv carrying the subscripts of the keys and
+ * GA_Sort_rank, and do the same for an irregular distribution, for fewer
+ * keys than processes, for keys that are all equal and for keys in
+ * descending order */
+void do_work()
+{
+  int types[] = { C_INT, C_LONG, C_LONGLONG, C_FLOAT, C_DBL };
+  char *names[] = { "int", "long", "long long", "float", "double" };
+  int nproc = GA_Nnodes(), i, n, g_a, block, map[2];
+
+  n = N;
+  for (i=0; i<5; i++) {
+    g_a = NGA_Create(types[i],1,&n,"keys",NULL);
+    if (!g_a) GA_Error("create failed",0);
+    test(g_a,types[i],n,0,names[i]);
+    GA_Destroy(g_a);
+  }
+
+  /* uneven distribution */
+  block = nproc > 1 ? 2 : 1;
+  map[0] = 0;
+  map[1] = N/10;
+  g_a = NGA_Create_irreg(C_DBL,1,&n,"keys",&block,map);
+  test(g_a,C_DBL,n,0,"irregular");
+  GA_Destroy(g_a);
+
+  /* fewer keys than processes, and all keys equal */
+  n = 3;
+  g_a = NGA_Create(C_LONG,1,&n,"keys",NULL);
+  test(g_a,C_LONG,n,0,"3 keys");
+  GA_Destroy(g_a);
+  n = N;
+  g_a = NGA_Create(C_INT,1,&n,"keys",NULL);
+  test(g_a,C_INT,n,1,"equal keys");
+  test(g_a,C_INT,n,2,"descending keys");
+  GA_Destroy(g_a);
+}
+
+
+int main(int argc, char **argv)
+{
+int heap=20000, stack=20000;
+int me, nproc;
+
+    MP_INIT(argc,argv);
+
+    GA_INIT(argc,argv);                            /* initialize GA */
+    me=GA_Nodeid();
+    nproc=GA_Nnodes();
+    if(me==0) {
+       printf("Using %ld processes\n",(long)nproc);
+       fflush(stdout);
+    }
+
+    heap /= nproc;
+    stack /= nproc;
+    if(! MA_init(MT_F_DBL, stack, heap))
+       GA_Error("MA_init failed",stack+heap);  /* initialize memory allocator*/
+
+    do_work();
+
+    if (me == 0) printf("All tests successful\n");
+    GA_Terminate();
+
+    MP_FINALIZE();
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#if HAVE_STDIO_H
+#   include <stdio.h>
+#endif
+#include <stdlib.h>
+
+#include "ga.h"
+#include "macdecls.h"
+#include "mp3.h"
+
+#define NBENCH 1000000  /* default keys per process */
+
+/* pseudo-random key of element i */
+static double key(long i)
+{
+  unsigned long long h;
+  h = (unsigned long long)i*6364136223846793005ULL + 1442695040888963407ULL;
+  return (double)(long long)(h >> 24) - (double)(1LL << 39);
+}
+
+static void fill(int g, int type)
+{
+  int me = GA_Nodeid();
+  int64_t lo, hi, ld;
+  long i;
+  void *p;
+
+  NGA_Distribution64(g,me,&lo,&hi);
+  if (lo > hi) return;
+  NGA_Access64(g,&lo,&hi,&p,&ld);
+  for (i=lo; i<=hi; i++) {
+    if (type == C_LONG) ((long*)p)[i-lo] = (long)key(i);
+    else ((double*)p)[i-lo] = key(i);
+  }
+  NGA_Release_update64(g,&lo,&hi);
+}
+
+/* Time GA_Sort of random double and long keys. The number of keys per
+ * process is taken from the first argument, so that weak scaling can be
+ * measured by running e.g.
+ *   mpirun -np 64 sort_perf.x 50000000
+ * which sorts 3.2 billion keys. */
+int main(int argc, char **argv)
+{
+  int heap=20000, stack=20000;
+  int types[] = { C_DBL, C_LONG };
+  char *names[] = { "double", "long" };
+  int me, nproc, i, g_a;
+  long nb = NBENCH;
+  int64_t n;
+  double t;
+
+  MP_INIT(argc,argv);
+  GA_INIT(argc,argv);
+  me=GA_Nodeid();
+  nproc=GA_Nnodes();
+  heap /= nproc;
+  stack /= nproc;
+  if(! MA_init(MT_F_DBL, stack, heap))
+    GA_Error("MA_init failed",stack+heap);
+  if (argc > 1) nb = atol(argv[1]);
+
+  n = (int64_t)nb*nproc;
+  if (me == 0) printf("sort of %ld random keys on %d processes\n",(long)n,
+      nproc);
+  for (i=0; i<2; i++) {
+    g_a = NGA_Create64(types[i],1,&n,"keys",NULL);
+    if (!g_a) GA_Error("create failed",i);
+    fill(g_a,types[i]);
+    GA_Sync();
+    t = GA_Wtime();
+    GA_Sort(g_a);
+    t = GA_Wtime() - t;
+    GA_Dgop(&t,1,"max");
+    if (me == 0) printf("  %-10s %10.4f s %10.2f Mkeys/s\n",names[i],t,
+        1.0e-6*n/t);
+    GA_Destroy(g_a);
+  }
+
+  GA_Terminate();
+  MP_FINALIZE();
+  return 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * Contention benchmark for shared task counters. Every process draws
+ * tasks as fast as it can, first from a single element with
+ * NGA_Read_inc and then from a hierarchical GA_Create_counter counter.
+ * Each task must be handed out exactly once; this is checked by counting
+ * the draws of every task in a global array.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpi.h"
+#include "ga.h"
+#include "macdecls.h"
+
+#define NTASKS 20000
+#define NTIMES 2
+
+/* sum the draws of every task over all processes and check that each task
+ * was drawn exactly once */
+int check_tasks(int g_cnt, int *list, int nlist)
+{
+  int i, lo, hi, ld, *buf, one = 1, ok = 1;
+  int *draws = (int*)calloc(NTASKS,sizeof(int));
+
+  for (i=0; i<nlist; i++) {
+    draws[list[i]]++;
+  }
+  GA_Zero(g_cnt);
+  lo = 0;
+  hi = NTASKS-1;
+  ld = NTASKS;
+  NGA_Acc(g_cnt,&lo,&hi,draws,&ld,&one);
+  free(draws);
+  GA_Sync();
+  NGA_Distribution(g_cnt,GA_Nodeid(),&lo,&hi);
+  if (lo <= hi) {
+    NGA_Access(g_cnt,&lo,&hi,&buf,&ld);
+    for (i=0; i<hi-lo+1; i++) {
+      if (buf[i] != 1) {
+        printf("p[%d] task %d drawn %d times\n",GA_Nodeid(),lo+i,buf[i]);
+        ok = 0;
+        break;
+      }
+    }
+    NGA_Release(g_cnt,&lo,&hi);
+  }
+  GA_Igop(&ok,1,"min");
+  return ok;
+}
+
+int main(int argc, char **argv)
+{
+  int g_inc, g_cnt, counter;
+  int me, nproc, ok = 1;
+  int iter, nlist, dims, zero = 0;
+  int *list;
+  long task;
+  double t;
+
+  MPI_Init(&argc, &argv);
+  MA_init(C_INT, 1000, 1000);
+  GA_Initialize();
+
+  me = GA_Nodeid();
+  nproc = GA_Nnodes();
+  if (me == 0) {
+    printf("\nTask counter contention on %d processors, %d nodes\n\n",nproc,
+        GA_Cluster_nnodes());
+    printf("%12s %12s %14s\n","counter","time (s)","tasks/s");
+  }
+
+  list = (int*)malloc(NTASKS*sizeof(int));
+  dims = 1;
+  g_inc = NGA_Create(C_LONG,1,&dims,"read_inc",NULL);
+  dims = NTASKS;
+  g_cnt = NGA_Create(C_INT,1,&dims,"draws",NULL);
+  if (!g_inc || !g_cnt) GA_Error("create failed",0);
+
+  for (iter=0; iter<NTIMES; iter++) {
+    GA_Zero(g_inc);
+    nlist = 0;
+    t = GA_Wtime();
+    while ((task = NGA_Read_inc(g_inc,&zero,1)) < NTASKS) {
+      list[nlist++] = (int)task;
+    }
+    t = GA_Wtime()-t;
+    GA_Dgop(&t,1,"max");
+    if (me == 0) printf("%12s %12.4f %14.0f\n","read_inc",t,NTASKS/t);
+    if (!check_tasks(g_cnt,list,nlist)) ok = 0;
+  }
+
+  counter = GA_Create_counter(NTASKS);
+  for (iter=0; iter<NTIMES; iter++) {
+    if (iter > 0) GA_Reset_counter(counter);
+    nlist = 0;
+    t = GA_Wtime();
+    while ((task = GA_Next_task(counter)) < NTASKS) {
+      list[nlist++] = (int)task;
+    }
+    t = GA_Wtime()-t;
+    GA_Dgop(&t,1,"max");
+    if (me == 0) printf("%12s %12.4f %14.0f\n","hierarchical",t,NTASKS/t);
+    if (!check_tasks(g_cnt,list,nlist)) ok = 0;
+  }
+  GA_Destroy_counter(counter);
+
+  /* an empty range hands out nothing */
+  counter = GA_Create_counter(0);
+  if (GA_Next_task(counter) != 0) ok = 0;
+  GA_Destroy_counter(counter);
+  GA_Igop(&ok,1,"min");
+
+  if (ok) {
+    if (me == 0) printf("\nAll tasks were handed out exactly once\n");
+  } else {
+    GA_Error("task counter test failed",0);
+  }
+
+  free(list);
+  GA_Destroy(g_cnt);
+  GA_Destroy(g_inc);
+  GA_Terminate();
+  MPI_Finalize();
+  return 0;
+}
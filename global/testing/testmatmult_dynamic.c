@@ -0,0 +1,112 @@
+/**
+ * Compare the static ga_dgemm algorithms with the dynamic, task stealing
+ * engine (GA_MATMUL_DYNAMIC) on square, tall-skinny and long-k shapes.
+ * Every dynamic result is checked against the static one.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpi.h"
+#include "ga.h"
+#include "macdecls.h"
+
+#define NSHAPES 3
+#define NDEPTHS 3
+#define NTIMES 3
+
+static int nums_m[NSHAPES] = {512, 4096,  128};
+static int nums_n[NSHAPES] = {512,   64,  128};
+static int nums_k[NSHAPES] = {512,  256, 8192};
+static char *depths[NDEPTHS] = {"2", "3", "6"};
+
+/* run C = A*B NTIMES and return the slowest process' average time */
+double time_dgemm(int g_a, int g_b, int g_c, int m, int n, int k)
+{
+  int i;
+  double t;
+
+  GA_Sync();
+  t = GA_Wtime();
+  for (i=0; i<NTIMES; i++) {
+    GA_Dgemm('n','n',m,n,k,1.0,g_a,g_b,0.0,g_c);
+  }
+  t = (GA_Wtime()-t)/NTIMES;
+  GA_Dgop(&t,1,"max");
+  return t;
+}
+
+int main(int argc, char **argv)
+{
+  int g_a, g_b, g_c, g_ref;
+  int me, nproc, ok = 1;
+  int i, d, m, n, k, dims[2];
+  double t, gflop, diff, ref;
+  double one = 1.0, mone = -1.0;
+
+  MPI_Init(&argc, &argv);
+  MA_init(C_DBL, 1000, 4000000);
+  GA_Initialize();
+
+  me = GA_Nodeid();
+  nproc = GA_Nnodes();
+  if (me == 0) {
+    printf("\nStatic vs dynamic ga_dgemm on %d processors\n\n",nproc);
+    printf("%6s %6s %6s %8s %10s %8s\n","m","n","k","engine","time (s)",
+        "GFLOP/s");
+  }
+
+  for (i=0; i<NSHAPES; i++) {
+    m = nums_m[i];
+    n = nums_n[i];
+    k = nums_k[i];
+    gflop = 2.0*m*n*k*1.0e-9;
+
+    dims[0] = m; dims[1] = k;
+    g_a = NGA_Create(C_DBL,2,dims,"A",NULL);
+    dims[0] = k; dims[1] = n;
+    g_b = NGA_Create(C_DBL,2,dims,"B",NULL);
+    dims[0] = m; dims[1] = n;
+    g_c = NGA_Create(C_DBL,2,dims,"C",NULL);
+    g_ref = NGA_Create(C_DBL,2,dims,"C ref",NULL);
+    if (!g_a || !g_b || !g_c || !g_ref) GA_Error("create failed",i);
+    GA_Randomize(g_a, &one);
+    GA_Randomize(g_b, &one);
+
+    setenv("GA_MATMUL_DYNAMIC","0",1);
+    t = time_dgemm(g_a,g_b,g_ref,m,n,k);
+    if (me == 0) printf("%6d %6d %6d %8s %10.4f %8.2f\n",m,n,k,"static",t,
+        gflop/t);
+    ref = GA_Ddot(g_ref,g_ref);
+
+    setenv("GA_MATMUL_DYNAMIC","1",1);
+    for (d=0; d<NDEPTHS; d++) {
+      setenv("GA_MATMUL_PIPELINE_DEPTH",depths[d],1);
+      GA_Zero(g_c);
+      t = time_dgemm(g_a,g_b,g_c,m,n,k);
+      if (me == 0) printf("%6d %6d %6d %7s%s %10.4f %8.2f\n",m,n,k,"depth ",
+          depths[d],t,gflop/t);
+      GA_Add(&one,g_c,&mone,g_ref,g_c);
+      diff = GA_Ddot(g_c,g_c);
+      if (diff > 1.0e-20*ref) {
+        if (me == 0) printf("dynamic result differs: %g\n",diff);
+        ok = 0;
+      }
+    }
+    setenv("GA_MATMUL_DYNAMIC","0",1);
+
+    GA_Destroy(g_ref);
+    GA_Destroy(g_c);
+    GA_Destroy(g_b);
+    GA_Destroy(g_a);
+  }
+
+  if (ok) {
+    if (me == 0) printf("\nDynamic ga_dgemm results agree\n");
+  } else {
+    GA_Error("dynamic ga_dgemm test failed",0);
+  }
+
+  GA_Terminate();
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,181 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#if HAVE_STDIO_H
+#   include <stdio.h>
+#endif
+#include <stdlib.h>
+
+#include "ga.h"
+#include "macdecls.h"
+#include "mp3.h"
+
+#define M 1500      /* rows of the test arrays */
+#define N 700       /* columns of the test arrays */
+
+/* value of element (i,j) of the input array */
+#define AVAL(i,j) ((double)(((i)*3+(j)*7)%1009) - 500.0)
+
+static void fill(int g, int type)
+{
+  int me = GA_Nodeid(), lo[2], hi[2], ld[1], i, j, k;
+  void *p;
+
+  NGA_Distribution(g,me,lo,hi);
+  if (lo[0] > hi[0] || lo[1] > hi[1]) return;
+  NGA_Access(g,lo,hi,&p,ld);
+  for (i=lo[0]; i<=hi[0]; i++) {
+    for (j=lo[1]; j<=hi[1]; j++) {
+      k = (i-lo[0])*ld[0]+(j-lo[1]);
+      switch (type) {
+        case C_INT: ((int*)p)[k] = (int)AVAL(i,j); break;
+        case C_LONG: ((long*)p)[k] = (long)AVAL(i,j); break;
+        case C_FLOAT: ((float*)p)[k] = (float)AVAL(i,j); break;
+        case C_DBL: ((double*)p)[k] = AVAL(i,j); break;
+        case C_DCPL:
+          ((DoubleComplex*)p)[k].real = AVAL(i,j);
+          ((DoubleComplex*)p)[k].imag = -AVAL(i,j);
+          break;
+      }
+    }
+  }
+  NGA_Release_update(g,lo,hi);
+}
+
+/* every element (i,j) of g must be element (j,i) of the input */
+static void check(int g, int type, char *what)
+{
+  int me = GA_Nodeid(), lo[2], hi[2], ld[1], i, j, k, ok = 1;
+  double val, ref;
+  void *p;
+
+  NGA_Distribution(g,me,lo,hi);
+  if (lo[0] <= hi[0] && lo[1] <= hi[1]) {
+    NGA_Access(g,lo,hi,&p,ld);
+    for (i=lo[0]; i<=hi[0] && ok; i++) {
+      for (j=lo[1]; j<=hi[1]; j++) {
+        k = (i-lo[0])*ld[0]+(j-lo[1]);
+        ref = AVAL(j,i);
+        switch (type) {
+          case C_INT: val = ((int*)p)[k]; break;
+          case C_LONG: val = ((long*)p)[k]; break;
+          case C_FLOAT: val = ((float*)p)[k]; break;
+          case C_DBL: val = ((double*)p)[k]; break;
+          default:
+            val = ((DoubleComplex*)p)[k].real;
+            if (((DoubleComplex*)p)[k].imag != -ref) val = ref + 1.0;
+            break;
+        }
+        if (val != ref) {
+          printf("%s: element (%d,%d) is %g, expected %g\n",what,i,j,val,ref);
+          ok = 0;
+          break;
+        }
+      }
+    }
+    NGA_Release(g,lo,hi);
+  }
+  GA_Igop(&ok,1,"min");
+  if (!ok) GA_Error("transpose gave wrong result",0);
+  if (me == 0) printf("Completed test of %s\n",what);
+}
+
+/* Transpose a non-square array into regular arrays of several types, into
+ * an array with ghost cells, into an irregularly distributed array and
+ * into a block-cyclic array */
+void do_work()
+{
+  int g_a, g_b, g_c;
+  int nproc = GA_Nnodes(), t;
+  int dims[2], tdims[2], width[2], block[2], *map;
+  int types[] = { C_INT, C_LONG, C_FLOAT, C_DBL, C_DCPL };
+  char *names[] = { "int", "long", "float", "double", "double complex" };
+  char what[64];
+
+  dims[0] = M;  dims[1] = N;
+  tdims[0] = N; tdims[1] = M;
+
+  /* regular arrays of each type */
+  for (t=0; t<(int)(sizeof(types)/sizeof(types[0])); t++) {
+    g_a = NGA_Create(types[t],2,dims,"A",NULL);
+    g_b = NGA_Create(types[t],2,tdims,"B",NULL);
+    if (!g_a || !g_b) GA_Error("create failed",t);
+    fill(g_a,types[t]);
+    GA_Transpose(g_a,g_b);
+    sprintf(what,"transpose, %s",names[t]);
+    check(g_b,types[t],what);
+    GA_Destroy(g_b);
+    GA_Destroy(g_a);
+  }
+
+  g_a = NGA_Create(C_DBL,2,dims,"A",NULL);
+  fill(g_a,C_DBL);
+
+  /* output with ghost cells */
+  width[0] = 2; width[1] = 1;
+  g_b = NGA_Create_ghosts(C_DBL,2,tdims,width,"G",NULL);
+  GA_Transpose(g_a,g_b);
+  check(g_b,C_DBL,"transpose, ghost cells");
+  GA_Destroy(g_b);
+
+  /* output distributed unevenly */
+  block[0] = nproc > 1 ? 2 : 1;
+  block[1] = nproc > 3 ? 2 : 1;
+  map = (int*)malloc((block[0]+block[1])*sizeof(int));
+  map[0] = 0;
+  if (block[0] > 1) map[1] = N/5;
+  map[block[0]] = 0;
+  if (block[1] > 1) map[block[0]+1] = 2*M/3;
+  g_b = NGA_Create_irreg(C_DBL,2,tdims,"R",block,map);
+  free(map);
+  GA_Transpose(g_a,g_b);
+  check(g_b,C_DBL,"transpose, irregular");
+  GA_Destroy(g_b);
+
+  /* block-cyclic output */
+  g_b = GA_Create_handle();
+  GA_Set_data(g_b,2,tdims,C_DBL);
+  block[0] = 64; block[1] = 96;
+  GA_Set_block_cyclic(g_b,block);
+  GA_Allocate(g_b);
+  GA_Zero(g_b);
+  GA_Transpose(g_a,g_b);
+  g_c = NGA_Create(C_DBL,2,tdims,"C",NULL);
+  GA_Copy(g_b,g_c);
+  check(g_c,C_DBL,"transpose, block-cyclic");
+  GA_Destroy(g_c);
+  GA_Destroy(g_b);
+  GA_Destroy(g_a);
+}
+
+
+int main(int argc, char **argv)
+{
+int heap=20000, stack=4*M*N;   /* two complex transpose buffers */
+int me, nproc;
+
+    MP_INIT(argc,argv);
+
+    GA_INIT(argc,argv);                            /* initialize GA */
+    me=GA_Nodeid();
+    nproc=GA_Nnodes();
+    if(me==0) {
+       printf("Using %ld processes\n",(long)nproc);
+       fflush(stdout);
+    }
+
+    heap /= nproc;
+    stack /= nproc;
+    if(! MA_init(MT_F_DBL, stack, heap))
+       GA_Error("MA_init failed",stack+heap);  /* initialize memory allocator*/
+
+    do_work();
+
+    if (me == 0) printf("All tests successful\n");
+    GA_Terminate();
+
+    MP_FINALIZE();
+
+    return 0;
+}
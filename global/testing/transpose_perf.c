@@ -0,0 +1,59 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#if HAVE_STDIO_H
+#   include <stdio.h>
+#endif
+#include <stdlib.h>
+
+#include "ga.h"
+#include "macdecls.h"
+#include "mp3.h"
+
+#define NT 2000     /* default dimension of the array */
+#define NTIMES 10
+
+/* Time repeated transposes of a square array of doubles. The dimension
+ * is taken from the first argument. */
+int main(int argc, char **argv)
+{
+  int heap=20000, stack;
+  int me, nproc, n = NT, i, dims[2], g_a, g_b;
+  double one = 1.0, time;
+
+  MP_INIT(argc,argv);
+  GA_INIT(argc,argv);
+  me=GA_Nodeid();
+  nproc=GA_Nnodes();
+  if (argc > 1) n = atoi(argv[1]);
+  /* transpose takes two buffers from the stack */
+  stack = (int)((2.0*n*n)/nproc) + 20000;
+  heap /= nproc;
+  if(! MA_init(MT_F_DBL, stack, heap))
+    GA_Error("MA_init failed",stack+heap);
+
+  dims[0] = n;
+  dims[1] = n;
+  g_a = NGA_Create(C_DBL,2,dims,"A",NULL);
+  g_b = NGA_Create(C_DBL,2,dims,"B",NULL);
+  if (!g_a || !g_b) GA_Error("create failed",n);
+  GA_Fill(g_a,&one);
+
+  GA_Sync();
+  time = GA_Wtime();
+  for (i=0; i<NTIMES; i++) GA_Transpose(g_a,g_b);
+  time = GA_Wtime() - time;
+  if (me == 0) {
+    printf("transpose of %dx%d doubles, %d times\n",n,n,NTIMES);
+    printf("  time       %10.4f s\n",time);
+    printf("  rate       %10.2f MB/s\n",
+        (double)NTIMES*n*n*sizeof(double)/time/1.0e6);
+  }
+
+  GA_Destroy(g_b);
+  GA_Destroy(g_a);
+  GA_Terminate();
+  MP_FINALIZE();
+  return 0;
+}
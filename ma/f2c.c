@@ -152,6 +152,14 @@ public Boolean FATR f2c_init_memhandle_iterator_(ithandle)
 }
 
 
+public Boolean FATR f2c_init_threads_(datatype, nominal_stack)
+    Integer *datatype;
+    Integer *nominal_stack;
+{
+    return MA_init_threads(*datatype, *nominal_stack);
+}
+
+
 public Integer FATR f2c_inquire_avail_(datatype)
     Integer *datatype;
 {
@@ -287,6 +295,13 @@ public Boolean FATR f2c_set_error_print_(value)
 }
 
 
+public Boolean FATR f2c_set_guard_check_(value)
+    Integer *value;
+{
+    return MA_set_guard_check((Boolean)*value);
+}
+
+
 public Boolean FATR f2c_set_hard_fail_(value)
     Integer *value;
 {
@@ -294,6 +309,13 @@ public Boolean FATR f2c_set_hard_fail_(value)
 }
 
 
+public Boolean FATR f2c_set_heap_bins_(value)
+    Integer *value;
+{
+    return MA_set_heap_bins((Boolean)*value);
+}
+
+
 public Boolean FATR f2c_set_numalign_(value)
     Integer *value;
 {
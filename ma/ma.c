@@ -18,6 +18,9 @@
 #if HAVE_MALLOC_H
 #   include <malloc.h>
 #endif
+#if HAVE_PTHREAD_H
+#   include <pthread.h>
+#endif
 #include "error.h"
 #include "farg.h"
 #include "ma.h"
@@ -61,6 +64,25 @@ extern void* ARMCI_Malloc_local(long bytes);
  * AD); and two gaps, each zero or more bytes long, to satisfy
  * alignment constraints (specifically, to ensure that AD and
  * client_space are aligned properly).
+ *
+ * The heap region can optionally be managed with segregated size
+ * classes (see MA_set_heap_bins).  Free heap blocks are then kept on
+ * per-class doubly linked lists whose occupancy is tracked in two
+ * levels of bitmaps, so that a suitable block is found without
+ * walking the free list.  Each heap block records the length of the
+ * block to its left and whether it is free (boundary tags), so that
+ * a deallocated block is coalesced with its neighbors directly.
+ * Free blocks never touch ma_hp: a block that would is returned to
+ * the unused space instead.
+ *
+ * After MA_init_threads, MA may be called from several threads.  The
+ * thread that called MA_init_threads keeps using the shared stack.  Every
+ * other thread gets its own stack region, carved from the heap the first
+ * time it needs one, and pushes and pops without locking.  Each thread
+ * also keeps a cache of small heap blocks by size class, refilled from
+ * the shared heap in batches, and a batch of reserved memhandles, so
+ * that most heap allocations and deallocations take no lock either.  A
+ * single mutex protects the shared heap and stack.
  */
 
 /**
@@ -107,6 +129,19 @@ extern void* ARMCI_Malloc_local(long bytes);
 #define MINBLOCKSIZE mai_round((size_t)(ALIGNMENT + BLOCK_OVERHEAD_FIXED), \
         (ulongi)ALIGNMENT)
 
+/* size classes: BIN_FL powers of two, each split into BIN_SL subclasses */
+#define BIN_SL_LOG 2
+#define BIN_SL     (1 << BIN_SL_LOG)
+#define BIN_FL     ((int)(8 * sizeof(size_t)))
+
+/* per-thread heap cache: largest block, total bytes, blocks per refill */
+#define THREAD_CACHE_BLOCK 65536
+#define THREAD_CACHE_BYTES 1048576
+#define THREAD_CACHE_BATCH 8
+
+/* # of memhandles a thread reserves at a time */
+#define THREAD_HANDLES 32
+
 /* signatures for guard words */
 #define GUARD1 (Guard)0xaaaaaaaa /* start signature */
 #define GUARD2 (Guard)0x55555555 /* stop signature */
@@ -134,9 +169,34 @@ typedef struct _AD
     Pointer     client_space;      /* start of client space */
     ulongi      nbytes;            /* total # of bytes */
     struct _AD *next;              /* AD in linked list */
+    struct _AD *prev;              /* AD in doubly linked list */
+    ulongi      prevbytes;         /* # of bytes in block to the left */
+    int         state;             /* BlockState of this block */
     ulongi      checksum;          /* of AD */
 } AD;
 
+/* block states, used by the size-class heap */
+typedef enum
+{
+    BS_Free,
+    BS_Heap,
+    BS_Stack,
+    BS_Cached
+} BlockState;
+
+/* per-thread state for thread-aware MA */
+typedef struct _MAThread
+{
+    AD         *region;            /* heap block holding the stack */
+    Pointer     base;              /* low end of the stack region */
+    Pointer     sp;                /* stack pointer */
+    AD         *sused;             /* used list for stack */
+    AD         *cache[BIN_FL][BIN_SL]; /* cached heap blocks by size class */
+    ulongi      cached;            /* # of bytes in cache */
+    Integer     handles[2 * THREAD_HANDLES]; /* reserved memhandles */
+    int         nhandles;          /* # of reserved memhandles */
+} MAThread;
+
 /* block location for mh2ad */
 typedef enum
 {
@@ -158,16 +218,36 @@ private Boolean ad_lt(AD *ad, Pointer ad_target);
 private void ad_print(AD *ad, char *block_type);
 private void balloc_after(AR *ar, Pointer address, Pointer *client_space, ulongi *nbytes);
 private void balloc_before(AR *ar, Pointer address, Pointer *client_space, ulongi *nbytes);
+private AD *bin_allocate(AR *ar, Boolean exhaustive);
+private void bin_index(ulongi nbytes, int *fl, int *sl);
+private void bin_insert(AD *ad);
+private int bin_lsb(ulongi x);
+private int bin_msb(ulongi x);
+private void bin_remove(AD *ad);
+private ulongi bin_round(ulongi nbytes);
+private AD *bin_search(ulongi nbytes);
+private AD *bin_used_list();
+private ulongi bin_worst(AR *ar);
+private void block_free_bins(AD *ad);
 private void block_free_heap(AD *ad);
 private AD *block_split(AD *ad, ulongi bytes_needed, Boolean insert_free);
+private void cache_flush(MAThread *t);
+private AD *cache_get(MAThread *t, AR *ar);
+private Boolean cache_put(MAThread *t, AD *ad);
+private Boolean cache_refill(MAThread *t, int fl, int sl);
 private ulongi checksum(AD *ad);
 
 #ifdef DEBUG
 private void debug_ad_print(AD *ad);
 #endif /* DEBUG */
 
+private void dlist_delete(AD *ad, AD **list);
+private void dlist_insert(AD *ad, AD **list);
 private Boolean guard_check(AD *ad);
 private void guard_set(AD *ad);
+private Integer handle_allocate(MAThread *t, AD *ad);
+private void handle_free(MAThread *t, Integer memhandle);
+private AD *heap_allocate(AR *ar);
 private void list_coalesce(AD *list);
 private AD *list_delete(AD *ad, AD **list);
 private int list_delete_many(AD **list, Boolean (*pred)(), Pointer closure, void (*action)());
@@ -177,13 +257,21 @@ private void list_insert_ordered(AD *ad, AD **list, Boolean (*pred)());
 private Boolean list_member(AD *ad, AD *list);
 private int list_print(AD *list, char *block_type, int index_base);
 private void list_verify(AD *list, char *block_type, char *preamble, int *blocks, int *bad_blocks, int *bad_checksums, int *bad_lguards, int *bad_rguards);
+private Integer ma_frag_nelem(AD *ad, Integer datatype, ulongi min_bytes);
 private Integer ma_max_heap_frag_nelem(Integer datatype, Integer min_nelem);
 private Integer ma_nelem(Pointer address, ulongi length, Integer datatype);
 private void ma_preinitialize(char *caller);
+private MAThread *ma_stack_select(Pointer **sp, AD ***sused);
+#if HAVE_PTHREAD_H
+private void ma_thread_exit(void *arg);
+private MAThread *ma_thread_self();
+#endif
 private Boolean mh2ad(Integer memhandle, AD **adout, BlockLocation location, char *caller);
 private void mh_free(AD *ad);
 private size_t mai_round(size_t value, ulongi unit);
 private void str_ncopy(char *to, char *from, int maxchars);
+private Boolean thread_stack_init(MAThread *t);
+private Integer thread_stack_nelem(MAThread *t, Integer datatype);
 
 /* foreign routines */
 
@@ -290,6 +378,11 @@ private AD *ma_hfree;         /* free list for heap */
 private AD *ma_hused;         /* used list for heap */
 private AD *ma_sused;         /* used list for stack */
 
+private AD *ma_hlast;         /* rightmost heap block (size-class heap) */
+private AD *ma_hbin[BIN_FL][BIN_SL]; /* free lists by size class */
+private ulongi ma_hbin_fl;    /* bit i set iff a list in ma_hbin[i] is nonempty */
+private unsigned int ma_hbin_sl[BIN_FL]; /* bit j set iff ma_hbin[i][j] nonempty */
+
 /* toggled when ma_preinitialize succeeds */
 private Boolean ma_preinitialized = MA_FALSE;
 
@@ -302,6 +395,24 @@ private Boolean ma_auto_verify = MA_FALSE;
 /* print push/pop/alloc/free? */
 private Boolean ma_trace = MA_FALSE;
 
+/* manage the heap with size classes instead of one address-ordered list? */
+private Boolean ma_heap_bins = MA_FALSE;
+
+/* verify checksum and guards of each block passed to MA? */
+private Boolean ma_guard_check = MA_TRUE;
+
+/* toggled when MA_init_threads succeeds */
+private Boolean ma_threads = MA_FALSE;
+
+#if HAVE_PTHREAD_H
+private pthread_mutex_t ma_mutex = PTHREAD_MUTEX_INITIALIZER; /* shared heap and stack */
+private pthread_key_t ma_thread_key;  /* MAThread of each thread */
+private pthread_t ma_main_thread;     /* thread that uses the shared stack */
+#endif
+
+/* # of bytes in the stack region of each thread */
+private ulongi ma_thread_stack = 0;
+
 /* base arrays for the C datatypes */
 public char                 ma_cb_char[2];    /* MT_C_CHAR */
 public int                  ma_cb_int[2];     /* MT_C_INT */
@@ -343,6 +454,18 @@ private Integer ma_numalign = 0;
 #endif
 #define max(a, b) (((b) > (a)) ? (b) : (a))
 
+/* serialize access to the shared heap and stack */
+#if HAVE_PTHREAD_H
+#define ma_lock() \
+    do { if (ma_threads) pthread_mutex_lock(&ma_mutex); } while (0)
+#define ma_unlock() \
+    do { if (ma_threads) pthread_mutex_unlock(&ma_mutex); } while (0)
+#else
+#define ma_lock()
+#define ma_unlock()
+#define ma_thread_self() ((MAThread *)NULL)
+#endif
+
 /* proper word ending corresponding to n */
 #define plural(n) (((n) == 1) ? "" : "s")
 
@@ -411,6 +534,7 @@ typedef enum
     FID_MA_init,
     FID_MA_initialized,
     FID_MA_init_memhandle_iterator,
+    FID_MA_init_threads,
     FID_MA_inquire_avail,
     FID_MA_inquire_heap,
     FID_MA_inquire_heap_check_stack,
@@ -424,7 +548,9 @@ typedef enum
     FID_MA_push_stack,
     FID_MA_set_auto_verify,
     FID_MA_set_error_print,
+    FID_MA_set_guard_check,
     FID_MA_set_hard_fail,
+    FID_MA_set_heap_bins,
     FID_MA_set_numalign,
     FID_MA_sizeof,
     FID_MA_sizeof_overhead,
@@ -463,6 +589,7 @@ private char *ma_routines[] =
     "MA_init",
     "MA_initialized",
     "MA_init_memhandle_iterator",
+    "MA_init_threads",
     "MA_inquire_avail",
     "MA_inquire_heap",
     "MA_inquire_heap_check_stack",
@@ -476,7 +603,9 @@ private char *ma_routines[] =
     "MA_push_stack",
     "MA_set_auto_verify",
     "MA_set_error_print",
+    "MA_set_guard_check",
     "MA_set_hard_fail",
+    "MA_set_heap_bins",
     "MA_set_numalign",
     "MA_sizeof",
     "MA_sizeof_overhead",
@@ -836,7 +965,338 @@ private void balloc_before(ar, address, client_space, nbytes)
 
 /* ------------------------------------------------------------------------- */
 /*
- * Reclaim the given block by updating ma_hp and ma_hfree.
+ * Remove from the size-class heap and return a free block suitable for ar,
+ * with its client_space set and any excess split off and reclaimed, or
+ * return NULL if no such block is found.
+ *
+ * The normal search only considers size classes whose every block is big
+ * enough for the worst-case length of ar, and is independent of the
+ * number of free blocks.  If exhaustive is MA_TRUE, every free block is
+ * tried instead; this is used as a last resort before failing.
+ */
+/* ------------------------------------------------------------------------- */
+
+private AD *bin_allocate(ar, exhaustive)
+    AR        *ar;        /* allocation request */
+    Boolean    exhaustive;    /* try every free block? */
+{
+    AD        *ad;        /* block found */
+    AD        *ad2;        /* remainder of ad */
+    Pointer    client_space;    /* location of client_space */
+    ulongi    nbytes;        /* length of block for ar */
+    int        fl;        /* first-level class index */
+    int        sl;        /* second-level class index */
+
+    ad = (AD *)NULL;
+
+    if (exhaustive)
+    {
+        for (fl = 0; (fl < BIN_FL) && !ad; fl++)
+            for (sl = 0; (sl < BIN_SL) && !ad; sl++)
+                for (ad2 = ma_hbin[fl][sl]; ad2; ad2 = ad2->next)
+                {
+                    balloc_after(ar, (Pointer)ad2, &client_space, &nbytes);
+                    if (nbytes <= ad2->nbytes)
+                    {
+                        ad = ad2;
+                        bin_remove(ad);
+                        break;
+                    }
+                }
+    }
+    else
+    {
+        ad = bin_search(bin_worst(ar));
+    }
+
+    if (ad == (AD *)NULL)
+        return (AD *)NULL;
+
+    /* place ar in ad and give back what is left over */
+    balloc_after(ar, (Pointer)ad, &client_space, &nbytes);
+    ad->client_space = client_space;
+    ad->state = BS_Heap;
+    if ((ad2 = block_split(ad, nbytes, MA_FALSE)) != (AD *)NULL)
+        block_free_bins(ad2);
+
+    return ad;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Compute the size class of a block of nbytes bytes.
+ */
+/* ------------------------------------------------------------------------- */
+
+private void bin_index(nbytes, fl, sl)
+    ulongi    nbytes;        /* length of block */
+    int        *fl;        /* RETURN: first-level index */
+    int        *sl;        /* RETURN: second-level index */
+{
+    *fl = bin_msb(nbytes);
+    if (*fl < BIN_SL_LOG)
+        *sl = 0;
+    else
+        *sl = (int)((nbytes >> (*fl - BIN_SL_LOG)) & (BIN_SL - 1));
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Insert free block ad in the list of its size class.
+ */
+/* ------------------------------------------------------------------------- */
+
+private void bin_insert(ad)
+    AD        *ad;        /* the AD to insert */
+{
+    int        fl;        /* first-level index */
+    int        sl;        /* second-level index */
+
+    bin_index(ad->nbytes, &fl, &sl);
+    dlist_insert(ad, &ma_hbin[fl][sl]);
+    ma_hbin_fl |= ((ulongi)1 << fl);
+    ma_hbin_sl[fl] |= (1U << sl);
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Return the index of the lowest set bit of x, which must be nonzero.
+ */
+/* ------------------------------------------------------------------------- */
+
+private int bin_lsb(x)
+    ulongi    x;        /* to search */
+{
+#if defined(__GNUC__)
+    return __builtin_ctzl((unsigned long)x);
+#else
+    int        i;        /* result */
+
+    for (i = 0; !(x & 1); i++)
+        x >>= 1;
+    return i;
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Return the index of the highest set bit of x, which must be nonzero.
+ */
+/* ------------------------------------------------------------------------- */
+
+private int bin_msb(x)
+    ulongi    x;        /* to search */
+{
+#if defined(__GNUC__)
+    return BIN_FL - 1 - __builtin_clzl((unsigned long)x);
+#else
+    int        i;        /* result */
+
+    for (i = 0; x >>= 1; i++)
+        ;
+    return i;
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Remove free block ad from the list of its size class.
+ */
+/* ------------------------------------------------------------------------- */
+
+private void bin_remove(ad)
+    AD        *ad;        /* the AD to remove */
+{
+    int        fl;        /* first-level index */
+    int        sl;        /* second-level index */
+
+    bin_index(ad->nbytes, &fl, &sl);
+    dlist_delete(ad, &ma_hbin[fl][sl]);
+    if (ma_hbin[fl][sl] == (AD *)NULL)
+    {
+        ma_hbin_sl[fl] &= ~(1U << sl);
+        if (ma_hbin_sl[fl] == 0)
+            ma_hbin_fl &= ~((ulongi)1 << fl);
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Return nbytes rounded up to the next size class boundary, so that every
+ * block in the class of the result is at least nbytes long, or 0 if no
+ * block can be that long.
+ */
+/* ------------------------------------------------------------------------- */
+
+private ulongi bin_round(nbytes)
+    ulongi    nbytes;        /* to round */
+{
+    ulongi    rounded;    /* result */
+    int        fl;        /* first-level index of nbytes */
+
+    fl = bin_msb(nbytes);
+    rounded = nbytes;
+    if (fl >= BIN_SL_LOG)
+        rounded += ((ulongi)1 << (fl - BIN_SL_LOG)) - 1;
+
+    return (rounded < nbytes) ? (ulongi)0 : rounded;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Remove and return a free block of at least nbytes bytes from the
+ * size-class heap, or return NULL if there is none in the classes searched.
+ *
+ * nbytes is first rounded up to the next class boundary (see bin_round);
+ * the search is then two bitmap scans.
+ */
+/* ------------------------------------------------------------------------- */
+
+private AD *bin_search(nbytes)
+    ulongi    nbytes;        /* # of bytes needed */
+{
+    AD        *ad;        /* result */
+    ulongi    rounded;    /* nbytes rounded to class boundary */
+    ulongi    fl_map;        /* candidate first-level classes */
+    unsigned int sl_map;    /* candidate second-level classes */
+    int        fl;        /* first-level index */
+    int        sl;        /* second-level index */
+
+    if ((rounded = bin_round(nbytes)) == 0)
+        /* no block can be this big */
+        return (AD *)NULL;
+    bin_index(rounded, &fl, &sl);
+
+    sl_map = ma_hbin_sl[fl] & (~0U << sl);
+    if (sl_map == 0)
+    {
+        /* nothing in this power of two; take the next nonempty one */
+        fl_map = (fl + 1 < BIN_FL) ? (ma_hbin_fl & (~(ulongi)0 << (fl + 1))) : 0;
+        if (fl_map == 0)
+            return (AD *)NULL;
+        fl = bin_lsb(fl_map);
+        sl_map = ma_hbin_sl[fl];
+    }
+    sl = bin_lsb((ulongi)sl_map);
+
+    ad = ma_hbin[fl][sl];
+    bin_remove(ad);
+    return ad;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Link the blocks of the size-class heap that are in use by the client
+ * through their next fields, in order of address, and return the first.
+ * The heap is walked using block lengths, so the result is only reliable
+ * while no other thread is using MA.
+ */
+/* ------------------------------------------------------------------------- */
+
+private AD *bin_used_list()
+{
+    AD        *ad;        /* traversal pointer */
+    AD        *list;        /* result */
+    AD        **tail;        /* end of result */
+
+    list = (AD *)NULL;
+    tail = &list;
+    for (ad = (AD *)ma_segment; (Pointer)ad < ma_hp;
+         ad = (AD *)((Pointer)ad + ad->nbytes))
+    {
+        if (ad->state == BS_Heap)
+        {
+            *tail = ad;
+            tail = &ad->next;
+        }
+    }
+    *tail = (AD *)NULL;
+
+    return list;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Return the longest block that ar can require, whatever its address.
+ */
+/* ------------------------------------------------------------------------- */
+
+private ulongi bin_worst(ar)
+    AR        *ar;        /* allocation request */
+{
+    ulongi    worst;        /* result */
+
+    worst = (ar->nelem * ma_sizeof[ar->datatype])
+        + max_block_overhead(ar->datatype);
+    if (ma_numalign > 0)
+        worst += ((ulongi)1 << ma_numalign);
+
+    return worst;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Reclaim the given block of the size-class heap by coalescing it with
+ * any free neighbors, then either returning it to the unused space (if
+ * it ends at ma_hp) or inserting it in its size class.
+ *
+ * The caller holds the lock.  A neighbor may belong to another thread,
+ * which can switch it between BS_Heap and BS_Cached without the lock;
+ * only transitions to and from BS_Free are made under the lock, so the
+ * tests below are unaffected.
+ */
+/* ------------------------------------------------------------------------- */
+
+private void block_free_bins(ad)
+    AD        *ad;        /* AD to free */
+{
+    AD        *ad2;        /* neighbor of ad */
+
+    ad->state = BS_Free;
+
+    /* merge the right neighbor into ad */
+    ad2 = (AD *)((Pointer)ad + ad->nbytes);
+    if (((Pointer)ad2 < ma_hp) && (ad2->state == BS_Free))
+    {
+        bin_remove(ad2);
+        ad->nbytes += ad2->nbytes;
+    }
+
+    /* merge ad into the left neighbor */
+    if (ad->prevbytes > 0)
+    {
+        ad2 = (AD *)((Pointer)ad - ad->prevbytes);
+        if (ad2->state == BS_Free)
+        {
+            bin_remove(ad2);
+            ad2->nbytes += ad->nbytes;
+            ad = ad2;
+        }
+    }
+
+    if (((Pointer)ad + ad->nbytes) == ma_hp)
+    {
+        /* ad is rightmost; shrink the heap region */
+        ma_hp = (Pointer)ad;
+        if (ad->prevbytes > 0)
+            ma_hlast = (AD *)((Pointer)ad - ad->prevbytes);
+        else
+            ma_hlast = (AD *)NULL;
+    }
+    else
+    {
+        /* update the boundary tag of the right neighbor */
+        ad2 = (AD *)((Pointer)ad + ad->nbytes);
+        ad2->prevbytes = ad->nbytes;
+
+        bin_insert(ad);
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Reclaim the given block by updating ma_hp and ma_hfree (or the size
+ * classes).
  */
 /* ------------------------------------------------------------------------- */
 
@@ -846,6 +1306,12 @@ private void block_free_heap(ad)
     AD        *ad2;        /* traversal pointer */
     AD        *max_ad;    /* rightmost AD */
 
+    if (ma_heap_bins)
+    {
+        block_free_bins(ad);
+        return;
+    }
+
     /* find rightmost heap block */
     for (max_ad = (AD *)NULL, ad2 = ma_hused; ad2; ad2 = ad2->next)
     {
@@ -915,6 +1381,15 @@ private AD *block_split(ad, bytes_needed, insert_free)
         /* set the length of ad2 */
         ad2->nbytes = bytes_extra;
 
+        if (ma_heap_bins)
+        {
+            /* set the boundary tags; caller reclaims ad2 */
+            ad2->prevbytes = bytes_needed;
+            ad2->state = BS_Heap;
+            if (ad == ma_hlast)
+                ma_hlast = ad2;
+        }
+
         if (insert_free)
         {
             /* insert ad2 into free list */
@@ -941,6 +1416,157 @@ private AD *block_split(ad, bytes_needed, insert_free)
     }
 }
 
+/* ------------------------------------------------------------------------- */
+/*
+ * Return every block in the heap cache of t to the size-class heap.
+ */
+/* ------------------------------------------------------------------------- */
+
+private void cache_flush(t)
+    MAThread    *t;        /* thread whose cache to flush */
+{
+    AD        *ad;        /* block to return */
+    int        fl;        /* first-level index */
+    int        sl;        /* second-level index */
+
+    ma_lock();
+    for (fl = 0; fl < BIN_FL; fl++)
+    {
+        for (sl = 0; sl < BIN_SL; sl++)
+        {
+            while ((ad = t->cache[fl][sl]) != (AD *)NULL)
+            {
+                t->cache[fl][sl] = ad->next;
+                block_free_bins(ad);
+            }
+        }
+    }
+    ma_unlock();
+
+    t->cached = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Remove from the heap cache of t and return a block suitable for ar,
+ * with its client_space set, refilling the cache from the size-class
+ * heap if necessary, or return NULL if ar is too big to be cached or
+ * no block is available.
+ */
+/* ------------------------------------------------------------------------- */
+
+private AD *cache_get(t, ar)
+    MAThread    *t;        /* thread whose cache to use */
+    AR        *ar;        /* allocation request */
+{
+    AD        *ad;        /* result */
+    Pointer    client_space;    /* location of client_space */
+    ulongi    nbytes;        /* length of block for ar */
+    ulongi    rounded;    /* worst case rounded to class boundary */
+    int        fl;        /* first-level index */
+    int        sl;        /* second-level index */
+
+    rounded = bin_round(bin_worst(ar));
+    if ((rounded == 0) || (rounded > THREAD_CACHE_BLOCK))
+        return (AD *)NULL;
+
+    /* every block cached in the class of rounded is big enough */
+    bin_index(rounded, &fl, &sl);
+    if ((t->cache[fl][sl] == (AD *)NULL) && !cache_refill(t, fl, sl))
+        return (AD *)NULL;
+
+    ad = t->cache[fl][sl];
+    t->cache[fl][sl] = ad->next;
+    t->cached -= ad->nbytes;
+
+    balloc_after(ar, (Pointer)ad, &client_space, &nbytes);
+    ad->client_space = client_space;
+
+    return ad;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Insert the given heap block in the heap cache of t, unless it is too
+ * big or the cache is full.
+ *
+ * Return MA_TRUE if the block was cached, else MA_FALSE.
+ */
+/* ------------------------------------------------------------------------- */
+
+private Boolean cache_put(t, ad)
+    MAThread    *t;        /* thread whose cache to use */
+    AD        *ad;        /* block to cache */
+{
+    int        fl;        /* first-level index */
+    int        sl;        /* second-level index */
+
+    if ((ad->nbytes > THREAD_CACHE_BLOCK)
+        || (t->cached + ad->nbytes > THREAD_CACHE_BYTES))
+        return MA_FALSE;
+
+    ad->state = BS_Cached;
+    bin_index(ad->nbytes, &fl, &sl);
+    ad->next = t->cache[fl][sl];
+    t->cache[fl][sl] = ad;
+    t->cached += ad->nbytes;
+
+    return MA_TRUE;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Move up to THREAD_CACHE_BATCH blocks, each at least as long as the
+ * smallest block of the given size class, from the size-class heap (or
+ * the unused space above it) to the heap cache of t.
+ *
+ * Return MA_TRUE if any block was moved, else MA_FALSE.
+ */
+/* ------------------------------------------------------------------------- */
+
+private Boolean cache_refill(t, fl, sl)
+    MAThread    *t;        /* thread whose cache to refill */
+    int        fl;        /* first-level index */
+    int        sl;        /* second-level index */
+{
+    AD        *ad;        /* block to cache */
+    AD        *ad2;        /* excess of ad */
+    ulongi    nbytes;        /* length of each block */
+    int        i;        /* counter */
+
+    nbytes = mai_round((size_t)(((ulongi)1 << fl)
+        + ((ulongi)sl << (fl - BIN_SL_LOG))), (ulongi)ALIGNMENT);
+
+    ma_lock();
+    for (i = 0; i < THREAD_CACHE_BATCH; i++)
+    {
+        if ((ad = bin_search(nbytes)) != (AD *)NULL)
+        {
+            ad->state = BS_Cached;
+            if ((ad2 = block_split(ad, nbytes, MA_FALSE)) != (AD *)NULL)
+                block_free_bins(ad2);
+        }
+        else if ((ulongi)(ma_sp - ma_hp) >= nbytes)
+        {
+            ad = (AD *)ma_hp;
+            ad->nbytes = nbytes;
+            ad->prevbytes = ma_hlast ? ma_hlast->nbytes : 0;
+            ad->state = BS_Cached;
+            ma_hlast = ad;
+            ma_hp += nbytes;
+        }
+        else
+            break;
+
+        ad->next = t->cache[fl][sl];
+        t->cache[fl][sl] = ad;
+        t->cached += ad->nbytes;
+    }
+    ma_unlock();
+
+    return (i > 0) ? MA_TRUE : MA_FALSE;
+}
+
 /* ------------------------------------------------------------------------- */
 /*
  * Compute and return a checksum for ad.  Include all fields except name,
@@ -969,7 +1595,7 @@ private ulongi checksum(ad)
 private void debug_ad_print(ad)
     AD        *ad;        /* the AD to print */
 {
-#define NUMADFIELDS 7
+#define NUMADFIELDS 10
 
     char    *fn[NUMADFIELDS];    /* field names */
     size_t    fa[NUMADFIELDS];    /* field addresses */
@@ -983,7 +1609,10 @@ private void debug_ad_print(ad)
     fn[3] = "client_space";
     fn[4] = "nbytes";
     fn[5] = "next";
-    fn[6] = "checksum";
+    fn[6] = "prev";
+    fn[7] = "prevbytes";
+    fn[8] = "state";
+    fn[9] = "checksum";
 
     /* set field addresses */
     fa[0] = (size_t)(&(ad->datatype));
@@ -992,7 +1621,10 @@ private void debug_ad_print(ad)
     fa[3] = (size_t)(&(ad->client_space));
     fa[4] = (size_t)(&(ad->nbytes));
     fa[5] = (size_t)(&(ad->next));
-    fa[6] = (size_t)(&(ad->checksum));
+    fa[6] = (size_t)(&(ad->prev));
+    fa[7] = (size_t)(&(ad->prevbytes));
+    fa[8] = (size_t)(&(ad->state));
+    fa[9] = (size_t)(&(ad->checksum));
 
     /* print AD fields to stderr */
     (void)fprintf(stderr, "debug_ad_print:\n");
@@ -1029,6 +1661,42 @@ private void debug_ad_print(ad)
 
 #endif /* DEBUG */
 
+/* ------------------------------------------------------------------------- */
+/*
+ * Delete ad from doubly linked list, of which it must be a member.
+ */
+/* ------------------------------------------------------------------------- */
+
+private void dlist_delete(ad, list)
+    AD        *ad;        /* the AD to delete */
+    AD        **list;        /* the list to delete from */
+{
+    if (ad->prev)
+        ad->prev->next = ad->next;
+    else
+        *list = ad->next;
+    if (ad->next)
+        ad->next->prev = ad->prev;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Insert ad into doubly linked list.
+ */
+/* ------------------------------------------------------------------------- */
+
+private void dlist_insert(ad, list)
+    AD        *ad;        /* the AD to insert */
+    AD        **list;        /* the list to insert into */
+{
+    /* push ad onto list */
+    ad->prev = (AD *)NULL;
+    ad->next = *list;
+    if (*list)
+        (*list)->prev = ad;
+    *list = ad;
+}
+
 /* ------------------------------------------------------------------------- */
 /*
  * Return MA_TRUE if the guards associated with ad contain valid signatures,
@@ -1077,6 +1745,128 @@ private void guard_set(ad)
     guard_write(guard, &signature);
 }
 
+/* ------------------------------------------------------------------------- */
+/*
+ * Return a memhandle for the given AD, taken from the handles reserved
+ * by t, or from the table itself if t is NULL.
+ */
+/* ------------------------------------------------------------------------- */
+
+private Integer handle_allocate(t, ad)
+    MAThread    *t;        /* calling thread */
+    AD        *ad;        /* AD to associate with the handle */
+{
+    Integer    memhandle;    /* result */
+
+    if (t == (MAThread *)NULL)
+        return ma_table_allocate((TableData)ad);
+
+    if (t->nhandles == 0)
+        t->nhandles = ma_table_reserve(t->handles, THREAD_HANDLES);
+    if (t->nhandles == 0)
+        return TABLE_HANDLE_NONE;
+
+    memhandle = t->handles[--t->nhandles];
+    ma_table_assign(memhandle, (TableData)ad);
+
+    return memhandle;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Free the given memhandle, keeping it reserved for t if t is non-NULL.
+ */
+/* ------------------------------------------------------------------------- */
+
+private void handle_free(t, memhandle)
+    MAThread    *t;        /* calling thread */
+    Integer    memhandle;    /* to free */
+{
+    if (t == (MAThread *)NULL)
+    {
+        ma_table_deallocate(memhandle);
+        return;
+    }
+
+    if (!ma_table_unassign(memhandle))
+        return;
+
+    t->handles[t->nhandles++] = memhandle;
+    if (t->nhandles == 2 * THREAD_HANDLES)
+    {
+        /* give half of them back */
+        t->nhandles -= THREAD_HANDLES;
+        ma_table_release(t->handles + t->nhandles, THREAD_HANDLES);
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Allocate a heap block for ar from the free list (or the size classes)
+ * or by expanding the heap region, and return it with its client_space
+ * and nbytes set, or return NULL if there is not enough space.  The
+ * caller holds the lock.
+ */
+/* ------------------------------------------------------------------------- */
+
+private AD *heap_allocate(ar)
+    AR        *ar;        /* allocation request */
+{
+    AD        *ad;        /* result */
+    Pointer    client_space;    /* location of client_space */
+    ulongi    nbytes;        /* length of block for ar */
+    Pointer    new_hp;        /* new ma_hp */
+
+    /* search the free list */
+    if (ma_heap_bins)
+        ad = bin_allocate(ar, MA_FALSE);
+    else
+        ad = list_delete_one(&ma_hfree, ad_big_enough, (Pointer)ar);
+
+    /* if search of free list failed, try expanding heap region */
+    if (ad == (AD *)NULL)
+    {
+        /* perform trial allocation to determine size */
+        balloc_after(ar, ma_hp, &client_space, &nbytes);
+
+        new_hp = ma_hp + nbytes;
+        if (new_hp > ma_sp)
+        {
+            /* size classes are searched conservatively; try every block */
+            if (ma_heap_bins)
+                ad = bin_allocate(ar, MA_TRUE);
+
+            if (ad == (AD *)NULL)
+                return (AD *)NULL;
+        }
+        else
+        {
+            /* heap region expanded successfully */
+            ad = (AD *)ma_hp;
+
+            /* set fields appropriately */
+            ad->client_space = client_space;
+            ad->nbytes = nbytes;
+
+            if (ma_heap_bins)
+            {
+                /* set the boundary tag */
+                ad->prevbytes = ma_hlast ? ma_hlast->nbytes : 0;
+                ma_hlast = ad;
+            }
+        }
+    }
+
+    /* update ma_hp if necessary */
+    new_hp = (Pointer)ad + ad->nbytes;
+    if (new_hp > ma_hp)
+    {
+        ma_hp = new_hp;
+    }
+
+    return ad;
+}
+
 /* ------------------------------------------------------------------------- */
 /*
  * Coalesce list by merging any adjacent elements that are contiguous.
@@ -1454,10 +2244,55 @@ private void list_verify(list, block_type, preamble, blocks,
             bad_block = MA_TRUE;
         }
 
-        /* if any errors, bump bad block count */
-        if (bad_block)
-            (*bad_blocks)++;
+        /* if any errors, bump bad block count */
+        if (bad_block)
+            (*bad_blocks)++;
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Return the maximum number of datatype elements that can currently be
+ * accomodated in heap fragment ad entirely within the heap region, or 0
+ * if the usable part of ad is shorter than min_bytes.
+ */
+/* ------------------------------------------------------------------------- */
+
+private Integer ma_frag_nelem(ad, datatype, min_bytes)
+    AD        *ad;        /* fragment to consider */
+    Integer    datatype;    /* of elements */
+    ulongi    min_bytes;    /* for fragment to be considered */
+{
+    ulongi    nbytes;        /* in fragment */
+
+    /*
+     * There are 3 cases to consider:
+     *
+     * (a) fragment is outside heap region
+     * (b) fragment straddles partition between heap and stack regions
+     * (c) fragment is inside heap region
+     */
+
+    if ((Pointer)ad >= ma_partition)
+    {
+        /* case (a): reject */
+        return (Integer)0;
+    }
+    else if (((Pointer)ad + ad->nbytes) >= ma_partition)
+    {
+        /* case (b): truncate fragment at partition */
+        nbytes = (ulongi)(ma_partition - (Pointer)ad);
     }
+    else
+    {
+        /* case (c): accept */
+        nbytes = ad->nbytes;
+    }
+
+    if (nbytes >= min_bytes)
+        return ma_nelem((Pointer)ad, nbytes, datatype);
+    else
+        return (Integer)0;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -1474,44 +2309,32 @@ private Integer ma_max_heap_frag_nelem(datatype, min_nelem)
 {
     ulongi    min_bytes;    /* for fragment to be considered */
     AD        *ad;        /* traversal pointer */
-    ulongi    nbytes;        /* in current fragment */
     Integer    nelem;        /* in current fragment */
     Integer    max_nelem;    /* result */
+    int        fl;        /* first-level class index */
+    int        sl;        /* second-level class index */
 
     /* set the threshold */
     min_bytes = (min_nelem * ma_sizeof[datatype]) + BLOCK_OVERHEAD_FIXED;
 
-    /* search the heap free list */
     max_nelem = 0;
-    for (ad = ma_hfree; ad; ad = ad->next)
+    if (ma_heap_bins)
     {
-        /*
-         * There are 3 cases to consider:
-         *
-         * (a) fragment is outside heap region
-         * (b) fragment straddles partition between heap and stack regions
-         * (c) fragment is inside heap region
-         */
-
-        if ((Pointer)ad >= ma_partition)
-        {
-            /* case (a): reject */
-            continue;
-        }
-        else if (((Pointer)ad + ad->nbytes) >= ma_partition)
-        {
-            /* case (b): truncate fragment at partition */
-            nbytes = (ulongi)(ma_partition - (Pointer)ad);
-        }
-        else
-        {
-            /* case (c): accept */
-            nbytes = ad->nbytes;
-        }
-
-        if (nbytes >= min_bytes)
+        /* search the size classes */
+        for (fl = 0; fl < BIN_FL; fl++)
+            for (sl = 0; sl < BIN_SL; sl++)
+                for (ad = ma_hbin[fl][sl]; ad; ad = ad->next)
+                {
+                    nelem = ma_frag_nelem(ad, datatype, min_bytes);
+                    max_nelem = max(max_nelem, nelem);
+                }
+    }
+    else
+    {
+        /* search the heap free list */
+        for (ad = ma_hfree; ad; ad = ad->next)
         {
-            nelem = ma_nelem((Pointer)ad, nbytes, datatype);
+            nelem = ma_frag_nelem(ad, datatype, min_bytes);
             max_nelem = max(max_nelem, nelem);
         }
     }
@@ -1588,6 +2411,110 @@ private void ma_preinitialize(caller)
     ma_preinitialized = MA_TRUE;
 }
 
+/* ------------------------------------------------------------------------- */
+/*
+ * Point *sp and *sused at the stack pointer and used list of the stack
+ * of the calling thread, and return its MAThread, or NULL if it uses the
+ * shared stack.
+ */
+/* ------------------------------------------------------------------------- */
+
+private MAThread *ma_stack_select(sp, sused)
+    Pointer    **sp;        /* RETURN: stack pointer */
+    AD        ***sused;    /* RETURN: used list for stack */
+{
+    MAThread    *t;        /* result */
+
+    if ((t = ma_thread_self()) == (MAThread *)NULL)
+    {
+        *sp = &ma_sp;
+        *sused = &ma_sused;
+    }
+    else
+    {
+        *sp = &t->sp;
+        *sused = &t->sused;
+    }
+
+    return t;
+}
+
+#if HAVE_PTHREAD_H
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Release everything held by an exiting thread: its stack blocks and
+ * their memhandles, its stack region, its heap cache, and its reserved
+ * memhandles.  Heap blocks it allocated stay allocated.
+ *
+ * Runs as the destructor of ma_thread_key, when the key no longer maps
+ * to t, so nothing called from here may call ma_thread_self.
+ */
+/* ------------------------------------------------------------------------- */
+
+private void ma_thread_exit(arg)
+    void    *arg;        /* MAThread of the exiting thread */
+{
+    MAThread    *t = (MAThread *)arg;
+    AD        *ad;        /* traversal pointer */
+    Integer    memhandle;    /* for ad */
+
+    for (ad = t->sused; ad; ad = ad->next)
+    {
+        if ((memhandle = ma_table_lookup_assoc((TableData)ad))
+            != TABLE_HANDLE_NONE)
+            ma_table_deallocate(memhandle);
+    }
+
+    if (t->region)
+    {
+        ma_lock();
+        block_free_bins(t->region);
+        ma_unlock();
+    }
+
+    cache_flush(t);
+    ma_table_release(t->handles, t->nhandles);
+
+    free((char *)t);
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Return the MAThread of the calling thread, creating it if necessary,
+ * or NULL if MA is not thread-aware or the caller uses the shared stack.
+ */
+/* ------------------------------------------------------------------------- */
+
+private MAThread *ma_thread_self()
+{
+    MAThread    *t;        /* result */
+
+    if (!ma_threads)
+        return (MAThread *)NULL;
+
+    if ((t = (MAThread *)pthread_getspecific(ma_thread_key)) != (MAThread *)NULL)
+        return t;
+
+    if (pthread_equal(pthread_self(), ma_main_thread))
+        return (MAThread *)NULL;
+
+    if ((t = (MAThread *)bytealloc(sizeof(MAThread))) == (MAThread *)NULL)
+    {
+        (void)sprintf(ma_ebuf,
+            "could not allocate %lu bytes of thread state",
+            (ulongi)sizeof(MAThread));
+        ma_error(EL_Fatal, ET_Internal, "ma_thread_self", ma_ebuf);
+        return (MAThread *)NULL;
+    }
+    (void)memset((char *)t, 0, sizeof(MAThread));
+    (void)pthread_setspecific(ma_thread_key, (void *)t);
+
+    return t;
+}
+
+#endif /* HAVE_PTHREAD_H */
+
 /* ------------------------------------------------------------------------- */
 /*
  * If memhandle is valid according to location, return the corresponding AD
@@ -1603,8 +2530,10 @@ private Boolean mh2ad(memhandle, adout, location, caller)
     char    *caller;    /* name of calling routine */
 {
     AD        *ad;
-    Boolean    check_checksum = MA_TRUE;
-    Boolean    check_guards = MA_TRUE;
+    Pointer    *sp;        /* stack pointer of caller */
+    AD        **sused;    /* used list for stack of caller */
+    Boolean    check_checksum = ma_guard_check;
+    Boolean    check_guards = ma_guard_check;
     Boolean    check_heap = MA_FALSE;
     Boolean    check_stack = MA_FALSE;
     Boolean    check_stacktop = MA_FALSE;
@@ -1674,7 +2603,7 @@ private Boolean mh2ad(memhandle, adout, location, caller)
 
     if (check_heap)
     {
-        if (!list_member(ad, ma_hused))
+        if (ma_heap_bins ? (ad->state != BS_Heap) : !list_member(ad, ma_hused))
         {
             (void)sprintf(ma_ebuf,
                 "memhandle %ld (name: '%s') not in heap",
@@ -1685,7 +2614,8 @@ private Boolean mh2ad(memhandle, adout, location, caller)
     }
     else if (check_stack)
     {
-        if (!list_member(ad, ma_sused))
+        (void)ma_stack_select(&sp, &sused);
+        if (!list_member(ad, *sused))
         {
             (void)sprintf(ma_ebuf,
                 "memhandle %ld (name: '%s') not in stack",
@@ -1697,7 +2627,8 @@ private Boolean mh2ad(memhandle, adout, location, caller)
     else if (check_stacktop)
     {
         /* is it in the stack? */
-        if (!list_member(ad, ma_sused))
+        (void)ma_stack_select(&sp, &sused);
+        if (!list_member(ad, *sused))
         {
             (void)sprintf(ma_ebuf,
                 "memhandle %ld (name: '%s') not in stack",
@@ -1707,7 +2638,7 @@ private Boolean mh2ad(memhandle, adout, location, caller)
         }
 
         /* is it on top of the stack? */
-        if ((Pointer)ad != ma_sp)
+        if ((Pointer)ad != *sp)
         {
             (void)sprintf(ma_ebuf,
                 "memhandle %ld (name: '%s') not top of stack",
@@ -1718,7 +2649,10 @@ private Boolean mh2ad(memhandle, adout, location, caller)
     }
     else if (check_heapandstack)
     {
-        if ((!list_member(ad, ma_hused)) && (!list_member(ad, ma_sused)))
+        /* any thread may access a block on the stack of another */
+        (void)ma_stack_select(&sp, &sused);
+        if ((ma_heap_bins ? (ad->state != BS_Heap) : !list_member(ad, ma_hused))
+            && (ma_threads ? (ad->state != BS_Stack) : !list_member(ad, *sused)))
         {
             (void)sprintf(ma_ebuf,
                 "memhandle %ld (name: '%s') not in heap or stack",
@@ -1754,7 +2688,7 @@ private void mh_free(ad)
     }
     else
         /* free memhandle */
-        ma_table_deallocate(memhandle);
+        handle_free(ma_thread_self(), memhandle);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -1798,6 +2732,68 @@ private void str_ncopy(to, from, maxchars)
     to[maxchars-1] = '\0';
 }
 
+/* ------------------------------------------------------------------------- */
+/*
+ * Carve the stack region of t from the heap.
+ *
+ * Return MA_TRUE upon success, or MA_FALSE upon failure.
+ */
+/* ------------------------------------------------------------------------- */
+
+private Boolean thread_stack_init(t)
+    MAThread    *t;        /* thread whose stack to create */
+{
+    AR        ar;        /* allocation request */
+    AD        *ad;        /* AD for the region */
+
+    ar.datatype = mt_import(MT_CHAR);
+    ar.nelem = (Integer)ma_thread_stack;
+
+    ma_lock();
+    if ((ad = heap_allocate(&ar)) != (AD *)NULL)
+    {
+        ad->datatype = ar.datatype;
+        ad->nelem = ar.nelem;
+        str_ncopy(ad->name, "MA thread stack", MA_NAMESIZE);
+        ad->state = BS_Heap;
+        ad->checksum = checksum(ad);
+        guard_set(ad);
+    }
+    ma_unlock();
+
+    if (ad == (AD *)NULL)
+    {
+        (void)sprintf(ma_ebuf,
+            "not enough space to allocate a thread stack of %lu bytes",
+            ma_thread_stack);
+        ma_error(EL_Nonfatal, ET_External, "thread_stack_init", ma_ebuf);
+        return MA_FALSE;
+    }
+
+    t->region = ad;
+    t->base = ad->client_space;
+    t->sp = ad->client_space + ma_thread_stack;
+
+    return MA_TRUE;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Return the maximum number of datatype elements that can currently
+ * be allocated in the stack of t, in a single allocation request.
+ */
+/* ------------------------------------------------------------------------- */
+
+private Integer thread_stack_nelem(t, datatype)
+    MAThread    *t;        /* thread whose stack to inquire */
+    Integer    datatype;    /* internal datatype */
+{
+    if ((t->region == (AD *)NULL) && !thread_stack_init(t))
+        return (Integer)0;
+
+    return ma_nelem(t->base, (ulongi)(t->sp - t->base), datatype);
+}
+
 /**
  ** public routines for internal use only
  **/
@@ -1894,7 +2890,8 @@ public void MAi_summarize_allocated_blocks(index_base)
     (void)printf("MA_summarize_allocated_blocks: starting scan ...\n");
 
     /* print blocks on the heap used list */
-    heap_blocks = list_print(ma_hused, "heap", index_base);
+    heap_blocks = list_print(ma_heap_bins ? bin_used_list() : ma_hused,
+        "heap", index_base);
 
     /* print blocks on the stack used list */
     stack_blocks = list_print(ma_sused, "stack", index_base);
@@ -1955,7 +2952,7 @@ public Boolean MA_allocate_heap(
     AD        *ad;        /* AD for newly allocated block */
     Pointer    client_space;    /* location of client_space */
     ulongi    nbytes;        /* length of block for ar */
-    Pointer    new_hp;        /* new ma_hp */
+    MAThread    *t;        /* calling thread */
 
 #ifdef STATS
     ma_stats.calls[(int)FID_MA_allocate_heap]++;
@@ -2009,33 +3006,37 @@ public Boolean MA_allocate_heap(
     ar.datatype = datatype;
     ar.nelem = nelem;
 
-    /* search the free list */
-    ad = list_delete_one(&ma_hfree, ad_big_enough, (Pointer)&ar);
+    t = ma_thread_self();
+
+    /* try the heap cache of the calling thread */
+    ad = (t == (MAThread *)NULL) ? (AD *)NULL : cache_get(t, &ar);
 
-    /* if search of free list failed, try expanding heap region */
     if (ad == (AD *)NULL)
     {
-        /* perform trial allocation to determine size */
-        balloc_after(&ar, ma_hp, &client_space, &nbytes);
+        ma_lock();
+        ad = heap_allocate(&ar);
+        ma_unlock();
 
-        new_hp = ma_hp + nbytes;
-        if (new_hp > ma_sp)
+        if ((ad == (AD *)NULL) && (t != (MAThread *)NULL) && (t->cached > 0))
+        {
+            /* the space might be held in the cache; give it back */
+            cache_flush(t);
+            ma_lock();
+            ad = heap_allocate(&ar);
+            ma_unlock();
+        }
+
+        if (ad == (AD *)NULL)
         {
+            /* perform trial allocation to determine size */
+            balloc_after(&ar, ma_hp, &client_space, &nbytes);
+
             (void)sprintf(ma_ebuf,
                 "block '%s', not enough space to allocate %lu bytes",
                 name, nbytes);
             ma_error(EL_Nonfatal, ET_External, "MA_allocate_heap", ma_ebuf);
             return MA_FALSE;
         }
-        else
-        {
-            /* heap region expanded successfully */
-            ad = (AD *)ma_hp;
-
-            /* set fields appropriately */
-            ad->client_space = client_space;
-            ad->nbytes = nbytes;
-        }
     }
 
     /*
@@ -2048,7 +3049,9 @@ public Boolean MA_allocate_heap(
     str_ncopy(ad->name, (char*)name, MA_NAMESIZE);
     /* ad->client_space is already set */
     /* ad->nbytes is already set */
-    list_insert(ad, &ma_hused);
+    ad->state = BS_Heap;
+    if (!ma_heap_bins)
+        list_insert(ad, &ma_hused);
     ad->checksum = checksum(ad);
 
     /* set the guards */
@@ -2058,13 +3061,6 @@ public Boolean MA_allocate_heap(
     debug_ad_print(ad);
 #endif /* DEBUG */
 
-    /* update ma_hp if necessary */
-    new_hp = (Pointer)ad + ad->nbytes;
-    if (new_hp > ma_hp)
-    {
-        ma_hp = new_hp;
-    }
-
 #ifdef STATS
     ma_stats.hblocks++;
     ma_stats.hblocks_max = max(ma_stats.hblocks, ma_stats.hblocks_max);
@@ -2073,7 +3069,7 @@ public Boolean MA_allocate_heap(
 #endif /* STATS */
 
     /* convert AD to memhandle */
-    if ((*memhandle = ma_table_allocate((TableData)ad)) == TABLE_HANDLE_NONE)
+    if ((*memhandle = handle_allocate(t, ad)) == TABLE_HANDLE_NONE)
         /* failure */
         return MA_FALSE;
     else
@@ -2093,6 +3089,9 @@ public Boolean MA_allocate_heap(
 public Boolean MA_chop_stack(Integer memhandle)/*the block to deallocate up to*/
 {
     AD        *ad;        /* AD for memhandle */
+    Pointer    *sp;        /* stack pointer of caller */
+    AD        **sused;    /* used list for stack of caller */
+    MAThread    *t;        /* calling thread */
 
 #ifdef STATS
     ma_stats.calls[(int)FID_MA_chop_stack]++;
@@ -2107,19 +3106,25 @@ public Boolean MA_chop_stack(Integer memhandle)/*the block to deallocate up to*/
     if (!mh2ad(memhandle, &ad, BL_Stack, "MA_chop_stack"))
         return MA_FALSE;
 
+    t = ma_stack_select(&sp, &sused);
+
     /* delete block and all blocks above it from used list */
 #ifdef STATS
     ma_stats.sblocks -=
-        list_delete_many(&ma_sused, ad_le, (Pointer)ad, mh_free);
+        list_delete_many(sused, ad_le, (Pointer)ad, mh_free);
 #else
-    (void)list_delete_many(&ma_sused, ad_le, (Pointer)ad, mh_free);
+    (void)list_delete_many(sused, ad_le, (Pointer)ad, mh_free);
 #endif /* STATS */
 
     /* pop block and all blocks above it from stack */
 #ifdef STATS
-    ma_stats.sbytes -= (((Pointer)ad + ad->nbytes) - ma_sp);
+    ma_stats.sbytes -= (((Pointer)ad + ad->nbytes) - *sp);
 #endif /* STATS */
-    ma_sp = (Pointer)ad + ad->nbytes;
+    if (t == (MAThread *)NULL)
+        ma_lock();
+    *sp = (Pointer)ad + ad->nbytes;
+    if (t == (MAThread *)NULL)
+        ma_unlock();
 
     /* success */
     return MA_TRUE;
@@ -2136,6 +3141,7 @@ public Boolean MA_chop_stack(Integer memhandle)/*the block to deallocate up to*/
 public Boolean MA_free_heap(Integer memhandle) /* the block to deallocate */
 {
     AD        *ad;        /* AD for memhandle */
+    MAThread    *t;        /* calling thread */
 
 #ifdef STATS
     ma_stats.calls[(int)FID_MA_free_heap]++;
@@ -2154,7 +3160,7 @@ public Boolean MA_free_heap(Integer memhandle) /* the block to deallocate */
     (void)printf("MA: freeing '%s'\n", ad->name);
 
     /* delete block from used list */
-    if (list_delete(ad, &ma_hused) != ad)
+    if (!ma_heap_bins && (list_delete(ad, &ma_hused) != ad))
     {
         (void)sprintf(ma_ebuf,
             "memhandle %ld (name: '%s') not on heap used list",
@@ -2169,10 +3175,16 @@ public Boolean MA_free_heap(Integer memhandle) /* the block to deallocate */
 #endif /* STATS */
 
     /* reclaim the deallocated block */
-    block_free_heap(ad);
+    t = ma_thread_self();
+    if ((t == (MAThread *)NULL) || !cache_put(t, ad))
+    {
+        ma_lock();
+        block_free_heap(ad);
+        ma_unlock();
+    }
 
     /* free memhandle */
-    ma_table_deallocate(memhandle);
+    handle_free(t, memhandle);
 
     /* success */
     return MA_TRUE;
@@ -2242,6 +3254,7 @@ public Boolean MA_free_heap_piece(
     if (nbytes < ad->nbytes)
     {
         /* ad has extra space; split block if possible */
+        ma_lock();
         ad_reclaim = block_split(ad, nbytes, (Boolean)MA_FALSE);
 
         if (ad_reclaim)
@@ -2253,6 +3266,7 @@ public Boolean MA_free_heap_piece(
             /* reclaim the deallocated (new) block */
             block_free_heap(ad_reclaim);
         }
+        ma_unlock();
     }
 
     /* update surviving block */
@@ -2564,6 +3578,11 @@ public Boolean MA_init(
     ma_hfree = (AD *)NULL;
     ma_hused = (AD *)NULL;
     ma_sused = (AD *)NULL;
+    ma_hlast = (AD *)NULL;
+
+    /* optionally manage the heap with size classes */
+    if (getenv("MA_USE_HEAP_BINS"))
+        ma_heap_bins = MA_TRUE;
 
     /* we are now initialized */
     ma_initialized = MA_TRUE;
@@ -2614,6 +3633,98 @@ public Boolean MA_init_memhandle_iterator( Integer *ithandle)
     return MA_FALSE;
 }
 
+/* ------------------------------------------------------------------------- */
+/*
+ * Make MA safe to call from several threads.  The calling thread keeps
+ * the shared stack; every other thread gets a stack of nominal_stack
+ * datatype elements, allocated from the heap when it first pushes.
+ * Heap blocks are managed by size class from now on (see
+ * MA_set_heap_bins).  Call this once, after MA_init and before other
+ * threads use MA.  The statistics printed by MA_print_stats are only
+ * approximate once several threads use MA.
+ *
+ * Return MA_TRUE upon success, or MA_FALSE upon failure.
+ */
+/* ------------------------------------------------------------------------- */
+
+public Boolean MA_init_threads(
+    Integer    datatype,    /* for computing storage requirement */
+    Integer    nominal_stack    /* # of datatype elements desired for each stack */)
+{
+#ifdef STATS
+    ma_stats.calls[(int)FID_MA_init_threads]++;
+#endif /* STATS */
+
+    /* verify initialization */
+    if (!ma_initialized)
+    {
+        (void)sprintf(ma_ebuf,
+            "MA not yet initialized");
+        ma_error(EL_Nonfatal, ET_External, "MA_init_threads", ma_ebuf);
+        return MA_FALSE;
+    }
+
+    /* verify datatype */
+    if (!mt_valid(datatype))
+    {
+        (void)sprintf(ma_ebuf,
+            "invalid datatype: %ld",
+            (size_t)datatype);
+        ma_error(EL_Nonfatal, ET_External, "MA_init_threads", ma_ebuf);
+        return MA_FALSE;
+    }
+
+#if HAVE_PTHREAD_H
+    if (ma_threads)
+    {
+        (void)sprintf(ma_ebuf,
+            "MA already thread-aware");
+        ma_error(EL_Nonfatal, ET_External, "MA_init_threads", ma_ebuf);
+        return MA_FALSE;
+    }
+
+    /* the heap caches and concurrent frees need boundary tags */
+    (void)MA_set_heap_bins(MA_TRUE);
+    if (!ma_heap_bins)
+        return MA_FALSE;
+
+    /* convert datatype to internal (index-suitable) value */
+    datatype = mt_import(datatype);
+
+    /* compute # of bytes in each thread stack */
+    if (nominal_stack < 0)
+    {
+        ma_thread_stack = DEFAULT_TOTAL_STACK;
+    }
+    else
+    {
+        ma_thread_stack = (nominal_stack * ma_sizeof[datatype]) +
+            (DEFAULT_REQUESTS_STACK * max_block_overhead(datatype));
+    }
+    ma_thread_stack = (size_t)mai_round((size_t)ma_thread_stack, (ulongi)ALIGNMENT);
+
+    if (pthread_key_create(&ma_thread_key, ma_thread_exit) != 0)
+    {
+        (void)sprintf(ma_ebuf,
+            "could not create thread-specific data key");
+        ma_error(EL_Nonfatal, ET_External, "MA_init_threads", ma_ebuf);
+        return MA_FALSE;
+    }
+    ma_main_thread = pthread_self();
+    ma_table_init_threads();
+
+    ma_threads = MA_TRUE;
+
+    /* success */
+    return MA_TRUE;
+#else
+    (void)sprintf(ma_ebuf,
+        "unavailable; MA was built without pthreads");
+    ma_error(EL_Nonfatal, ET_External, "MA_init_threads", ma_ebuf);
+    return MA_FALSE;
+#endif /* HAVE_PTHREAD_H */
+}
+
 /* ------------------------------------------------------------------------- */
 /*
  * Return the maximum number of datatype elements that can currently
@@ -2904,6 +4015,7 @@ public Integer MA_inquire_stack(Integer datatype)
 {
     size_t    gap_length;    /* # of bytes between partition and stack */
     Integer    nelem_gap;    /* max elements containable in gap */
+    MAThread    *t;        /* calling thread */
 
 #ifdef STATS
     ma_stats.calls[(int)FID_MA_inquire_stack]++;
@@ -2936,6 +4048,10 @@ public Integer MA_inquire_stack(Integer datatype)
     /* convert datatype to internal (index-suitable) value */
     datatype = mt_import(datatype);
 
+    /* other threads have a stack region of their own */
+    if ((t = ma_thread_self()) != (MAThread *)NULL)
+        return thread_stack_nelem(t, datatype);
+
     /*
      * compute the # of elements for which space is available
      */
@@ -2972,6 +4088,7 @@ public Integer MA_inquire_stack_check_heap(Integer datatype)
 {
     size_t    gap_length;    /* # of bytes between partition and stack */
     Integer    nelem_gap;    /* max elements containable in gap */
+    MAThread    *t;        /* calling thread */
 
 #ifdef STATS
     ma_stats.calls[(int)FID_MA_inquire_stack_check_heap]++;
@@ -3004,6 +4121,10 @@ public Integer MA_inquire_stack_check_heap(Integer datatype)
     /* convert datatype to internal (index-suitable) value */
     datatype = mt_import(datatype);
 
+    /* other threads have a stack region of their own */
+    if ((t = ma_thread_self()) != (MAThread *)NULL)
+        return thread_stack_nelem(t, datatype);
+
     /*
      * compute the # of elements for which space is available
      */
@@ -3041,6 +4162,7 @@ public Integer MA_inquire_stack_no_partition(Integer datatype)
 {
     size_t    gap_length;    /* # of bytes between heap and partition */
     Integer    nelem_gap;    /* max elements containable in gap */
+    MAThread    *t;        /* calling thread */
 
 #ifdef STATS
     ma_stats.calls[(int)FID_MA_inquire_stack_no_partition]++;
@@ -3073,6 +4195,10 @@ public Integer MA_inquire_stack_no_partition(Integer datatype)
     /* convert datatype to internal (index-suitable) value */
     datatype = mt_import(datatype);
 
+    /* other threads have a stack region of their own */
+    if ((t = ma_thread_self()) != (MAThread *)NULL)
+        return thread_stack_nelem(t, datatype);
+
     /*
      * compute the # of elements for which space is available
      */
@@ -3101,6 +4227,9 @@ public Integer MA_inquire_stack_no_partition(Integer datatype)
 public Boolean MA_pop_stack(Integer memhandle) /* the block to deallocate */
 {
     AD        *ad;        /* AD for memhandle */
+    Pointer    *sp;        /* stack pointer of caller */
+    AD        **sused;    /* used list for stack of caller */
+    MAThread    *t;        /* calling thread */
 
 #ifdef STATS
     ma_stats.calls[(int)FID_MA_pop_stack]++;
@@ -3118,8 +4247,10 @@ public Boolean MA_pop_stack(Integer memhandle) /* the block to deallocate */
     if (ma_trace) 
     (void)printf("MA: popping '%s'\n", ad->name);
 
+    t = ma_stack_select(&sp, &sused);
+
     /* delete block from used list */
-    if (list_delete(ad, &ma_sused) != ad)
+    if (list_delete(ad, sused) != ad)
     {
         (void)sprintf(ma_ebuf,
             "memhandle %ld (name: '%s') not on stack used list",
@@ -3129,7 +4260,11 @@ public Boolean MA_pop_stack(Integer memhandle) /* the block to deallocate */
     }
 
     /* pop block from stack */
-    ma_sp += ad->nbytes;
+    if (t == (MAThread *)NULL)
+        ma_lock();
+    *sp += ad->nbytes;
+    if (t == (MAThread *)NULL)
+        ma_unlock();
 
 #ifdef STATS
     ma_stats.sblocks--;
@@ -3137,7 +4272,7 @@ public Boolean MA_pop_stack(Integer memhandle) /* the block to deallocate */
 #endif /* STATS */
 
     /* free memhandle */
-    ma_table_deallocate(memhandle);
+    handle_free(t, memhandle);
 
     /* success */
     return MA_TRUE;
@@ -3249,6 +4384,10 @@ public Boolean MA_push_stack(
     Pointer    client_space;    /* location of client_space */
     ulongi    nbytes;        /* length of block for ar */
     Pointer    new_sp;        /* new ma_sp */
+    Pointer    *sp;        /* stack pointer of caller */
+    AD        **sused;    /* used list for stack of caller */
+    Pointer    limit;        /* lowest address of stack of caller */
+    MAThread    *t;        /* calling thread */
 
 #ifdef STATS
     ma_stats.calls[(int)FID_MA_push_stack]++;
@@ -3302,12 +4441,22 @@ public Boolean MA_push_stack(
     ar.datatype = datatype;
     ar.nelem = nelem;
 
-    balloc_before(&ar, ma_sp, &client_space, &nbytes);
+    /* other threads push on a stack region of their own */
+    t = ma_stack_select(&sp, &sused);
+    if (t == (MAThread *)NULL)
+        ma_lock();
+    else if ((t->region == (AD *)NULL) && !thread_stack_init(t))
+        return MA_FALSE;
+    limit = (t == (MAThread *)NULL) ? ma_hp : t->base;
+
+    balloc_before(&ar, *sp, &client_space, &nbytes);
 
-    new_sp = ma_sp - nbytes;
-    /* if (new_sp < ma_hp) */
-    if (((ulongi)(ma_sp - ma_hp)) < nbytes)
+    new_sp = *sp - nbytes;
+    /* if (new_sp < limit) */
+    if (((ulongi)(*sp - limit)) < nbytes)
     {
+        if (t == (MAThread *)NULL)
+            ma_unlock();
         (void)sprintf(ma_ebuf,
             "block '%s', not enough space to allocate %lu bytes",
             name, nbytes);
@@ -3329,7 +4478,8 @@ public Boolean MA_push_stack(
     str_ncopy(ad->name, (char*)name, MA_NAMESIZE);
     ad->client_space = client_space;
     ad->nbytes = nbytes;
-    list_insert(ad, &ma_sused);
+    ad->state = BS_Stack;
+    list_insert(ad, sused);
     ad->checksum = checksum(ad);
 
     /* set the guards */
@@ -3340,7 +4490,9 @@ public Boolean MA_push_stack(
 #endif /* DEBUG */
 
     /* update ma_sp */
-    ma_sp = new_sp;
+    *sp = new_sp;
+    if (t == (MAThread *)NULL)
+        ma_unlock();
 
 #ifdef STATS
     ma_stats.sblocks++;
@@ -3350,7 +4502,7 @@ public Boolean MA_push_stack(
 #endif /* STATS */
 
     /* convert AD to memhandle */
-    if ((*memhandle = ma_table_allocate((TableData)ad)) == TABLE_HANDLE_NONE)
+    if ((*memhandle = handle_allocate(t, ad)) == TABLE_HANDLE_NONE)
         /* failure */
         return MA_FALSE;
     else
@@ -3396,6 +4548,29 @@ public Boolean MA_set_error_print(Boolean value /* to set flag to */)
     return old_value;
 }
 
+/* ------------------------------------------------------------------------- */
+/*
+ * Set the ma_guard_check flag to value and return its previous value.
+ *
+ * When the flag is MA_FALSE, the checksum and guards of a block are not
+ * verified each time its memhandle is passed to MA.  Guards are still
+ * written, so MA_verify_allocator_stuff continues to find trashed blocks.
+ */
+/* ------------------------------------------------------------------------- */
+
+public Boolean MA_set_guard_check(Boolean value /* to set flag to */)
+{
+    Boolean    old_value;    /* of flag */
+
+#ifdef STATS
+    ma_stats.calls[(int)FID_MA_set_guard_check]++;
+#endif /* STATS */
+
+    old_value = ma_guard_check;
+    ma_guard_check = value;
+    return old_value;
+}
+
 /* ------------------------------------------------------------------------- */
 /*
  * Set the ma_hard_fail flag to value and return its previous value.
@@ -3415,6 +4590,53 @@ public Boolean MA_set_hard_fail( Boolean value /* to set flag to */)
     return old_value;
 }
 
+/* ------------------------------------------------------------------------- */
+/*
+ * Set the ma_heap_bins flag to value and return its previous value.
+ *
+ * When the flag is MA_TRUE, free heap blocks are kept in segregated size
+ * classes with boundary-tag coalescing, and heap allocation and
+ * deallocation take time independent of the number of blocks.  The flag
+ * may only be changed while no heap blocks are allocated; otherwise it
+ * is left alone.  Setting MA_USE_HEAP_BINS in the environment sets the
+ * flag in MA_init.
+ */
+/* ------------------------------------------------------------------------- */
+
+public Boolean MA_set_heap_bins(Boolean value /* to set flag to */)
+{
+    Boolean    old_value;    /* of flag */
+
+#ifdef STATS
+    ma_stats.calls[(int)FID_MA_set_heap_bins]++;
+#endif /* STATS */
+
+    old_value = ma_heap_bins;
+
+    if ((value != old_value) && ma_threads)
+    {
+        (void)sprintf(ma_ebuf,
+            "MA is thread-aware; heap mode unchanged");
+        ma_error(EL_Nonfatal, ET_External, "MA_set_heap_bins", ma_ebuf);
+        return old_value;
+    }
+
+    if ((value != old_value)
+        && (old_value ? (ma_hp != ma_segment) : (ma_hused != (AD *)NULL)))
+    {
+        (void)sprintf(ma_ebuf,
+            "heap blocks are allocated; heap mode unchanged");
+        ma_error(EL_Nonfatal, ET_External, "MA_set_heap_bins", ma_ebuf);
+        return old_value;
+    }
+
+    /* the heap region is empty in either mode */
+    ma_hlast = (AD *)NULL;
+
+    ma_heap_bins = value;
+    return old_value;
+}
+
 /* ------------------------------------------------------------------------- */
 /*
  * Set the requested alignment.
@@ -3618,7 +4840,7 @@ public Boolean MA_verify_allocator_stuff()
     preamble = "MA_verify_allocator_stuff: starting scan ...\n";
 
     /* check each block on the heap used list */
-    list_verify(ma_hused,
+    list_verify(ma_heap_bins ? bin_used_list() : ma_hused,
         "heap",
         preamble,
         &heap_blocks,
@@ -28,6 +28,7 @@ extern void MAi_summarize_allocated_blocks(int index_base);
 #define f2c_inform_base_fcd_            F77_FUNC_(f2c_inform_base_fcd,F2C_INFORM_BASE_FCD)
 #define f2c_init_                       F77_FUNC_(f2c_init,F2C_INIT)
 #define f2c_init_memhandle_iterator_    F77_FUNC_(f2c_init_memhandle_iterator,F2C_INIT_MEMHANDLE_ITERATOR)
+#define f2c_init_threads_               F77_FUNC_(f2c_init_threads,F2C_INIT_THREADS)
 #define f2c_initialized_                F77_FUNC_(f2c_initialized,F2C_INITIALIZED)
 #define f2c_inquire_avail_              F77_FUNC_(f2c_inquire_avail,F2C_INQUIRE_AVAIL)
 #define f2c_inquire_heap_               F77_FUNC_(f2c_inquire_heap,F2C_INQUIRE_HEAP)
@@ -42,7 +43,9 @@ extern void MAi_summarize_allocated_blocks(int index_base);
 #define f2c_push_stack_                 F77_FUNC_(f2c_push_stack,F2C_PUSH_STACK)
 #define f2c_set_auto_verify_            F77_FUNC_(f2c_set_auto_verify,F2C_SET_AUTO_VERIFY)
 #define f2c_set_error_print_            F77_FUNC_(f2c_set_error_print,F2C_SET_ERROR_PRINT)
+#define f2c_set_guard_check_            F77_FUNC_(f2c_set_guard_check,F2C_SET_GUARD_CHECK)
 #define f2c_set_hard_fail_              F77_FUNC_(f2c_set_hard_fail,F2C_SET_HARD_FAIL)
+#define f2c_set_heap_bins_              F77_FUNC_(f2c_set_heap_bins,F2C_SET_HEAP_BINS)
 #define f2c_set_numalign_               F77_FUNC_(f2c_set_numalign,F2C_SET_NUMALIGN)
 #define f2c_sizeof_                     F77_FUNC_(f2c_sizeof,F2C_SIZEOF)
 #define f2c_sizeof_overhead_            F77_FUNC_(f2c_sizeof_overhead,F2C_SIZEOF_OVERHEAD)
@@ -68,6 +68,9 @@ extern Boolean MA_init(
     Integer     nominal_heap   /**< # of datatype elements desired for heap */);
 extern Boolean MA_initialized();
 extern Boolean MA_init_memhandle_iterator( Integer *ithandle);
+extern Boolean MA_init_threads(
+    Integer     datatype,      /**< for computing storage requirement */
+    Integer     nominal_stack  /**< # of datatype elements desired for each stack */);
 extern Integer MA_inquire_avail(Integer datatype);
 extern Integer MA_inquire_heap(Integer datatype);
 extern Integer MA_inquire_heap_check_stack(Integer datatype);
@@ -90,7 +93,9 @@ extern Boolean MA_push_stack(
     Integer     *memhandle      /**< RETURN: handle for this block */);
 extern Boolean MA_set_auto_verify(Boolean  value /* to set flag to */);
 extern Boolean MA_set_error_print(Boolean value /* to set flag to */);
+extern Boolean MA_set_guard_check(Boolean value /* to set flag to */);
 extern Boolean MA_set_hard_fail( Boolean value /* to set flag to */);
+extern Boolean MA_set_heap_bins(Boolean value /* to set flag to */);
 extern Boolean MA_set_numalign(Integer  value);
 extern Integer MA_sizeof(
     Integer     datatype1,      /**< of source elements */
@@ -13,6 +13,11 @@
  * The size of the table is automatically increased if there isn't room
  * to add another entry.  The client can allocate, deallocate, verify
  * entries, and perform both handle-->data and data-->handle lookup.
+ *
+ * The table grows by whole chunks that never move, so that lookups need
+ * no lock.  After ma_table_init_threads, allocation and deallocation are
+ * serialized by a mutex, and threads can reserve a batch of slots with
+ * ma_table_reserve and fill and empty them without locking.
  */
 
 #if HAVE_STDIO_H
@@ -21,6 +26,9 @@
 #if HAVE_STDLIB_H
 #   include <stdlib.h>
 #endif
+#if HAVE_PTHREAD_H
+#   include <pthread.h>
+#endif
 #include "error.h"
 #include "memcpy.h"
 #include "scope.h"
@@ -30,8 +38,9 @@
  ** constants
  **/
 
-/* default # of initial table entries */
-#define DEFAULT_TABLE_ENTRIES    32
+/* # of table entries per chunk, and max # of chunks */
+#define TABLE_CHUNK_ENTRIES    1024
+#define TABLE_CHUNKS           16384
 
 /**
  ** types
@@ -42,7 +51,8 @@ typedef enum
 {
     TES_Unused = 0,            /* never used */
     TES_Allocated,            /* currently in use */
-    TES_Deallocated            /* formerly in use */
+    TES_Deallocated,            /* formerly in use */
+    TES_Reserved            /* held by a thread for later use */
 } TableEntryState;
 
 /* table entry consists of data and state */
@@ -52,78 +62,97 @@ typedef struct _TableEntry
     TableEntryState    state;        /* of this entry */
 } TableEntry;
 
-/* table is an array of table entries */
-typedef TableEntry * Table;
+/* table is an array of chunks of table entries */
+typedef TableEntry * Table[TABLE_CHUNKS];
 
 /**
  ** variables
  **/
 
 /* currently only one table is managed */
-private Table ma_table = NULL;
+private Table ma_table;
 
 private Integer ma_table_capacity = 0;
 private Integer ma_table_entries = 0;
 private Integer ma_table_next_slot = 0;
 
+#if HAVE_PTHREAD_H
+/* serialize allocation and deallocation? */
+private Boolean ma_table_threads = MA_FALSE;
+private pthread_mutex_t ma_table_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define table_lock() \
+    do { if (ma_table_threads) pthread_mutex_lock(&ma_table_mutex); } while (0)
+#define table_unlock() \
+    do { if (ma_table_threads) pthread_mutex_unlock(&ma_table_mutex); } while (0)
+#else
+#define table_lock()
+#define table_unlock()
+#endif
+
 /**
- ** public routines for internal use only
+ ** macros
+ **/
+
+/* table entry for handle */
+#define entry(handle) \
+    (ma_table[(handle) / TABLE_CHUNK_ENTRIES][(handle) % TABLE_CHUNK_ENTRIES])
+
+/**
+ ** private routines
  **/
 
 /* ------------------------------------------------------------------------- */
 /*
- * Allocate a table slot, store the given data into it, and return a handle
- * by which the slot may be referenced.  If a slot cannot be allocated,
- * return TABLE_HANDLE_NONE.
+ * Claim a table slot that is neither allocated nor reserved, expanding
+ * the table if necessary, mark it with state, and return its handle.
+ * If a slot cannot be claimed, return TABLE_HANDLE_NONE.  The caller
+ * holds the table lock.
  */
 /* ------------------------------------------------------------------------- */
 
-public Integer ma_table_allocate(data)
-    TableData    data;        /* to store */
+private Integer table_claim(state, caller)
+    TableEntryState    state;    /* to give the slot */
+    char    *caller;    /* name of calling routine */
 {
-    Table    new_ma_table;
-    Integer    new_ma_table_capacity;
-    unsigned    new_ma_table_size;
+    TableEntry    *chunk;
+    unsigned    chunk_size;
     Integer    i;
     Integer    slots_examined;
 
     /* expand the table if necessary */
     if (ma_table_entries >= ma_table_capacity)
     {
-        /* increase table capacity */
-        if (ma_table_capacity == 0)
-            /* set the initial capacity */
-            new_ma_table_capacity = DEFAULT_TABLE_ENTRIES;
-        else
-            /* double the current capacity */
-            new_ma_table_capacity = 2 * ma_table_capacity;
-
-        /* allocate space for new table */
-        new_ma_table_size = (unsigned)(new_ma_table_capacity * sizeof(TableEntry));
-        if ((new_ma_table = (Table)bytealloc(new_ma_table_size)) == (Table)NULL)
+        if (ma_table_capacity >= (Integer)TABLE_CHUNKS * TABLE_CHUNK_ENTRIES)
         {
             (void)sprintf(ma_ebuf,
-                "could not allocate %u bytes for ma_table",
-                new_ma_table_size);
-            ma_error(EL_Nonfatal, ET_Internal, "ma_table_allocate", ma_ebuf);
+                "ma_table is full, %ld slots used",
+                (long)ma_table_entries);
+            ma_error(EL_Nonfatal, ET_Internal, caller, ma_ebuf);
             return TABLE_HANDLE_NONE;
         }
 
-        /* copy and free old table */
-        if (ma_table_capacity > 0)
+        /* allocate space for a new chunk */
+        chunk_size = (unsigned)(TABLE_CHUNK_ENTRIES * sizeof(TableEntry));
+        if ((chunk = (TableEntry *)bytealloc(chunk_size)) == (TableEntry *)NULL)
         {
-            bytecopy(ma_table, new_ma_table, (ma_table_capacity * sizeof(TableEntry)));
-            bytefree(ma_table);
+            (void)sprintf(ma_ebuf,
+                "could not allocate %u bytes for ma_table",
+                chunk_size);
+            ma_error(EL_Nonfatal, ET_Internal, caller, ma_ebuf);
+            return TABLE_HANDLE_NONE;
         }
 
-        /* initialize new part of new table */
-        for (i = new_ma_table_capacity-1; i >= ma_table_capacity; i--)
-            new_ma_table[i].state = TES_Unused;
+        /* initialize new chunk */
+        for (i = 0; i < TABLE_CHUNK_ENTRIES; i++)
+            chunk[i].state = TES_Unused;
 
-        /* remember the new table */
-        ma_table = new_ma_table;
+        /* publish the chunk before the capacity that covers it */
+        ma_table[ma_table_capacity / TABLE_CHUNK_ENTRIES] = chunk;
+#if defined(__GNUC__)
+        __sync_synchronize();
+#endif
         ma_table_next_slot = ma_table_capacity;
-        ma_table_capacity = new_ma_table_capacity;
+        ma_table_capacity += TABLE_CHUNK_ENTRIES;
     }
 
     /* perform a linear circular search to find the next available slot */
@@ -131,11 +160,9 @@ public Integer ma_table_allocate(data)
          slots_examined < ma_table_capacity;
          slots_examined++, i = (i+1) % ma_table_capacity)
     {
-        if (ma_table[i].state != TES_Allocated)
+        if ((entry(i).state != TES_Allocated) && (entry(i).state != TES_Reserved))
         {
-            /* store the data */
-            ma_table[i].data = data;
-            ma_table[i].state = TES_Allocated;
+            entry(i).state = state;
 
             /* increment ma_table_entries */
             ma_table_entries++;
@@ -152,10 +179,52 @@ public Integer ma_table_allocate(data)
     (void)sprintf(ma_ebuf,
         "no ma_table slot available, %ld/%ld slots used",
         (long)ma_table_entries, (long)ma_table_capacity);
-    ma_error(EL_Nonfatal, ET_Internal, "ma_table_allocate", ma_ebuf);
+    ma_error(EL_Nonfatal, ET_Internal, caller, ma_ebuf);
     return TABLE_HANDLE_NONE;
 }
 
+/**
+ ** public routines for internal use only
+ **/
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Allocate a table slot, store the given data into it, and return a handle
+ * by which the slot may be referenced.  If a slot cannot be allocated,
+ * return TABLE_HANDLE_NONE.
+ */
+/* ------------------------------------------------------------------------- */
+
+public Integer ma_table_allocate(data)
+    TableData    data;        /* to store */
+{
+    Integer    handle;
+
+    table_lock();
+    handle = table_claim(TES_Allocated, "ma_table_allocate");
+    if (handle != TABLE_HANDLE_NONE)
+        /* store the data */
+        entry(handle).data = data;
+    table_unlock();
+
+    return handle;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Store data into a slot previously reserved by ma_table_reserve.
+ * No lock is taken; the caller owns the slot.
+ */
+/* ------------------------------------------------------------------------- */
+
+public void ma_table_assign(handle, data)
+    Integer    handle;        /* reserved slot */
+    TableData    data;        /* to store */
+{
+    entry(handle).data = data;
+    entry(handle).state = TES_Allocated;
+}
+
 /* ------------------------------------------------------------------------- */
 /*
  * Deallocate the table slot corresponding to the given handle,
@@ -169,14 +238,31 @@ public void ma_table_deallocate(handle)
 {
     if (ma_table_verify(handle, "ma_table_deallocate"))
     {
+        table_lock();
+
         /* deallocate the slot */
-        ma_table[handle].state = TES_Deallocated;
+        entry(handle).state = TES_Deallocated;
 
         /* decrement ma_table_entries */
         ma_table_entries--;
+
+        table_unlock();
     }
 }
 
+/* ------------------------------------------------------------------------- */
+/*
+ * Turn on the locking needed when several threads use the table.
+ */
+/* ------------------------------------------------------------------------- */
+
+public void ma_table_init_threads()
+{
+#if HAVE_PTHREAD_H
+    ma_table_threads = MA_TRUE;
+#endif
+}
+
 /* ------------------------------------------------------------------------- */
 /*
  * Return the data in the table slot corresponding to the given handle,
@@ -190,7 +276,7 @@ public TableData ma_table_lookup(handle)
 {
     if (ma_table_verify(handle, "ma_table_lookup"))
         /* success */
-        return ma_table[handle].data;
+        return entry(handle).data;
     else
         /* failure */
         return (TableData)NULL;
@@ -214,7 +300,7 @@ public Integer ma_table_lookup_assoc(data)
 
     /* perform a linear search from the first table slot */
     for (i = 0; i < ma_table_capacity; i++)
-        if ((ma_table[i].state == TES_Allocated) && (ma_table[i].data == data))
+        if ((entry(i).state == TES_Allocated) && (entry(i).data == data))
             /* success */
             return i;
 
@@ -222,6 +308,68 @@ public Integer ma_table_lookup_assoc(data)
     return TABLE_HANDLE_NONE;
 }
 
+/* ------------------------------------------------------------------------- */
+/*
+ * Give back n slots held by the caller (allocated or reserved).
+ */
+/* ------------------------------------------------------------------------- */
+
+public void ma_table_release(handles, n)
+    Integer    *handles;    /* slots to give back */
+    int        n;        /* # of slots */
+{
+    int        i;
+
+    table_lock();
+    for (i = 0; i < n; i++)
+    {
+        entry(handles[i]).state = TES_Deallocated;
+        ma_table_entries--;
+    }
+    table_unlock();
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Reserve up to n free slots for the caller, store their handles in
+ * handles, and return the number reserved.  Reserved slots are counted
+ * as in use, but are not valid handles until ma_table_assign.
+ */
+/* ------------------------------------------------------------------------- */
+
+public int ma_table_reserve(handles, n)
+    Integer    *handles;    /* RETURN: reserved slots */
+    int        n;        /* # of slots wanted */
+{
+    int        i;
+
+    table_lock();
+    for (i = 0; i < n; i++)
+        if ((handles[i] = table_claim(TES_Reserved, "ma_table_reserve"))
+                == TABLE_HANDLE_NONE)
+            break;
+    table_unlock();
+
+    return i;
+}
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Return a slot filled by ma_table_assign to the reserved state, after
+ * verifying it.  No lock is taken.  Return MA_FALSE if handle is invalid.
+ */
+/* ------------------------------------------------------------------------- */
+
+public Boolean ma_table_unassign(handle)
+    Integer    handle;        /* to empty */
+{
+    if (!ma_table_verify(handle, "ma_table_unassign"))
+        return MA_FALSE;
+
+    entry(handle).state = TES_Reserved;
+    return MA_TRUE;
+}
+
 /* ------------------------------------------------------------------------- */
 /*
  * Return MA_TRUE if the given handle corresponds to a valid table slot
@@ -241,14 +389,15 @@ public Boolean ma_table_verify(handle, caller)
     /* if handle is invalid, construct an error message */
     if ((handle < 0) ||
         (handle >= ma_table_capacity) ||
-        (ma_table[handle].state == TES_Unused))
+        (entry(handle).state == TES_Unused))
     {
         (void)sprintf(ma_ebuf,
             "handle %ld is not valid",
             (long)handle);
         badhandle = MA_TRUE;
     }
-    else if (ma_table[handle].state == TES_Deallocated)
+    else if ((entry(handle).state == TES_Deallocated) ||
+             (entry(handle).state == TES_Reserved))
     {
         (void)sprintf(ma_ebuf,
             "handle %ld already deallocated",
@@ -28,9 +28,14 @@ typedef char * TableData;
  **/
 
 extern Integer ma_table_allocate(TableData data);
+extern void ma_table_assign(Integer handle, TableData data);
 extern void ma_table_deallocate(Integer handle);
+extern void ma_table_init_threads();
 extern TableData ma_table_lookup(Integer handle);
 extern Integer ma_table_lookup_assoc(TableData data);
+extern void ma_table_release(Integer *handles, int n);
+extern int ma_table_reserve(Integer *handles, int n);
+extern Boolean ma_table_unassign(Integer handle);
 extern Boolean ma_table_verify(Integer handle, char *caller);
 
 #endif /* _table_h */
@@ -12,31 +12,38 @@
 #if HAVE_STDLIB_H
 #   include <stdlib.h>
 #endif
+#include <time.h>
 #include "macdecls.h"
 
 #define MAXHANDLES 10
 
-int main(int argc, char **argv)
+/* fragmentation benchmark: live blocks, operations, largest block */
+#define NSLOTS   2000
+#define NOPS     200000
+#define MAXNELEM 512
+
+static Integer heap_bytes(void)
+{
+    return 1024 + 4 * NSLOTS * MAXNELEM * sizeof(double);
+}
+
+/*
+ * Allocate 4 blocks, free 2 non-adjacent ones, and check that the
+ * freed space is coalesced once the block between them is freed.
+ */
+static int test_coalesce(void)
 {
-    Integer        bytes_heap;
-    Integer        bytes_stack;
     int            howmany;
+    int            status = 0;
+    Integer        filler;
     Boolean        ok;
-                  
+
     Integer        handle[MAXHANDLES];
     MA_AccessIndex index[MAXHANDLES];
 
-    /* set sizes of heap and stack */
-    bytes_heap = 1024;
-    bytes_stack = 0;
-
-    /* initialize */
-    ok = MA_init(MT_CHAR, bytes_stack, bytes_heap);
-    if (!ok)
-    {
-        (void)fprintf(stderr, "MA_init failed; punting\n");
-        exit(1);
-    }
+    /* confine the test to the last 4096 bytes of the segment */
+    filler = MA_inquire_avail(MT_CHAR) - 4096;
+    MA_alloc_get(MT_CHAR, filler, "filler", &handle[5], &index[5]);
 
     howmany = MA_inquire_heap(MT_INT);
     (void)printf("MA_inquire_heap(MT_INT) = %d\n", howmany);
@@ -52,14 +59,132 @@ int main(int argc, char **argv)
     MA_free_heap(handle[2]);
 
     printf("# Attempting to allocate memory segment -- should fail\n");
-    MA_alloc_get(MT_INT, howmany/4, "heap4", &handle[4], &index[4]);
+    if (MA_alloc_get(MT_INT, howmany/4, "heap4", &handle[4], &index[4]))
+    {
+        (void)printf("ERROR: allocation succeeded\n");
+        MA_free_heap(handle[4]);
+        status = 1;
+    }
 
     printf("# Freeing some memory and trying again -- should succeed\n");
     MA_free_heap(handle[1]);
-    MA_alloc_get(MT_INT, howmany/4, "heap4", &handle[4], &index[4]);
+    ok = MA_alloc_get(MT_INT, howmany/4, "heap4", &handle[4], &index[4]);
+    if (!ok)
+    {
+        (void)printf("ERROR: allocation failed\n");
+        status = 1;
+    }
 
-    printf("# Printing stats for allocated blocks -- should be two active\n");
+    printf("# Printing stats for allocated blocks -- should be two active (plus filler)\n");
     MA_summarize_allocated_blocks();
 
-    return 0;
+    /* empty the heap again */
+    MA_free_heap(handle[3]);
+    if (ok)
+        MA_free_heap(handle[4]);
+    MA_free_heap(handle[5]);
+
+    return status;
+}
+
+/*
+ * Time random frees and allocations of MT_DBL blocks against a heap
+ * fragmented by freeing every other block.  The contents of each block
+ * are checked before it is freed.
+ */
+static int bench_fragmented(Boolean bins, double *usec)
+{
+    static Integer        handle[NSLOTS];
+    static Integer        nelem[NSLOTS];
+    static double        *ptr[NSLOTS];
+    MA_AccessIndex        index;
+    int                   i, k, op, status = 0, failed = 0;
+    clock_t               start;
+
+    (void)MA_set_heap_bins(bins);
+    srand(12345);
+
+    for (i = 0; i < NSLOTS; i++)
+    {
+        nelem[i] = 1 + rand() % MAXNELEM;
+        if (!MA_alloc_get(MT_DBL, nelem[i], "bench", &handle[i], &index)
+            || !MA_get_pointer(handle[i], &ptr[i]))
+            return 1;
+        ptr[i][0] = ptr[i][nelem[i]-1] = (double)i;
+    }
+    for (i = 0; i < NSLOTS; i += 2)
+    {
+        (void)MA_free_heap(handle[i]);
+        ptr[i] = NULL;
+    }
+
+    start = clock();
+    for (op = 0; op < NOPS; op++)
+    {
+        k = rand() % NSLOTS;
+        if (ptr[k])
+        {
+            if (ptr[k][0] != (double)k || ptr[k][nelem[k]-1] != (double)k)
+                status = 1;
+            (void)MA_free_heap(handle[k]);
+            ptr[k] = NULL;
+        }
+        else
+        {
+            nelem[k] = 1 + rand() % MAXNELEM;
+            if (MA_alloc_get(MT_DBL, nelem[k], "bench", &handle[k], &index)
+                && MA_get_pointer(handle[k], &ptr[k]))
+                ptr[k][0] = ptr[k][nelem[k]-1] = (double)k;
+            else
+                failed++;
+        }
+    }
+    *usec = 1.0e6 * (double)(clock() - start) / CLOCKS_PER_SEC / NOPS;
+
+    for (i = 0; i < NSLOTS; i++)
+        if (ptr[i])
+            (void)MA_free_heap(handle[i]);
+
+    if (failed)
+        (void)printf("%d allocations failed\n", failed);
+    if (status)
+        (void)printf("ERROR: block contents overwritten\n");
+    return status;
+}
+
+int main(int argc, char **argv)
+{
+    Integer        bytes_heap;
+    Integer        bytes_stack;
+    Boolean        ok;
+    int            status = 0;
+    double         list_usec, bins_usec;
+
+    /* set sizes of heap and stack */
+    bytes_heap = heap_bytes();
+    bytes_stack = 0;
+
+    /* initialize */
+    ok = MA_init(MT_CHAR, bytes_stack, bytes_heap);
+    if (!ok)
+    {
+        (void)fprintf(stderr, "MA_init failed; punting\n");
+        exit(1);
+    }
+
+    printf("# Address-ordered free list\n");
+    (void)MA_set_heap_bins(MA_FALSE);
+    status |= test_coalesce();
+
+    printf("# Size-class heap\n");
+    (void)MA_set_heap_bins(MA_TRUE);
+    status |= test_coalesce();
+
+    printf("# Alloc/free under fragmentation, %d live blocks\n", NSLOTS/2);
+    status |= bench_fragmented(MA_FALSE, &list_usec);
+    status |= bench_fragmented(MA_TRUE, &bins_usec);
+    printf("address-ordered list: %8.3f usec per operation\n", list_usec);
+    printf("size classes:         %8.3f usec per operation\n", bins_usec);
+
+    return status;
 }
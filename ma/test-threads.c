@@ -0,0 +1,148 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#if HAVE_STDIO_H
+#   include <stdio.h>
+#endif
+#if HAVE_STDLIB_H
+#   include <stdlib.h>
+#endif
+#include <pthread.h>
+#include <time.h>
+#include "macdecls.h"
+
+/* threads, live blocks and operations per thread, largest block */
+#define NTHREADS 4
+#define NSLOTS   256
+#define NOPS     200000
+#define MAXNELEM 512
+
+/* elements in each thread stack */
+#define NSTACK   (4 * MAXNELEM)
+
+static int errors[NTHREADS];
+
+/*
+ * Randomly allocate and free heap blocks of MT_DBL, pushing and popping a
+ * stack block every so often, and check the contents of each block
+ * before it is freed.
+ */
+static void *worker(void *arg)
+{
+    int                   me = (int)(size_t)arg;
+    Integer               handle[NSLOTS];
+    Integer               nelem[NSLOTS];
+    double                *ptr[NSLOTS];
+    Integer               shandle;
+    double                *sptr;
+    MA_AccessIndex        index;
+    unsigned int          seed = 1234u + me;
+    int                   i, k, op;
+
+    for (i = 0; i < NSLOTS; i++)
+        ptr[i] = NULL;
+
+    for (op = 0; op < NOPS; op++)
+    {
+        k = rand_r(&seed) % NSLOTS;
+        if (ptr[k])
+        {
+            if (ptr[k][0] != (double)(me * NSLOTS + k)
+                || ptr[k][nelem[k]-1] != (double)(me * NSLOTS + k))
+                errors[me]++;
+            (void)MA_free_heap(handle[k]);
+            ptr[k] = NULL;
+        }
+        else
+        {
+            nelem[k] = 1 + rand_r(&seed) % MAXNELEM;
+            if (MA_alloc_get(MT_DBL, nelem[k], "heap", &handle[k], &index)
+                && MA_get_pointer(handle[k], &ptr[k]))
+                ptr[k][0] = ptr[k][nelem[k]-1] = (double)(me * NSLOTS + k);
+            else
+                errors[me]++;
+        }
+
+        if (op % 64 == 0)
+        {
+            if (!MA_push_get(MT_DBL, NSTACK / 2, "stack", &shandle, &index)
+                || !MA_get_pointer(shandle, &sptr))
+            {
+                errors[me]++;
+                continue;
+            }
+            sptr[0] = sptr[NSTACK/2 - 1] = (double)op;
+            if (sptr[0] != (double)op || !MA_pop_stack(shandle))
+                errors[me]++;
+        }
+    }
+
+    for (i = 0; i < NSLOTS; i++)
+        if (ptr[i])
+            (void)MA_free_heap(handle[i]);
+
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    pthread_t      thread[NTHREADS];
+    Integer        avail;
+    Integer        handle;
+    MA_AccessIndex index;
+    int            i, status = 0;
+    struct timespec start, end;
+    double         usec;
+
+    if (!MA_init(MT_DBL, 1024, NTHREADS * (NSLOTS * MAXNELEM + 2 * NSTACK)))
+    {
+        (void)fprintf(stderr, "MA_init failed; punting\n");
+        exit(1);
+    }
+    if (!MA_init_threads(MT_DBL, NSTACK))
+    {
+        (void)fprintf(stderr, "MA_init_threads failed; punting\n");
+        exit(1);
+    }
+
+    avail = MA_inquire_avail(MT_CHAR);
+
+    /* the main thread keeps the shared stack */
+    if (!MA_push_get(MT_DBL, 16, "main", &handle, &index))
+        status = 1;
+
+    printf("# %d threads, %d heap operations each\n", NTHREADS, NOPS);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < NTHREADS; i++)
+        pthread_create(&thread[i], NULL, worker, (void *)(size_t)i);
+    for (i = 0; i < NTHREADS; i++)
+        pthread_join(thread[i], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    usec = 1.0e6 * (end.tv_sec - start.tv_sec)
+        + 1.0e-3 * (end.tv_nsec - start.tv_nsec);
+    printf("%8.3f usec per operation\n", usec / ((double)NTHREADS * NOPS));
+
+    for (i = 0; i < NTHREADS; i++)
+    {
+        if (errors[i])
+        {
+            (void)printf("ERROR: thread %d: %d failures\n", i, errors[i]);
+            status = 1;
+        }
+    }
+
+    if (!MA_pop_stack(handle))
+        status = 1;
+
+    /* exiting threads give back their stacks and cached blocks */
+    if (MA_inquire_avail(MT_CHAR) != avail)
+    {
+        (void)printf("ERROR: %ld bytes available, expected %ld\n",
+            (long)MA_inquire_avail(MT_CHAR), (long)avail);
+        MA_summarize_allocated_blocks();
+        status = 1;
+    }
+
+    return status;
+}
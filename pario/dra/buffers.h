@@ -11,8 +11,8 @@
 /* alignment factor for the internal buffer */
 #define ALIGN 16
 
-#define MAXBUF 16 /* max # of buffers that can be used */
-#define DEFBUF 4 /* default # of buffers */
+#define MAXBUF 64 /* max # of buffers that can be used */
+#define DEFBUF 8 /* default # of buffers */
 
 /** internal buffer structure */
 typedef struct {
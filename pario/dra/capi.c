@@ -249,6 +249,14 @@ void DRA_Set_default_config(int numfiles, int numioprocs)
     return;
 }
 
+void DRA_Set_compression(logical flag, int bits)
+{
+    Integer bbits;
+    bbits = (Integer)bits;
+    dra_set_compression_(&flag, &bbits);
+    return;
+}
+
 int DRA_Wait(int request)
 {
     Integer rrequest, status;
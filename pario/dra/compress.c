@@ -0,0 +1,230 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+/** @file
+ * Codec for compressed disk arrays.
+ *
+ * A chunk is encoded in blocks of ZBLOCK elements.  Each element is
+ * XORed with the one before it, which leaves smooth data with long
+ * runs of zero high-order bytes, and the bytes of a block are split
+ * into planes (byte k of every element).  Each plane is then coded as
+ * runs of zero bytes and of literal bytes.  In the lossy mode the low
+ * mantissa bits of floating-point elements are cleared first, which
+ * turns the low-order planes into zeros as well.
+ *
+ * The encoded chunk starts with a DAI_ZHDR byte header: the raw length,
+ * the method and the element width.  Compressed data are always shorter
+ * than the chunk, so that they fit in its place in the file; a chunk
+ * that does not compress is stored as is by the caller.
+ */
+
+#if HAVE_STRING_H
+#   include <string.h>
+#endif
+
+#include "drap.h"
+
+#define ZBLOCK   1024  /**< elements per block */
+#define ZPLANES  1     /**< method: XOR delta, byte planes, zero runs */
+
+typedef unsigned long long zword_t;
+
+
+/**
+ * Code the n bytes of plane at out, as runs of zeros (token 128..255,
+ * run of token-127 zeros) and literal runs (token 0..127, token+1 bytes
+ * follow).  Returns the end of the output, or NULL if it would pass
+ * limit.
+ */
+static unsigned char *zplane_encode(const unsigned char *plane, int n,
+        unsigned char *out, const unsigned char *limit)
+{
+    int i = 0, j;
+
+    while (i < n) {
+        if (out + 129 > limit) return NULL;
+        if (plane[i] == 0) {
+            for (j = i+1; j < n && j-i < 128 && plane[j] == 0; j++);
+            *out++ = (unsigned char)(127 + j - i);
+        } else {
+            /* a single zero is cheaper inside a literal run */
+            for (j = i+1; j < n && j-i < 128; j++)
+                if (plane[j] == 0 && (j+1 == n || plane[j+1] == 0)) break;
+            *out++ = (unsigned char)(j - i - 1);
+            memcpy(out, plane + i, j - i);
+            out += j - i;
+        }
+        i = j;
+    }
+    return out;
+}
+
+
+/**
+ * Decode n bytes of a plane coded by zplane_encode.  Returns the end of
+ * the input, or NULL if the input is corrupt.
+ */
+static const unsigned char *zplane_decode(const unsigned char *in,
+        const unsigned char *end, unsigned char *plane, int n)
+{
+    int i = 0, len;
+
+    while (i < n) {
+        if (in >= end) return NULL;
+        if (*in >= 128) {
+            len = *in++ - 127;
+            if (i + len > n) return NULL;
+            memset(plane + i, 0, len);
+        } else {
+            len = *in++ + 1;
+            if (i + len > n || in + len > end) return NULL;
+            memcpy(plane + i, in, len);
+            in += len;
+        }
+        i += len;
+    }
+    return in;
+}
+
+
+/**
+ * Return the element width used for data of the given type and, in
+ * *mant, the number of mantissa bits of a floating-point element (0
+ * for integers).
+ */
+static int zwidth(int type, int *mant)
+{
+    *mant = 0;
+    switch (type) {
+        case C_DBL:
+        case C_DCPL:
+            *mant = 52;
+            return 8;
+        case C_FLOAT:
+        case C_SCPL:
+            *mant = 23;
+            return 4;
+        case C_LONG:
+            return (int)sizeof(long) == 8 ? 8 : 4;
+        default:
+            return (int)sizeof(int) == 8 ? 8 : 4;
+    }
+}
+
+
+/**
+ * Compress bytes of data of the given type from src to dst, which must
+ * hold bytes.  If 0 < bits, floating-point elements keep only bits bits
+ * of mantissa.  Returns the length of the compressed data, which is
+ * less than bytes, or 0 if the data do not compress.
+ */
+Size_t dai_compress(const char *src, Size_t bytes, int type, int bits,
+        char *dst)
+{
+    zword_t d[ZBLOCK], prev = 0, cur, mask = ~(zword_t)0;
+    unsigned char plane[ZBLOCK], *out, *limit;
+    unsigned int raw = (unsigned int)bytes, cur32;
+    int width, mant, n, nelem, e, i, k;
+
+    width = zwidth(type, &mant);
+    if (bits > 0 && bits < mant) mask <<= mant - bits;
+    if (bytes % width || bytes <= DAI_ZHDR + 129) return 0;
+
+    dst[4] = ZPLANES;
+    dst[5] = (char)width;
+    dst[6] = dst[7] = 0;
+    memcpy(dst, &raw, 4);
+
+    out = (unsigned char*)dst + DAI_ZHDR;
+    limit = (unsigned char*)dst + bytes - 1;
+    nelem = (int)(bytes / width);
+
+    for (e = 0; out && e < nelem; e += n) {
+        n = (nelem - e < ZBLOCK) ? nelem - e : ZBLOCK;
+
+        /* delta against the previous element */
+        for (i = 0; i < n; i++) {
+            if (width == 8) {
+                memcpy(&cur, src + (Size_t)(e+i)*8, 8);
+            } else {
+                memcpy(&cur32, src + (Size_t)(e+i)*4, 4);
+                cur = cur32;
+            }
+            cur &= mask;
+            d[i] = cur ^ prev;
+            prev = cur;
+        }
+
+        /* byte planes, in memory order of the elements */
+        for (k = 0; k < width && out; k++) {
+            for (i = 0; i < n; i++) {
+                if (width == 8) {
+                    plane[i] = ((unsigned char*)(d + i))[k];
+                } else {
+                    cur32 = (unsigned int)d[i];
+                    plane[i] = ((unsigned char*)&cur32)[k];
+                }
+            }
+            out = zplane_encode(plane, n, out, limit);
+        }
+    }
+
+    return out ? (Size_t)(out - (unsigned char*)dst) : 0;
+}
+
+
+/**
+ * Decompress zbytes of data compressed by dai_compress from src to
+ * dst, which must hold bytes.  Returns 0 on success, -1 if the data
+ * are corrupt or do not have length bytes.
+ */
+int dai_decompress(const char *src, Size_t zbytes, char *dst, Size_t bytes)
+{
+    zword_t d[ZBLOCK], prev = 0;
+    unsigned char plane[ZBLOCK];
+    const unsigned char *in, *end;
+    unsigned int raw, cur32;
+    int width, n, nelem, e, i, k;
+
+    if (zbytes < DAI_ZHDR) return -1;
+    memcpy(&raw, src, 4);
+    if ((Size_t)raw != bytes) return -1;
+
+    width = src[5];
+    if (src[4] != ZPLANES || (width != 8 && width != 4) || bytes % width)
+        return -1;
+
+    in = (const unsigned char*)src + DAI_ZHDR;
+    end = (const unsigned char*)src + zbytes;
+    nelem = (int)(bytes / width);
+
+    for (e = 0; e < nelem; e += n) {
+        n = (nelem - e < ZBLOCK) ? nelem - e : ZBLOCK;
+        memset(d, 0, n * sizeof(zword_t));
+
+        for (k = 0; k < width; k++) {
+            if (!(in = zplane_decode(in, end, plane, n))) return -1;
+            for (i = 0; i < n; i++) {
+                if (width == 8) {
+                    ((unsigned char*)(d + i))[k] = plane[i];
+                } else {
+                    cur32 = (unsigned int)d[i];
+                    ((unsigned char*)&cur32)[k] = plane[i];
+                    d[i] = cur32;
+                }
+            }
+        }
+
+        for (i = 0; i < n; i++) {
+            prev ^= d[i];
+            if (width == 8) {
+                memcpy(dst + (Size_t)(e+i)*8, &prev, 8);
+            } else {
+                cur32 = (unsigned int)prev;
+                memcpy(dst + (Size_t)(e+i)*4, &cur32, 4);
+            }
+        }
+    }
+    return (in == end) ? 0 : -1;
+}
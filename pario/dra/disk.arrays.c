@@ -119,7 +119,10 @@ Integer _dra_number_of_files;
 disk_array_t *DRA;
 
 buf_context_t buf_ctxt; /**< buffer context handle */
-int nbuf = 4; /**< number of buffers to be used */
+int nbuf = DEFBUF; /**< number of buffers to be used */
+int _dra_mmap = 0; /**< map arrays opened read-only into memory */
+int _dra_compress = 0; /**< compress arrays created from now on */
+int _dra_zbits = 0;    /**< mantissa bits they keep, 0 = lossless */
 
 Integer _max_disk_array; /**< max number of disk arrays open at a time */
 logical dra_debug_flag;  /**< globally defined debug parameter */
@@ -532,6 +535,14 @@ void dai_callback(int op, int transp, section_t gs_a, section_t ds_a, section_t
  * this function will be passed on as a parameter to a buffer management layer
  */
 void wait_buf(char *buf);
+void dai_issue_put(char *buf);
+void ndai_zinit(Integer d_a);
+void ndai_zclose(Integer d_a, int keep);
+void ndai_zput(buf_info *bi, section_t ds_a, char *buf, io_request_t *id);
+void ndai_zget(buf_info *bi, section_t ds_a, char *buf, io_request_t *id);
+void ndai_zfinish(buf_info *bi, section_t ds_a, char *buf);
+void dai_set_config(Integer numfiles, Integer numioprocs,
+        Integer *number_of_files, Integer *io_procs);
 
 
 /**
@@ -567,7 +578,15 @@ Integer FATR dra_init_(
     _dra_io_procs = pnga_cluster_nnodes();
     _dra_number_of_files = pnga_cluster_nnodes();
 
+    /* DRA_NUM_SERV stripes arrays over that many I/O procs, one file each */
+    if (Dra_num_serv > 0)
+        dai_set_config(Dra_num_serv, Dra_num_serv,
+                &_dra_number_of_files, &_dra_io_procs);
+
+    _dra_mmap = drai_get_mmap();
+
     /* initialize Buffer Manager */
+    if (drai_get_num_buf() > 0) nbuf = drai_get_num_buf();
     buf_size = sizeof (buf_info) + (int) DBL_BUF_SIZE;
     buffer_init(&buf_ctxt, nbuf, buf_size, &wait_buf);
 
@@ -678,6 +697,8 @@ Integer dai_get_handle(void)
         if(!DRA[candidate].actv){ 
             dra_handle=candidate;
             DRA[candidate].actv =1;
+            DRA[candidate].map = NULL;
+            DRA[candidate].zindex = NULL;
         }
         candidate++;
     }while(candidate < _max_disk_array && dra_handle == -1);
@@ -906,6 +927,11 @@ Integer drai_open(char *filename, Integer *mode, Integer *d_a)
 
     if(dai_read_param(DRA[handle].fname, *d_a))return((Integer)-1);
 
+    /* the parameters of process 0 came with its pointers */
+    DRA[handle].map = NULL;
+    ndai_zinit(*d_a);
+    if(DRA[handle].compress) dai_read_zindex(DRA[handle].fname, *d_a);
+
     DRA[handle].indep = dai_file_config(filename); /*check file configuration*/
 
     if(dai_io_manage(*d_a)){ 
@@ -924,6 +950,17 @@ Integer drai_open(char *filename, Integer *mode, Integer *d_a)
                 pnga_nodeid());
         if(DRA[handle].fd->fd ==-1)dai_error("dra_open failed (-1)",
                 pnga_nodeid());  
+
+        /* the file cannot change, so reads can come from a mapping;
+         * if it cannot be mapped, buffered reads are used */
+        if(_dra_mmap && DRA[handle].mode == DRA_R && !DRA[handle].compress){
+            Off_t length;
+            if(elio_length(DRA[handle].fd, &length) == ELIO_OK){
+                DRA[handle].maplen = (Size_t)length;
+                DRA[handle].map = (char*)elio_map(DRA[handle].fd, 0.,
+                        DRA[handle].maplen);
+            }
+        }
     }
 
 
@@ -952,6 +989,8 @@ Integer FATR dra_close_(Integer* d_a) /* input:DRA handle*/
     pnga_sync();
 
     dai_check_handleM(*d_a, "dra_close");
+    ndai_zclose(*d_a, 1);
+    if(DRA[handle].map) elio_unmap(DRA[handle].map, DRA[handle].maplen);
     if(dai_io_manage(*d_a)) if(ELIO_OK != (rc=elio_close(DRA[handle].fd)))
         dai_error("dra_close: close failed",rc);
     dai_release_handle(d_a); 
@@ -1541,6 +1580,7 @@ void dai_exec_callback(char *buf, int caller)
         return;
 
     buffer = (char*) (buf + sizeof(buf_info));
+    ndai_zfinish(bi, arg->ds_chunk, buffer);
     if (caller == WAIT) {/* call blocking nga_move() */
         nga_move(arg->op, arg->transp, arg->gs_a, arg->ds_a, arg->ds_chunk, buffer, arg->ld, NULL);
         ga_dra_free_buf(&buf_ctxt, buf);
@@ -1768,7 +1808,10 @@ Integer FATR dra_delete_(Integer* d_a)
 
     dai_check_handleM(*d_a,"dra_delete");
     dai_delete_param(DRA[handle].fname,*d_a);
+    if(DRA[handle].compress) dai_delete_zindex(DRA[handle].fname,*d_a);
+    ndai_zclose(*d_a, 0);
 
+    if(DRA[handle].map) elio_unmap(DRA[handle].map, DRA[handle].maplen);
     if(dai_io_manage(*d_a)) if(ELIO_OK != (rc=elio_close(DRA[handle].fd)))
         dai_error("dra_close: close failed",rc);
 
@@ -1793,6 +1836,12 @@ Integer FATR dra_delete_(Integer* d_a)
  */
 Integer FATR dra_terminate_()
 {
+    int i;
+
+    /* scratch space of compressed arrays */
+    for (i = 0; i < buf_ctxt.nbuf; i++)
+        free(((buf_info*)buf_ctxt.buf[i].buffer)->zbuf);
+
     free(DRA);
     buf_terminate(&buf_ctxt);
 
@@ -2209,6 +2258,9 @@ Integer ndrai_create_config(Integer *type, Integer *ndim, Integer dims[],
     DRA[handle].mode = (int)*mode;
     strncpy (DRA[handle].fname, filename,  DRA_MAX_FNAME);
     strncpy(DRA[handle].name, name, DRA_MAX_NAME );
+    DRA[handle].compress = _dra_compress;
+    DRA[handle].zbits = _dra_zbits;
+    ndai_zinit(*d_a);
 
     dai_write_param(DRA[handle].fname, *d_a);      /* create param file */
     DRA[handle].indep = dai_file_config(filename); /*check file configuration*/
@@ -2453,6 +2505,242 @@ void ndai_get(section_t ds_a, void *buf, Integer ld[], io_request_t *id)
 }
 
 
+/**
+ * set up the chunk index of a compressed array: compressed length of
+ * each chunk, 0 if never written, the chunk length if stored as is
+ */
+void ndai_zinit(Integer d_a)
+{
+    Integer handle = d_a + DRA_OFFSET, i;
+
+    DRA[handle].zindex = NULL;
+    DRA[handle].zdirty = NULL;
+    DRA[handle].zraw = DRA[handle].zdisk = DRA[handle].ztime = 0.0;
+    if (!DRA[handle].compress) return;
+
+    DRA[handle].nchunks = 1;
+    for (i=0; i<DRA[handle].ndim; i++)
+        DRA[handle].nchunks *= (DRA[handle].dims[i]+DRA[handle].chunk[i]-1)
+            / DRA[handle].chunk[i];
+
+    DRA[handle].zindex = (Size_t*) calloc(DRA[handle].nchunks, sizeof(Size_t));
+    DRA[handle].zdirty = (char*) calloc(DRA[handle].nchunks, 1);
+    if (!DRA[handle].zindex || !DRA[handle].zdirty)
+        dai_error("ndai_zinit: no memory for chunk index",DRA[handle].nchunks);
+}
+
+
+/**
+ * release the chunk index of a compressed array; if keep is set, first
+ * combine the chunks written by all processes and save the index
+ */
+void ndai_zclose(Integer d_a, int keep)
+{
+    Integer handle = d_a + DRA_OFFSET, i, *len, any = 0;
+    Integer nchunks = DRA[handle].nchunks;
+
+    if (!DRA[handle].compress || !DRA[handle].zindex) return;
+
+    if (keep) {
+        /* a chunk is written by one process only */
+        len = (Integer*) malloc(nchunks*sizeof(Integer));
+        if (!len) dai_error("ndai_zclose: no memory",nchunks);
+        for (i=0; i<nchunks; i++)
+            len[i] = DRA[handle].zdirty[i] ? (Integer)DRA[handle].zindex[i]+1 : 0;
+        pnga_gop(pnga_type_f2c(MT_F_INT), len, nchunks, "max");
+        for (i=0; i<nchunks; i++) if (len[i]) {
+            DRA[handle].zindex[i] = (Size_t)(len[i]-1);
+            any = 1;
+        }
+        free(len);
+        if (any) dai_write_zindex(DRA[handle].fname, d_a);
+    }
+
+    free(DRA[handle].zindex);
+    free(DRA[handle].zdirty);
+    DRA[handle].zindex = NULL;
+    DRA[handle].zdirty = NULL;
+}
+
+
+/**
+ * locate section ds_a within its chunk: return the chunk length in
+ * bytes, the chunk in ds_full, its index in *cr, and the offset and
+ * length of ds_a within it in *off and *bytes
+ */
+static Size_t ndai_zchunk(section_t ds_a, section_t *ds_full, Integer *cr,
+        Size_t *off, Size_t *bytes)
+{
+    Integer handle = ds_a.handle + DRA_OFFSET, i;
+    Integer ndim = DRA[handle].ndim;
+    Size_t elem = 1, raw;
+
+    *ds_full = ds_a;
+    for (i=0; i<ndim; i++) {
+        ds_full->lo[i] = ((ds_a.lo[i]-1)/DRA[handle].chunk[i])
+            * DRA[handle].chunk[i] + 1;
+        ds_full->hi[i] = PARIO_MIN(DRA[handle].dims[i],
+                ds_full->lo[i] + DRA[handle].chunk[i] - 1);
+        if (i<ndim-1 && (ds_a.lo[i] != ds_full->lo[i]
+                    || ds_a.hi[i] != ds_full->hi[i]))
+            dai_error("ndai_zchunk: section not aligned",ds_a.lo[i]);
+        if (i<ndim-1) elem *= (Size_t)(ds_full->hi[i]-ds_full->lo[i]+1);
+    }
+    nsect_to_blockM(*ds_full, cr);
+
+    elem *= dai_sizeofM(DRA[handle].type);
+    raw = elem * (Size_t)(ds_full->hi[ndim-1]-ds_full->lo[ndim-1]+1);
+    *off = elem * (Size_t)(ds_a.lo[ndim-1]-ds_full->lo[ndim-1]);
+    *bytes = elem * (Size_t)(ds_a.hi[ndim-1]-ds_a.lo[ndim-1]+1);
+    if (raw > (Size_t)DRA_BUF_SIZE) dai_error("ndai_zchunk: chunk too large",*cr);
+    return raw;
+}
+
+
+/**
+ * return the scratch space of buffer bi: room for a compressed chunk
+ * followed by room for a whole chunk
+ */
+static char *ndai_zbuf(buf_info *bi)
+{
+    if (!bi->zbuf && !(bi->zbuf = (char*) malloc(2*DRA_BUF_SIZE)))
+        dai_error("ndai_zbuf: no memory",0);
+    return bi->zbuf;
+}
+
+
+/**
+ * read the whole chunk ds_full of a compressed array into raw
+ */
+static void ndai_zload(buf_info *bi, section_t ds_full, Integer cr,
+        char *raw, Size_t bytes)
+{
+    Integer handle = ds_full.handle + DRA_OFFSET;
+    Size_t  zlen = DRA[handle].zindex[cr];
+    char   *zbuf = ndai_zbuf(bi);
+    Off_t   offset;
+    double  t0;
+
+    if (zlen == 0) {
+        memset(raw, 0, bytes);
+        return;
+    }
+    ndai_file_location(ds_full, &offset);
+    if (elio_read(DRA[handle].fd, offset, zlen == bytes ? raw : zbuf, zlen)
+            != zlen)
+        dai_error("ndai_zload: read failed",cr);
+    if (zlen == bytes) return;
+
+    t0 = pnga_wtime();
+    if (dai_decompress(zbuf, zlen, raw, bytes))
+        dai_error("ndai_zload: corrupt chunk",cr);
+    DRA[handle].ztime += pnga_wtime() - t0;
+}
+
+
+/**
+ * write section ds_a of a compressed array from buf: the whole chunk is
+ * compressed, after reading the rest of it if ds_a is only part of it,
+ * and written in place of the chunk
+ */
+void ndai_zput(buf_info *bi, section_t ds_a, char *buf, io_request_t *id)
+{
+    Integer handle = ds_a.handle + DRA_OFFSET, cr;
+    section_t ds_full;
+    Size_t  raw, off, bytes, zlen;
+    char   *zbuf = ndai_zbuf(bi), *src = buf;
+    Off_t   offset;
+    double  t0;
+
+    bi->zbytes = 0;
+    raw = ndai_zchunk(ds_a, &ds_full, &cr, &off, &bytes);
+    if (bytes < raw) {
+        src = zbuf + DRA_BUF_SIZE;
+        ndai_zload(bi, ds_full, cr, src, raw);
+        memcpy(src + off, buf, bytes);
+    }
+
+    t0 = pnga_wtime();
+    zlen = dai_compress(src, raw, DRA[handle].type, DRA[handle].zbits, zbuf);
+    DRA[handle].ztime += pnga_wtime() - t0;
+
+    ndai_file_location(ds_full, &offset);
+    if (ELIO_OK != elio_awrite(DRA[handle].fd, offset, zlen ? zbuf : src,
+                zlen ? zlen : raw, id))
+        dai_error("ndai_zput failed", ds_a.handle);
+
+    DRA[handle].zindex[cr] = zlen ? zlen : raw;
+    DRA[handle].zdirty[cr] = 1;
+    DRA[handle].zraw += raw;
+    DRA[handle].zdisk += zlen ? zlen : raw;
+}
+
+
+/**
+ * start reading section ds_a of a compressed array into buf; the data
+ * are ready after the request completes and ndai_zfinish is called
+ */
+void ndai_zget(buf_info *bi, section_t ds_a, char *buf, io_request_t *id)
+{
+    Integer handle = ds_a.handle + DRA_OFFSET, cr;
+    section_t ds_full;
+    Size_t  raw, off, bytes, zlen;
+    Off_t   offset;
+
+    bi->zbytes = 0;
+    raw = ndai_zchunk(ds_a, &ds_full, &cr, &off, &bytes);
+    zlen = DRA[handle].zindex[cr];
+    ndai_file_location(ds_full, &offset);
+
+    if (zlen == 0) {
+        /* never written */
+        memset(buf, 0, bytes);
+        *id = ELIO_DONE;
+        return;
+    }
+    if (zlen == raw) {
+        /* stored as is */
+        if (ELIO_OK != elio_aread(DRA[handle].fd, offset + (Off_t)off, buf,
+                    bytes, id))
+            dai_error("ndai_zget failed", ds_a.handle);
+        DRA[handle].zraw += bytes;
+        DRA[handle].zdisk += bytes;
+        return;
+    }
+
+    if (ELIO_OK != elio_aread(DRA[handle].fd, offset, ndai_zbuf(bi), zlen, id))
+        dai_error("ndai_zget failed", ds_a.handle);
+    bi->zbytes = zlen;
+    DRA[handle].zraw += raw;
+    DRA[handle].zdisk += zlen;
+}
+
+
+/**
+ * decompress the chunk read by ndai_zget, once the read has completed
+ */
+void ndai_zfinish(buf_info *bi, section_t ds_a, char *buf)
+{
+    Integer handle = ds_a.handle + DRA_OFFSET, cr;
+    section_t ds_full;
+    Size_t  raw, off, bytes;
+    char   *dst;
+    double  t0;
+
+    if (!bi->zbytes) return;
+
+    raw = ndai_zchunk(ds_a, &ds_full, &cr, &off, &bytes);
+    dst = (bytes == raw) ? buf : bi->zbuf + DRA_BUF_SIZE;
+
+    t0 = pnga_wtime();
+    if (dai_decompress(bi->zbuf, bi->zbytes, dst, raw))
+        dai_error("ndai_zfinish: corrupt chunk",cr);
+    DRA[handle].ztime += pnga_wtime() - t0;
+    if (dst != buf) memcpy(buf, dst + off, bytes);
+    bi->zbytes = 0;
+}
+
+
 /**
  * decompose section defined by lo and hi into aligned and unaligned DRA
  * subsections
@@ -2794,6 +3082,80 @@ int ndai_next_chunk(Integer req, Integer* list, section_t* ds_chunk)
 }
 
 
+/**
+ * read part ds_sect of the aligned chunk ds_chunk of a memory-mapped
+ * array: the data go to g_a straight from the mapping, without a copy
+ * into a DRA buffer
+ */
+void ndai_map_read(int transp, section_t gs_a, section_t ds_a,
+        section_t ds_chunk, section_t ds_sect)
+{
+    Integer handle = ds_a.handle+DRA_OFFSET, ndim = ds_a.ndim;
+    Integer chunk_ld[MAXDIM], offset, i;
+    Off_t   foffset;
+    char    *buffer;
+
+    ndai_file_location(ds_chunk, &foffset);
+    for (i=0; i<ndim-1; i++) chunk_ld[i] = ds_chunk.hi[i] - ds_chunk.lo[i] + 1;
+
+    /* determine location of ds_sect in the chunk */
+    offset = ds_sect.lo[ndim-1]-ds_chunk.lo[ndim-1];
+    for (i=ndim-2; i>=0; i--)  {
+        offset = offset*chunk_ld[i];
+        offset += ds_sect.lo[i] - ds_chunk.lo[i];
+    }
+    buffer = DRA[handle].map + (long)foffset
+        + offset * dai_sizeofM(DRA[handle].type);
+
+    nga_move(STORE, transp, gs_a, ds_a, ds_sect, buffer, chunk_ld, NULL);
+}
+
+
+/**
+ * start reading into memory the next chunk of list that this process
+ * will read from a memory-mapped array, so that the disk works ahead of
+ * the puts to g_a
+ */
+void ndai_map_advise(Integer req, Integer* list, section_t ds_chunk)
+{
+    Integer handle = ds_chunk.handle+DRA_OFFSET, elem, i;
+    Off_t   offset;
+
+    while(ndai_next_chunk(req, list, &ds_chunk)){
+        if(dai_myturn(ds_chunk)){
+            ndai_file_location(ds_chunk, &offset);
+            elem = 1;
+            for (i=0; i<ds_chunk.ndim; i++) elem *= (ds_chunk.hi[i]-ds_chunk.lo[i]+1);
+            elio_advise(DRA[handle].map + (long)offset,
+                    (Size_t) elem * dai_sizeofM(DRA[handle].type));
+            return;
+        }
+    }
+}
+
+
+/**
+ * start the disk write of an aligned chunk once its data has arrived from
+ * the global array; the write was deferred so that the get of the next
+ * chunk could be issued first
+ */
+void dai_issue_put(char *buf)
+{
+    buf_info *bi = (buf_info*) buf;
+
+    if (buf == NULL || bi->callback == OFF) return;
+    bi->callback = OFF;
+
+    pnga_nbwait(&(bi->ga_movhdl));
+    if (DRA[bi->args.ds_chunk.handle+DRA_OFFSET].compress)
+        ndai_zput(bi, bi->args.ds_chunk, buf + sizeof(buf_info),
+                &(bi->io_req));
+    else
+        ndai_put(bi->args.ds_chunk, buf + sizeof(buf_info), bi->args.ld,
+                &(bi->io_req));
+}
+
+
 /**
  * function to complete an operation and release the buffer associated
  * with a buffer id
@@ -2819,6 +3181,7 @@ void wait_buf(char *buf)
 
     switch(op_code) {
         case DRA_OP_WRITE:
+            dai_issue_put(buf);
             elio_wait(io_req);
             break;
 
@@ -2924,6 +3287,11 @@ void ndai_transfer_unlgn(
                 if(!dai_section_intersect(ds_chunk, &ds_unlg))
                     dai_error("ndai_transfer_unlgn: inconsistent cover", 0);
 
+                if(opcode == DRA_OP_READ && DRA[ds_a.handle+DRA_OFFSET].map){
+                    ndai_map_read(transp, gs_a, ds_a, ds_chunk, ds_unlg);
+                    continue;
+                }
+
                 /* copy data from disk to DRA buffer */
                 for (i=0; i<ndim-1; i++) chunk_ld[i] = ds_chunk.hi[i] - ds_chunk.lo[i] + 1;
                 /* get a free buffer */
@@ -2933,11 +3301,18 @@ void ndai_transfer_unlgn(
                 io_req = &(bi->io_req);
                 ga_movhdl = &(bi->ga_movhdl);
                 bi->align = 0;
+                bi->callback = OFF;
 
                 buf = (char*) (buf + sizeof(buf_info));
 
-                ndai_get(ds_chunk, buf, chunk_ld, io_req);
-                elio_wait(io_req); 
+                if(DRA[ds_a.handle+DRA_OFFSET].compress){
+                    ndai_zget(bi, ds_chunk, buf, io_req);
+                    elio_wait(io_req);
+                    ndai_zfinish(bi, ds_chunk, buf);
+                }else{
+                    ndai_get(ds_chunk, buf, chunk_ld, io_req);
+                    elio_wait(io_req); 
+                }
                 /* determine location in the buffer where GA data should be */
                 offset = ds_unlg.lo[ndim-1]-ds_chunk.lo[ndim-1];
                 for (i=ndim-2; i>=0; i--)  {
@@ -2955,7 +3330,10 @@ void ndai_transfer_unlgn(
                         pnga_nbwait(ga_movhdl);
 
                         /* write ENTIRE updated buffer back to disk */
-                        ndai_put(ds_chunk, buf, chunk_ld, io_req);
+                        if(DRA[ds_a.handle+DRA_OFFSET].compress)
+                            ndai_zput(bi, ds_chunk, buf, io_req);
+                        else
+                            ndai_put(ds_chunk, buf, chunk_ld, io_req);
 
                         break;
 
@@ -2998,7 +3376,7 @@ void ndai_transfer_algn(
     Integer  next, chunk_ld[MAXDIM], ndim = ds_a.ndim;
     Integer i;
     section_t ds_chunk = ds_a;
-    char *buf, *buffer;
+    char *buf, *buffer, *pending = NULL;
     Integer *ga_movhdl;
     io_request_t *io_req;
     buf_info *bi;
@@ -3019,6 +3397,12 @@ void ndai_transfer_algn(
 
             if(dai_myturn(ds_chunk)){
 
+                if(opcode == DRA_OP_READ && DRA[ds_a.handle+DRA_OFFSET].map){
+                    ndai_map_advise(req, Requests[req].list_algn[next], ds_chunk);
+                    ndai_map_read(transp, gs_a, ds_a, ds_chunk, ds_chunk);
+                    continue;
+                }
+
                 for (i=0; i<ndim-1; i++) chunk_ld[i] = ds_chunk.hi[i] - ds_chunk.lo[i] + 1;
                 /* get a free buffer */
                 buf = get_buf(&buf_ctxt, Requests[req].call_id);
@@ -3036,19 +3420,23 @@ void ndai_transfer_algn(
 
                     case DRA_OP_WRITE:
                         bi->op = DRA_OP_WRITE;
-                        /* copy data from g_a to DRA buffer */
+                        /* start copying data from g_a to DRA buffer */
                         nga_move(LOAD, transp, gs_a, ds_a, ds_chunk, buf, chunk_ld, ga_movhdl);
-                        pnga_nbwait(ga_movhdl);
+                        dai_callback(LOAD, transp, gs_a, ds_a, ds_chunk, chunk_ld, buffer, req);
 
-                        /* copy data from DRA buffer to disk */
-                        ndai_put(ds_chunk, buf, chunk_ld, io_req);
+                        /* while it is in flight, write the previous chunk */
+                        dai_issue_put(pending);
+                        pending = buffer;
 
                         break;
 
                     case DRA_OP_READ:
                         bi->op = DRA_OP_READ;
                         /* copy data from disk to DRA buffer */
-                        ndai_get(ds_chunk, buf, chunk_ld, io_req);
+                        if(DRA[ds_a.handle+DRA_OFFSET].compress)
+                            ndai_zget(bi, ds_chunk, buf, io_req);
+                        else
+                            ndai_get(ds_chunk, buf, chunk_ld, io_req);
 
                         /* copy data from DRA buffer to g_a */
                         /* nga_move(STORE, transp, gs_a, ds_a, ds_chunk, buf, chunk_ld, ga_movhdl); */
@@ -3070,6 +3458,7 @@ void ndai_transfer_algn(
             }
         }
     }
+    dai_issue_put(pending);
     /*
        returning from this function leaving some outstanding operations,
        so that dra_read()/write() can be non-blocking to some extent. we will 
@@ -3613,8 +4002,17 @@ void FATR dra_print_internals_(Integer *d_a)
     Integer handle = *d_a + DRA_OFFSET;
     Integer ndim = DRA[handle].ndim;
     Integer me = pnga_nodeid();
+    double zstat[3];
     dims = DRA[handle].dims;
     chunks = DRA[handle].chunk;
+
+    /* compression statistics are summed over I/O processes */
+    if (DRA[handle].compress) {
+        zstat[0] = DRA[handle].zraw;
+        zstat[1] = DRA[handle].zdisk;
+        zstat[2] = DRA[handle].ztime;
+        pnga_gop(C_DBL, zstat, 3, "+");
+    }
     if (me == 0) {
         printf("Internal Data for DRA: %s\n",DRA[handle].name);
         printf("  DRA Metafile Name: %s\n",DRA[handle].fname);
@@ -3679,6 +4077,17 @@ void FATR dra_print_internals_(Integer *d_a)
         printf("  Number files used for DRA: %d\n",(int)DRA[handle].numfiles);
         printf("  Number IO processors used for DRA: %d\n",
                 (int)DRA[handle].ioprocs);
+        if (DRA[handle].compress) {
+            if (DRA[handle].zbits)
+                printf("  DRA is compressed, keeping %d mantissa bits\n",
+                        DRA[handle].zbits);
+            else
+                printf("  DRA is compressed without loss\n");
+            printf("  Bytes transferred: %.3e raw, %.3e on disk (ratio %.2f)\n",
+                    zstat[0], zstat[1], zstat[1] > 0 ? zstat[0]/zstat[1] : 0.);
+            printf("  Codec throughput: %.1f MB/s (%.3f s)\n",
+                    zstat[2] > 0 ? 1e-6*zstat[0]/zstat[2] : 0., zstat[2]);
+        }
     }
 }
 
@@ -3695,6 +4104,19 @@ void FATR dra_set_default_config_(Integer *numfiles, Integer *numioprocs)
 }
 
 
+/**
+ * SELECT COMPRESSION OF DRAs CREATED FROM NOW ON
+ *
+ * @param flag[in] compress chunks or not
+ * @param bits[in] mantissa bits kept by floating-point data, 0 = lossless
+ */
+void FATR dra_set_compression_(logical *flag, Integer *bits)
+{
+    _dra_compress = (*flag) ? 1 : 0;
+    _dra_zbits = (*bits > 0) ? (int)*bits : 0;
+}
+
+
 /**
  * SET DEBUG FLAG FOR DRA OPERATIONS TO TRUE OR FALSE
  */
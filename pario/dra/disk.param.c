@@ -21,6 +21,7 @@
 #define HD_NAME_EXT_LEN 10
 #define HDLEN           80 
 #define HD_EXT          ".info"
+#define ZX_EXT          ".zidx"
 
 /**
  * check file configuration: shared or independent files are used
@@ -126,6 +127,15 @@ int dai_read_param(char* filename,Integer d_a)
             fgets(dummy,HDLEN,fd); /*advance to next line*/
             if(!fgets(DRA[dra_hndl].name,DRA_MAX_NAME,fd))dai_error("dai_read_param:name",0);
 
+            /* compression was added later, older files have none */
+            DRA[dra_hndl].compress = 0;
+            DRA[dra_hndl].zbits = 0;
+            if(fscanf(fd,"%ld",&input) == 1){
+                DRA[dra_hndl].compress = (int) input;
+                if(!fscanf(fd,"%ld",&input)) dai_error("dai_read_param:zbits",0);
+                DRA[dra_hndl].zbits = (int) input;
+            }
+
             if(fclose(fd))dai_error("dai_read_param: fclose failed",0);
         }else rc = -1;
     }
@@ -193,6 +203,9 @@ void dai_write_param(char* filename, Integer d_a)
 
         if(!fprintf(fd,"\n%s\n",DRA[dra_hndl].name))
             dai_error("dai_write_param:name",0);
+        if(DRA[dra_hndl].compress && !fprintf(fd,"%d %d\n",
+                    DRA[dra_hndl].compress, DRA[dra_hndl].zbits))
+            dai_error("dai_write_param:compress",0);
 
         if(fclose(fd))dai_error("dai_write_param: fclose failed",0);
     }
@@ -224,3 +237,79 @@ void dai_delete_param(char* filename,Integer d_a)
         if(unlink(param_filename)) dai_error("dai_delete_param failed",d_a);
     }
 }
+
+
+/**
+ * Build name of the chunk index file of a compressed disk array
+ */
+static void dai_zindex_name(char* filename, char* index_filename)
+{
+    Integer len = strlen(filename);
+
+    if(len+HD_NAME_EXT_LEN >= MAX_HD_NAME_LEN)
+        dai_error("dai_zindex_name: filename too long:",len);
+    strcpy(index_filename,filename);
+    strcat(index_filename,ZX_EXT);
+}
+
+
+/**
+ * Retrieve the chunk index of a compressed disk array from the disk;
+ * an array that was never written has no index file
+ */
+void dai_read_zindex(char* filename, Integer d_a)
+{
+    FILE *fd;
+    char index_filename[MAX_HD_NAME_LEN];
+    Integer me=pnga_nodeid(), dra_hndl=d_a+DRA_OFFSET;
+    Integer brd_type=DRA_BRD_TYPE, orig=0;
+    Integer nchunks=DRA[dra_hndl].nchunks;
+
+    if(!me){ /* only process 0 reads index file */
+        dai_zindex_name(filename, index_filename);
+        if((fd=fopen(index_filename,"rb"))){
+            if(fread(DRA[dra_hndl].zindex, sizeof(Size_t), (size_t)nchunks, fd)
+                    != (size_t)nchunks)
+                dai_error("dai_read_zindex: index too short",nchunks);
+            if(fclose(fd))dai_error("dai_read_zindex: fclose failed",0);
+        }
+    }
+
+    pnga_brdcst(brd_type, DRA[dra_hndl].zindex, nchunks*sizeof(Size_t), orig);
+}
+
+
+/**
+ * Store the chunk index of a compressed disk array on the disk
+ */
+void dai_write_zindex(char* filename, Integer d_a)
+{
+    FILE *fd;
+    char index_filename[MAX_HD_NAME_LEN];
+    Integer me=pnga_nodeid(), dra_hndl=d_a+DRA_OFFSET;
+    Integer nchunks=DRA[dra_hndl].nchunks;
+
+    if(!me){ /* only process 0 writes index file */
+        dai_zindex_name(filename, index_filename);
+        if(!(fd=fopen(index_filename,"wb")))
+            dai_error("dai_write_zindex: open failed",0);
+        if(fwrite(DRA[dra_hndl].zindex, sizeof(Size_t), (size_t)nchunks, fd)
+                != (size_t)nchunks)
+            dai_error("dai_write_zindex: write failed",nchunks);
+        if(fclose(fd))dai_error("dai_write_zindex: fclose failed",0);
+    }
+}
+
+
+/**
+ * Delete chunk index file
+ */
+void dai_delete_zindex(char* filename, Integer d_a)
+{
+    char index_filename[MAX_HD_NAME_LEN];
+
+    if(!pnga_nodeid()){
+        dai_zindex_name(filename, index_filename);
+        (void) unlink(index_filename);
+    }
+}
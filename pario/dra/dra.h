@@ -79,6 +79,8 @@ extern void DRA_Print_internals(    int d_a);
 
 extern void DRA_Set_default_config(    int numfiles, int numioprocs);
 
+extern void DRA_Set_compression(    logical flag, int bits);
+
 extern int DRA_Wait(          int request);
 
 extern int DRA_Delete(        int d_a);
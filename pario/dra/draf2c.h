@@ -13,6 +13,7 @@
 #define dra_probe_           F77_FUNC_(dra_probe,DRA_PROBE)
 #define dra_read_            F77_FUNC_(dra_read,DRA_READ)
 #define dra_read_section_    F77_FUNC_(dra_read_section,DRA_READ_SECTION)
+#define dra_set_compression_ F77_FUNC_(dra_set_compression,DRA_SET_COMPRESSION)
 #define dra_set_debug_       F77_FUNC_(dra_set_debug,DRA_SET_DEBUG)
 #define dra_set_default_config_ F77_FUNC_(dra_set_default_config,DRA_SET_DEFAULT_CONFIG)
 #define dra_terminate_       F77_FUNC_(dra_terminate,DRA_TERMINATE)
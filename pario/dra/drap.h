@@ -41,6 +41,16 @@ typedef struct {                 /**< stores basic DRA info */
     Fd_t fd;                     /**< ELIO meta-file descriptor */
     Integer numfiles;            /**< # files on open file system */
     Integer ioprocs;             /**< number of IO procs per node */
+    char *map;                   /**< read-only mapping of file or NULL */
+    Size_t maplen;               /**< length of mapping */
+    int compress;                /**< are chunks compressed ? */
+    int zbits;                   /**< mantissa bits kept, 0 = lossless */
+    Integer nchunks;             /**< # chunks in compressed array */
+    Size_t *zindex;              /**< compressed length of each chunk */
+    char *zdirty;                /**< chunks written since open */
+    double zraw;                 /**< raw bytes through the codec */
+    double zdisk;                /**< compressed bytes through the codec */
+    double ztime;                /**< seconds spent in the codec */
 } disk_array_t;
 
 #define MAX_ALGN  1                /**< max # aligned subsections   */ 
@@ -83,6 +93,8 @@ typedef struct {
     args_t args;
     int align;
     int callback;
+    char *zbuf;         /**< compressed data, for compressed arrays */
+    Size_t zbytes;      /**< compressed bytes being read into zbuf */
 } buf_info;
 
 extern disk_array_t *DRA;
@@ -98,8 +110,20 @@ extern int     dai_read_param(char* filename, Integer d_a);
 extern void    dai_write_param(char* filename, Integer d_a);
 extern void    dai_delete_param(char* filename, Integer d_a);
 extern int     dai_file_config(char* filename);
+extern void    dai_read_zindex(char* filename, Integer d_a);
+extern void    dai_write_zindex(char* filename, Integer d_a);
+extern void    dai_delete_zindex(char* filename, Integer d_a);
 extern logical dai_section_intersect(section_t sref, section_t* sadj);
 extern int     drai_get_num_serv(void);
+extern int     drai_get_num_buf(void);
+extern int     drai_get_mmap(void);
+
+/* chunk codec for compressed arrays */
+#define DAI_ZHDR 8 /**< bytes of header in front of compressed chunk */
+extern Size_t  dai_compress(const char *src, Size_t bytes, int type, int bits,
+        char *dst);
+extern int     dai_decompress(const char *src, Size_t zbytes, char *dst,
+        Size_t bytes);
 
 /* internal fortran calls */
 extern Integer drai_create(Integer *type, Integer *dim1, Integer *dim2, 
@@ -206,6 +230,8 @@ extern void FATR dra_set_debug_(logical *flag);
 extern void FATR dra_set_default_config_(Integer *numfiles, 
         Integer *numioprocs);
 
+extern void FATR dra_set_compression_(logical *flag, Integer *bits);
+
 extern Integer FATR dra_delete_(Integer* d_a);
 
 extern Integer FATR dra_close_(Integer* d_a);
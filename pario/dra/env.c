@@ -16,6 +16,8 @@
 #   include <string.h>
 #endif
 
+#include "buffers.h"
+
 #define MAX_NUM_SERV 64
 
 /**
@@ -34,3 +36,36 @@ int drai_get_num_serv()
     }
     return val;
 }  
+
+
+/**
+ * get number of I/O buffers from optional environmental variable
+ * DRA_NUM_BUFFERS; more buffers keep more transfers in flight
+ */
+int drai_get_num_buf()
+{
+    int  val=-1;
+    char *str;
+
+    str = getenv("DRA_NUM_BUFFERS");
+    if(str==NULL)val = 0;
+    else{
+        val = atoi(str);
+        if(val<1 || val >MAXBUF)val =0;
+    }
+    return val;
+}
+
+
+/**
+ * check optional environmental variable DRA_MMAP, which selects
+ * memory-mapped reads of arrays opened read-only
+ */
+int drai_get_mmap()
+{
+    char *str;
+
+    str = getenv("DRA_MMAP");
+    if(str==NULL)return 0;
+    return atoi(str) != 0;
+}
@@ -0,0 +1,171 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#if HAVE_STDIO_H
+#   include <stdio.h>
+#endif
+#if HAVE_STDLIB_H
+#   include <stdlib.h>
+#endif
+
+#define BASE_NAME "dra_mmapc.file"
+#ifdef  HPIODIR
+#   define FNAME HPIODIR/*BASE_NAME*/
+#else
+#   define FNAME BASE_NAME
+#endif
+
+#define N 60        /* dimension of test array */
+#define TRUE (logical)1
+#define FALSE (logical)0
+
+#include "dra.h"
+#include "ga.h"
+#include "macdecls.h"
+#include "mp3.h"
+
+/* value of element (i,j) of the test array */
+#define VALUE(i,j) ((double)((i)*N+(j)+1))
+
+static void fill(int g_a)
+{
+    int me = GA_Nodeid(), lo[2], hi[2], ld[1], i, j;
+    double *p;
+
+    NGA_Distribution(g_a, me, lo, hi);
+    if (lo[0] > hi[0] || lo[1] > hi[1]) return;
+    NGA_Access(g_a, lo, hi, &p, ld);
+    for (i=lo[0]; i<=hi[0]; i++)
+        for (j=lo[1]; j<=hi[1]; j++)
+            p[(i-lo[0])*ld[0]+(j-lo[1])] = VALUE(i,j);
+    NGA_Release_update(g_a, lo, hi);
+}
+
+/* g_b must equal g_a in the patch lo:hi; g_b is overwritten */
+static void compare(int g_a, int g_b, int *lo, int *hi, char *what)
+{
+    double plus = 1.0, minus = -1.0, err;
+
+    NGA_Add_patch(&plus, g_a, lo, hi, &minus, g_b, lo, hi, g_b, lo, hi);
+    err = NGA_Ddot_patch(g_b, 'n', lo, hi, g_b, 'n', lo, hi);
+    if (err != 0.0) GA_Error(what, (int)err);
+}
+
+static void open_array(char *fname, int mode, int *d_a)
+{
+    if (DRA_Open(fname, mode, d_a) != 0) GA_Error("DRA_Open failed", mode);
+}
+
+static void wait_request(int req)
+{
+    if (DRA_Wait(req) != 0) GA_Error("DRA_Wait failed", req);
+}
+
+
+/* Write an array to disk and read it back from a read-only open, whole
+ * and in an unaligned section, then change part of it through a
+ * read-write open and read it back again.  With DRA_MMAP set the reads
+ * come from a mapping of the file; with DRA_MMAP=0 they are buffered. */
+void do_work()
+{
+    int g_a, g_b, d_a, req;
+    int me = GA_Nodeid();
+    int dims[2], lo[2], hi[2];
+    dra_size_t ddims[2], reqdim[2], dlo[2], dhi[2];
+    double minus = -1.0;
+    char fname[200];
+
+    dims[0] = dims[1] = N;
+    g_a = NGA_Create(C_DBL, 2, dims, "A", NULL);
+    g_b = NGA_Create(C_DBL, 2, dims, "B", NULL);
+    if (!g_a || !g_b) GA_Error("NGA_Create failed", 0);
+    fill(g_a);
+
+    sprintf(fname, "%s", FNAME);
+    ddims[0] = ddims[1] = N;
+    reqdim[0] = N/3;
+    reqdim[1] = N;
+    if (NDRA_Create(MT_DBL, 2, ddims, "A", fname, DRA_W, reqdim, &d_a) != 0)
+        GA_Error("NDRA_Create failed", 0);
+    if (NDRA_Write(g_a, d_a, &req) != 0) GA_Error("NDRA_Write failed", 0);
+    wait_request(req);
+    if (DRA_Close(d_a) != 0) GA_Error("DRA_Close failed", d_a);
+
+    /* read the whole array and an unaligned section */
+    open_array(fname, DRA_R, &d_a);
+    GA_Zero(g_b);
+    if (NDRA_Read(g_b, d_a, &req) != 0) GA_Error("NDRA_Read failed", 0);
+    wait_request(req);
+    lo[0] = lo[1] = 0;
+    hi[0] = hi[1] = N-1;
+    compare(g_a, g_b, lo, hi, "NDRA_Read comparison failed");
+    if (me == 0) printf("Completed test of NDRA_Read\n");
+
+    lo[0] = 3; hi[0] = N-5;
+    lo[1] = 7; hi[1] = N/2;
+    dlo[0] = lo[0]; dhi[0] = hi[0];
+    dlo[1] = lo[1]; dhi[1] = hi[1];
+    GA_Zero(g_b);
+    if (NDRA_Read_section(FALSE, g_b, lo, hi, d_a, dlo, dhi, &req) != 0)
+        GA_Error("NDRA_Read_section failed", 0);
+    wait_request(req);
+    compare(g_a, g_b, lo, hi, "NDRA_Read_section comparison failed");
+    if (DRA_Close(d_a) != 0) GA_Error("DRA_Close failed", d_a);
+    if (me == 0) printf("Completed test of NDRA_Read_section\n");
+
+    /* change a band of rows on disk, then read everything back */
+    lo[0] = N/4; hi[0] = N/2;
+    lo[1] = 0;   hi[1] = N-1;
+    NGA_Scale_patch(g_a, lo, hi, &minus);
+    dlo[0] = lo[0]; dhi[0] = hi[0];
+    dlo[1] = lo[1]; dhi[1] = hi[1];
+    open_array(fname, DRA_RW, &d_a);
+    if (NDRA_Write_section(FALSE, g_a, lo, hi, d_a, dlo, dhi, &req) != 0)
+        GA_Error("NDRA_Write_section failed", 0);
+    wait_request(req);
+    if (DRA_Close(d_a) != 0) GA_Error("DRA_Close failed", d_a);
+
+    open_array(fname, DRA_R, &d_a);
+    GA_Zero(g_b);
+    if (NDRA_Read(g_b, d_a, &req) != 0) GA_Error("NDRA_Read failed", 0);
+    wait_request(req);
+    lo[0] = lo[1] = 0;
+    hi[0] = hi[1] = N-1;
+    compare(g_a, g_b, lo, hi, "read back of changed array failed");
+    if (DRA_Delete(d_a) != 0) GA_Error("DRA_Delete failed", 0);
+    if (me == 0) printf("Completed test of read back after a change\n");
+
+    GA_Destroy(g_b);
+    GA_Destroy(g_a);
+}
+
+
+int main(int argc, char **argv)
+{
+    int me;
+    int max_arrays = 10;
+    int stack=80000, heap=80000;
+    double max_sz=100000000.0, max_disk=10000000000.0, max_mem=1000000.0;
+
+    MP_INIT(argc,argv);
+    if(MA_init(MT_DBL, stack, heap) ) {
+        GA_Initialize();
+        me    = GA_Nodeid();
+        /* map read-only arrays unless DRA_MMAP says otherwise */
+        setenv("DRA_MMAP", "1", 0);
+        if (DRA_Init(max_arrays, max_sz, max_disk, max_mem) != 0)
+            GA_Error("DRA_Init failed: ",0);
+        if (me == 0) printf("Using %s reads\n",
+                atoi(getenv("DRA_MMAP")) ? "memory-mapped" : "buffered");
+        do_work();
+        if (me == 0) printf("All tests successful\n");
+        (void) DRA_Terminate();
+        GA_Terminate();
+    } else {
+        printf("MA_init failed\n");
+    }
+    MP_FINALIZE();
+
+    return 0;
+}
@@ -615,6 +615,240 @@ void test_io_dbl()
 }
 
 
+/**
+ * Aligned write and read bandwidth against the number of I/O servers.
+ * Each pass stripes the array over nserv files, one per I/O process.
+ */
+void test_io_scaling()
+{
+    int ndim = NDIM;
+    double err, tt0, tt1, mbytes, wrate, rrate;
+    int g_a, g_b, d_a;
+    int i, req, nserv;
+    dra_size_t n;
+    dra_size_t ddims[MAXDIM], reqdims[MAXDIM];
+    int glo[MAXDIM],ghi[MAXDIM];
+    int dims[MAXDIM];
+    int me, nproc, isize;
+    double plus, minus;
+    double *index;
+    int ld[MAXDIM], chunk[MAXDIM];
+    char filename[80];
+
+    n = SIZE;
+    req = -1;
+    nproc = GA_Nnodes();
+    me    = GA_Nodeid();
+
+    for (i=0; i<ndim; i++) {
+        dims[i] = n;
+        chunk[i] = 1;
+        ddims[i] = n;
+        reqdims[i] = n;
+    }
+    g_a = NGA_Create(MT_DBL, ndim, dims, "a", chunk);
+    if (!g_a) GA_Error("NGA_Create failed: a", 0);
+    g_b = NGA_Create(MT_DBL, ndim, dims, "b", chunk);
+    if (!g_b) GA_Error("NGA_Create failed: b", 0);
+
+    GA_Sync();
+    NGA_Distribution(g_a, me, glo, ghi);
+    NGA_Access(g_a, glo, ghi, &index, ld);
+    isize = 1;
+    for (i=0; i<ndim; i++) isize *= (ghi[i]-glo[i]+1);
+    fill_random(index, isize);
+    GA_Sync();
+
+    plus = 1.0;
+    minus = -1.0;
+    mbytes = 1.e-6 * (double)(pow(n,ndim)*sizeof(double));
+    if (me == 0) {
+        printf("aligned blocking I/O of %.2f MB against I/O servers\n", mbytes);
+        printf(" servers   write MB/s    read MB/s\n");
+    }
+
+    for (nserv = 1; nserv <= nproc; nserv *= 2) {
+        DRA_Set_default_config(nserv, nserv);
+        filename_check(filename, FNAME, FNAME_ALT);
+        if (NDRA_Create(MT_DBL, ndim, ddims, "A", filename, DRA_RW,
+                    reqdims, &d_a) != 0) {
+            GA_Error("NDRA_Create failed(d_a): ",nserv);
+        }
+
+        GA_Sync();
+        tt0 = MP_TIMER();
+        if (NDRA_Write(g_a, d_a, &req) != 0) GA_Error("NDRA_Write failed(d_a):",0);
+        if (DRA_Wait(req) != 0) GA_Error("DRA_Wait failed(d_a): ",req);
+        tt1 = MP_TIMER() - tt0;
+        GA_Dgop(&tt1,1,"+");
+        wrate = mbytes/(tt1/((double)nproc));
+
+        GA_Zero(g_b);
+        GA_Sync();
+        tt0 = MP_TIMER();
+        if (NDRA_Read(g_b, d_a, &req) != 0) GA_Error("NDRA_Read failed:",0);
+        if (DRA_Wait(req) != 0) GA_Error("DRA_Wait failed: ",req);
+        tt1 = MP_TIMER() - tt0;
+        GA_Dgop(&tt1,1,"+");
+        rrate = mbytes/(tt1/((double)nproc));
+
+        GA_Add(&plus, g_a, &minus, g_b, g_b);
+        err = GA_Ddot(g_b, g_b);
+        if (me == 0) {
+            printf("%8d %12.3f %12.3f%s\n", nserv, wrate, rrate,
+                    err != 0 ? "  ERROR" : "");
+            fflush(stdout);
+        }
+        if (DRA_Delete(d_a) != 0) GA_Error("DRA_Delete failed",0);
+    }
+
+    GA_Destroy(g_a);
+    GA_Destroy(g_b);
+}
+
+
+/**
+ * Smooth data, zero in the upper half of the last dimension, written and
+ * read through raw, lossless and lossy compressed arrays.  The lossless
+ * array is reopened before it is read, and a section not aligned on
+ * chunks is written and read back.
+ */
+void test_io_compress()
+{
+    int ndim = NDIM;
+    double err, norm, tt0, tt1, mbytes, wrate, rrate;
+    int g_a, g_b, g_c, d_a;
+    int i, j, k, req, mode, isize;
+    dra_size_t n;
+    dra_size_t ddims[MAXDIM], reqdims[MAXDIM], dlo[MAXDIM], dhi[MAXDIM];
+    int glo[MAXDIM],ghi[MAXDIM];
+    int dims[MAXDIM];
+    int me, nproc;
+    double plus, minus;
+    double *index;
+    int ld[MAXDIM], chunk[MAXDIM];
+    char filename[80];
+    static const int bits[3] = {-1, 0, 20};
+    static const char *label[3] = {"raw", "lossless", "lossy/20"};
+
+    n = SIZE;
+    req = -1;
+    nproc = GA_Nnodes();
+    me    = GA_Nodeid();
+
+    for (i=0; i<ndim; i++) {
+        dims[i] = n;
+        chunk[i] = 1;
+        ddims[i] = n;
+        reqdims[i] = n;
+    }
+    g_a = NGA_Create(MT_DBL, ndim, dims, "a", chunk);
+    if (!g_a) GA_Error("NGA_Create failed: a", 0);
+    g_b = NGA_Create(MT_DBL, ndim, dims, "b", chunk);
+    if (!g_b) GA_Error("NGA_Create failed: b", 0);
+
+    /* a = sin of the position, zero in the upper half of dimension 0 */
+    GA_Sync();
+    NGA_Distribution(g_a, me, glo, ghi);
+    NGA_Access(g_a, glo, ghi, &index, ld);
+    isize = 1;
+    for (i=0; i<ndim; i++) isize *= (ghi[i]-glo[i]+1);
+    for (j=0; j<isize; j++) {
+        double x = 0.0;
+        int rem = j, ext;
+        for (i=ndim-1; i>=0; i--) {
+            ext = ghi[i]-glo[i]+1;
+            k = glo[i] + rem%ext;
+            rem /= ext;
+            x += (i+1)*k;
+        }
+        index[j] = (k < n/2) ? sin(1.e-3*x) : 0.0;
+    }
+    NGA_Release_update(g_a, glo, ghi);
+    GA_Sync();
+    norm = GA_Ddot(g_a, g_a);
+
+    plus = 1.0;
+    minus = -1.0;
+    mbytes = 1.e-6 * (double)(pow(n,ndim)*sizeof(double));
+    if (me == 0) {
+        printf("compressed I/O of %.2f MB of smooth, half zero data\n", mbytes);
+        printf(" mode        write MB/s    read MB/s   rel. error\n");
+    }
+
+    for (mode = 0; mode < 3; mode++) {
+        DRA_Set_compression(bits[mode] >= 0, bits[mode]);
+        filename_check(filename, FNAME, FNAME_ALT);
+        if (NDRA_Create(MT_DBL, ndim, ddims, "A", filename, DRA_RW,
+                    reqdims, &d_a) != 0) {
+            GA_Error("NDRA_Create failed(d_a): ",mode);
+        }
+
+        GA_Sync();
+        tt0 = MP_TIMER();
+        if (NDRA_Write(g_a, d_a, &req) != 0) GA_Error("NDRA_Write failed(d_a):",0);
+        if (DRA_Wait(req) != 0) GA_Error("DRA_Wait failed(d_a): ",req);
+        tt1 = MP_TIMER() - tt0;
+        GA_Dgop(&tt1,1,"+");
+        wrate = mbytes/(tt1/((double)nproc));
+
+        if (mode == 1) {
+            if (DRA_Close(d_a) != 0) GA_Error("DRA_Close failed",0);
+            if (DRA_Open(filename, DRA_R, &d_a) != 0)
+                GA_Error("DRA_Open failed",0);
+        }
+
+        GA_Zero(g_b);
+        GA_Sync();
+        tt0 = MP_TIMER();
+        if (NDRA_Read(g_b, d_a, &req) != 0) GA_Error("NDRA_Read failed:",0);
+        if (DRA_Wait(req) != 0) GA_Error("DRA_Wait failed: ",req);
+        tt1 = MP_TIMER() - tt0;
+        GA_Dgop(&tt1,1,"+");
+        rrate = mbytes/(tt1/((double)nproc));
+
+        GA_Add(&plus, g_a, &minus, g_b, g_b);
+        err = sqrt(GA_Ddot(g_b, g_b)/norm);
+        if (me == 0) {
+            printf(" %-10s %12.3f %12.3f %12.2e%s\n", label[mode], wrate,
+                    rrate, err, (mode < 2 ? err != 0 : err > 1.e-5) ?
+                    "  ERROR" : "");
+            fflush(stdout);
+        }
+
+        /* a section off chunk boundaries goes through partial chunks */
+        if (mode == 2) {
+            for (i=0; i<ndim; i++) {
+                dlo[i] = glo[i] = n/3;
+                dhi[i] = ghi[i] = n - n/4;
+            }
+            g_c = GA_Duplicate(g_a, "c");
+            GA_Copy(g_a, g_c);
+            NGA_Zero_patch(g_c, glo, ghi);
+            if (NDRA_Write_section(FALSE, g_c, glo, ghi, d_a, dlo, dhi, &req)
+                    != 0) GA_Error("NDRA_Write_section failed:",0);
+            if (DRA_Wait(req) != 0) GA_Error("DRA_Wait failed: ",req);
+            if (NDRA_Read(g_b, d_a, &req) != 0) GA_Error("NDRA_Read failed:",0);
+            if (DRA_Wait(req) != 0) GA_Error("DRA_Wait failed: ",req);
+            GA_Add(&plus, g_c, &minus, g_b, g_b);
+            err = sqrt(GA_Ddot(g_b, g_b)/norm);
+            if (me == 0) {
+                printf(" section    %25s %12.2e%s\n", "", err,
+                        err > 1.e-5 ? "  ERROR" : "");
+                fflush(stdout);
+            }
+            GA_Destroy(g_c);
+        }
+        if (mode == 2) DRA_Print_internals(d_a);
+        if (DRA_Delete(d_a) != 0) GA_Error("DRA_Delete failed",0);
+    }
+    DRA_Set_compression(FALSE, 0);
+
+    GA_Destroy(g_a);
+    GA_Destroy(g_b);
+}
+
+
 int main(int argc, char **argv)
 {
     int status, me;
@@ -662,6 +896,10 @@ int main(int argc, char **argv)
         if (me == 0) printf("TESTING PERFORMANCE OF DISK ARRAYS\n");
         if (me == 0) printf("\n");
         test_io_dbl();
+        if (me == 0) printf("\n");
+        test_io_scaling();
+        if (me == 0) printf("\n");
+        test_io_compress();
         status = DRA_Terminate();
         GA_Terminate();
     } else {
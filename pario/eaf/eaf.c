@@ -60,6 +60,7 @@
 #include "elio.h"
 #include "eaf.h"
 #include "eafP.h"
+#include "eaf_cache.h"
 #include "macdecls.h"
 
 #ifdef OPEN_MAX
@@ -73,6 +74,7 @@ static int eafhack_openfiles=0;
 static struct {
     char *fname;      /**< Filename --- if non-null is active*/
     Fd_t elio_fd;     /**< ELIO file descriptor */
+    eaf_cache_t *cache; /**< block cache, NULL if not cached */
     int type;         /**< file type */
     int nwait;        /**< #waits */
     int nwrite;       /**< #synchronous writes */
@@ -206,6 +208,7 @@ int EAF_Open(const char *fname, int type, int *fd)
             file[i].fname = 0;
             return ELIO_PENDING_ERR;
       }
+      file[i].cache = eaf_cache_open(file[i].elio_fd);
     }
 
     file[i].nwait = file[i].nread = file[i].nwrite = 
@@ -225,6 +228,8 @@ int EAF_Open(const char *fname, int type, int *fd)
  */
 int EAF_Close(int fd)
 {
+    int rc = EAF_OK, rc2;
+
     if (!valid_fd(fd)) return EAF_ERR_INVALID_FD;
     
     if (file[fd].size > 0) {
@@ -240,7 +245,14 @@ int EAF_Close(int fd)
     free(file[fd].fname);
     file[fd].fname = 0;
 
-    return elio_close(file[fd].elio_fd);
+    /* a write behind that failed is reported here, the file is closed
+       in any case */
+    if (file[fd].cache) {
+        rc = eaf_cache_close(file[fd].cache);
+        file[fd].cache = NULL;
+    }
+    rc2 = elio_close(file[fd].elio_fd);
+    return rc ? rc : rc2;
     }
 }
 
@@ -271,6 +283,8 @@ int EAF_Write(int fd, eaf_off_t offset, const void *buf, size_t bytes)
       memcpy(((char*)file[fd].pointer)+(long)offset, buf, bytes);
       rc=bytes;
       }
+    }else if (file[fd].cache) {
+    rc = eaf_cache_write(file[fd].cache, (Off_t) offset, buf, (Size_t) bytes);
     }else{
     rc = elio_write(file[fd].elio_fd, (Off_t) offset, buf, (Size_t) bytes);
     }
@@ -314,6 +328,8 @@ int EAF_Awrite(
       rc=bytes;
       }
     }else{
+    if (file[fd].cache && (rc = eaf_cache_flush(file[fd].cache, 1)))
+        return rc;
     rc = elio_awrite(file[fd].elio_fd, (Off_t)offset, buf, (Size_t)bytes, &req);
     }
     if(!rc){
@@ -345,6 +361,8 @@ int EAF_Read(int fd, eaf_off_t offset, void *buf, size_t bytes)
       memcpy(buf, ((char*)file[fd].pointer)+(long)offset,  bytes);
       rc=bytes;
       }
+    }else if (file[fd].cache) {
+    rc = eaf_cache_read(file[fd].cache, (Off_t) offset, buf, (Size_t) bytes);
     }else{
     rc = elio_read(file[fd].elio_fd, (Off_t) offset, buf, (Size_t) bytes);
     }
@@ -385,6 +403,8 @@ int EAF_Aread(int fd, eaf_off_t offset, void *buf, size_t bytes, int *req_id)
       rc=0;
       }
     }else{
+    if (file[fd].cache && (rc = eaf_cache_flush(file[fd].cache, 0)))
+        return rc;
     rc = elio_aread(file[fd].elio_fd, (Off_t) offset, buf, (Size_t)bytes, &req);
     }
 
@@ -398,6 +418,49 @@ int EAF_Aread(int fd, eaf_off_t offset, void *buf, size_t bytes, int *req_id)
 }
 
 
+/**
+ * Map bytes at the specified offset in the file read-only into memory
+ * and return their address in *ptr, so that data can be used in place
+ * instead of being read into a buffer.  The mapping must be released
+ * with EAF_Unmap before the file is closed or written.
+ * Return 0 on success, non-zero if the file cannot be mapped, in which
+ * case EAF_Read should be used.
+ */
+int EAF_Map(int fd, eaf_off_t offset, size_t bytes, void **ptr)
+{
+    double start = wall_time();
+
+    if (!valid_fd(fd)) return EAF_ERR_INVALID_FD;
+
+    if (file[fd].size > 0) {
+      if((offset+bytes)>file[fd].size) return EAF_ERR_MAP;
+      *ptr = ((char*)file[fd].pointer)+(long)offset;
+    }else{
+      if (offset != (eaf_off_t)(long)offset) return EAF_ERR_NONINTEGER_OFFSET;
+      if (file[fd].cache && eaf_cache_flush(file[fd].cache, 0)) return EAF_ERR_MAP;
+      *ptr = elio_map(file[fd].elio_fd, (Off_t) offset, (Size_t) bytes);
+      if (*ptr == NULL) return EAF_ERR_MAP;
+    }
+    file[fd].nread++;
+    file[fd].nb_read += bytes;
+    file[fd].t_read += wall_time() - start;
+    return EAF_OK;
+}
+
+
+/**
+ * Release a mapping obtained from EAF_Map.
+ * Return 0 on success, non-zero on failure
+ */
+int EAF_Unmap(int fd, void *ptr, size_t bytes)
+{
+    if (!valid_fd(fd)) return EAF_ERR_INVALID_FD;
+
+    if (file[fd].size > 0) return EAF_OK;
+    return elio_unmap(ptr, (Size_t) bytes);
+}
+
+
 /**
  * Wait for the I/O operation referred to by req_id to complete.
  * Return 0 on success, non-zero on failure
@@ -581,6 +644,8 @@ void EAF_Errmsg(int code, char *msg)
         (void) strcpy(msg, "offset is not an integer");
     else if (code == EAF_ERR_TRUNCATE)
         (void) strcpy(msg, "truncate failed");
+    else if (code == EAF_ERR_MAP)
+        (void) strcpy(msg, "file cannot be mapped");
     else 
         elio_errmsg(code, msg);
 }
@@ -598,6 +663,9 @@ int EAF_Truncate(int fd, eaf_off_t length)
 
     if (!valid_fd(fd)) return EAF_ERR_INVALID_FD;
 
+    if (file[fd].cache && eaf_cache_flush(file[fd].cache, 1))
+        return EAF_ERR_TRUNCATE;
+
 #ifdef CRAY 
     /* ftruncate does not work with Cray FFIO, we need to implement it
      * as a sequence of generic close, truncate, open calls 
@@ -611,8 +679,16 @@ int EAF_Truncate(int fd, eaf_off_t length)
         file[fd].fname = 0;
         return ELIO_PENDING_ERR;
     }
+    if (file[fd].cache) {
+        rc = eaf_cache_close(file[fd].cache);
+        file[fd].cache = eaf_cache_open(file[fd].elio_fd);
+        if (rc) return rc;
+    }
 #else
     if(elio_truncate(file[fd].elio_fd, (Off_t)length)) return EAF_ERR_TRUNCATE;
+    /* learn the new length */
+    if (file[fd].cache && eaf_cache_flush(file[fd].cache, 1))
+        return EAF_ERR_TRUNCATE;
 #endif
 
     return EAF_OK;
@@ -637,6 +713,8 @@ int EAF_Length(int fd, eaf_off_t *length)
       len=file[fd].size;
       rc=0;
     }else{
+    if (file[fd].cache && (rc = eaf_cache_flush(file[fd].cache, 0)))
+        return rc;
     rc = elio_length(file[fd].elio_fd, &len);
     }
     if(!rc) *length = (eaf_off_t) len;
@@ -702,6 +780,16 @@ void EAF_Print_stats(int fd)
         printf("rate(mb/s): %.2e  %.2e\n", mbw, mbr);
         printf("------------------------------------------------------------\n\n");
     }
+    if (file[fd].cache) {
+        eaf_cache_stats_t cs;
+        eaf_cache_stats(file[fd].cache, &cs);
+        printf("cache: %ld hits %ld misses (%.1f%% hit rate), "
+                "%ld blocks read ahead\n", cs.hits, cs.misses,
+                (cs.hits + cs.misses) ? 100.0*cs.hits/(cs.hits + cs.misses)
+                                      : 0.0, cs.ahead);
+        printf("cache: %ld writes, %.2e bytes written behind\n\n",
+                cs.writes, cs.behind);
+    }
     fflush(stdout);
 }
 
@@ -24,6 +24,7 @@
 #define EAF_ERR_NONINTEGER_OFFSET -10018
 #define EAF_ERR_TRUNCATE       -10019
 #define EAF_ERR_LENGTH         -10020
+#define EAF_ERR_MAP            -10021
 
 
 #endif
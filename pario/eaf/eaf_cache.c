@@ -0,0 +1,483 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+/** @file
+ * Block cache for EAF files.
+ *
+ * Reads and writes no larger than a cache block go through a pool of
+ * blocks shared by all open files.  Writes are kept in the cache and
+ * merged, so that a run of small records reaches the disk as one large
+ * write; a block that has been filled completely is written behind
+ * asynchronously.  A file read sequentially has the blocks ahead of the
+ * reader read asynchronously.  Larger requests go to ELIO directly.
+ *
+ * EAF_CACHE_MB sets the size of the pool (default 16 MB, 0 disables the
+ * cache) and EAF_CACHE_KB the size of a block (default 256 KB).
+ */
+
+#if HAVE_STDIO_H
+#   include <stdio.h>
+#endif
+#if HAVE_STDLIB_H
+#   include <stdlib.h>
+#endif
+#if HAVE_STRING_H
+#   include <string.h>
+#endif
+
+#include "elio.h"
+#include "eafP.h"
+#include "eaf_cache.h"
+
+#define CACHE_MB      16    /**< default size of block pool in MB */
+#define CACHE_KB      256   /**< default size of a block in KB */
+#define CACHE_MIN     4     /**< fewest blocks worth having */
+#define CACHE_SEQ     2     /**< sequential reads before reading ahead */
+#define CACHE_AHEAD   2     /**< blocks read ahead of a sequential reader */
+
+#define BLK_FREE      0     /**< not in use */
+#define BLK_VALID     1     /**< holds data of its owner */
+#define BLK_READING   2     /**< being read ahead */
+#define BLK_WRITING   3     /**< being written behind */
+
+typedef struct {
+    eaf_cache_t *owner;     /**< file the block belongs to */
+    long block;             /**< block index in file */
+    int state;              /**< BLK_* */
+    long vlo, vhi;          /**< valid bytes [vlo,vhi) of block */
+    long dlo, dhi;          /**< dirty bytes, empty if dlo == dhi */
+    io_request_t req;       /**< pending read or write */
+    unsigned long stamp;    /**< time of last use */
+    char *data;
+} cache_block_t;
+
+struct eaf_cache_t {
+    Fd_t fd;                /**< ELIO file descriptor */
+    double length;          /**< length of file on disk, as last known */
+    double next;            /**< offset following the last read */
+    int seq;                /**< consecutive sequential reads */
+    eaf_cache_stats_t stats;
+};
+
+static cache_block_t *blocks = NULL;
+static int nblocks = -1;    /**< -1 until the pool is set up */
+static long bsize;
+static unsigned long clock_now = 0;
+
+
+/**
+ * Allocate the block pool on first use.  Returns the number of blocks,
+ * 0 if the cache is disabled.
+ */
+static int cache_setup(void)
+{
+    char *env;
+    long mb = CACHE_MB, kb = CACHE_KB, i;
+    char *mem;
+
+    if (nblocks >= 0) return nblocks;
+
+    if ((env = getenv("EAF_CACHE_MB")) != NULL) mb = atol(env);
+    if ((env = getenv("EAF_CACHE_KB")) != NULL) kb = atol(env);
+    nblocks = 0;
+    if (mb <= 0 || kb <= 0 || mb*1024/kb < CACHE_MIN) return nblocks;
+
+    bsize = kb*1024;
+    blocks = (cache_block_t*) malloc(sizeof(cache_block_t) * (mb*1024/kb));
+    mem = (char*) malloc((size_t)(mb*1024/kb) * bsize);
+    if (!blocks || !mem) {
+        free(blocks);
+        free(mem);
+        blocks = NULL;
+        return nblocks;
+    }
+    nblocks = (int)(mb*1024/kb);
+    for (i = 0; i < nblocks; i++) {
+        blocks[i].owner = NULL;
+        blocks[i].state = BLK_FREE;
+        blocks[i].stamp = 0;
+        blocks[i].data = mem + i*bsize;
+    }
+    return nblocks;
+}
+
+
+/**
+ * Return the block holding block b of c, or NULL.
+ */
+static cache_block_t *cache_find(eaf_cache_t *c, long b)
+{
+    int i;
+
+    for (i = 0; i < nblocks; i++)
+        if (blocks[i].owner == c && blocks[i].block == b
+                && blocks[i].state != BLK_FREE)
+            return blocks + i;
+    return NULL;
+}
+
+
+/**
+ * Wait for an asynchronous read or write of blk.  A failed read ahead
+ * only loses the block; a failed write is reported.
+ */
+static int cache_complete(cache_block_t *blk)
+{
+    int rc = ELIO_OK;
+
+    if (blk->state == BLK_READING) {
+        if (elio_wait(&blk->req) != ELIO_OK) {
+            blk->state = BLK_FREE;
+            blk->owner = NULL;
+            return ELIO_OK;
+        }
+        blk->state = BLK_VALID;
+    } else if (blk->state == BLK_WRITING) {
+        rc = elio_wait(&blk->req);
+        blk->state = BLK_VALID;
+    }
+    return rc;
+}
+
+
+/**
+ * Write the dirty bytes of blk to disk, asynchronously if async is set.
+ */
+static int cache_writeback(cache_block_t *blk, int async)
+{
+    eaf_cache_t *c = blk->owner;
+    double offset = (double)blk->block*bsize + blk->dlo;
+    long bytes = blk->dhi - blk->dlo;
+    int rc = ELIO_OK;
+
+    if (bytes <= 0) return ELIO_OK;
+
+    if (async) {
+        rc = elio_awrite(c->fd, (Off_t) offset, blk->data + blk->dlo,
+                (Size_t) bytes, &blk->req);
+        if (rc == ELIO_OK) blk->state = BLK_WRITING;
+    } else if (elio_write(c->fd, (Off_t) offset, blk->data + blk->dlo,
+                (Size_t) bytes) != bytes) {
+        rc = EAF_ERR_WRITE;
+    }
+    if (offset + bytes > c->length) c->length = offset + bytes;
+    blk->dlo = blk->dhi = 0;
+    c->stats.behind += bytes;
+    return rc;
+}
+
+
+/**
+ * Take the least recently used block, writing back what it holds, and
+ * give it to block b of c.  Returns NULL if the write back failed.
+ */
+static cache_block_t *cache_new(eaf_cache_t *c, long b)
+{
+    cache_block_t *blk = NULL;
+    int i;
+
+    for (i = 0; i < nblocks; i++) {
+        if (blocks[i].state == BLK_FREE) {
+            blk = blocks + i;
+            break;
+        }
+        if (!blk || blocks[i].stamp < blk->stamp) blk = blocks + i;
+    }
+
+    if (blk->state != BLK_FREE) {
+        if (cache_complete(blk) != ELIO_OK) return NULL;
+        if (blk->state != BLK_FREE && cache_writeback(blk, 0) != ELIO_OK)
+            return NULL;
+    }
+
+    blk->owner = c;
+    blk->block = b;
+    blk->state = BLK_VALID;
+    blk->vlo = blk->vhi = blk->dlo = blk->dhi = 0;
+    blk->stamp = ++clock_now;
+    return blk;
+}
+
+
+/**
+ * Return the number of bytes of block b that are in the file on disk.
+ */
+static long cache_extent(eaf_cache_t *c, long b)
+{
+    double offset = (double)b*bsize;
+    Off_t length;
+
+    /* the file may have grown through other means */
+    if (offset + bsize > c->length && elio_length(c->fd, &length) == ELIO_OK
+            && length > c->length)
+        c->length = (double) length;
+    if (c->length <= offset) return 0;
+    return (c->length - offset < bsize) ? (long)(c->length - offset) : bsize;
+}
+
+
+/**
+ * Read bytes [lo,hi) of block blk from disk, after writing back its dirty
+ * bytes.  A sequential reader gets the whole block instead.
+ */
+static int cache_fill(cache_block_t *blk, long lo, long hi)
+{
+    eaf_cache_t *c = blk->owner;
+    long bytes;
+    int rc;
+
+    if ((rc = cache_complete(blk)) != ELIO_OK) return rc;
+    if ((rc = cache_writeback(blk, 0)) != ELIO_OK) return rc;
+
+    bytes = cache_extent(c, blk->block);
+    if (c->seq > 0 || hi > bytes) {
+        lo = 0;
+        hi = bytes;
+    }
+    if (hi > lo && elio_read(c->fd, (Off_t)((double)blk->block*bsize + lo),
+                blk->data + lo, (Size_t)(hi - lo)) != hi - lo)
+        return EAF_ERR_READ;
+    blk->vlo = lo;
+    blk->vhi = hi;
+    return ELIO_OK;
+}
+
+
+/**
+ * Start reading the blocks that follow block b of a sequential reader.
+ */
+static void cache_read_ahead(eaf_cache_t *c, long b)
+{
+    cache_block_t *blk;
+    long next, bytes;
+
+    for (next = b+1; next <= b+CACHE_AHEAD; next++) {
+        if (cache_find(c, next)) continue;
+        if ((double)next*bsize >= c->length) return;
+        bytes = (c->length - (double)next*bsize < bsize) ?
+            (long)(c->length - (double)next*bsize) : bsize;
+        if (!(blk = cache_new(c, next))) return;
+        if (elio_aread(c->fd, (Off_t)((double)next*bsize), blk->data,
+                    (Size_t) bytes, &blk->req) != ELIO_OK) {
+            blk->state = BLK_FREE;
+            blk->owner = NULL;
+            return;
+        }
+        blk->state = BLK_READING;
+        blk->vhi = bytes;
+        c->stats.ahead++;
+    }
+}
+
+
+/**
+ * Write back and forget all blocks of c that overlap [offset,offset+bytes).
+ */
+static int cache_forget(eaf_cache_t *c, double offset, double bytes)
+{
+    int i, rc, status = ELIO_OK;
+
+    for (i = 0; i < nblocks; i++) {
+        cache_block_t *blk = blocks + i;
+        if (blk->owner != c || blk->state == BLK_FREE) continue;
+        if ((double)(blk->block+1)*bsize <= offset
+                || (double)blk->block*bsize >= offset + bytes) continue;
+        if ((rc = cache_complete(blk)) != ELIO_OK) status = rc;
+        if (blk->state != BLK_FREE && (rc = cache_writeback(blk, 0)) != ELIO_OK)
+            status = rc;
+        blk->state = BLK_FREE;
+        blk->owner = NULL;
+    }
+    return status;
+}
+
+
+/**
+ * Return a cache for the ELIO file fd, or NULL if caching is disabled.
+ */
+eaf_cache_t *eaf_cache_open(Fd_t fd)
+{
+    eaf_cache_t *c;
+    Off_t length;
+
+    if (cache_setup() == 0) return NULL;
+    if (!(c = (eaf_cache_t*) malloc(sizeof(eaf_cache_t)))) return NULL;
+
+    c->fd = fd;
+    c->length = (elio_length(fd, &length) == ELIO_OK) ? (double) length : 0.0;
+    c->next = -1.0;
+    c->seq = 0;
+    memset(&c->stats, 0, sizeof(c->stats));
+    return c;
+}
+
+
+/**
+ * Read bytes at offset through the cache.
+ * Returns the number of bytes read or an error code (<0), as elio_read.
+ */
+Size_t eaf_cache_read(eaf_cache_t *c, Off_t offset, void *buf, Size_t bytes)
+{
+    cache_block_t *blk;
+    long b, lo, hi;
+    Size_t done = 0;
+    int rc, hit;
+
+    if (bytes > bsize) {
+        if ((rc = cache_forget(c, offset, (double) bytes)) != ELIO_OK)
+            return rc;
+        return elio_read(c->fd, offset, buf, bytes);
+    }
+
+    c->seq = (offset == c->next) ? c->seq+1 : 0;
+    c->next = offset + bytes;
+
+    while (done < bytes) {
+        b  = (long)((offset + done)/bsize);
+        lo = (long)(offset + done - (double)b*bsize);
+        hi = (bytes - done < bsize - lo) ? lo + (long)(bytes - done) : bsize;
+
+        hit = 0;
+        if ((blk = cache_find(c, b)) && blk->state == BLK_READING) {
+            (void) cache_complete(blk);
+            if (blk->state == BLK_FREE) blk = NULL;
+        }
+        if (blk) hit = (lo >= blk->vlo && hi <= blk->vhi);
+        if (!hit) {
+            if (!blk && !(blk = cache_new(c, b))) return EAF_ERR_READ;
+            if ((rc = cache_fill(blk, lo, hi)) != ELIO_OK) return rc;
+            /* past the end of file: let ELIO report it */
+            if (lo < blk->vlo || hi > blk->vhi)
+                return elio_read(c->fd, offset, buf, bytes);
+            c->stats.misses++;
+        } else {
+            c->stats.hits++;
+        }
+
+        memcpy((char*)buf + done, blk->data + lo, hi - lo);
+        blk->stamp = ++clock_now;
+        done += hi - lo;
+    }
+
+    if (c->seq >= CACHE_SEQ)
+        cache_read_ahead(c, (long)((offset + bytes - 1)/bsize));
+
+    return bytes;
+}
+
+
+/**
+ * Write bytes at offset through the cache.
+ * Returns the number of bytes written or an error code (<0), as elio_write.
+ */
+Size_t eaf_cache_write(eaf_cache_t *c, Off_t offset, const void *buf,
+        Size_t bytes)
+{
+    cache_block_t *blk;
+    long b, lo, hi;
+    Size_t done = 0;
+    int rc;
+
+    if (bytes > bsize) {
+        if ((rc = cache_forget(c, offset, (double) bytes)) != ELIO_OK)
+            return rc;
+        done = elio_write(c->fd, offset, buf, bytes);
+        if (done > 0 && offset + done > c->length) c->length = offset + done;
+        return done;
+    }
+
+    while (done < bytes) {
+        b  = (long)((offset + done)/bsize);
+        lo = (long)(offset + done - (double)b*bsize);
+        hi = (bytes - done < bsize - lo) ? lo + (long)(bytes - done) : bsize;
+
+        if ((blk = cache_find(c, b))) {
+            if ((rc = cache_complete(blk)) != ELIO_OK) return rc;
+            if (blk->state == BLK_FREE) blk = NULL;
+        }
+        if (!blk && !(blk = cache_new(c, b))) return EAF_ERR_WRITE;
+
+        if (blk->vlo == blk->vhi) {
+            blk->vlo = lo;
+            blk->vhi = hi;
+        } else if (lo <= blk->vhi && hi >= blk->vlo) {
+            if (lo < blk->vlo) blk->vlo = lo;
+            if (hi > blk->vhi) blk->vhi = hi;
+        } else {
+            /* keep the valid bytes contiguous */
+            if ((rc = cache_writeback(blk, 0)) != ELIO_OK) return rc;
+            blk->vlo = lo;
+            blk->vhi = hi;
+        }
+        if (blk->dlo == blk->dhi) {
+            blk->dlo = lo;
+            blk->dhi = hi;
+        } else {
+            if (lo < blk->dlo) blk->dlo = lo;
+            if (hi > blk->dhi) blk->dhi = hi;
+        }
+
+        memcpy(blk->data + lo, (const char*)buf + done, hi - lo);
+        blk->stamp = ++clock_now;
+        done += hi - lo;
+
+        /* a full block is written behind */
+        if (blk->dlo == 0 && blk->dhi == bsize
+                && (rc = cache_writeback(blk, 1)) != ELIO_OK)
+            return rc;
+    }
+    c->stats.writes++;
+
+    return bytes;
+}
+
+
+/**
+ * Write all dirty blocks of c to disk.  If drop is set, also forget
+ * the blocks, so that later reads go to disk.
+ */
+int eaf_cache_flush(eaf_cache_t *c, int drop)
+{
+    int i, rc, status = ELIO_OK;
+    Off_t length;
+
+    for (i = 0; i < nblocks; i++)
+        if (blocks[i].owner == c && blocks[i].state == BLK_VALID
+                && (rc = cache_writeback(blocks + i, 1)) != ELIO_OK)
+            status = rc;
+
+    for (i = 0; i < nblocks; i++) {
+        if (blocks[i].owner != c) continue;
+        if ((rc = cache_complete(blocks + i)) != ELIO_OK) status = rc;
+        if (drop) {
+            blocks[i].state = BLK_FREE;
+            blocks[i].owner = NULL;
+        }
+    }
+
+    if (drop && elio_length(c->fd, &length) == ELIO_OK)
+        c->length = (double) length;
+    return status;
+}
+
+
+/**
+ * Write back and release the cache of a file being closed.
+ */
+int eaf_cache_close(eaf_cache_t *c)
+{
+    int rc = eaf_cache_flush(c, 1);
+
+    free(c);
+    return rc;
+}
+
+
+/**
+ * Return the statistics of c.
+ */
+void eaf_cache_stats(eaf_cache_t *c, eaf_cache_stats_t *stats)
+{
+    *stats = c->stats;
+}
@@ -0,0 +1,26 @@
+#ifndef EAF_CACHE_H
+#define EAF_CACHE_H
+
+/* Block cache in front of ELIO files, for EAF internal use only.
+ * elio.h must be included first. */
+
+typedef struct eaf_cache_t eaf_cache_t;
+
+typedef struct {
+    long hits;        /**< reads served from the cache */
+    long misses;      /**< reads that had to go to disk */
+    long ahead;       /**< blocks read ahead */
+    long writes;      /**< writes kept in the cache */
+    double behind;    /**< bytes written back */
+} eaf_cache_stats_t;
+
+extern eaf_cache_t *eaf_cache_open(Fd_t fd);
+extern Size_t eaf_cache_read(eaf_cache_t *c, Off_t offset, void *buf,
+                             Size_t bytes);
+extern Size_t eaf_cache_write(eaf_cache_t *c, Off_t offset, const void *buf,
+                              Size_t bytes);
+extern int eaf_cache_flush(eaf_cache_t *c, int drop);
+extern int eaf_cache_close(eaf_cache_t *c);
+extern void eaf_cache_stats(eaf_cache_t *c, eaf_cache_stats_t *stats);
+
+#endif
@@ -0,0 +1,179 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#if HAVE_STDIO_H
+#   include <stdio.h>
+#endif
+#if HAVE_STDLIB_H
+#   include <stdlib.h>
+#endif
+#if HAVE_STRING_H
+#   include <string.h>
+#endif
+
+#include "eaf.h"
+#include "mp3.h"
+
+#define FNAME "eaf_testc"
+
+#define RECORD 1000     /* bytes of a record, smaller than a cache block */
+#define NRECORD 2000    /* records written, several cache blocks */
+
+static int me = 0;
+
+static void check(int rc, char *what)
+{
+    char msg[80];
+
+    if (rc == 0) return;
+    EAF_Errmsg(rc, msg);
+    printf("%d: %s failed: %s\n", me, what, msg);
+    exit(1);
+}
+
+static void fill(char *buf, int record)
+{
+    int i;
+    for (i = 0; i < RECORD; i++) buf[i] = (char)((record*31 + i) % 251);
+}
+
+
+/* Write records smaller than a cache block, so that they are merged in
+ * the cache and written behind, close the file and read them back, one
+ * record at a time, which goes through the cache and reads ahead */
+void test_write_behind(char *fname)
+{
+    char buf[RECORD], ref[RECORD];
+    eaf_off_t length;
+    int fd, i;
+
+    check(EAF_Open(fname, EAF_RW, &fd), "EAF_Open");
+    for (i = 0; i < NRECORD; i++) {
+        fill(buf, i);
+        check(EAF_Write(fd, (eaf_off_t)i*RECORD, buf, RECORD), "EAF_Write");
+    }
+    check(EAF_Close(fd), "EAF_Close after write behind");
+
+    check(EAF_Open(fname, EAF_R, &fd), "EAF_Open");
+    check(EAF_Length(fd, &length), "EAF_Length");
+    if (length != (eaf_off_t)NRECORD*RECORD) {
+        printf("%d: file has %.0f bytes, expected %d\n", me, length,
+                NRECORD*RECORD);
+        exit(1);
+    }
+    for (i = 0; i < NRECORD; i++) {
+        check(EAF_Read(fd, (eaf_off_t)i*RECORD, buf, RECORD), "EAF_Read");
+        fill(ref, i);
+        if (memcmp(buf, ref, RECORD)) {
+            printf("%d: record %d read back wrong\n", me, i);
+            exit(1);
+        }
+    }
+    check(EAF_Close(fd), "EAF_Close");
+}
+
+
+/* A write to a file opened read-only cannot reach the disk.  When it is
+ * kept in the cache, closing the file must report the failure. */
+void test_failed_write(char *fname)
+{
+    char buf[RECORD];
+    int fd, rc;
+
+    check(EAF_Open(fname, EAF_R, &fd), "EAF_Open");
+    fill(buf, 0);
+    rc = EAF_Write(fd, 0.0, buf, RECORD);
+    if (rc == 0) rc = EAF_Close(fd);
+    else check(EAF_Close(fd), "EAF_Close");
+    if (rc == 0) {
+        printf("%d: write to a read-only file was not reported\n", me);
+        exit(1);
+    }
+}
+
+
+/* Check records first to last, which must hold the values of records
+ * first+shift and on, in place if the file can be mapped, otherwise
+ * after reading them into buf */
+static void map_or_read(int fd, int first, int last, int shift, char *buf,
+        char *what)
+{
+    size_t bytes = (size_t)(last-first+1)*RECORD;
+    eaf_off_t offset = (eaf_off_t)first*RECORD;
+    void *ptr;
+    char ref[RECORD];
+    int i;
+
+    if (EAF_Map(fd, offset, bytes, &ptr) != 0) {
+        check(EAF_Read(fd, offset, buf, bytes), "EAF_Read");
+        ptr = buf;
+    }
+    for (i = first; i <= last; i++) {
+        fill(ref, i+shift);
+        if (memcmp((char*)ptr + (size_t)(i-first)*RECORD, ref, RECORD)) {
+            printf("%d: %s: record %d is wrong\n", me, what, i);
+            exit(1);
+        }
+    }
+    if (ptr != buf) check(EAF_Unmap(fd, ptr, bytes), "EAF_Unmap");
+}
+
+
+/* Map the records, change some of them, which stay in the cache, and map
+ * them again, then check everything after the file is reopened.  A region
+ * past the end of the file cannot be mapped and is read instead. */
+void test_map(char *fname)
+{
+    char *buf = (char*)malloc((size_t)NRECORD*RECORD);
+    void *ptr;
+    int fd, i;
+
+    if (!buf) {
+        printf("%d: cannot allocate buffer\n", me);
+        exit(1);
+    }
+    check(EAF_Open(fname, EAF_RW, &fd), "EAF_Open");
+    map_or_read(fd, 0, NRECORD-1, 0, buf, "EAF_Map");
+    for (i = NRECORD/4; i < NRECORD/2; i++) {
+        fill(buf, i+NRECORD);
+        check(EAF_Write(fd, (eaf_off_t)i*RECORD, buf, RECORD), "EAF_Write");
+    }
+    map_or_read(fd, NRECORD/4, NRECORD/2-1, NRECORD, buf,
+            "EAF_Map after EAF_Write");
+    check(EAF_Close(fd), "EAF_Close");
+
+    check(EAF_Open(fname, EAF_R, &fd), "EAF_Open");
+    map_or_read(fd, 0, NRECORD/4-1, 0, buf, "EAF_Map after reopen");
+    map_or_read(fd, NRECORD/4, NRECORD/2-1, NRECORD, buf,
+            "EAF_Map after reopen");
+    map_or_read(fd, NRECORD/2, NRECORD-1, 0, buf, "EAF_Map after reopen");
+    if (EAF_Map(fd, (eaf_off_t)NRECORD*RECORD, RECORD, &ptr) == 0) {
+        printf("%d: EAF_Map past the end of the file succeeded\n", me);
+        exit(1);
+    }
+    check(EAF_Close(fd), "EAF_Close");
+    free(buf);
+}
+
+
+int main(int argc, char **argv)
+{
+    char fname[256];
+
+    MP_INIT(argc,argv);
+    MP_MYID(&me);
+    sprintf(fname, "%s.%d", FNAME, me);
+
+    test_write_behind(fname);
+    if (me == 0) printf("Completed test of write behind and read back\n");
+    test_failed_write(fname);
+    if (me == 0) printf("Completed test of failed write behind\n");
+    test_map(fname);
+    if (me == 0) printf("Completed test of EAF_Map\n");
+    check(EAF_Delete(fname), "EAF_Delete");
+
+    if (me == 0) printf("All tests successful\n");
+    MP_FINALIZE();
+    return 0;
+}
@@ -56,7 +56,7 @@
 
 /****************** Internal Constants and Parameters **********************/
 
-#define  MAX_AIO_REQ  4
+#define  MAX_AIO_REQ  64
 #define  NULL_AIO    -123456
 #define  FOPEN_MODE 0644
 #define  MAX_ATTEMPTS 10
@@ -124,7 +124,9 @@
 #   define INPROGRESS 1
 #endif
 
+#ifdef AIO
 static long           aio_req[MAX_AIO_REQ]; /* array for AIO requests */
+#endif
 static int            first_elio_init = 1;  /* intialization status */
 int                   _elio_Errors_Fatal=0; /* sets mode of handling errors */
 
@@ -133,7 +135,7 @@ int                   _elio_Errors_Fatal=0; /* sets mode of handling errors */
 #if defined(AIO)
 #  define AIO_LOOKUP(aio_i) {\
       aio_i = 0;\
-      while(aio_req[aio_i] != NULL_AIO && aio_i < MAX_AIO_REQ) aio_i++;\
+      while(aio_i < MAX_AIO_REQ && aio_req[aio_i] != NULL_AIO) aio_i++;\
 }
 #else
 #  define AIO_LOOKUP(aio_i) aio_i = MAX_AIO_REQ
@@ -383,6 +385,12 @@ int elio_awrite(Fd_t fd, Off_t doffset, const void* buf, Size_t bytes, io_reques
      aio_req[aio_i] = *req_id;
   }
 
+#elif defined(ELIO_POOL)
+   /* blocking io when there are no I/O threads or the queue is full */
+   if(elio_pool_submit(ELIO_POOL_WRITE, fd->fd, offset, (void*) buf, bytes,
+                       req_id) != ELIO_OK){
+      SYNC_EMULATE(write);
+   } else stat = 0;
 #else
       /* call blocking write when AIO not available */
       SYNC_EMULATE(write);
@@ -615,6 +623,14 @@ int elio_aread(Fd_t fd, Off_t doffset, void* buf, Size_t bytes, io_request_t * r
 #       endif
         aio_req[aio_i] = *req_id;
     }
+#elif defined(ELIO_POOL)
+
+    /* blocking io when there are no I/O threads or the queue is full */
+    if(elio_pool_submit(ELIO_POOL_READ, fd->fd, offset, buf, bytes,
+                        req_id) != ELIO_OK){
+       SYNC_EMULATE(read);
+    } else stat = 0;
+
 #else
 
     /* call blocking write when AIO not available */
@@ -636,7 +652,9 @@ int elio_aread(Fd_t fd, Off_t doffset, void* buf, Size_t bytes, io_request_t * r
 \*/
 int elio_wait(io_request_t *req_id)
 {
+#if defined(AIO) || !defined(ELIO_POOL)
   int  aio_i=0;
+#endif
   int  rc;
 
   rc=0; /* just to remove the compiler warning */
@@ -647,6 +665,11 @@ int elio_wait(io_request_t *req_id)
 
   if(*req_id != ELIO_DONE ) { 
 
+#if !defined(AIO) && defined(ELIO_POOL)
+      rc = elio_pool_wait(*req_id);
+      *req_id = ELIO_DONE;
+      if(rc != ELIO_OK) ELIO_ERROR(rc,0);
+#else
 #    ifdef AIO
 #      if defined(CRAY)
 
@@ -682,11 +705,12 @@ int elio_wait(io_request_t *req_id)
 #  endif
 #endif
 
-      while(aio_req[aio_i] != *req_id && aio_i < MAX_AIO_REQ) aio_i++;
+      while(aio_i < MAX_AIO_REQ && aio_req[aio_i] != *req_id) aio_i++;
       if(aio_i >= MAX_AIO_REQ) ELIO_ERROR(HANDFAIL, aio_i);
 
       aio_req[aio_i] = NULL_AIO;
       *req_id = ELIO_DONE;
+#endif
    }
 
 #ifdef PABLO
@@ -703,7 +727,9 @@ int elio_wait(io_request_t *req_id)
 int elio_probe(io_request_t *req_id, int* status)
 {
   int    errval=-1;
+#ifdef AIO
   int    aio_i = 0;
+#endif
      
 #ifdef PABLO
   int pablo_code = PABLO_elio_probe;
@@ -713,8 +739,15 @@ int elio_probe(io_request_t *req_id, int* status)
   if(*req_id == ELIO_DONE){
       *status = ELIO_DONE;
   } else {
-      
-#ifdef AIO
+
+#if !defined(AIO) && defined(ELIO_POOL)
+      int done;
+      if((errval = elio_pool_probe(*req_id, &done)) != ELIO_OK){
+          *req_id = ELIO_DONE;
+          return errval;
+      }
+      errval = done ? 0 : INPROGRESS;
+#elif defined(AIO)
 #    if defined(CRAY)
 
 #     if defined(FFIO)
@@ -737,12 +770,14 @@ int elio_probe(io_request_t *req_id, int* status)
 #endif
       switch (errval) {
       case 0: 
-          while(aio_req[aio_i] != *req_id && aio_i < MAX_AIO_REQ) aio_i++;
+#ifdef AIO
+          while(aio_i < MAX_AIO_REQ && aio_req[aio_i] != *req_id) aio_i++;
           if(aio_i >= MAX_AIO_REQ) ELIO_ERROR(HANDFAIL, aio_i);
+          aio_req[aio_i] = NULL_AIO;
+#endif
 
       *req_id = ELIO_DONE; 
       *status = ELIO_DONE;
-      aio_req[aio_i] = NULL_AIO;
       break;
       case INPROGRESS:
       *status = ELIO_PENDING; 
@@ -991,6 +1026,62 @@ int elio_fsync(Fd_t fd)
 }
 
 
+
+/*\ Map bytes at offset of the file read-only into memory.
+ *  Returns the address of offset in the mapping, or NULL if the file
+ *  cannot be mapped (no mmap, several extents, past end of file); the
+ *  caller should then use elio_read.
+\*/
+void *elio_map(Fd_t fd, Off_t doffset, Size_t bytes)
+{
+#ifdef ELIO_MMAP
+  long  page = sysconf(_SC_PAGESIZE);
+  off_t offset = (off_t) doffset;
+  off_t base = offset - offset % page;
+  Off_t length;
+  char *ptr;
+
+  if (fd->next || bytes <= 0) return NULL;
+  if (elio_length(fd, &length) != ELIO_OK || doffset + bytes > length)
+    return NULL;
+
+  ptr = mmap(NULL, (size_t)(bytes + (offset - base)), PROT_READ, MAP_SHARED,
+             fd->fd, base);
+  if (ptr == MAP_FAILED) return NULL;
+  return ptr + (offset - base);
+#else
+  return NULL;
+#endif
+}
+
+
+/*\ Remove a mapping made by elio_map
+\*/
+int elio_unmap(void *ptr, Size_t bytes)
+{
+#ifdef ELIO_MMAP
+  long  page = sysconf(_SC_PAGESIZE);
+  long  lead = (long)((size_t)ptr % page);
+
+  if (munmap((char*)ptr - lead, (size_t)(bytes + lead)) == -1)
+    return CLOSFAIL;
+#endif
+  return ELIO_OK;
+}
+
+
+/*\ Start reading bytes at ptr of a mapping into memory
+\*/
+void elio_advise(void *ptr, Size_t bytes)
+{
+#if defined(ELIO_MMAP) && defined(MADV_WILLNEED)
+  long  page = sysconf(_SC_PAGESIZE);
+  long  lead = (long)((size_t)ptr % page);
+
+  (void) madvise((char*)ptr - lead, (size_t)(bytes + lead), MADV_WILLNEED);
+#endif
+}
+
 /*\ Delete File
 \*/
 int elio_delete(const char* filename)
@@ -1035,7 +1126,7 @@ int elio_delete(const char* filename)
 void elio_init(void)
 {
   if(first_elio_init) {
-#     if defined(ASYNC)
+#     if defined(AIO)
            int i;
            for(i=0; i < MAX_AIO_REQ; i++)
          aio_req[i] = NULL_AIO;
@@ -55,4 +55,7 @@ extern int    elio_truncate(Fd_t fd, Off_t length);
 extern int    elio_length(Fd_t fd, Off_t *length);
 extern void   elio_errmsg(int code, char *msg);
 extern int    elio_fsync(Fd_t fd);
+extern void  *elio_map(Fd_t fd, Off_t offset, Size_t bytes);
+extern int    elio_unmap(void *ptr, Size_t bytes);
+extern void   elio_advise(void *ptr, Size_t bytes);
 
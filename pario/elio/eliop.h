@@ -75,6 +75,23 @@ extern int                   _elio_Errors_Fatal;
 extern void                  elio_init(void);
 extern int                   elio_pending_error;
 
+/* asynchronous I/O by a pool of I/O threads (pool.c) */
+#if HAVE_PTHREAD_H && !defined(WIN32)
+#   define ELIO_POOL 1
+#   define ELIO_POOL_READ  0
+#   define ELIO_POOL_WRITE 1
+extern int elio_pool_submit(int op, int fd, off_t offset, void *buf,
+                            Size_t bytes, io_request_t *req_id);
+extern int elio_pool_wait(io_request_t req_id);
+extern int elio_pool_probe(io_request_t req_id, int *done);
+#endif
+
+/* read-only mappings of files (elio_map) */
+#if HAVE_SYS_MMAN_H && !defined(WIN32)
+#   define ELIO_MMAP 1
+#   include <sys/mman.h>
+#endif
+
 
 #if !defined(PRINT_AND_ABORT)
 #   if defined(SUN)
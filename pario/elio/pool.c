@@ -0,0 +1,310 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+/** @file
+ * Portable asynchronous I/O engine for ELIO.
+ *
+ * Requests are queued to a small pool of I/O threads that perform them
+ * with pread/pwrite.  Requests queued back to back on the same file, in
+ * the same direction and at contiguous offsets are combined into one
+ * preadv/pwritev.  Each request owns a slot of a fixed table; free slots
+ * are kept on a list so that submission does not search the table.  A
+ * request id encodes its slot and a generation count, so stale ids are
+ * detected.  Completion is published in the slot itself, so elio_probe
+ * costs no system call and no lock; elio_wait only sleeps once the
+ * request has been seen pending for a while.
+ *
+ * ELIO_THREADS sets the number of I/O threads (default 4); 0 makes every
+ * request synchronous, as on systems without pthreads.
+ */
+
+#include "eliop.h"
+
+#ifdef ELIO_POOL
+
+#include <pthread.h>
+#include <sys/uio.h>
+#include <limits.h>
+
+/* slots in the request table, default I/O threads, requests per vector */
+#define POOL_REQ      1024
+#define POOL_THREADS  4
+#define POOL_IOV      64
+
+/* spins on the completion flag before elio_pool_wait sleeps */
+#define POOL_SPIN     2000
+
+/* slot states */
+#define SLOT_FREE     0
+#define SLOT_QUEUED   1
+#define SLOT_ACTIVE   2
+#define SLOT_DONE     3
+
+typedef struct {
+  volatile int state;   /* SLOT_* */
+  int     op;           /* ELIO_POOL_READ or ELIO_POOL_WRITE */
+  int     fd;           /* OS handle */
+  off_t   offset;       /* in file */
+  char   *buf;          /* user buffer */
+  Size_t  bytes;        /* to transfer */
+  int     status;       /* ELIO_OK or error code, valid when SLOT_DONE */
+  long    gen;          /* generation, part of the request id */
+  int     next;         /* free list or queue link */
+} pool_slot_t;
+
+static pool_slot_t     pool[POOL_REQ];
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  pool_work = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  pool_done = PTHREAD_COND_INITIALIZER;
+static int             pool_free = -1;     /* first free slot */
+static int             pool_head = -1;     /* first queued slot */
+static int             pool_tail = -1;     /* last queued slot */
+static int             pool_waiters = 0;   /* threads in elio_pool_wait */
+static int             pool_nthreads = -1; /* -1 until started */
+
+
+/*\ Transfer the given vector at offset, restarting after interrupts and
+ *  partial transfers.  Returns ELIO_OK or an error code.
+\*/
+static int pool_transfer(int op, int fd, struct iovec *iov, int n, off_t offset)
+{
+  ssize_t stat;
+
+  while (n > 0) {
+#if HAVE_PREADV && HAVE_PWRITEV
+    if (n > 1)
+      stat = (op == ELIO_POOL_READ) ? preadv(fd, iov, n, offset)
+                                    : pwritev(fd, iov, n, offset);
+    else
+#endif
+      stat = (op == ELIO_POOL_READ) ? pread(fd, iov->iov_base, iov->iov_len, offset)
+                                    : pwrite(fd, iov->iov_base, iov->iov_len, offset);
+
+    if (stat == -1 && (errno == EINTR || errno == EAGAIN))
+      continue;
+    if (stat == 0 && op == ELIO_POOL_READ)
+      return EOFFAIL;
+    if (stat <= 0)
+      return (op == ELIO_POOL_READ) ? AREADFAIL : AWRITFAIL;
+
+    /* skip what was transferred */
+    offset += stat;
+    while (n > 0 && (size_t)stat >= iov->iov_len) {
+      stat -= iov->iov_len;
+      iov++;
+      n--;
+    }
+    if (n > 0) {
+      iov->iov_base = (char*)iov->iov_base + stat;
+      iov->iov_len -= stat;
+    }
+  }
+  return ELIO_OK;
+}
+
+
+/*\ I/O thread: take the request at the head of the queue, together with
+ *  any requests queued behind it that continue it in the same file, and
+ *  perform them as one transfer.
+\*/
+static void *pool_thread(void *arg)
+{
+  struct iovec iov[POOL_IOV];
+  int    slot[POOL_IOV];
+  int    i, n, status;
+
+  for (;;) {
+    pthread_mutex_lock(&pool_lock);
+    while (pool_head < 0)
+      pthread_cond_wait(&pool_work, &pool_lock);
+
+    n = 0;
+    do {
+      pool_slot_t *s = pool + pool_head;
+      slot[n] = pool_head;
+      iov[n].iov_base = s->buf;
+      iov[n].iov_len = (size_t)s->bytes;
+      s->state = SLOT_ACTIVE;
+      n++;
+      pool_head = s->next;
+    } while (pool_head >= 0 && n < POOL_IOV
+             && pool[pool_head].fd == pool[slot[0]].fd
+             && pool[pool_head].op == pool[slot[0]].op
+             && pool[pool_head].offset == pool[slot[n-1]].offset
+                                          + pool[slot[n-1]].bytes);
+    if (pool_head < 0)
+      pool_tail = -1;
+    pthread_mutex_unlock(&pool_lock);
+
+    status = pool_transfer(pool[slot[0]].op, pool[slot[0]].fd, iov, n,
+                           pool[slot[0]].offset);
+
+    /* publish the results; elio_pool_probe reads them without the lock */
+    for (i = 0; i < n; i++)
+      pool[slot[i]].status = status;
+    __sync_synchronize();
+    for (i = 0; i < n; i++)
+      pool[slot[i]].state = SLOT_DONE;
+
+    pthread_mutex_lock(&pool_lock);
+    if (pool_waiters > 0)
+      pthread_cond_broadcast(&pool_done);
+    pthread_mutex_unlock(&pool_lock);
+  }
+  return arg;
+}
+
+
+/*\ Build the free list and start the I/O threads.  Called with the lock
+ *  held, on the first submission.
+\*/
+static void pool_start(void)
+{
+  pthread_attr_t attr;
+  pthread_t      thread;
+  char          *env;
+  int            i, n;
+
+  for (i = 0; i < POOL_REQ; i++) {
+    pool[i].state = SLOT_FREE;
+    pool[i].gen = 0;
+    pool[i].next = i + 1;
+  }
+  pool[POOL_REQ-1].next = -1;
+  pool_free = 0;
+
+  n = POOL_THREADS;
+  if ((env = getenv("ELIO_THREADS")) != NULL)
+    n = atoi(env);
+
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  for (pool_nthreads = 0; pool_nthreads < n; pool_nthreads++)
+    if (pthread_create(&thread, &attr, pool_thread, NULL) != 0)
+      break;
+  pthread_attr_destroy(&attr);
+}
+
+
+/*\ Return the slot of a request id, or -1 if the id is stale or invalid.
+\*/
+static int pool_slot(io_request_t req_id)
+{
+  int slot;
+
+  if (req_id < POOL_REQ) return -1;
+  slot = (int)(req_id % POOL_REQ);
+  if (pool[slot].gen != req_id / POOL_REQ || pool[slot].state == SLOT_FREE)
+    return -1;
+  return slot;
+}
+
+
+/*\ Return a completed slot to the free list and return its status.
+\*/
+static int pool_release(int slot)
+{
+  int status = pool[slot].status;
+
+  pthread_mutex_lock(&pool_lock);
+  pool[slot].state = SLOT_FREE;
+  pool[slot].next = pool_free;
+  pool_free = slot;
+  pthread_mutex_unlock(&pool_lock);
+
+  return status;
+}
+
+
+/*\ Queue a read or write of bytes at offset of the OS file fd.
+ *  Returns ELIO_OK and sets *req_id, or ELIO_PENDING if the request
+ *  was not queued (no I/O threads or a full table), in which case the
+ *  caller should perform it synchronously.
+\*/
+int elio_pool_submit(int op, int fd, off_t offset, void *buf, Size_t bytes,
+                     io_request_t *req_id)
+{
+  pool_slot_t *s;
+  int slot;
+
+  pthread_mutex_lock(&pool_lock);
+  if (pool_nthreads < 0)
+    pool_start();
+  if (pool_nthreads == 0 || pool_free < 0) {
+    pthread_mutex_unlock(&pool_lock);
+    return ELIO_PENDING;
+  }
+
+  slot = pool_free;
+  s = pool + slot;
+  pool_free = s->next;
+
+  s->op = op;
+  s->fd = fd;
+  s->offset = offset;
+  s->buf = (char*)buf;
+  s->bytes = bytes;
+  s->gen++;
+  s->state = SLOT_QUEUED;
+  s->next = -1;
+
+  if (pool_tail < 0)
+    pool_head = slot;
+  else
+    pool[pool_tail].next = slot;
+  pool_tail = slot;
+
+  pthread_cond_signal(&pool_work);
+  pthread_mutex_unlock(&pool_lock);
+
+  *req_id = (io_request_t)(s->gen * POOL_REQ + slot);
+  return ELIO_OK;
+}
+
+
+/*\ Wait for a queued request to complete and invalidate it.
+ *  Returns ELIO_OK or the error code of the request.
+\*/
+int elio_pool_wait(io_request_t req_id)
+{
+  int slot, spin;
+
+  if ((slot = pool_slot(req_id)) < 0) return HANDFAIL;
+
+  for (spin = 0; spin < POOL_SPIN && pool[slot].state != SLOT_DONE; spin++)
+    ;
+  if (pool[slot].state != SLOT_DONE) {
+    pthread_mutex_lock(&pool_lock);
+    pool_waiters++;
+    while (pool[slot].state != SLOT_DONE)
+      pthread_cond_wait(&pool_done, &pool_lock);
+    pool_waiters--;
+    pthread_mutex_unlock(&pool_lock);
+  }
+  __sync_synchronize();
+
+  return pool_release(slot);
+}
+
+
+/*\ Check whether a queued request has completed; if so, invalidate it.
+ *  Returns ELIO_OK or the error code of the request.
+\*/
+int elio_pool_probe(io_request_t req_id, int *done)
+{
+  int slot;
+
+  if ((slot = pool_slot(req_id)) < 0) return HANDFAIL;
+
+  if (pool[slot].state != SLOT_DONE) {
+    *done = 0;
+    return ELIO_OK;
+  }
+  __sync_synchronize();
+
+  *done = 1;
+  return pool_release(slot);
+}
+
+#endif /* ELIO_POOL */
@@ -0,0 +1,192 @@
+#if HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#if HAVE_STDIO_H
+#   include <stdio.h>
+#endif
+#if HAVE_STDLIB_H
+#   include <stdlib.h>
+#endif
+#if HAVE_STRING_H
+#   include <string.h>
+#endif
+
+#include "eliop.h"
+#include "mp3.h"
+
+#define FNAME "elio_testc"
+
+#define RECORD 1000     /* bytes of a request */
+#define NREQ 1500       /* outstanding requests, more than the pool holds */
+
+static int me = 0;
+
+static void check(int rc, char *what)
+{
+    char msg[80];
+
+    if (rc == ELIO_OK) return;
+    elio_errmsg(rc, msg);
+    printf("%d: %s failed: %s\n", me, what, msg);
+    exit(1);
+}
+
+static void expect(int rc, int code, char *what)
+{
+    char msg[80], ref[80];
+
+    if (rc == code) return;
+    elio_errmsg(rc, msg);
+    elio_errmsg(code, ref);
+    printf("%d: %s returned %d (%s), expected %s\n", me, what, rc, msg, ref);
+    exit(1);
+}
+
+static void fill(char *buf, int record)
+{
+    int i;
+    for (i = 0; i < RECORD; i++) buf[i] = (char)((record*31 + i) % 251);
+}
+
+static void compare(char *buf, int record, char *what)
+{
+    char ref[RECORD];
+
+    fill(ref, record);
+    if (memcmp(buf, ref, RECORD)) {
+        printf("%d: %s: record %d is wrong\n", me, what, record);
+        exit(1);
+    }
+}
+
+
+/* Queue more contiguous writes than the pool has slots, so that some are
+ * combined and some are done synchronously, and wait for them out of
+ * order.  Then read the records back while a second region is written,
+ * polling for completion, and check both regions. */
+void test_concurrent(char *fname)
+{
+    io_request_t *req = (io_request_t*)malloc(2*NREQ*sizeof(io_request_t));
+    char *out = (char*)malloc(2*(Size_t)NREQ*RECORD);
+    char *in = (char*)malloc((Size_t)NREQ*RECORD);
+    int i, n, status;
+    Fd_t fd;
+
+    if (!req || !out || !in) {
+        printf("%d: cannot allocate buffers\n", me);
+        exit(1);
+    }
+    for (i = 0; i < 2*NREQ; i++) fill(out + (Size_t)i*RECORD, i);
+
+    if ((fd = elio_open(fname, ELIO_RW, ELIO_PRIVATE)) == NULL) {
+        printf("%d: elio_open failed\n", me);
+        exit(1);
+    }
+    for (i = 0; i < NREQ; i++)
+        check(elio_awrite(fd, (Off_t)i*RECORD, out + (Size_t)i*RECORD,
+                    RECORD, req + i), "elio_awrite");
+    for (i = NREQ-1; i >= 0; i--) {
+        check(elio_wait(req + i), "elio_wait after write");
+        if (req[i] != ELIO_DONE) {
+            printf("%d: elio_wait did not invalidate request %d\n", me, i);
+            exit(1);
+        }
+    }
+
+    for (i = 0; i < NREQ; i++) {
+        check(elio_aread(fd, (Off_t)i*RECORD, in + (Size_t)i*RECORD,
+                    RECORD, req + i), "elio_aread");
+        check(elio_awrite(fd, (Off_t)(NREQ+i)*RECORD,
+                    out + (Size_t)(NREQ+i)*RECORD, RECORD, req + NREQ + i),
+                "elio_awrite");
+    }
+    do {
+        n = 0;
+        for (i = 0; i < 2*NREQ; i++) {
+            check(elio_probe(req + i, &status), "elio_probe");
+            if (status == ELIO_PENDING) n++;
+            else if (status != ELIO_DONE || req[i] != ELIO_DONE) {
+                printf("%d: elio_probe gave status %d for request %d\n",
+                        me, status, i);
+                exit(1);
+            }
+        }
+    } while (n > 0);
+    for (i = 0; i < NREQ; i++)
+        compare(in + (Size_t)i*RECORD, i, "elio_aread");
+
+    for (i = 0; i < NREQ; i++) {
+        if (elio_read(fd, (Off_t)(NREQ+i)*RECORD, in + (Size_t)i*RECORD,
+                    RECORD) != RECORD) {
+            printf("%d: elio_read failed\n", me);
+            exit(1);
+        }
+        compare(in + (Size_t)i*RECORD, NREQ+i, "elio_awrite");
+    }
+    check(elio_close(fd), "elio_close");
+
+    free(in);
+    free(out);
+    free(req);
+}
+
+
+/* A read past the end of the file, a write to a file opened read-only
+ * and a request that has already completed must report their errors.
+ * Requests done synchronously report the errors of elio_read and
+ * elio_write. */
+void test_errors(char *fname)
+{
+    char buf[RECORD];
+    io_request_t id, copy;
+    int rc, status;
+    Fd_t fd;
+
+    if ((fd = elio_open(fname, ELIO_R, ELIO_PRIVATE)) == NULL) {
+        printf("%d: elio_open failed\n", me);
+        exit(1);
+    }
+
+    rc = elio_aread(fd, (Off_t)2*NREQ*RECORD, buf, RECORD, &id);
+    if (rc == ELIO_OK) rc = elio_wait(&id);
+    if (rc != EOFFAIL && rc != READFAIL)
+        expect(rc, AREADFAIL, "elio_aread past end of file");
+
+    fill(buf, 0);
+    rc = elio_awrite(fd, 0.0, buf, RECORD, &id);
+    if (rc == ELIO_OK) rc = elio_wait(&id);
+    if (rc != WRITFAIL)
+        expect(rc, AWRITFAIL, "elio_awrite to a read-only file");
+
+    check(elio_aread(fd, 0.0, buf, RECORD, &id), "elio_aread");
+    copy = id;
+    check(elio_wait(&id), "elio_wait");
+    compare(buf, 0, "elio_aread");
+    if (copy != ELIO_DONE)
+        expect(elio_wait(&copy), HANDFAIL, "elio_wait on a completed request");
+    check(elio_probe(&id, &status), "elio_probe");
+    expect(status, ELIO_DONE, "elio_probe on a completed request");
+
+    check(elio_close(fd), "elio_close");
+}
+
+
+int main(int argc, char **argv)
+{
+    char fname[256];
+
+    MP_INIT(argc,argv);
+    MP_MYID(&me);
+    sprintf(fname, "%s.%d", FNAME, me);
+
+    test_concurrent(fname);
+    if (me == 0) printf("Completed test of concurrent elio_aread and elio_awrite\n");
+    test_errors(fname);
+    if (me == 0) printf("Completed test of asynchronous I/O errors\n");
+    check(elio_delete(fname), "elio_delete");
+
+    if (me == 0) printf("All tests successful\n");
+    MP_FINALIZE();
+    return 0;
+}